@@ -18,6 +18,7 @@ It also applies the custom Look and Feel for the plugin.
 #include "Pitchblade/ui/CustomLookAndFeel.h"
 #include "Pitchblade/ui/ColorPalette.h"
 #include "Pitchblade/ui/TooltipManager.h"
+#include "Pitchblade/ui/FrameClock.h"
 
 #include "ui/TopBar.h"
 #include "ui/DaisyChain.h"
@@ -32,7 +33,8 @@ It also applies the custom Look and Feel for the plugin.
 class AudioPluginAudioProcessorEditor final : public juce::AudioProcessorEditor,
                                               public juce::DragAndDropContainer,
                                               public juce::Button::Listener,     // Austin -  added this for the settings panel
-	                                          public juce::MouseListener         // reyna - for presets/settings closing on outside click
+	                                          public juce::MouseListener,        // reyna - for presets/settings closing on outside click
+                                              public FrameClock::Host            // Austin - one frame clock for every visualizer and meter
 {
 public:
     explicit AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor&);
@@ -68,10 +70,16 @@ public:
 	//Austin - button listener for settings/presets panel
     void buttonClicked(juce::Button* button) override;
 
+    //Austin - visualizers and meters find this by looking up the component tree
+    FrameClock& getFrameClock() override { return frameClock; }
+
 private:
     // This reference is provided as a quick way for your editor to access the processor object that created it.
     AudioPluginAudioProcessor& processorRef;
 
+    //Austin - drives every visualizer and meter. Declared before the components so it outlives them
+    FrameClock frameClock;
+
     //reyna ui
 	CustomLookAndFeel customLF;     //custom colorpallet using juce lookandfeel
                                                 
@@ -12,6 +12,7 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <juce_audio_processors/juce_audio_processors.h>
 //Austin
 #include "Pitchblade/effects/GainProcessor.h"       
@@ -30,7 +31,7 @@
 class EffectNode;   // forward declaration for effectNode order 
 
 //==============================================================================
-class AudioPluginAudioProcessor final : public juce::AudioProcessor {
+class AudioPluginAudioProcessor final : public juce::AudioProcessor, private juce::AsyncUpdater, private juce::ValueTree::Listener {
 public:
     //==============================
     AudioPluginAudioProcessor();
@@ -72,6 +73,9 @@ public:
     bool isBypassed() const;
     void setBypassed(bool newState);
 
+    // call after a node's bypass is changed, so the chain latency is counted again - Austin
+    void chainLatencyChanged() { latencyChanged.store(true); }
+
     //============================== stored parameters for daisy chain - reyna
 	juce::AudioProcessorValueTreeState apvts;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
@@ -91,14 +95,8 @@ public:
     int getCurrentBlockSize() const {return currentBlockSize;}; // Austin - Was having an issue initializing de-esser
 
     // huda
-    FormantDetector& getFormantDetector() { return formantDetector; }
     void setLatestFormants(const std::vector<float>& freqs) { latestFormants = freqs; }
     const std::vector<float>& getLatestFormants() { return latestFormants; }
-    FormantShifter& getFormantShifter() { return formantShifter; }
-    Equalizer& getEqualizer() { return equalizer; }
-
-    //hayley
-    PitchCorrector& getPitchCorrector() { return pitchProcessor; }
 
     //reyna 
 	// effect node chain management
@@ -109,10 +107,24 @@ public:
 
 	// preset management
     void savePresetToFile(const juce::File& file);
-    void loadPresetFromFile(const juce::File& file);
+    void loadPresetFromFile(const juce::File& file);    // builds the chain on a background thread, then swaps it in with a short crossfade
+    // INTEGRATION TEST BUG: expose the crossfaded load without the loader thread, the chain is built on the calling thread
+    void loadPresetForTest(const juce::File& file);
     void loadDefaultPreset(const juce::String& type);
     void clearAllNodes();  
 
+	// A/B morph - a second chain (B) next to the current one (A), GLOBAL_MORPH goes from A at 0 to B at 1
+    void loadMorphTargetFromFile(const juce::File& file);   // builds B on the loader thread
+    void captureMorphTarget();                              // B becomes a copy of the chain as it is now
+    void clearMorphTarget();                                // A keeps whatever it sounds like at the moment
+    bool hasMorphTarget() const { return !morphTarget.empty(); }
+    bool isMorphBlending() const { return !morphPairs.empty(); }   // B lines up with A, so its params are blended into A
+    void updateMorph();                                     // control rate, called by the morph timer
+
+	// adds a node's state under EffectNodes, called from node constructors
+	// nodes built by the preset loader keep theirs until the preset is swapped in on the message thread
+    void addNodeState(const juce::ValueTree& nodeState);
+
 private:
     //============================================================================== 
     //processors
@@ -127,15 +139,7 @@ private:
     int currentBlockSize = 512;
 
     // huda
-    Equalizer equalizer;                    
-    FormantDetector formantDetector;        // To handle detection
     std::vector<float> latestFormants;      // Vector to store formants 
-    FormantShifter formantShifter;   
-
-    //hayley                
-    PitchDetector pitchDetector;            
-    PitchShifter pitchShifter;
-    PitchCorrector  pitchProcessor;         // To correct pitch
 
 	// reyna 
     // global bypass
@@ -155,5 +159,122 @@ private:
 	std::atomic<bool> layoutRequested{ false };     // flag for layout request
     void applyPendingLayout();
 
+    // latency reporting - Austin
+    // lookahead on the dynamics nodes delays the audio, so the total for the chain is reported to the host
+	// the total is only worked out when something changed. The audio thread first runs one block so the nodes
+	// have picked up new settings, then hands the count to the message thread. processBlock only reads the flags
+	std::atomic<int> chainLatencySamples{ 0 };      // latest total latency of the active chain
+    std::atomic<bool> latencyChanged{ true };       // the chain, a bypass or a node setting changed
+    std::atomic<bool> latencyRecount{ false };      // a block has run since, ready to count on the message thread
+    void updateChainLatency();                      // walks the chain on the message thread and tells the host
+    void handleAsyncUpdate() override;
+    // node settings (lookahead, fft mode, linear phase) live in apvts.state, any change there is counted again
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+
+    //============================== background preset loading - reyna
+	// a preset fully built and wired off the audio thread, waiting to be swapped in
+    struct LoadedChain {
+        std::vector<std::shared_ptr<EffectNode>> nodes;     // in row order, already connected
+        std::vector<Row> rows;                              // layout for the ui
+        std::vector<juce::ValueTree> nodeStates;            // go into apvts.state on the message thread at the swap
+        int frameRate = 0;                                  // GLOBAL_FRAMERATE, 0 if not stored
+        juce::File file;
+        bool morphTarget = false;                           // built as B for the A/B morph
+    };
+
+	// the chain as a preset tree: node types and params, bypass, chain modes, rows and globals. Call with audioMutex held
+    std::unique_ptr<juce::XmlElement> createPresetXml(const std::vector<std::shared_ptr<EffectNode>>& nodes, const std::vector<Row>& rows, bool withUuids);
+	// reads a preset file and builds every node. Safe off the message thread, touches nothing the audio thread uses
+    std::unique_ptr<LoadedChain> buildChainFromFile(const juce::File& file);
+    std::unique_ptr<LoadedChain> buildChainFromXml(const juce::XmlElement& presetRoot, bool keepUuids);
+	// makes a built chain the current one. crossfade hands it to the audio thread to fade in, otherwise it's live straight away
+    void installChain(LoadedChain& chain, bool crossfade);
+	// connects nodes by rows and returns them in row order. Only touches the nodes passed in
+    static std::vector<std::shared_ptr<EffectNode>> connectRows(const std::vector<std::shared_ptr<EffectNode>>& nodes, const std::vector<Row>& rows);
+
+	// builds presets one at a time. A newer request replaces one that hasn't finished
+    class PresetLoader : public juce::Thread {
+    public:
+        explicit PresetLoader(AudioPluginAudioProcessor& p) : juce::Thread("Preset loader"), owner(p) {}
+        void load(const juce::File& file, bool asMorphTarget = false);
+        void run() override;
+    private:
+        AudioPluginAudioProcessor& owner;
+        std::mutex requestLock;
+        juce::File requested, requestedMorph;   // the chain and B each keep their newest request
+        bool hasRequest = false;
+        bool hasMorphRequest = false;
+    };
+
+    std::mutex loadedChainLock;                     // guards loadedChain between the loader and the message thread
+    std::unique_ptr<LoadedChain> loadedChain;       // finished preset for the message thread
+    void swapInLoadedChain();                       // message thread: hand the loaded chain to the audio thread
+
+	// audio thread side of the swap. the old chain keeps running under the new one while it fades out,
+	// and is handed back to the message thread to be deleted so nothing is freed on the audio thread
+    using NodeList = std::shared_ptr<std::vector<std::shared_ptr<EffectNode>>>;
+    NodeList incomingNodes;                         // set under audioMutex, taken by the audio thread
+    std::atomic<bool> chainSwapPending{ false };
+    NodeList fadingNodes;                           // audio thread only
+    NodeList retiredNodes;                          // audio thread fills it, message thread empties it
+    std::atomic<bool> retiredReady{ false };
+    juce::AudioBuffer<float> crossfadeBuffer;       // old chain's copy of the block, sized in prepareToPlay
+    int fadeLengthSamples = 960;
+    int fadeSamplesDone = 0;
+    void takeIncomingChain();                       // audio thread, never waits on the lock
+    void crossfadeOut(juce::AudioBuffer<float>& buffer);
+    void retireFadingChain();
+    void discardIncomingChain();                    // when something else replaces the chain first
+
+    //============================== session state - reyna
+	// host sessions are saved as the chain's preset tree in binary, see getStateInformation
+    std::unique_ptr<juce::XmlElement> pendingSession;   // restored before the first prepareToPlay, built there at the real rate
+    double preparedRate = 0.0;                          // what the current chain's nodes were prepared with
+    int preparedBlockSize = 0;
+
+    //============================== A/B morph - reyna
+	// if B has the same node types in the same rows as A, B never runs. Its params are blended into A's nodes at control rate,
+	// the same way the panels change them. Otherwise both chains run and their outputs get an equal power crossfade.
+	// Whichever side is fully faded out sleeps, and B runs on the spare half of crossfadeBuffer so nothing else is allocated
+    struct MorphPair {
+        std::shared_ptr<EffectNode> a, b;
+        juce::NamedValueSet fromA;      // A's own values, followed while the morph sits at A
+        bool bypassA = false;
+    };
+    std::vector<std::shared_ptr<EffectNode>> morphTarget;   // B in row order, message thread
+    std::vector<Row> morphRows;
+    std::vector<MorphPair> morphPairs;                      // empty unless blending
+    std::vector<EffectNode*> morphPairedNodes;              // A's nodes and rows when the pairs were made
+    std::vector<Row> morphPairedRows;
+    float lastMorphApplied = -1.0f;
+    std::atomic<bool> morphRebuildPending{ false };         // B is rebuilt on the message thread after a rate change
+    void installMorphTarget(LoadedChain& chain);
+    void updateMorphPairing();                              // blend or crossfade, depending on how A and B line up
+    void applyMorphParams(float amount);
+    void setMorphAudioChain(NodeList nodes);                // hands B to the audio thread, or takes it back with nullptr
+
+    class MorphControl : public juce::Timer {
+    public:
+        explicit MorphControl(AudioPluginAudioProcessor& p) : owner(p) {}
+        void timerCallback() override { owner.updateMorph(); }
+    private:
+        AudioPluginAudioProcessor& owner;
+    };
+    MorphControl morphControl{ *this };
+
+	// audio thread side, handed over and retired the same way as a loaded preset
+    NodeList incomingMorph;                         // set under audioMutex
+    std::atomic<bool> morphSwapPending{ false };
+    NodeList morphNodes;                            // audio thread only
+    NodeList retiredMorph;
+    std::atomic<bool> retiredMorphReady{ false };
+    juce::SmoothedValue<float> morphGain;           // 0 is all A, 1 is all B
+    std::atomic<float>* morphAmount = nullptr;      // GLOBAL_MORPH
+    int morphChannelOffset = 0;                     // B's channels in crossfadeBuffer
+    void takeMorphChain();
+    void mixMorph(juce::AudioBuffer<float>& buffer, bool aAsleep);
+
+    PresetLoader presetLoader{ *this };             // last, so it stops before anything it builds into goes away
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
 };
\ No newline at end of file
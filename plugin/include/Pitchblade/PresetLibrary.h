@@ -0,0 +1,95 @@
+//reyna
+/*
+    The PresetLibrary keeps an index of every preset in a presets folder so
+    the PresetsPanel can search and filter them without opening the files.
+
+    Each entry has the preset's name, tags, node types, modified time, size
+    and a hash of the file. The index is stored in one cache file, by default
+    Pitchblade/PresetIndex.bin in the user's application data folder. At
+    startup only that file is read, then a background scan
+    checks the folder and only parses presets that are new or have changed
+    since the last scan.
+
+    Other .xml files in the folder are kept in the index too, with only their
+    path, modified time and size, so they aren't opened again on every scan.
+    They never show up in searches, counts or node types.
+
+    Tags come from a "tags" attribute on the preset (comma separated) and
+    from the sub folders the preset sits in, so a shared preset folder can
+    be organised by folder.
+
+    One library is shared by every plugin instance in the process through
+    juce::SharedResourcePointer, so many instances don't each scan the folder.
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class PresetLibrary : public juce::ChangeBroadcaster, private juce::Thread {
+public:
+    struct Entry {
+        juce::File file;
+        juce::String name;              // file name without .xml
+        juce::StringArray tags;
+        juce::StringArray nodeTypes;    // node xml tags in chain order, e.g. GainNode
+        juce::int64 modified = 0;       // ms since epoch
+        juce::int64 size = 0;
+        juce::String hash;              // hex of a 64 bit hash of the file
+        juce::String searchText;        // lower case name, tags and types for search
+        bool isPreset = true;           // false for other xml files, which are only remembered so they aren't re-read
+    };
+
+    // the default folder in Documents/Pitchblade/Presets
+    PresetLibrary();
+    PresetLibrary(const juce::File& presetsFolder, const juce::File& cacheFile);
+    ~PresetLibrary() override;
+
+    // checks the folder again on the background thread. Change listeners hear about it when it's done
+    void rescan();
+    // blocks until the current scan finishes. For tests
+    bool waitForScan(int timeoutMs);
+    bool isScanning() const { return scanning.load(); }
+
+    // every word in text has to be somewhere in the name, tags or node types. An empty nodeType matches any preset
+    std::vector<Entry> search(const juce::String& text, const juce::String& nodeType = {}) const;
+    int getNumPresets() const;
+    // every node type used by at least one preset, sorted
+    juce::StringArray getAllNodeTypes() const;
+
+    // how many files the last scan had to open, everything else came from the index
+    int getNumParsedLastScan() const { return parsedLastScan.load(); }
+
+    const juce::File& getFolder() const { return folder; }
+
+    static juce::File getDefaultFolder();
+
+private:
+    void run() override;
+
+    // reads the preset for its metadata and hash. Files that aren't presets come back with isPreset false
+    Entry readPreset(const juce::File& file) const;
+    static void makeSearchText(Entry& e);
+
+    void loadIndex();
+    void saveIndex(const std::vector<Entry>& list) const;
+
+    juce::File folder;
+    juce::File indexFile;
+
+    mutable std::mutex entriesLock;
+    std::vector<Entry> entries;
+
+    // every rescan gets a number. scanDone is only signalled once the scan that started after the newest
+    // request has finished, and both are changed under scanLock so a rescan can't slip in between
+    std::mutex scanLock;
+    int requestedScan = 0;
+    int finishedScan = 0;
+    std::atomic<bool> scanning{ false };
+    std::atomic<int> parsedLastScan{ 0 };
+    juce::WaitableEvent scanDone{ true };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLibrary)
+};
@@ -0,0 +1,143 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+//Analysis taps are how the audio thread hands data to the visualizers
+//Before this, the de-esser and de-noiser ran an FFT, dB conversion and smoothing for the graph on the audio thread every hop,
+//allocated two vectors of points each time, and then swapped them in under a lock. All of that happened even with the editor closed.
+//Now nodes only copy samples (or a frame of magnitudes) into one of the taps below. The visualizer does all of the analysis on the
+//UI thread, and only while it's on screen. When nothing is reading, the audio thread skips the copy entirely.
+//Neither tap allocates or locks on the audio thread. There is one writer (the audio thread) and one reader (the UI thread)
+
+//Ring of the most recent samples. The writer never waits. The reader grabs the newest block and checks afterwards whether the writer
+//lapped it during the copy, in which case it just tries again on the next frame
+class AnalysisTap{
+public:
+    //Capacity is rounded up to a power of two so the index can be masked
+    explicit AnalysisTap(int minimumCapacity = 8192){
+        int size = 1;
+        while(size < minimumCapacity){
+            size <<= 1;
+        }
+        ring.assign((size_t)size, 0.0f);
+        mask = (std::uint64_t)size - 1;
+    }
+
+    //Called from the processor's prepare. Not thread safe with push
+    void prepare(double newSampleRate){
+        sampleRate.store(newSampleRate);
+        std::fill(ring.begin(), ring.end(), 0.0f);
+        writeCount.store(0);
+    }
+
+    double getSampleRate() const { return sampleRate.load(std::memory_order_relaxed); }
+    int getCapacity() const { return (int)ring.size(); }
+
+    //Readers register while they are visible. The audio thread checks this before doing any work for the display
+    void addReader(){ readers.fetch_add(1, std::memory_order_relaxed); }
+    void removeReader(){ readers.fetch_sub(1, std::memory_order_relaxed); }
+    bool isActive() const { return readers.load(std::memory_order_relaxed) > 0; }
+
+    //Audio thread. Adds one channel of samples
+    void push(const float* samples, int numSamples){
+        const auto start = writeCount.load(std::memory_order_relaxed);
+        for(int i = 0; i < numSamples; i++){
+            ring[(size_t)((start + (std::uint64_t)i) & mask)] = samples[i];
+        }
+        writeCount.store(start + (std::uint64_t)numSamples, std::memory_order_release);
+    }
+
+    //Audio thread. Adds the mono mix of all channels
+    void pushMono(const float* const* channels, int numChannels, int numSamples){
+        if(numChannels <= 0){
+            return;
+        }
+        const float channelScale = 1.0f / (float)numChannels;
+        const auto start = writeCount.load(std::memory_order_relaxed);
+        for(int i = 0; i < numSamples; i++){
+            float mono = 0.0f;
+            for(int ch = 0; ch < numChannels; ch++){
+                mono += channels[ch][i];
+            }
+            ring[(size_t)((start + (std::uint64_t)i) & mask)] = mono * channelScale;
+        }
+        writeCount.store(start + (std::uint64_t)numSamples, std::memory_order_release);
+    }
+
+    //Total samples written so far. Lets the reader tell if anything new has arrived
+    std::uint64_t getWriteCount() const { return writeCount.load(std::memory_order_acquire); }
+
+    //UI thread. Copies the newest numSamples into dest, oldest first
+    //Returns false if there isn't enough yet or the writer overwrote part of it while copying
+    bool readLatest(float* dest, int numSamples) const{
+        if(numSamples > (int)ring.size()){
+            return false;
+        }
+        const auto end = writeCount.load(std::memory_order_acquire);
+        if(end < (std::uint64_t)numSamples){
+            return false;
+        }
+        const auto start = end - (std::uint64_t)numSamples;
+        for(int i = 0; i < numSamples; i++){
+            dest[i] = ring[(size_t)((start + (std::uint64_t)i) & mask)];
+        }
+        //If the writer has moved more than the free space in the ring, the oldest samples we copied were replaced mid copy
+        const auto after = writeCount.load(std::memory_order_acquire);
+        return after - start <= (std::uint64_t)ring.size();
+    }
+
+private:
+    std::vector<float> ring;
+    std::uint64_t mask = 0;
+    std::atomic<std::uint64_t> writeCount {0};
+    std::atomic<int> readers {0};
+    std::atomic<double> sampleRate {44100.0};
+};
+
+//Latest complete frame of a fixed size, for data that isn't a stream of samples (like the de-noiser's noise profile)
+//This is a triple buffer. The writer always has a spare frame to fill, and publishing is a single atomic exchange
+class SnapshotTap{
+public:
+    explicit SnapshotTap(int frameSize){
+        for(auto& frame : frames){
+            frame.assign((size_t)frameSize, 0.0f);
+        }
+    }
+
+    int getFrameSize() const { return (int)frames[0].size(); }
+
+    //Audio thread. Copies a whole frame and makes it the newest one
+    void publish(const float* data){
+        std::copy(data, data + frames[(size_t)back].size(), frames[(size_t)back].begin());
+        const int previous = middle.exchange(back | newFrameFlag, std::memory_order_acq_rel);
+        back = previous & indexMask;
+    }
+
+    //UI thread. Copies the newest frame into dest. Returns true if it's different from the last call
+    bool pull(float* dest){
+        bool isNew = false;
+        if(middle.load(std::memory_order_relaxed) & newFrameFlag){
+            const int previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & indexMask;
+            isNew = true;
+        }
+        const auto& frame = frames[(size_t)front];
+        std::copy(frame.begin(), frame.end(), dest);
+        return isNew;
+    }
+
+private:
+    static constexpr int newFrameFlag = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<std::vector<float>, 3> frames;
+    int front = 0;
+    std::atomic<int> middle {1};
+    int back = 2;
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+#include <complex>
+
+/* Author: huda
+   Biquad design without allocating.
+   juce::dsp::IIR::Coefficients::make... returns a new reference counted object
+   every call, which is not something the audio thread should be doing. These
+   give the same filters (same RBJ cookbook formulas JUCE uses) as plain values,
+   so they can be worked out and blended on the audio thread.
+*/
+
+// Normalised coefficients (a0 = 1)
+struct BiquadCoefficients
+{
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+    // A filter that passes the signal through unchanged
+    static BiquadCoefficients identity() noexcept { return {}; }
+
+    static BiquadCoefficients lowShelf(double sampleRate, float frequency, float q, float gainFactor) noexcept
+    {
+        const double A = std::sqrt(juce::jmax(0.0f, gainFactor));
+        const double aMinus1 = A - 1.0;
+        const double aPlus1 = A + 1.0;
+        const double omega = juce::MathConstants<double>::twoPi * juce::jmax((double)frequency, 2.0) / sampleRate;
+        const double coso = std::cos(omega);
+        const double beta = std::sin(omega) * std::sqrt(A) / q;
+        const double aMinus1TimesCoso = aMinus1 * coso;
+
+        return normalise(A * (aPlus1 - aMinus1TimesCoso + beta),
+                         A * 2.0 * (aMinus1 - aPlus1 * coso),
+                         A * (aPlus1 - aMinus1TimesCoso - beta),
+                         aPlus1 + aMinus1TimesCoso + beta,
+                         -2.0 * (aMinus1 + aPlus1 * coso),
+                         aPlus1 + aMinus1TimesCoso - beta);
+    }
+
+    static BiquadCoefficients highShelf(double sampleRate, float frequency, float q, float gainFactor) noexcept
+    {
+        const double A = std::sqrt(juce::jmax(0.0f, gainFactor));
+        const double aMinus1 = A - 1.0;
+        const double aPlus1 = A + 1.0;
+        const double omega = juce::MathConstants<double>::twoPi * juce::jmax((double)frequency, 2.0) / sampleRate;
+        const double coso = std::cos(omega);
+        const double beta = std::sin(omega) * std::sqrt(A) / q;
+        const double aMinus1TimesCoso = aMinus1 * coso;
+
+        return normalise(A * (aPlus1 + aMinus1TimesCoso + beta),
+                         A * -2.0 * (aMinus1 + aPlus1 * coso),
+                         A * (aPlus1 + aMinus1TimesCoso - beta),
+                         aPlus1 - aMinus1TimesCoso + beta,
+                         2.0 * (aMinus1 - aPlus1 * coso),
+                         aPlus1 - aMinus1TimesCoso - beta);
+    }
+
+    static BiquadCoefficients peak(double sampleRate, float frequency, float q, float gainFactor) noexcept
+    {
+        const double A = juce::jmax(0.0f, std::sqrt(gainFactor));
+        const double omega = juce::MathConstants<double>::twoPi * juce::jmax((double)frequency, 2.0) / sampleRate;
+        const double alpha = std::sin(omega) / (q * 2.0);
+        const double c2 = -2.0 * std::cos(omega);
+        const double alphaTimesA = alpha * A;
+        const double alphaOverA = alpha / A;
+
+        return normalise(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                         1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+
+    static BiquadCoefficients highPass(double sampleRate, float frequency, float q) noexcept
+    {
+        const double n = std::tan(juce::MathConstants<double>::pi * clampFrequency(sampleRate, frequency) / sampleRate);
+        const double nSquared = n * n;
+        const double invQ = 1.0 / q;
+        const double c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return { (float)c1, (float)(c1 * -2.0), (float)c1,
+                 (float)(c1 * 2.0 * (nSquared - 1.0)), (float)(c1 * (1.0 - invQ * n + nSquared)) };
+    }
+
+    static BiquadCoefficients lowPass(double sampleRate, float frequency, float q) noexcept
+    {
+        const double n = 1.0 / std::tan(juce::MathConstants<double>::pi * clampFrequency(sampleRate, frequency) / sampleRate);
+        const double nSquared = n * n;
+        const double invQ = 1.0 / q;
+        const double c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return { (float)c1, (float)(c1 * 2.0), (float)c1,
+                 (float)(c1 * 2.0 * (1.0 - nSquared)), (float)(c1 * (1.0 - invQ * n + nSquared)) };
+    }
+
+    static BiquadCoefficients notch(double sampleRate, float frequency, float q) noexcept
+    {
+        const double n = 1.0 / std::tan(juce::MathConstants<double>::pi * clampFrequency(sampleRate, frequency) / sampleRate);
+        const double nSquared = n * n;
+        const double invQ = 1.0 / q;
+        const double c1 = 1.0 / (1.0 + n * invQ + nSquared);
+        const double b0 = c1 * (1.0 + nSquared);
+        const double b1 = 2.0 * c1 * (1.0 - nSquared);
+
+        return { (float)b0, (float)b1, (float)b0, (float)b1, (float)(c1 * (1.0 - n * invQ + nSquared)) };
+    }
+
+    // How much the filter scales a sine at this frequency
+    float magnitudeAt(double frequency, double sampleRate) const noexcept
+    {
+        const auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        const auto num = (double)b0 + z * ((double)b1 + z * (double)b2);
+        const auto den = 1.0 + z * ((double)a1 + z * (double)a2);
+        return (float)(std::abs(num) / std::abs(den));
+    }
+
+    // Multiplies a whole curve of magnitudes (squared) by this filter's, for drawing. phi is sin^2(w/2) at each
+    // point, worked out once by the caller. This is the form of |H|^2 that stays accurate at low frequencies,
+    // where the cos(w) version cancels itself out in float, and with no trig or complex maths it vectorises
+    void multiplyMagnitudeSquared(const float* phi, float* magnitudeSquared, int numPoints) const noexcept
+    {
+        const float bSum = b0 + b1 + b2;
+        const float n1 = -4.0f * (b0 * b1 + 4.0f * b0 * b2 + b1 * b2);
+        const float n2 = 16.0f * b0 * b2;
+        const float aSum = 1.0f + a1 + a2;
+        const float d1 = -4.0f * (a1 + 4.0f * a2 + a1 * a2);
+        const float d2 = 16.0f * a2;
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const float p = phi[i];
+            const float num = bSum * bSum + p * (n1 + p * n2);
+            const float den = aSum * aSum + p * (d1 + p * d2);
+            magnitudeSquared[i] *= juce::jmax(0.0f, num) / juce::jmax(1.0e-30f, den);
+        }
+    }
+
+    // Straight line between two sets of coefficients. Fine for the small steps made while a knob moves,
+    // and safe even between different filter types: the stable values of a1 and a2 form a triangle, so
+    // every point on a line between two stable filters is stable too
+    static BiquadCoefficients interpolate(const BiquadCoefficients& from, const BiquadCoefficients& to, float amount) noexcept
+    {
+        return { from.b0 + amount * (to.b0 - from.b0),
+                 from.b1 + amount * (to.b1 - from.b1),
+                 from.b2 + amount * (to.b2 - from.b2),
+                 from.a1 + amount * (to.a1 - from.a1),
+                 from.a2 + amount * (to.a2 - from.a2) };
+    }
+
+private:
+    // tan() blows up at Nyquist, so keep the cut and notch frequencies just under it
+    static double clampFrequency(double sampleRate, float frequency) noexcept
+    {
+        return juce::jlimit(2.0, sampleRate * 0.49, (double)frequency);
+    }
+
+    static BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2) noexcept
+    {
+        const double inv = 1.0 / a0;
+        return { (float)(b0 * inv), (float)(b1 * inv), (float)(b2 * inv), (float)(a1 * inv), (float)(a2 * inv) };
+    }
+};
+
+// Filter memory for one channel (transposed direct form II)
+struct BiquadState
+{
+    float s1 = 0.0f, s2 = 0.0f;
+
+    void reset() noexcept { s1 = s2 = 0.0f; }
+
+    inline float process(float x, const BiquadCoefficients& c) noexcept
+    {
+        const float y = c.b0 * x + s1;
+        s1 = c.b1 * x - c.a1 * y + s2;
+        s2 = c.b2 * x - c.a2 * y;
+        return y;
+    }
+
+    // Runs a block with fixed coefficients
+    void process(float* data, int numSamples, const BiquadCoefficients& c) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = process(data[i], c);
+    }
+
+    // Runs a block while sliding the coefficients from one set to the other, one step per sample
+    void process(float* data, int numSamples, const BiquadCoefficients& from, const BiquadCoefficients& to) noexcept
+    {
+        const float step = 1.0f / (float)numSamples;
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = process(data[i], BiquadCoefficients::interpolate(from, to, (float)(i + 1) * step));
+    }
+};
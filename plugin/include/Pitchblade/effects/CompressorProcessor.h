@@ -4,6 +4,7 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 #include <JuceHeader.h>
+#include "Pitchblade/effects/DynamicsCore.h"
 
 //This is needed to pass the real-time audio level to the UI for the graph
 #include <atomic>
@@ -21,14 +22,11 @@ private:
     //release time controls how quickly the compressor stops reducing the volume after the signal falls below the threshold. It is measured in milliseconds, and it is defined by the user.
     float releaseTime = 100.0f;
 
-    //The following two variables are internal parameters that determine the speed at which the compressor's envelope state changes
-    float attackCoeff = 0.0f;
-    float releaseCoeff = 0.0f;
-
-    //The envelope is the current state of the compressor. Unlike the noise gate, it does not control the audio directly.
+    //The shared dynamics kernel does the actual processing. See DynamicsCore.h
+    //Its computer holds the attack and release coefficients and the envelope. Unlike the noise gate, the envelope does not control the audio directly.
     //Its role is more to track the amplitude of the loudest channel in a given sample, which is then used to calculate
     //the amount to reduce the gain by.
-    float envelope = 0.0f;
+    DynamicsCore::DynamicsKernel<DynamicsCore::PeakDetector, DynamicsCore::CompressorComputer<DynamicsCore::HardKnee>> kernel;
 
     //The sample rate will help to convert the unit in milliseconds to something that translates more closely to the audio signal
     double sampleRate = 44100.0;
@@ -48,6 +46,11 @@ public:
     void setRatio(float ratioValue);
     void setAttack(float attackInMS);
     void setRelease(float releaseInMS);
+    //Lookahead delays the audio so the compressor can react to a peak before it gets through. 0 to 10 ms
+    void setLookahead(float lookaheadInMS);
+
+    //How many samples of delay the lookahead adds
+    int getLatencySamples() const;
 
     //processes the input audio buffer to apply compression
     void process(juce::AudioBuffer<float>& buffer);
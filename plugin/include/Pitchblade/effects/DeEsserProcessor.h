@@ -4,6 +4,8 @@
 #include <JuceHeader.h>
 #include <juce_dsp/juce_dsp.h>
 #include <vector>
+#include "Pitchblade/effects/DynamicsCore.h"
+#include "Pitchblade/effects/AnalysisTap.h"
 
 class DeEsserProcessor{
 private:
@@ -19,47 +21,50 @@ private:
     float frequency = 6000.0f;
 
     //Internal variables. See compressor.h for more information
-    float attackCoeff = 0.0f;
-    float releaseCoeff = 0.0f;
-    float envelope = 0.0f;
     double sampleRate = 44100.0;
 
-    //For TC-17, I am creating this to act as a bridge across the gap of waveform peaks so that attack and release work as intended
-    //This tracks peaks rather than averages
-    float rippleEnvelope = 0.0f;
-
-    //A stereo IIR filter to detect sibilant frequencies in the sidechain
-    //Use an array to hold one filter per channel
-    std::array<juce::dsp::IIR::Filter<float>, 2> sidechainFilters;
+    //Detector for the shared dynamics kernel. Instead of looking at the raw audio, it looks at the band-passed sidechain
+    struct SibilanceDetector{
+        //A stereo IIR filter to detect sibilant frequencies in the sidechain
+        //Use an array to hold one filter per channel
+        std::array<juce::dsp::IIR::Filter<float>, 2> sidechainFilters;
+
+        //For TC-17, I am creating this to act as a bridge across the gap of waveform peaks so that attack and release work as intended
+        //This tracks peaks rather than averages
+        float rippleEnvelope = 0.0f;
+        //Fixed release coefficient for ripple smoother. Set in prepare
+        float rippleReleaseCoeff = 0.0f;
+
+        void reset();
+        void detect(const float* const* channels, int numChannels, int numSamples, float* sidechain);
+    };
+
+    //Gain stage for the kernel. In wideband mode it turns the whole signal down like before
+    //In split-band mode only a bell around the de-esser frequency is turned down, so the rest of the voice is left alone
+    struct SibilanceGainStage{
+        bool splitBand = false;
+
+        //The bell is a state variable filter with the same centre and Q as the sidechain band-pass
+        //Its normalised band-pass output is exactly the sibilant band, so taking (1 - gain) of it away from the input gives a bell cut of
+        //depth gain. The gain just scales one output, so the filter coefficients never change while the envelope moves
+        float g = 0.0f, k = 1.0f, a1 = 1.0f, a2 = 0.0f, a3 = 0.0f;
+        std::array<float, 2> ic1 {}, ic2 {};
+
+        void setBell(double sampleRate, float frequencyInHz, float q);
+        void reset();
+        void apply(float* const* channels, int numChannels, int numSamples, const float* gain);
+    };
+
+    //The gain computation is identical to the compressor, so it uses the same computer
+    DynamicsCore::DynamicsKernel<SibilanceDetector, DynamicsCore::CompressorComputer<DynamicsCore::HardKnee>, SibilanceGainStage> kernel;
 
     //Updates attack and release coefficients
     void updateAttackAndRelease();
     //Updates the sidechain filter coefficients when frequency or sample rate changes
     void updateFilter();
 
-    //Visualizer stuff
-    // FFT and Overlap add parameters for visualizer
-    static constexpr int fftOrder = 11;
-    static constexpr int fftSize = 2048;
-    static constexpr int hopSize = fftSize / 4;
-    static constexpr int overlap = fftSize - hopSize;
-
-    juce::dsp::FFT forwardFFT;
-    juce::dsp::WindowingFunction<float> window;
-
-    //Buffers for visualizer FFT
-    std::vector<float> fftInputBuffer;
-    int fftInputBufferPos = 0;
-
-    //Buffers for processing
-    std::vector<float> fftData;
-
-    //Main processing for a single visualizer frame
-    void processVisualizerFrame();
-
-    //Storage for visualizer data
-    juce::CriticalSection dataMutex;
-    std::vector<juce::Point<float>> currentSpectrumData;
+    //Processed audio for the visualizer. The visualizer does the FFT on the UI thread
+    AnalysisTap analysisTap;
 
 public:
     //Constructor
@@ -74,10 +79,17 @@ public:
     void setAttack(float attackMs);
     void setRelease(float releaseMs);
     void setFrequency(float frequencyInHz);
+    //Lookahead so the reduction is already in place when the "s" starts. 0 to 10 ms
+    void setLookahead(float lookaheadMs);
+    //Split-band mode only turns down the sibilant band instead of the whole signal
+    void setSplitBand(bool shouldSplit);
+
+    //How many samples of delay the lookahead adds
+    int getLatencySamples() const;
 
     //Processes the input audio buffer to apply de-essing
     void process(juce::AudioBuffer<float>& buffer);
 
     //For visualizer
-    std::vector<juce::Point<float>> getSpectrumData();
+    AnalysisTap& getAnalysisTap() { return analysisTap; }
 };
\ No newline at end of file
@@ -4,12 +4,23 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 #include <JuceHeader.h>
+#include "Pitchblade/effects/AnalysisTap.h"
+#include "Pitchblade/effects/NoiseTracker.h"
+#include "Pitchblade/effects/StftEngine.h"
 
 //This is needed to store various audio information
+#include <array>
+#include <memory>
 #include <vector>
 
 //Defining the class that handles denoiser logic
 class DeNoiserProcessor{
+public:
+    //FFT size modes. Sizes are for 44.1/48k, and double with each doubling of the sample rate so the timing stays the same
+    //Low latency is 512/128 (about 11 ms), balanced is 2048/512 (the old fixed size), and high resolution is 4096/1024
+    enum class FFTMode { lowLatency = 0, balanced, highResolution };
+    static constexpr int numModes = 3;
+
 private:
     //User defined parameters
     //This determines the intensity by which the noise reduction algorithm takes away from various frequencies. It ranges from 0.0 to 1.0
@@ -18,56 +29,101 @@ private:
     //This determines if the processor is currently learning
     bool isLearning = false;
 
+    //This determines if the noise profile follows the audio on its own. A manual learn still overrides it, and tracking picks up from the learned profile
+    bool isAdaptive = false;
+
     //Sample rate
     double sampleRate = 44100.0;
 
     //This increases the power of the reduction even further. I found that 2.0x wasn't enough, so I made a constant that can be altered in this header to fine-tune it
     const float POWER_MULTIPLIER = 4.0f;
 
-    // FFT and Overlap add parameters
-    static constexpr int fftOrder = 11;
-    static constexpr int fftSize = 2048;
-    static constexpr int hopSize = fftSize / 4;
-    static constexpr int overlap = fftSize - hopSize;
-
-    juce::dsp::FFT forwardFFT;
-    juce::dsp::WindowingFunction<float> window;
-
-    //Buffers for overlap add
-    std::vector<float> inputBuffer;
-    std::vector<float> outputBuffer;
-    int inputBufferPos = 0;
-    int outputBufferPos = 0;
-
-    //Buffers for processing
-    std::vector<float> fftData;
+    //Lowest gain any bin can be turned down to. Same as the old floor of 0.1% of the magnitude
+    const float GAIN_FLOOR = 0.001f;
+
+    //How fast the per bin gains move, in ms. Rising fast keeps speech onsets sharp, and falling slowly hides musical noise
+    const double GAIN_RISE_MS = 20.0;
+    const double GAIN_FALL_MS = 80.0;
+    float gainRiseCoeff = 0.0f;
+    float gainFallCoeff = 0.0f;
+
+    // FFT and Overlap add parameters. These are set from the mode and sample rate in applyMode
+    //The hop is always a quarter of the FFT
+    static constexpr std::array<int, numModes> modeOrders { 9, 11, 12 };
+    FFTMode mode = FFTMode::balanced;
+    int fftSize = 2048;
+    int numBins = 1025;
+
+    //One STFT engine per mode. They are all made in prepare, so changing modes while playing doesn't allocate
+    //Each channel gets its own STFT so the stereo image is kept. They all share one noise profile and one gain mask
+    //(worked out from the average magnitude across channels), so every channel is turned down by the same amount in each bin
+    std::array<StftEngine, numModes> engines;
+    StftEngine* stft = nullptr;
+
+    //Buffers for processing. Sized for the largest mode at the current sample rate
     std::vector<float> noiseProfile;
 
+    //Per bin buffers for the gain. binGains is the smoothed gain that is actually applied, and carries over between frames
+    std::vector<float> binMagnitudes;
+    std::vector<float> targetGains;
+    std::vector<float> smoothedTargets;
+    std::vector<float> binGains;
+
     //Internal counters
     int noiseProfileSamples = 0;
 
-    //Main processing for a single frame
-    void processFrame();
+    //Set once noiseProfile holds a real profile, either learned or tracked
+    bool hasNoiseProfile = false;
 
-    //Storage for visualizer data
-    juce::CriticalSection dataMutex;
-    std::vector<juce::Point<float>> currentSpectrumData;
-    std::vector<juce::Point<float>> noiseProfileData;
+    //Keeps the noise profile up to date between learns
+    NoiseTracker noiseTracker;
+
+    //Main processing for a single frame. Works on the spectra in place
+    void processFrame(std::complex<float>* const* spectra, int numChannels);
+
+    //FFT order for a mode at a sample rate
+    static int orderForMode(FFTMode modeValue, double sRate);
+
+    //Switches the sizes over to the current mode, clears the audio buffers and carries the noise profile across. Doesn't allocate
+    void applyMode(int previousBins);
+
+    //Maps a per bin noise magnitude from one FFT size to another. Noise magnitude grows with the square root of the FFT size, so that is scaled too
+    static void resampleProfile(const float* source, int sourceBins, float* dest, int destBins);
+
+    //Visualizer taps. The processed audio goes into a ring and the noise profile is published as a frame of magnitudes
+    //The visualizer does the FFT and dB conversion on the UI thread. Its FFT size never changes, so the profile is always published at that size
+    static constexpr int displayFFTOrder = 11;
+    static constexpr int displayBins = (1 << displayFFTOrder) / 2 + 1;
+    AnalysisTap analysisTap;
+    SnapshotTap noiseProfileTap { displayBins };
+    //Scratch for resampling the profile, so nothing is allocated
+    std::vector<float> noiseProfileScratch;
+    std::vector<float> displayProfile;
+
+    //Copies the current noise profile (averaged over the frames so far) into the snapshot tap
+    void publishNoiseProfile();
 public:
     //Constructor
     DeNoiserProcessor();
 
-    //Called to prepare the denoiser with the current sample rate
-    void prepare(const double sRate);
+    //Called to prepare the denoiser with the current sample rate and the number of channels it will see
+    void prepare(const double sRate, int numChannels = 2);
 
     //Setters for parameters
     void setReduction(float reduction);
     void setLearning(bool learning);
+    void setAdaptive(bool adaptive);
+    void setFFTMode(FFTMode newMode);
+
+    //Delay through the de-noiser, which is one FFT frame
+    int getLatencySamples() const { return stft->getLatencySamples(); }
 
     //Processes the input audio buffer to apply denoising
     void process(juce::AudioBuffer<float>& buffer);
 
     //Getters for visualizer data
-    std::vector<juce::Point<float>> getSpectrumData();
-    std::vector<juce::Point<float>> getNoiseProfileData();
+    AnalysisTap& getAnalysisTap() { return analysisTap; }
+    SnapshotTap& getNoiseProfileTap() { return noiseProfileTap; }
+    //Size of the FFT the published noise profile is laid out for, so the visualizer can match it
+    static constexpr int getDisplayFFTOrder() { return displayFFTOrder; }
 };
\ No newline at end of file
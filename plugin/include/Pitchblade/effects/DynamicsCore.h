@@ -0,0 +1,429 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+//Shared building blocks for the gate, compressor and de-esser
+//Before this, each of them hand rolled the same loop: find the loudest channel with getSample, move an envelope toward it,
+//then call gainToDecibels and decibelsToGain for every single sample. That last part was the most expensive thing in all three.
+//The kernel below splits that work up into passes over a small block so that each pass is a simple loop the compiler can vectorize:
+//  1. Detector pass - turns the audio into one sidechain level per sample (peak, RMS, filtered, etc.)
+//  2. Gain computer pass - runs the attack/release envelope, then works out the gain in dB using the fast log/exp below
+//  3. Apply pass - puts the gain curve onto the audio, usually by multiplying every channel by it
+//Optionally, the kernel can look ahead. The audio is delayed a few milliseconds, and the sidechain is replaced by the peak
+//over that window, so the gain is already coming down (or the gate already opening) by the time the loud part arrives
+//The detector, gain computer and gain stage are template parameters, so each processor just picks the pieces it needs
+namespace DynamicsCore
+{
+    //Fast approximations =====================================================================
+
+    //Approximate log2 of a positive number
+    //The float is split into exponent and mantissa, and then log2 of the mantissa (1 to 2) is found with the atanh series
+    //The error is under 2e-5 in log2, which is about 1e-4 dB. That is far below anything you could ever hear
+    inline float fastLog2(float x){
+        const auto bits = std::bit_cast<std::uint32_t>(x);
+        const float exponent = (float)((int)((bits >> 23) & 0xff) - 127);
+        const float mantissa = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u);
+
+        //log2(m) = 2/ln(2) * atanh(y) where y = (m - 1) / (m + 1). Since m is in [1, 2), y stays under 1/3
+        const float y = (mantissa - 1.0f) / (mantissa + 1.0f);
+        const float y2 = y * y;
+        const float series = y * (1.0f + y2 * (0.33333333f + y2 * (0.2f + y2 * 0.14285714f)));
+        return exponent + 2.88539008f * series;
+    }
+
+    //Approximate 2^x
+    //The input is split into the nearest whole number, which goes straight into the float exponent, and a leftover part in [-0.5, 0.5]
+    //The leftover part uses a short Taylor series. The relative error is under 4e-6
+    inline float fastExp2(float x){
+        x = std::clamp(x, -126.0f, 127.0f);
+        const float whole = std::floor(x + 0.5f);
+        const float t = (x - whole) * 0.69314718f;
+        const float poly = 1.0f + t * (1.0f + t * (0.5f + t * (0.16666667f + t * (0.04166667f + t * 0.00833333f))));
+        const float scale = std::bit_cast<float>((std::uint32_t)((int)whole + 127) << 23);
+        return poly * scale;
+    }
+
+    //Same idea as juce::Decibels::gainToDecibels, including the floor value for silence
+    inline float fastGainToDecibels(float gain, float minusInfinityDb = -100.0f){
+        //20 * log10(x) = 20 * log10(2) * log2(x)
+        return gain > 0.0f ? std::max(6.02059991f * fastLog2(gain), minusInfinityDb) : minusInfinityDb;
+    }
+
+    //Same idea as juce::Decibels::decibelsToGain
+    inline float fastDecibelsToGain(float decibels){
+        //10^(x / 20) = 2^(x * log2(10) / 20)
+        return fastExp2(decibels * 0.16609640f);
+    }
+
+    //Envelope ballistics ======================================================================
+
+    //The attack/release smoother every dynamics effect was using
+    //The coefficients are worked out by each processor, since they each tuned their own curve
+    struct Ballistics{
+        float attackCoeff = 0.0f;
+        float releaseCoeff = 0.0f;
+        float envelope = 0.0f;
+
+        inline float process(float input){
+            //If the input is louder than the envelope, move toward it at the attack speed. Otherwise use the release speed
+            const float coeff = input > envelope ? attackCoeff : releaseCoeff;
+            envelope = coeff * envelope + (1.0f - coeff) * input;
+            return envelope;
+        }
+
+        void reset(){ envelope = 0.0f; }
+    };
+
+    //Detector policies ========================================================================
+    //A detector turns the channels into one linear level per sample
+
+    //Loudest channel for each sample. This is what all three processors originally did
+    struct PeakDetector{
+        void reset(){}
+
+        void detect(const float* const* channels, int numChannels, int numSamples, float* sidechain){
+            std::fill(sidechain, sidechain + numSamples, 0.0f);
+            for(int ch = 0; ch < numChannels; ch++){
+                const float* data = channels[ch];
+                for(int i = 0; i < numSamples; i++){
+                    sidechain[i] = std::max(sidechain[i], std::abs(data[i]));
+                }
+            }
+        }
+    };
+
+    //Root mean square over all channels, averaged over a short window
+    //This reacts more like our ears do than the peak detector, but it is slower to catch transients
+    struct RmsDetector{
+        //Smoothing for the mean square. Set from the window length with setWindow
+        float averageCoeff = 0.0f;
+        float meanSquare = 0.0f;
+
+        void setWindow(float windowInMs, double sampleRate){
+            averageCoeff = std::exp(-1.0f / (0.001f * windowInMs * (float)sampleRate + 0.0000001f));
+        }
+
+        void reset(){ meanSquare = 0.0f; }
+
+        void detect(const float* const* channels, int numChannels, int numSamples, float* sidechain){
+            //Pass one just sums the squares, which vectorizes
+            std::fill(sidechain, sidechain + numSamples, 0.0f);
+            for(int ch = 0; ch < numChannels; ch++){
+                const float* data = channels[ch];
+                for(int i = 0; i < numSamples; i++){
+                    sidechain[i] += data[i] * data[i];
+                }
+            }
+
+            //The running average has to go sample by sample
+            const float channelScale = numChannels > 0 ? 1.0f / (float)numChannels : 0.0f;
+            for(int i = 0; i < numSamples; i++){
+                meanSquare = averageCoeff * meanSquare + (1.0f - averageCoeff) * sidechain[i] * channelScale;
+                sidechain[i] = std::sqrt(meanSquare);
+            }
+        }
+    };
+
+    //Knee policies ============================================================================
+    //A knee takes how far the level is over the threshold in dB and returns how much of that should be compressed
+
+    //Compression starts instantly at the threshold. This matches the original compressor
+    struct HardKnee{
+        inline float overshoot(float overDb) const { return std::max(overDb, 0.0f); }
+    };
+
+    //Compression fades in over widthDb around the threshold instead of kicking in all at once
+    struct SoftKnee{
+        float widthDb = 6.0f;
+
+        inline float overshoot(float overDb) const {
+            const float halfWidth = 0.5f * widthDb;
+            if(overDb <= -halfWidth) return 0.0f;
+            if(overDb >= halfWidth) return overDb;
+            const float x = overDb + halfWidth;
+            return x * x / (2.0f * widthDb);
+        }
+    };
+
+    //Gain computer policies ===================================================================
+    //A gain computer turns the sidechain levels into a gain multiplier for each sample
+
+    //Downward compression. Used by the compressor, the limiter mode and the de-esser
+    template <typename Knee>
+    struct CompressorComputer{
+        float thresholdDB = 0.0f;
+        float ratio = 1.0f;
+        Ballistics ballistics;
+        Knee knee;
+
+        void reset(){ ballistics.reset(); }
+
+        void computeGain(const float* sidechain, float* gain, int numSamples){
+            //First the envelope. Each sample depends on the last, so this loop can't be vectorized, but it is very cheap now
+            for(int i = 0; i < numSamples; i++){
+                gain[i] = ballistics.process(sidechain[i]);
+            }
+
+            //Then the gain in the log domain. No sample depends on any other here, so this vectorizes
+            const float slope = 1.0f - (1.0f / ratio);
+            for(int i = 0; i < numSamples; i++){
+                const float envelopeDB = fastGainToDecibels(gain[i]);
+                const float gainReductionDB = knee.overshoot(envelopeDB - thresholdDB) * slope;
+                gain[i] = fastDecibelsToGain(-gainReductionDB);
+            }
+        }
+    };
+
+    //Noise gate. The envelope runs on the gain itself rather than the level, so the gate fades open and closed
+    struct GateComputer{
+        //Linear threshold
+        float threshold = 0.0f;
+        Ballistics ballistics;
+
+        void reset(){ ballistics.reset(); }
+
+        void computeGain(const float* sidechain, float* gain, int numSamples){
+            for(int i = 0; i < numSamples; i++){
+                gain[i] = ballistics.process(sidechain[i] > threshold ? 1.0f : 0.0f);
+            }
+        }
+    };
+
+    //Lookahead helpers =======================================================================
+
+    //Longest lookahead any processor can ask for, in ms
+    constexpr float maxLookaheadMs = 10.0f;
+
+    //Loudest value over the last windowSize samples, using a monotonic deque
+    //Every sample is added and removed at most once, so this is O(1) per sample no matter how long the window is
+    //The deque lives in a fixed ring that is sized in prepare, so nothing is allocated while processing
+    class SlidingWindowMax{
+    public:
+        void prepare(int maxWindowSize){
+            //A window of n can hold n + 1 entries for a moment before the oldest is dropped
+            capacity = std::max(maxWindowSize, 1) + 1;
+            values.assign((size_t)capacity, 0.0f);
+            positions.assign((size_t)capacity, 0);
+            reset();
+        }
+
+        void reset(){
+            head = 0;
+            count = 0;
+            sampleCounter = 0;
+        }
+
+        void setWindowSize(int newWindowSize){
+            windowSize = std::clamp(newWindowSize, 1, std::max(capacity - 1, 1));
+        }
+
+        inline float process(float input){
+            //Anything at the back that is quieter than the new sample can never be the max again, so drop it
+            while(count > 0 && values[(size_t)wrap(head + count - 1)] <= input){
+                count--;
+            }
+            const int back = wrap(head + count);
+            values[(size_t)back] = input;
+            positions[(size_t)back] = sampleCounter;
+            count++;
+
+            //Drop anything at the front that has slid out of the window
+            while(positions[(size_t)head] <= sampleCounter - windowSize){
+                head = wrap(head + 1);
+                count--;
+            }
+
+            sampleCounter++;
+            return values[(size_t)head];
+        }
+
+    private:
+        inline int wrap(int index) const { return index >= capacity ? index - capacity : index; }
+
+        std::vector<float> values;
+        std::vector<std::int64_t> positions;
+        int capacity = 0;
+        int head = 0;
+        int count = 0;
+        int windowSize = 1;
+        std::int64_t sampleCounter = 0;
+    };
+
+    //Multichannel delay line for the audio path. All channels share one preallocated block
+    class LookaheadDelay{
+    public:
+        void prepare(int maxDelaySamples, int numChannels){
+            length = std::max(maxDelaySamples, 0) + 1;
+            channels = numChannels;
+            memory.assign((size_t)(length * channels), 0.0f);
+            reset();
+        }
+
+        void reset(){
+            std::fill(memory.begin(), memory.end(), 0.0f);
+            writePos = 0;
+        }
+
+        void setDelay(int newDelaySamples){
+            delay = std::clamp(newDelaySamples, 0, length - 1);
+        }
+
+        int getDelay() const { return delay; }
+
+        //Delays numSamples of each channel in place
+        void process(float* const* data, int numChannels, int numSamples){
+            if(delay == 0){
+                return;
+            }
+            numChannels = std::min(numChannels, channels);
+
+            for(int ch = 0; ch < numChannels; ch++){
+                float* line = memory.data() + ch * length;
+                float* samples = data[ch];
+                int write = writePos;
+                int read = write - delay;
+                if(read < 0) read += length;
+
+                for(int i = 0; i < numSamples; i++){
+                    line[write] = samples[i];
+                    samples[i] = line[read];
+                    if(++write == length) write = 0;
+                    if(++read == length) read = 0;
+                }
+            }
+
+            writePos = (writePos + numSamples) % length;
+        }
+
+    private:
+        std::vector<float> memory;
+        int length = 1;
+        int channels = 0;
+        int writePos = 0;
+        int delay = 0;
+    };
+
+    //Gain stages ==============================================================================
+    //Each one has apply(channels, numChannels, numSamples, gain), which runs last and puts the gain curve onto the audio
+
+    //The usual gain stage. Every channel is turned down by the whole gain
+    struct BroadbandGain{
+        void reset(){}
+
+        void apply(float* const* channels, int numChannels, int numSamples, const float* gain){
+            for(int ch = 0; ch < numChannels; ch++){
+                juce::FloatVectorOperations::multiply(channels[ch], gain, numSamples);
+            }
+        }
+    };
+
+    //The kernel ===============================================================================
+
+    template <typename Detector, typename Computer, typename GainStage = BroadbandGain>
+    class DynamicsKernel{
+    public:
+        //Work is done in chunks of this many samples so the scratch buffers can live on the object
+        //This means the kernel never allocates while processing and doesn't need to know the host's block size
+        static constexpr int chunkSize = 256;
+        //Channel pointers are kept in a fixed array as well
+        //The plugin only accepts mono or stereo buses (see isBusesLayoutSupported), and the de-esser's filters are stereo,
+        //so the kernel is sized for two. Anything past that would be left unprocessed, so it's asserted in process
+        static constexpr int maxChannels = 2;
+
+        Detector detector;
+        Computer computer;
+        GainStage gainStage;
+
+        //Allocates the lookahead buffers for the longest lookahead at this sample rate
+        void prepare(double newSampleRate){
+            sampleRate = newSampleRate;
+            const int maxLookaheadSamples = (int)std::ceil(0.001 * maxLookaheadMs * sampleRate);
+            peakWindow.prepare(maxLookaheadSamples + 1);
+            delayLine.prepare(maxLookaheadSamples, maxChannels);
+            setLookahead(lookaheadMs);
+        }
+
+        void reset(){
+            detector.reset();
+            computer.reset();
+            gainStage.reset();
+            peakWindow.reset();
+            delayLine.reset();
+        }
+
+        //Sets the lookahead from 0 to maxLookaheadMs. Safe to call from the audio thread since the buffers already exist
+        void setLookahead(float newLookaheadMs){
+            lookaheadMs = std::clamp(newLookaheadMs, 0.0f, maxLookaheadMs);
+            const int samples = (int)std::round(0.001 * lookaheadMs * sampleRate);
+            delayLine.setDelay(samples);
+            //The delay line may have clamped it if prepare hasn't been called
+            peakWindow.setWindowSize(delayLine.getDelay() + 1);
+        }
+
+        //How many samples the audio is delayed by, which has to be reported to the host
+        int getLatencySamples() const { return delayLine.getDelay(); }
+
+        //Runs all three passes over the buffer
+        void process(juce::AudioBuffer<float>& buffer){
+            juce::ScopedNoDenormals noDenormals;
+
+            const int numSamples = buffer.getNumSamples();
+            jassert(buffer.getNumChannels() <= maxChannels);
+            const int numChannels = std::min(buffer.getNumChannels(), maxChannels);
+            std::array<float*, maxChannels> channels {};
+            for(int ch = 0; ch < numChannels; ch++){
+                channels[ch] = buffer.getWritePointer(ch);
+            }
+
+            for(int start = 0; start < numSamples; start += chunkSize){
+                const int count = std::min(chunkSize, numSamples - start);
+                std::array<const float*, maxChannels> chunk {};
+                for(int ch = 0; ch < numChannels; ch++){
+                    chunk[ch] = channels[ch] + start;
+                }
+
+                detector.detect(chunk.data(), numChannels, count, sidechain.data());
+
+                //With lookahead, the detector sees the peak of everything that is still sitting in the delay line
+                const bool lookingAhead = delayLine.getDelay() > 0;
+                if(lookingAhead){
+                    for(int i = 0; i < count; i++){
+                        sidechain[i] = peakWindow.process(sidechain[i]);
+                    }
+                }
+
+                computer.computeGain(sidechain.data(), gain.data(), count);
+
+                if(lookingAhead){
+                    std::array<float*, maxChannels> delayed {};
+                    for(int ch = 0; ch < numChannels; ch++){
+                        delayed[ch] = channels[ch] + start;
+                    }
+                    delayLine.process(delayed.data(), numChannels, count);
+                }
+
+                std::array<float*, maxChannels> output {};
+                for(int ch = 0; ch < numChannels; ch++){
+                    output[ch] = channels[ch] + start;
+                }
+                gainStage.apply(output.data(), numChannels, count, gain.data());
+            }
+        }
+
+    private:
+        std::array<float, chunkSize> sidechain {};
+        std::array<float, chunkSize> gain {};
+
+        double sampleRate = 44100.0;
+        float lookaheadMs = 0.0f;
+        SlidingWindowMax peakWindow;
+        LookaheadDelay delayLine;
+    };
+}
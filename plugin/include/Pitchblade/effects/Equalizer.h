@@ -1,7 +1,11 @@
 #pragma once
 #include <JuceHeader.h>
 #include <atomic>
+#include <memory>
 #include <vector>
+#include "Pitchblade/effects/BiquadDesign.h"
+#include "Pitchblade/effects/PartitionedConvolver.h"
+#include "Pitchblade/effects/StftEngine.h"
 
 /* Author: huda
    Equalizer; basic 3-band EQ:
@@ -9,12 +13,21 @@
      - mid  = peaking (center + gain)
      - high = high shelf (cutoff + gain)
    Uses proper shelving filters for transparent EQ.
+   Coefficients are only redesigned when a knob moves, and are blended
+   sample by sample while it does, so nothing allocates on the audio thread.
+
+   Linear phase mode: the same magnitude response, with no phase shift, for
+   mastering style work. The response is turned into a symmetric FIR kernel on
+   a background thread whenever a knob moves, and run with partitioned FFT
+   convolution. Costs latency (half the kernel plus one partition), which is
+   reported to the host through the node.
 */
 
 class Equalizer
 {
 public:
     Equalizer() = default;
+    ~Equalizer();
 
     void prepare(double sampleRate, int maxBlockSize, int numChannels);
     void reset();
@@ -29,6 +42,13 @@ public:
     void setHighFreq(float hz);
     void setHighGainDb(float dB);
 
+    // switches between the normal filters and the linear phase FIR
+    void setLinearPhase(bool shouldBeLinear);
+    bool isLinearPhase() const noexcept { return linearPhase.load(); }
+
+    // samples of delay in the current mode
+    int getLatencySamples() const noexcept;
+
     // process in-place
     void processBlock(juce::AudioBuffer<float>& buffer) noexcept;
 
@@ -40,8 +60,37 @@ public:
     float getHighFreq() const noexcept { return highFreqHz; }
     float getHighGainDb() const noexcept { return highGainDb; }
 
+    // goes up by one every time a setter is called, so the UI can tell when the response needs redrawing
+    uint32_t getParameterVersion() const noexcept { return parameterVersion.load(std::memory_order_acquire); }
+
 private:
-    void updateFilters();
+    enum class Shape { lowShelf, peak, highShelf };
+
+    // One band: its knobs smoothed on the audio thread, the coefficients in use, and one filter memory per channel
+    struct Band
+    {
+        Shape shape = Shape::peak;
+
+        // smoothing for gain and frequency changes (applied on audio thread)
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gainSmooth;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freqSmooth;
+
+        // what the current coefficients were designed for, so they are only redone when a knob actually moves
+        float designedHz = 0.0f;
+        float designedDb = 0.0f;
+        BiquadCoefficients coeffs;
+
+        // false while the band sits at 0 dB and is skipped
+        bool active = false;
+
+        std::vector<BiquadState> states;
+    };
+
+    // Works out a band's coefficients for a frequency and gain. No allocation
+    BiquadCoefficients designBand(const Band& band, float hz, float dB) const noexcept;
+
+    // Processes one band over part of the buffer, blending to new coefficients if its knobs are moving
+    void processBand(Band& band, juce::AudioBuffer<float>& buffer, int nCh, int start, int num, float targetHz, float targetDb) noexcept;
 
     double sr = 44100.0;
     int channels = 2;
@@ -58,28 +107,46 @@ private:
     std::atomic<float> highFreqHz { 4000.0f };
     std::atomic<float> highGainDb {0.0f };
 
-    // smoothing for gain changes (applied on audio thread)
     float smoothingTimeSeconds = 0.02f; // 20 ms
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> lowGainSmooth;
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> midGainSmooth;
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> highGainSmooth;
 
-    // last applied freqs (used if we want to debounce updates later)
-    float lastLowFreqHz  = 200.0f;
-    float lastMidFreqHz  = 1000.0f;
-    float lastHighFreqHz = 4000.0f;
+    // While knobs move, coefficients are redesigned every this many samples and blended per sample in between
+    static constexpr int subBlockSize = 32;
 
-    // one ProcessorDuplicator per channel per band
-    using IIRFilter = juce::dsp::IIR::Filter<float>;
-    using IIRCoeff = juce::dsp::IIR::Coefficients<float>;
-    using IIRProc= juce::dsp::ProcessorDuplicator<IIRFilter, IIRCoeff>;
+    Band lowBand, midBand, highBand;
 
-    struct Band
+    // ===== linear phase =====
+    // Rebuilds the kernel off the audio thread whenever it's told a knob moved
+    class KernelBuilder : public juce::Thread
     {
-        std::vector<IIRProc> filters;
+    public:
+        explicit KernelBuilder(Equalizer& e) : juce::Thread("EQ kernel builder"), owner(e) {}
+        void run() override;
+    private:
+        Equalizer& owner;
     };
 
-    Band lowBand, midBand, highBand;
+    // Kernel is 4096 taps at 44.1/48 kHz and doubles with the sample rate, so it covers the same low end.
+    // Partitions are 256 samples, which sets the extra latency on top of half the kernel
+    static constexpr int baseKernelOrder = 12;
+    static constexpr int partitionOrder = 8;
+
+    // Bumps the parameter version, flags a rebuild and wakes the builder if linear phase is on
+    void requestKernel();
+    // Works out the FIR for the knobs as they are now and hands it to the convolver. Not for the audio thread
+    void buildKernel();
+
+    std::atomic<uint32_t> parameterVersion { 0 };
+    std::atomic<bool> linearPhase { false };
+    std::atomic<bool> kernelDirty { true };
+    bool wasLinearPhase = false;    // audio thread's view, to clear the convolver on a switch
+
+    int kernelOrder = baseKernelOrder;
+    std::shared_ptr<const StftPlan> kernelPlan;    // shared hann window
+    std::unique_ptr<juce::dsp::FFT> kernelFft;      // the builder's own FFT
+    std::vector<float> kernelData;  // builder scratch: spectrum, then the taps
+    std::vector<float> kernelTaps;
+    PartitionedConvolver convolver;
+    KernelBuilder builder { *this };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Equalizer)
 };
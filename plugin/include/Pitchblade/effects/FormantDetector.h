@@ -1,13 +1,17 @@
 #pragma once
+#include <complex>
 #include <vector>
 #include <juce_dsp/juce_dsp.h>
 #include <JuceHeader.h>
+#include "Pitchblade/effects/StftEngine.h"
 
 /*
   FormantDetector class
   --------------------
   Detects dominant resonances (formants) in an audio signal in real-time.
   Uses FFT to find spectral peaks and can provide frequencies in Hz.
+  Audio is buffered into overlapping frames by the shared STFT engine, so short
+  host blocks still get a full size FFT instead of a zero padded one.
   
   Author: Huda
 */
@@ -35,18 +39,15 @@ public:
 private:
     int fftOrder;                 // log2 of FFT size
     int fftSize;                  // actual FFT size
-    juce::dsp::FFT fft;           // JUCE FFT object
+    StftEngine stft;              // Frames, windows and FFTs the incoming audio (analysis only)
 
-    std::vector<float> window;    // Hann window for framing
-    std::vector<float> fftData;   // Buffer for FFT input/output
+    std::vector<float> magnitude; // Magnitude spectrum of the latest frame
+    std::vector<std::pair<float, int>> candidates; // Peaks found in the latest frame (mag, bin)
     std::vector<float> formants;  // Detected formant bins
 
     double sampleRate = 44100.0;  // Sample rate used for frequency conversion
 
-    // Internal helper: compute FFT of audio block
-    void computeFFT(const juce::AudioBuffer<float>& buffer);
-
-    // Internal helper: find spectral peaks in FFT data
-    void findFormantPeaks();
+    // Internal helper: find spectral peaks in one frame's spectrum
+    void findFormantPeaks(const std::complex<float>* bins);
 
 };
@@ -0,0 +1,121 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "Pitchblade/effects/BiquadDesign.h"
+
+//Loudness meter following ITU-R BS.1770-4 / EBU R128. It can sit at any point in the chain and only reads the audio
+//  - Momentary loudness: the last 400 ms
+//  - Short-term loudness: the last 3 s
+//  - Integrated loudness: everything since the last reset, with the -70 LUFS absolute gate and the -10 LU relative gate
+//  - True peak: the highest peak with the signal oversampled 4x, so peaks that fall between samples are caught
+//The audio is K-weighted (a high shelf for the head, then a high pass) and the power is summed in 100 ms steps.
+//Every 400 ms window goes into a histogram of 0.1 LU bins, so integrated loudness over any length of time is a fixed amount of memory
+//Everything is fixed size. prepare doesn't allocate, so a node can (re)prepare its meter on the audio thread when the sample rate changes
+//Readings are published through atomics, so the UI can read them whenever it likes
+class LoudnessMeter{
+public:
+    //Readings below this are shown as silence
+    static constexpr float SILENCE_LUFS = -100.0f;
+    //Channels past this are not metered
+    static constexpr int MAX_CHANNELS = 8;
+
+    LoudnessMeter();
+
+    //Works out the filters for the sample rate and clears everything. Doesn't allocate
+    void prepare(double newSampleRate);
+    double getSampleRate() const { return sampleRate; }
+
+    //Clears all readings on the audio thread
+    void reset();
+
+    //Any thread. The next block starts the readings again (integrated and true peak included)
+    void requestReset(){ resetRequested.store(true, std::memory_order_release); }
+
+    //Audio thread. Only reads the audio
+    void process(const float* const* channels, int numChannels, int numSamples) noexcept;
+    void process(const juce::AudioBuffer<float>& buffer) noexcept{
+        process(buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+    }
+
+    //Readings, safe from any thread
+    float getMomentaryLufs() const { return momentaryLufs.load(std::memory_order_relaxed); }
+    float getShortTermLufs() const { return shortTermLufs.load(std::memory_order_relaxed); }
+    float getIntegratedLufs() const { return integratedLufs.load(std::memory_order_relaxed); }
+    float getTruePeakDb() const { return truePeakDb.load(std::memory_order_relaxed); }
+
+    //The K-weighting filters, for a sample rate
+    static BiquadCoefficients kWeightingShelf(double sampleRate);
+    static BiquadCoefficients kWeightingHighPass(double sampleRate);
+
+private:
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    //Oversampling filter for true peak. Each of the 4 phases is one lane, so a whole set of oversampled points is one register
+    static constexpr int OVERSAMPLING = 4;
+    static constexpr int TAPS_PER_PHASE = 12;
+    //Only when a register is exactly 4 floats (SSE, NEON). Wider registers (AVX) fall back to one phase at a time
+    static constexpr bool PHASES_IN_ONE_REGISTER = (int)Vec::SIMDNumElements == OVERSAMPLING;
+
+    //Steps and windows, in 100 ms steps
+    static constexpr int MOMENTARY_STEPS = 4;
+    static constexpr int SHORT_TERM_STEPS = 30;
+
+    //Histogram of gated 400 ms windows. 0.1 LU bins from the absolute gate up to +10 LUFS
+    static constexpr float ABSOLUTE_GATE_LUFS = -70.0f;
+    static constexpr float RELATIVE_GATE_LU = -10.0f;
+    static constexpr float BIN_WIDTH_LU = 0.1f;
+    static constexpr int NUM_BINS = 800;
+
+    struct ChannelState{
+        BiquadState shelf;
+        BiquadState highPass;
+        //The last TAPS_PER_PHASE samples, written twice so they can always be read as one straight run
+        std::array<float, TAPS_PER_PHASE * 2> history {};
+        int historyPos = 0;
+    };
+
+    //Runs K-weighting and true peak over one channel and returns the sum of the weighted samples squared
+    double processChannel(ChannelState& state, const float* samples, int numSamples, Vec& peak) noexcept;
+
+    //Called every 100 ms with that step's power, to update the windows and publish readings
+    void finishStep() noexcept;
+    void updateIntegrated() noexcept;
+
+    static float powerToLufs(double power){
+        return power > 0.0 ? juce::jmax(SILENCE_LUFS, (float)(-0.691 + 10.0 * std::log10(power))) : SILENCE_LUFS;
+    }
+
+    double sampleRate = 0.0;
+    BiquadCoefficients shelfCoeffs, highPassCoeffs;
+    std::array<Vec, TAPS_PER_PHASE> phaseTaps;
+    std::array<std::array<float, OVERSAMPLING>, TAPS_PER_PHASE> phaseTapsScalar {};
+    std::array<ChannelState, MAX_CHANNELS> channelStates;
+
+    //Current 100 ms step
+    int stepLength = 4800;
+    int stepFill = 0;
+    double stepSum = 0.0;
+
+    //Mean power of the most recent steps, newest at stepPos
+    std::array<double, SHORT_TERM_STEPS> stepPowers {};
+    int stepPos = 0;
+    int stepsSeen = 0;
+
+    std::array<double, NUM_BINS> binPower {};
+    std::array<std::uint32_t, NUM_BINS> binCount {};
+
+    float maxPeak = 0.0f;
+
+    std::atomic<bool> resetRequested {false};
+    std::atomic<float> momentaryLufs {SILENCE_LUFS};
+    std::atomic<float> shortTermLufs {SILENCE_LUFS};
+    std::atomic<float> integratedLufs {SILENCE_LUFS};
+    std::atomic<float> truePeakDb {SILENCE_LUFS};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoudnessMeter)
+};
@@ -0,0 +1,94 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include "Pitchblade/effects/DynamicsCore.h"
+
+//Defining the class that handles the multiband compressor
+//The audio is split into 2 to 4 bands with Linkwitz-Riley crossovers, each band is compressed on its own, and then they are added back together
+//Rather than running a separate filter bank and compressor for each band, every band lives in its own lane of a SIMD register.
+//That way one set of filter and envelope math handles all of the bands at once, which keeps the cost close to a single compressor
+class MultibandCompressorProcessor
+{
+public:
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int maxBands = 4;
+    static constexpr int maxChannels = 2;
+    static constexpr int numLanes = (int)Vec::SIMDNumElements;
+    static_assert(numLanes >= maxBands, "Each band needs its own SIMD lane");
+
+    //Constructor
+    MultibandCompressorProcessor();
+
+    //Called before processing to prepare the compressor with the current sample rate
+    void prepare(const double sRate);
+
+    //Setters
+    void setNumBands(int numBandsValue);
+    //Crossover index 0 is between bands 1 and 2, index 1 is between bands 2 and 3, and so on
+    void setCrossover(int index, float frequencyInHz);
+    void setThreshold(int band, float thresholdInDB);
+    void setRatio(int band, float ratioValue);
+    void setAttack(float attackInMS);
+    void setRelease(float releaseInMS);
+
+    //Processes the input audio buffer to apply compression per band
+    void process(juce::AudioBuffer<float>& buffer);
+
+    //Latest gain reduction for each band in dB, for the UI
+    std::array<std::atomic<float>, maxBands> bandGainReductionDb {};
+
+    //Store the latest output level in dB for the visualizer
+    std::atomic<float> currentOutputLevelDb {-100.0f};
+
+private:
+    //Work is done in chunks so the scratch buffers can live on the object. Same idea as the dynamics kernel
+    static constexpr int chunkSize = 256;
+    //Each crossover is a 4th order Linkwitz-Riley filter, which is two biquads in a row
+    static constexpr int stagesPerCrossover = 2;
+    static constexpr int maxStages = (maxBands - 1) * stagesPerCrossover;
+
+    //One biquad where each SIMD lane has its own coefficients
+    struct BiquadLanes{
+        Vec b0, b1, b2, a1, a2;
+    };
+
+    //Filter state for one biquad, one channel, all lanes
+    struct BiquadState{
+        Vec s1, s2;
+    };
+
+    int numBands = 3;
+    std::array<float, maxBands - 1> crossovers { 200.0f, 1000.0f, 5000.0f };
+    std::array<float, maxBands> thresholds {};
+    std::array<float, maxBands> ratios { 3.0f, 3.0f, 3.0f, 3.0f };
+    float attackTime = 10.0f;
+    float releaseTime = 100.0f;
+    double sampleRate = 44100.0;
+
+    //Filter bank. Only the first (numBands - 1) * stagesPerCrossover stages are used
+    std::array<BiquadLanes, maxStages> stages;
+    std::array<std::array<BiquadState, maxStages>, maxChannels> filterState;
+    //Set whenever a crossover or the band count changes, so the coefficients are only worked out when needed
+    bool filtersNeedUpdate = true;
+
+    //Per band envelope, with the same attack and release curve as CompressorProcessor
+    Vec envelope;
+    Vec attackCoeff, releaseCoeff;
+
+    //Scratch space for one chunk
+    std::array<std::array<Vec, chunkSize>, maxChannels> bandSignals;
+    alignas(16) std::array<float, chunkSize * numLanes> envelopeLanes {};
+    alignas(16) std::array<float, chunkSize * numLanes> gainLanes {};
+
+    void updateFilters();
+    void updateAttackAndRelease();
+    void processChunk(float* const* channels, int numChannels, int numSamples);
+
+    //Helper for building a register from one value per lane
+    static Vec fromLanes(const std::array<float, numLanes>& values);
+};
@@ -5,6 +5,7 @@
 #include <juce_dsp/juce_dsp.h>
 #include <JuceHeader.h>
 #include <atomic>
+#include "Pitchblade/effects/DynamicsCore.h"
 
 //Defining the class that handles the simple noise gate
 class NoiseGateProcessor
@@ -16,12 +17,9 @@ private:
     float attackTime = 50.0f;
     //Release time refers to the amount of milliseconds before the gate will be closed after the audio dips below the threshold volume. This manifests in a fade rather than an abrupt close
     float releaseTime = 50.0f;
-    //The following two variables are internal parameters that determine the speed at which the gate's current state changes
-    float attackCoeff = 0.0f;
-    float releaseCoeff = 0.0f;
-
-    //The envelope is the current state of the gate, where 0.0 is closed and 1.0 is open
-    float envelope = 0.0f;
+    //The shared dynamics kernel does the actual processing. See DynamicsCore.h
+    //The gate computer holds the threshold, the attack and release coefficients, and the envelope, which is the current state of the gate where 0.0 is closed and 1.0 is open
+    DynamicsCore::DynamicsKernel<DynamicsCore::PeakDetector, DynamicsCore::GateComputer> kernel;
 
     //The sample rate will help to convert the unit in milliseconds to something that translates more closely to the audio signal
     double sampleRate = 44100.0;
@@ -40,6 +38,11 @@ public:
     void setThreshold(float thresholdInDB);
     void setAttack(float attackInMs);
     void setRelease(float releaseInMs);
+    //Lookahead lets the gate start opening before a word actually starts, so the onset isn't chopped off. 0 to 10 ms
+    void setLookahead(float lookaheadInMs);
+
+    //How many samples of delay the lookahead adds
+    int getLatencySamples() const;
 
     //Processes the input buffer
     void process(juce::AudioBuffer<float>& buffer);
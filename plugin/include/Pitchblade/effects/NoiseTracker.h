@@ -0,0 +1,131 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//Follows the noise floor in every FFT bin while audio is playing, so the de-noiser doesn't need a fresh "Learn" every time the room changes
+//This is MCRA (minima controlled recursive averaging) with a continuous minimum tracker in place of the usual search window:
+//  1. Each bin's power is smoothed over time
+//  2. A slowly rising minimum follows the smoothed power from below. Speech comes and goes, but the noise is always there, so the minimum sits on the noise
+//  3. Where the smoothed power is well above the minimum, speech is probably there. That probability is smoothed too
+//  4. The noise estimate is averaged from the frame's power, but held still while speech is likely
+//Everything is one recursion per bin per frame, so it is four floats per bin with no history buffers
+class NoiseTracker{
+public:
+    //Makes room for up to maxBins, so prepare can be called again for a different FFT size without allocating
+    void reserve(int maxBins){
+        smoothedPower.reserve((size_t)maxBins);
+        minimumPower.reserve((size_t)maxBins);
+        speechProbability.reserve((size_t)maxBins);
+        noisePower.reserve((size_t)maxBins);
+    }
+
+    //Sets up the per bin state. hopMs is the time between frames, and is used to turn the time constants into per frame coefficients
+    void prepare(int numBinsValue, double hopMs){
+        numBins = numBinsValue;
+        smoothedPower.assign((size_t)numBins, 0.0f);
+        minimumPower.assign((size_t)numBins, 0.0f);
+        speechProbability.assign((size_t)numBins, 0.0f);
+        noisePower.assign((size_t)numBins, 0.0f);
+
+        smoothingCoeff = coeffFor(hopMs, POWER_SMOOTHING_MS);
+        minimumCoeff = coeffFor(hopMs, MINIMUM_RISE_MS);
+        minimumLookCoeff = coeffFor(hopMs, MINIMUM_LOOK_MS);
+        probabilityCoeff = coeffFor(hopMs, PROBABILITY_MS);
+        noiseCoeff = coeffFor(hopMs, NOISE_MS);
+
+        needsSeed = true;
+    }
+
+    //Forget the current estimate. The next frame becomes the starting point
+    void reset(){
+        needsSeed = true;
+    }
+
+    //Start from a known noise magnitude per bin (like a manually learned profile) instead of the next frame
+    void seed(const float* noiseMagnitudes){
+        for(int i = 0; i < numBins; i++){
+            const float power = noiseMagnitudes[i] * noiseMagnitudes[i] * MAGNITUDE_TO_POWER;
+            smoothedPower[i] = power;
+            minimumPower[i] = power;
+            noisePower[i] = power;
+        }
+        std::fill(speechProbability.begin(), speechProbability.end(), 0.0f);
+        needsSeed = false;
+    }
+
+    //Feeds one frame of magnitudes, and writes the updated noise magnitude for every bin into noiseMagnitudes
+    void process(const float* magnitudes, float* noiseMagnitudes){
+        if(needsSeed){
+            //Best guess until the minimum has had time to settle
+            seed(magnitudes);
+        }
+
+        for(int i = 0; i < numBins; i++){
+            const float power = magnitudes[i] * magnitudes[i];
+
+            //1. Smooth the power over time
+            const float smoothed = smoothingCoeff * smoothedPower[i] + (1.0f - smoothingCoeff) * power;
+
+            //2. Follow the minimum. It drops straight down to anything lower, and otherwise creeps up at a rate set by how much the power rose
+            if(minimumPower[i] < smoothed){
+                minimumPower[i] = minimumCoeff * minimumPower[i]
+                    + (1.0f - minimumCoeff) / (1.0f - minimumLookCoeff) * (smoothed - minimumLookCoeff * smoothedPower[i]);
+            }else{
+                minimumPower[i] = smoothed;
+            }
+            smoothedPower[i] = smoothed;
+
+            //3. Speech is probably present if the bin is well above its minimum
+            const bool present = smoothed > SPEECH_RATIO * minimumPower[i];
+            speechProbability[i] = probabilityCoeff * speechProbability[i] + (present ? 1.0f - probabilityCoeff : 0.0f);
+
+            //4. Average the noise, but only as much as speech is absent. On frames that look like speech it is held completely,
+            //otherwise the first frame of every word would leak into the estimate before the probability has caught up
+            if(!present){
+                const float coeff = noiseCoeff + (1.0f - noiseCoeff) * speechProbability[i];
+                noisePower[i] = coeff * noisePower[i] + (1.0f - coeff) * power;
+            }
+
+            //Back to a magnitude on the same scale as a learned profile
+            noiseMagnitudes[i] = std::sqrt(noisePower[i] / MAGNITUDE_TO_POWER);
+        }
+    }
+
+private:
+    //Time constants. These are the usual MCRA values, converted from per frame coefficients to ms so they don't depend on the hop size
+    static constexpr double POWER_SMOOTHING_MS = 36.0;
+    static constexpr double MINIMUM_RISE_MS = 4000.0;
+    static constexpr double MINIMUM_LOOK_MS = 200.0;
+    static constexpr double PROBABILITY_MS = 5.0;
+    static constexpr double NOISE_MS = 160.0;
+
+    //How far above the minimum a bin has to be (in power) before it's counted as speech
+    static constexpr float SPEECH_RATIO = 5.0f;
+
+    //A learned profile is the average magnitude, but this tracks the average power. For noise, the mean power is 4/pi times the
+    //squared mean magnitude, so this keeps the two on the same scale and the reduction slider feels the same either way
+    static constexpr float MAGNITUDE_TO_POWER = 4.0f / juce::MathConstants<float>::pi;
+
+    static float coeffFor(double hopMs, double timeMs){
+        return (float)std::exp(-hopMs / timeMs);
+    }
+
+    int numBins = 0;
+    bool needsSeed = true;
+
+    float smoothingCoeff = 0.0f;
+    float minimumCoeff = 0.0f;
+    float minimumLookCoeff = 0.0f;
+    float probabilityCoeff = 0.0f;
+    float noiseCoeff = 0.0f;
+
+    //Per bin state
+    std::vector<float> smoothedPower;
+    std::vector<float> minimumPower;
+    std::vector<float> speechProbability;
+    std::vector<float> noisePower;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "Pitchblade/effects/BiquadDesign.h"
+
+/* Author: huda
+   ParametricEq; up to 16 bands, each with its own type, frequency, gain and Q.
+
+   The bands run as a cascade of biquads (transposed direct form II), but
+   instead of one biquad after another, four bands share one SIMD register,
+   one band per lane. A cascade is serial (band 2 needs band 1's output), so
+   the lanes are staggered by a sample: on each step lane 0 takes a new input
+   sample while lane 1 filters what lane 0 produced on the step before, and so
+   on down the lanes. Every lane does useful work on every step apart from the
+   few at the start and end of a block where the pipeline fills and drains,
+   and it fully drains every block, so there is no added latency.
+
+   8 bands is two registers per sample, which is less work than the three
+   separate filters the 3-band Equalizer runs.
+*/
+
+class ParametricEq
+{
+public:
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int maxBands = 16;
+    static constexpr int numLanes = (int)Vec::SIMDNumElements;
+    static constexpr int maxGroups = (maxBands + numLanes - 1) / numLanes;
+
+    enum class BandType { bell = 0, lowShelf, highShelf, lowCut, highCut, notch };
+    static constexpr int numBandTypes = 6;
+
+    ParametricEq();
+
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    void reset();
+
+    // param setters (safe from GUI thread)
+    void setNumBands(int count);
+    void setBandType(int band, BandType type);
+    void setBandFrequency(int band, float hz);
+    void setBandGainDb(int band, float dB);
+    void setBandQ(int band, float q);
+    void setBandEnabled(int band, bool enabled);
+
+    // process in-place
+    void processBlock(juce::AudioBuffer<float>& buffer) noexcept;
+
+    // getters for UI
+    int getNumBands() const noexcept { return numBandsTarget.load(); }
+    BandType getBandType(int band) const noexcept { return (BandType)params[(size_t)band].type.load(); }
+    float getBandFrequency(int band) const noexcept { return params[(size_t)band].freqHz.load(); }
+    float getBandGainDb(int band) const noexcept { return params[(size_t)band].gainDb.load(); }
+    float getBandQ(int band) const noexcept { return params[(size_t)band].q.load(); }
+    bool isBandEnabled(int band) const noexcept { return params[(size_t)band].enabled.load(); }
+
+    // The filter one band makes, for drawing response curves
+    static BiquadCoefficients designBand(double sampleRate, BandType type, float hz, float dB, float q) noexcept;
+
+    // Spread of starting frequencies so a fresh EQ covers the whole range
+    static float defaultFrequency(int band) noexcept;
+
+private:
+    // Knobs as set from the GUI
+    struct BandParams
+    {
+        std::atomic<int> type { (int)BandType::bell };
+        std::atomic<float> freqHz { 1000.0f };
+        std::atomic<float> gainDb { 0.0f };
+        std::atomic<float> q { 1.0f };
+        std::atomic<bool> enabled { true };
+    };
+
+    // The audio thread's copy of one band
+    struct Band
+    {
+        BandType type = BandType::bell;
+        bool enabled = true;
+
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gainSmooth;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freqSmooth;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> qSmooth;
+
+        // what the current coefficients were designed for
+        BandType designedType = BandType::bell;
+        bool designedEnabled = false;
+        float designedHz = 0.0f, designedDb = 0.0f, designedQ = 0.0f;
+        BiquadCoefficients coeffs;
+        bool identity = true;
+    };
+
+    // Coefficients for one group of bands, one band per lane
+    struct LaneCoefficients
+    {
+        Vec b0, b1, b2, a1, a2;
+    };
+
+    // Filter memory for one group of bands on one channel
+    struct LaneState
+    {
+        Vec s1, s2;
+    };
+
+    // Runs one group of bands over a run of samples in place. When ramping, the coefficients move by step each sample
+    void processGroup(const LaneCoefficients& start, const LaneCoefficients* step, LaneState& state,
+                      float* data, int numSamples) const noexcept;
+
+    // Pulls the GUI values into the audio thread's bands. Returns true if anything needs smoothing
+    bool pullParameters() noexcept;
+
+    // Redesigns any band whose smoothed knobs moved since last time, and loads the group registers
+    void updateCoefficients(int numSamplesToSkip) noexcept;
+    void loadGroup(int group) noexcept;
+
+    double sr = 44100.0;
+    bool isPrepared = false;
+
+    std::atomic<int> numBandsTarget { 8 };
+    int numBands = 8;
+    std::array<BandParams, maxBands> params;
+    std::array<Band, maxBands> bands;
+
+    // One set of registers per group, and one filter memory per group per channel
+    std::array<LaneCoefficients, maxGroups> groupCoeffs;
+    std::array<bool, maxGroups> groupActive {};
+    std::vector<std::array<LaneState, maxGroups>> states;
+
+    // Lane numbers 0, 1, 2, 3, for working out which lanes are busy while the pipeline fills and drains
+    Vec laneIndex;
+
+    float smoothingTimeSeconds = 0.02f; // 20 ms
+
+    // While knobs move, coefficients are redesigned every this many samples and blended per sample in between
+    static constexpr int subBlockSize = 32;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParametricEq)
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+#include <juce_dsp/juce_dsp.h>
+
+/* Author: huda
+   Uniformly partitioned FFT convolution (overlap-save) for long FIR kernels.
+
+   The kernel is cut into partitions the size of one block, and each one is
+   FFT'd once when the kernel is loaded. Every block of input is FFT'd once,
+   kept in a ring of past spectra, and multiplied against all the partitions,
+   so a 4096 tap kernel costs a few complex multiplies per sample instead of
+   4096 multiplies. Output is one partition behind the input.
+
+   New kernels can be loaded from any thread but the audio one. They are built
+   into a free slot and handed over with one atomic, and the audio thread
+   crossfades from the old kernel to the new one over a block so nothing clicks.
+*/
+
+class PartitionedConvolver
+{
+public:
+    using Complex = std::complex<float>;
+
+    // Allocates everything: the partitions, the input history and every kernel slot
+    void prepare(int partitionOrder, int maxKernelLength, int numChannels);
+
+    // Clears the audio in flight. Kernels are kept
+    void reset();
+
+    // Not for the audio thread. FFTs the kernel into a free slot and hands it over to be faded in
+    void loadKernel(const float* taps, int numTaps);
+
+    // Convolves the buffer in place. Channels past the number prepared for are left alone
+    void process(juce::AudioBuffer<float>& buffer) noexcept;
+
+    int getPartitionSize() const noexcept { return partitionSize; }
+    int getLatencySamples() const noexcept { return partitionSize; }
+    int getNumChannels() const noexcept { return (int)channels.size(); }
+
+private:
+    // One kernel, already in the frequency domain
+    struct Kernel
+    {
+        std::vector<Complex> partitions;    // numPartitions * numBins
+        int numUsed = 0;                    // partitions actually holding taps
+    };
+
+    struct ChannelState
+    {
+        std::vector<float> input;           // this block's input as it arrives
+        std::vector<float> output;          // last block's output, handed back as input arrives
+        std::vector<float> history;         // previous block then this one, what gets FFT'd
+        std::vector<Complex> spectra;       // ring of past input spectra, numPartitions * numBins
+    };
+
+    // Slot handover. active and fading belong to the audio thread, published to the loader, all packed in one atomic
+    // so neither side ever sees a half changed set
+    static constexpr int numSlots = 4;
+    static constexpr uint32_t noSlot = 0xF;
+    static uint32_t packSlots(uint32_t active, uint32_t fading, uint32_t published) noexcept { return active | (fading << 4) | (published << 8); }
+    static uint32_t activeSlot(uint32_t s) noexcept    { return s & 0xF; }
+    static uint32_t fadingSlot(uint32_t s) noexcept    { return (s >> 4) & 0xF; }
+    static uint32_t publishedSlot(uint32_t s) noexcept { return (s >> 8) & 0xF; }
+
+    // Runs one full block of every channel through the active kernel (and the old one while fading)
+    void processPartition(int numChannels) noexcept;
+    // Multiplies the ring of input spectra by a kernel and sums the products into accumulator
+    void accumulate(const ChannelState& channel, const Kernel& kernel) noexcept;
+    // Inverse FFT of accumulator. The last half of fftData is the new output
+    void inverse() noexcept;
+
+    // loadKernel runs on the builder thread while process runs on the audio thread, so each has its own FFT
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::FFT> loadFft;
+    int partitionSize = 0;
+    int fftSize = 0;
+    int numBins = 0;
+    int numPartitions = 0;
+
+    std::array<Kernel, numSlots> kernels;
+    std::atomic<uint32_t> slots { packSlots(noSlot, noSlot, noSlot) };
+
+    std::vector<ChannelState> channels;
+    int ringPos = 0;        // newest spectrum in each channel's ring
+    int fillPos = 0;        // samples gathered towards the next block
+
+    // Audio thread scratch
+    std::vector<float> fftData;
+    std::vector<float> fadeOutput;
+    std::vector<Complex> accumulator;
+
+    // Loader scratch
+    std::vector<float> loadData;
+};
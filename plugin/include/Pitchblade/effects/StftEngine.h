@@ -0,0 +1,154 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <complex>
+#include <memory>
+#include <vector>
+
+//Shared short-time Fourier transform plumbing for anything that works on spectra
+//The de-noiser, formant detector and spectrum analyser each used to have their own copy of the windowing, FFT buffers and overlap add,
+//and each one was slightly different (the de-noiser's hard coded 1 / 1.5 was only right for one window and hop). Now they all use this
+
+//Window table for one FFT size. It never changes once made, so one plan is shared by every engine and analyser using that size
+//The FFT itself isn't shared. juce::dsp::FFT isn't safe to run from two threads at once, and the users of a size can be on the
+//audio thread, the UI thread and a kernel builder, so each one owns its own
+class StftPlan{
+public:
+    //Returns the plan for this FFT order, making it the first time it is asked for
+    //This takes a lock, so call it from prepare or the UI thread, never while processing
+    static std::shared_ptr<const StftPlan> get(int fftOrder);
+
+    explicit StftPlan(int fftOrder);
+
+    const int order;
+    const int size;
+
+    //Periodic hann window. Periodic rather than symmetric, so overlapped copies of it add up to a flat line
+    std::vector<float> window;
+    //Sum of the window, for scaling magnitudes to what a normalised window would give
+    float windowSum = 0.0f;
+};
+
+//Streams audio through a window, FFT, per frame callback, inverse FFT and overlap add
+//Input and output are circular buffers, so nothing is shifted each hop. The callback gets the spectrum of every channel once per hop,
+//as (real, imag) pairs for bins 0 to fftSize / 2, and can change them in place
+class StftEngine{
+public:
+    using Complex = std::complex<float>;
+
+    //Allocates everything. The hop has to divide the FFT size and be at most a quarter of it,
+    //since the window is applied twice and hann squared only adds up flat with at least 75% overlap
+    void prepare(int fftOrder, int hopSizeValue, int numChannels);
+
+    //Clears the audio in flight without allocating
+    void reset();
+
+    int getFFTSize() const { return fftSize; }
+    int getHopSize() const { return hopSize; }
+    int getNumBins() const { return numBins; }
+    int getNumChannels() const { return (int)channels.size(); }
+    const StftPlan& getPlan() const { return *plan; }
+
+    //Output lags input by one full frame
+    int getLatencySamples() const { return fftSize; }
+
+    //Processes the buffer in place. onFrame(Complex* const* spectra, int numChannels) is called once per hop
+    //Channels past the number prepared for are left alone
+    template<typename FrameCallback>
+    void process(juce::AudioBuffer<float>& buffer, FrameCallback&& onFrame);
+
+    //Same as process but nothing is put back together, for detectors that only look at the spectrum
+    template<typename FrameCallback>
+    void analyse(const float* const* input, int numInputChannels, int numSamples, FrameCallback&& onFrame);
+
+private:
+    std::shared_ptr<const StftPlan> plan;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0;
+    int hopSize = 0;
+    int numBins = 0;
+    int mask = 0;
+
+    //Overlap adding windowed frames (window on the way in and on the way out) sums to hop / (sum of window squared)
+    //Multiplying by this on the way out puts the level back exactly
+    float synthesisScale = 1.0f;
+
+    struct ChannelState{
+        //Last fftSize samples in, and the overlap add of the frames out. Both are indexed by ringPos
+        std::vector<float> inputRing;
+        std::vector<float> outputRing;
+        //Frame being worked on. The FFT needs twice the size
+        std::vector<float> fftData;
+    };
+    std::vector<ChannelState> channels;
+    //Spectra for the callback, pointing into each channel's fftData
+    std::vector<Complex*> spectra;
+
+    //Every channel moves together, so the positions are shared
+    int ringPos = 0;
+    int hopCounter = 0;
+
+    //Unwraps the newest frame from each input ring, windows it and runs the forward FFT
+    void analyseFrame(int numChannels);
+    //Inverse FFT, window and overlap add into each output ring
+    void synthesiseFrame(int numChannels);
+};
+
+template<typename FrameCallback>
+void StftEngine::process(juce::AudioBuffer<float>& buffer, FrameCallback&& onFrame){
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = std::min(buffer.getNumChannels(), (int)channels.size());
+
+    int position = 0;
+    while(position < numSamples){
+        //Work in straight runs up to the next hop (which is never past the end of the rings, since the hop divides the size)
+        const int count = std::min(numSamples - position, hopSize - hopCounter);
+
+        for(int ch = 0; ch < numChannels; ch++){
+            auto& channel = channels[(size_t)ch];
+            float* data = buffer.getWritePointer(ch) + position;
+            float* output = channel.outputRing.data() + ringPos;
+
+            //Take the input, hand back the finished output, and clear that spot for the frames still to come
+            std::copy(data, data + count, channel.inputRing.data() + ringPos);
+            std::copy(output, output + count, data);
+            std::fill(output, output + count, 0.0f);
+        }
+        ringPos = (ringPos + count) & mask;
+        hopCounter += count;
+        position += count;
+
+        if(hopCounter == hopSize){
+            hopCounter = 0;
+            analyseFrame(numChannels);
+            onFrame(spectra.data(), numChannels);
+            synthesiseFrame(numChannels);
+        }
+    }
+}
+
+template<typename FrameCallback>
+void StftEngine::analyse(const float* const* input, int numInputChannels, int numSamples, FrameCallback&& onFrame){
+    const int numChannels = std::min(numInputChannels, (int)channels.size());
+
+    int position = 0;
+    while(position < numSamples){
+        const int count = std::min(numSamples - position, hopSize - hopCounter);
+
+        for(int ch = 0; ch < numChannels; ch++){
+            const float* data = input[ch] + position;
+            std::copy(data, data + count, channels[(size_t)ch].inputRing.data() + ringPos);
+        }
+        ringPos = (ringPos + count) & mask;
+        hopCounter += count;
+        position += count;
+
+        if(hopCounter == hopSize){
+            hopCounter = 0;
+            analyseFrame(numChannels);
+            onFrame(spectra.data(), numChannels);
+        }
+    }
+}
@@ -4,14 +4,15 @@
 #include <JuceHeader.h>
 #include "Pitchblade/PluginProcessor.h"
 #include "Pitchblade/ui/LevelMeter.h"   //for volume meter - reyna
+#include "Pitchblade/ui/FrameClock.h"
 
 class CompressorNode;
 
 // volume meter bar - reyna
-class SimpleVolumeBar : public juce::Component, private juce::Timer {
+class SimpleVolumeBar : public juce::Component, private FrameClockClient {
 public:
-    SimpleVolumeBar(std::function<float()> postGetter, std::function<float()> preGetter) : getPost(std::move(postGetter)), getPre(std::move(preGetter)) {
-        startTimerHz(30); // refresh about 30 FPS
+    // refreshes at the framerate setting
+    SimpleVolumeBar(std::function<float()> postGetter, std::function<float()> preGetter) : FrameClockClient(*this), getPost(std::move(postGetter)), getPre(std::move(preGetter)) {
     }
     void setThresholdDecibels(float newThreshold) { thresholdDb = newThreshold; }
 
@@ -82,7 +83,7 @@ private:
 
     float thresholdDb = -20.0f;
 
-    void timerCallback() override { repaint(); }
+    void frameCallback() override { repaint(); }
 };
 
 //Defines the UI panel /////////////////////////////////////////////
@@ -105,13 +106,13 @@ private:
     AudioPluginAudioProcessor& processor;
 
     //Sliders
-    juce::Slider thresholdSlider, ratioSlider, attackSlider, releaseSlider;
+    juce::Slider thresholdSlider, ratioSlider, attackSlider, releaseSlider, lookaheadSlider;
 
     //Button for mode switching
     juce::ToggleButton modeButton {"Limiter Mode"};
 
     //Labels for sliders
-    juce::Label compressorLabel, thresholdLabel, ratioLabel, attackLabel, releaseLabel;
+    juce::Label compressorLabel, thresholdLabel, ratioLabel, attackLabel, releaseLabel, lookaheadLabel;
 
     //volume meter - reyna
     static void place(juce::Rectangle<int> area, juce::Slider& slider, juce::Label& label, bool useCustomLF);
@@ -140,7 +141,7 @@ private:
     juce::ValueTree localState;
 public:
     explicit CompressorVisualizer(AudioPluginAudioProcessor& proc, CompressorNode& node, juce::ValueTree& state)
-        : RealTimeGraphVisualizer(proc.apvts, "dB", {-100.0f, 0.0f},false,6),
+        : RealTimeGraphVisualizer("dB", {-100.0f, 0.0f},false,6),
             processor(proc),
             compressorNode(node),
             localState(state)
@@ -156,7 +157,7 @@ public:
     ~CompressorVisualizer() override;
 
     //Update the graph
-    void timerCallback() override;
+    void frameCallback() override;
 
     void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
 
@@ -182,13 +183,11 @@ public:
             getMutableNodeState().setProperty("CompRelease", 250.0f, nullptr);
         if (!getMutableNodeState().hasProperty("CompLimiterMode"))
             getMutableNodeState().setProperty("CompLimiterMode", false, nullptr);
-
-        //ensure EffectNodes tree exists
-        if (!processor.apvts.state.hasType("EffectNodes"))
-            processor.apvts.state = juce::ValueTree("EffectNodes");
+        if (!getMutableNodeState().hasProperty("CompLookahead"))
+            getMutableNodeState().setProperty("CompLookahead", 0.0f, nullptr);
 
         //add this node to processor state tree
-        processor.apvts.state.addChild(getMutableNodeState(), -1, nullptr);
+        processor.addNodeState(getMutableNodeState());
 
         //Preparing the compressor
         compressorDSP.prepare(proc.getSampleRate());
@@ -209,14 +208,18 @@ public:
         const float attack = (float)getNodeState().getProperty("CompAttack", 50.0f);
         const float release = (float)getNodeState().getProperty("CompRelease", 250.0f);
         const bool isLimiterMode = (bool)getNodeState().getProperty("CompLimiterMode", false);
+        const float lookahead = (float)getNodeState().getProperty("CompLookahead", 0.0f);
+
+        compressorDSP.setLookahead(lookahead);
         
         //Check if the limiter mode is active
         if (isLimiterMode)
         {
             // In limiter mode, use a high fixed ratio and fast attack
+            // With lookahead on, the attack is stretched to the lookahead time so the gain is fully down right as the peak comes out of the delay
             compressorDSP.setThreshold(threshold);
             compressorDSP.setRatio(2000.0f); // High, fixed ratio
-            compressorDSP.setAttack(1.0f);   // Very fast attack
+            compressorDSP.setAttack(std::max(1.0f, lookahead));   // Very fast attack
             compressorDSP.setRelease(release);
         }
         else
@@ -257,6 +260,11 @@ public:
         return compressorDSP.priorOutputLevelDb;
     }
 
+    //Lookahead delay, so the host can line everything back up
+    int getLatencySamples() const override {
+        return compressorDSP.getLatencySamples();
+    }
+
     ////////////////////////////////////////////////////////////  reyna
 
     // clone node
@@ -24,10 +24,13 @@ private:
     AudioPluginAudioProcessor& processor;
 
     //Sliders
-    juce::Slider thresholdSlider, ratioSlider, attackSlider, releaseSlider, frequencySlider;
+    juce::Slider thresholdSlider, ratioSlider, attackSlider, releaseSlider, frequencySlider, lookaheadSlider;
+
+    //Toggle for split-band mode
+    juce::ToggleButton splitBandButton {"Split Band"};
 
     //Labels
-    juce::Label deEsserLabel, thresholdLabel, ratioLabel, attackLabel, releaseLabel, frequencyLabel;
+    juce::Label deEsserLabel, thresholdLabel, ratioLabel, attackLabel, releaseLabel, frequencyLabel, lookaheadLabel;
 
     juce::ValueTree localState;
 
@@ -37,6 +40,7 @@ private:
 //Visualizer Node for DeEsser
 #include "Pitchblade/ui/VisualizerPanel.h"
 #include "Pitchblade/ui/FrequencyGraphVisualizer.h"
+#include "Pitchblade/ui/SpectrumAnalyser.h"
 
 class DeEsserNode;
 
@@ -46,6 +50,10 @@ private:
     DeEsserNode& deEsserNode;
     juce::ValueTree localState;
 
+    //Does the FFT of the processed audio on the UI thread
+    SpectrumAnalyser analyser;
+    std::vector<juce::Point<float>> spectrumPoints;
+
     // Helper to set threshold lines from state
     void updateThresholdLines(){
         const float freq = (float)localState.getProperty("DeEsserFrequency", 6000.0f);
@@ -54,19 +62,14 @@ private:
     }
 
 public:
-    explicit DeEsserVisualizer(AudioPluginAudioProcessor& proc, DeEsserNode& node, juce::ValueTree& state)
-        : FrequencyGraphVisualizer(proc.apvts, 5, 1),
-            processor(proc),
-            deEsserNode(node),
-            localState(state)
-    {
-        localState.addListener(this);
-        updateThresholdLines();
-    }
+    explicit DeEsserVisualizer(AudioPluginAudioProcessor& proc, DeEsserNode& node, juce::ValueTree& state);
 
     ~DeEsserVisualizer() override;
 
-    void timerCallback() override;
+    void frameCallback() override;
+
+    //Only listens to the processor while on screen
+    void frameVisibilityChanged(bool isNowShowing) override;
 
     void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
 
@@ -90,13 +93,13 @@ public:
             getMutableNodeState().setProperty("DeEsserRelease", 5.0f, nullptr);
         if (!getMutableNodeState().hasProperty("DeEsserFrequency"))
             getMutableNodeState().setProperty("DeEsserFrequency", 6000.0f, nullptr);
+        if (!getMutableNodeState().hasProperty("DeEsserLookahead"))
+            getMutableNodeState().setProperty("DeEsserLookahead", 0.0f, nullptr);
+        if (!getMutableNodeState().hasProperty("DeEsserSplitBand"))
+            getMutableNodeState().setProperty("DeEsserSplitBand", false, nullptr);
         
-        //Ensure EffectNodes tree exists
-        if (!processor.apvts.state.hasType("EffectNodes"))
-            processor.apvts.state = juce::ValueTree("EffectNodes");
-
         //Add this node to processor state tree
-        processor.apvts.state.addChild(getMutableNodeState(), -1, nullptr);
+        processor.addNodeState(getMutableNodeState());
 
         //Preparing the de-esser
         deEsserDSP.prepare(proc.getSampleRate(),proc.getCurrentBlockSize());
@@ -111,12 +114,16 @@ public:
         const float attack = (float)getNodeState().getProperty("DeEsserAttack", 5.0f);
         const float release = (float)getNodeState().getProperty("DeEsserRelease", 5.0f);
         const float frequency = (float)getNodeState().getProperty("DeEsserFrequency", 6000.0f);
+        const float lookahead = (float)getNodeState().getProperty("DeEsserLookahead", 0.0f);
+        const bool splitBand = (bool)getNodeState().getProperty("DeEsserSplitBand", false);
 
         deEsserDSP.setThreshold(threshold);
         deEsserDSP.setRatio(ratio);
         deEsserDSP.setAttack(attack);
         deEsserDSP.setRelease(release);
         deEsserDSP.setFrequency(frequency);
+        deEsserDSP.setLookahead(lookahead);
+        deEsserDSP.setSplitBand(splitBand);
 
         deEsserDSP.process(buffer);
     }
@@ -152,6 +159,11 @@ public:
         return deEsserDSP;
     }
 
+    //Lookahead delay, so the host can line everything back up
+    int getLatencySamples() const override {
+        return deEsserDSP.getLatencySamples();
+    }
+
     // XML serialization for saving/loading
     std::unique_ptr<juce::XmlElement> toXml() const override;
     void loadFromXml(const juce::XmlElement& xml) override;
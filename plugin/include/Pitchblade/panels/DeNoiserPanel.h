@@ -17,8 +17,14 @@ private:
     //Button for learning
     juce::TextButton learnButton {"Learn Noise Profile"};
 
+    //Toggle for following the noise floor automatically
+    juce::ToggleButton adaptiveButton {"Adaptive"};
+
+    //FFT size mode
+    juce::ComboBox modeBox;
+
     //Labels
-    juce::Label deNoiserLabel, reductionLabel, statusLabel;
+    juce::Label deNoiserLabel, reductionLabel, statusLabel, modeLabel;
 
     juce::ValueTree localState;
 
@@ -48,27 +54,33 @@ public:
 //Visualizer
 #include "Pitchblade/ui/VisualizerPanel.h"
 #include "Pitchblade/ui/FrequencyGraphVisualizer.h"
+#include "Pitchblade/ui/SpectrumAnalyser.h"
 
 class DeNoiserNode;
-//Not fully implemented. Just shows a placeholder
+//Shows the processed spectrum with the learned noise profile behind it
 class DeNoiserVisualizer : public FrequencyGraphVisualizer, public juce::ValueTree::Listener{
 private:
     AudioPluginAudioProcessor& processor;
     DeNoiserNode& deNoiserNode;
     juce::ValueTree localState;
+
+    //Does the FFT of the processed audio on the UI thread
+    SpectrumAnalyser analyser;
+    std::vector<juce::Point<float>> spectrumPoints;
+
+    //Noise profile is pulled as magnitudes and turned into points here
+    std::vector<float> noiseMagnitudes;
+    std::vector<juce::Point<float>> noisePoints;
+    bool hasNoiseProfile = false;
 public:
-    explicit DeNoiserVisualizer(AudioPluginAudioProcessor& proc, DeNoiserNode& node, juce::ValueTree& state)
-        : FrequencyGraphVisualizer(proc.apvts, 5,2),
-            processor(proc),
-            deNoiserNode(node),
-            localState(state)
-    {
-        //Nothing yet
-    }
+    explicit DeNoiserVisualizer(AudioPluginAudioProcessor& proc, DeNoiserNode& node, juce::ValueTree& state);
 
     ~DeNoiserVisualizer() override;
 
-    void timerCallback() override;
+    void frameCallback() override;
+
+    //Only listens to the processor while on screen
+    void frameVisibilityChanged(bool isNowShowing) override;
 
     void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
 
@@ -87,15 +99,15 @@ public:
             getMutableNodeState().setProperty("DenoiserReduction",0.5f,nullptr);
         if(!getMutableNodeState().hasProperty("DenoiserLearn"))
             getMutableNodeState().setProperty("DenoiserLearn",false,nullptr);
-
-        //Ensure EffectNodes tree exists
-        if(!processor.apvts.state.hasType("EffectNodes"))
-            processor.apvts.state = juce::ValueTree("EffectNodes");
+        if(!getMutableNodeState().hasProperty("DenoiserAdaptive"))
+            getMutableNodeState().setProperty("DenoiserAdaptive",false,nullptr);
+        if(!getMutableNodeState().hasProperty("DenoiserMode"))
+            getMutableNodeState().setProperty("DenoiserMode",(int)DeNoiserProcessor::FFTMode::balanced,nullptr);
 
         //Add this node to processor state tree
-        processor.apvts.state.addChild(getMutableNodeState(),-1,nullptr);
+        processor.addNodeState(getMutableNodeState());
 
-        deNoiserDSP.prepare(proc.getSampleRate());
+        deNoiserDSP.prepare(proc.getSampleRate(), std::max(2, proc.getTotalNumOutputChannels()));
     }
 
     //DSP processing step for denoiser
@@ -104,9 +116,13 @@ public:
 
         const float reduction = (float)getNodeState().getProperty("DenoiserReduction", 0.5f);
         const bool isLearning = (bool)getNodeState().getProperty("DenoiserLearn", false);
+        const bool isAdaptive = (bool)getNodeState().getProperty("DenoiserAdaptive", false);
+        const int mode = juce::jlimit(0, DeNoiserProcessor::numModes - 1, (int)getNodeState().getProperty("DenoiserMode", 1));
 
         deNoiserDSP.setReduction(reduction);
         deNoiserDSP.setLearning(isLearning);
+        deNoiserDSP.setAdaptive(isAdaptive);
+        deNoiserDSP.setFFTMode((DeNoiserProcessor::FFTMode)mode);
 
         deNoiserDSP.process(buffer);
     }
@@ -135,6 +151,11 @@ public:
         return clonePtr;
     }
 
+    //Report the frame delay so the host can line things up
+    int getLatencySamples() const override {
+        return deNoiserDSP.getLatencySamples();
+    }
+
     DeNoiserProcessor& getDSP(){
         return deNoiserDSP;
     }
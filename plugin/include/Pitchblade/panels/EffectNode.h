@@ -18,6 +18,9 @@
 #pragma once
 #include <JuceHeader.h>
 #include "Pitchblade/PluginProcessor.h"
+#include "Pitchblade/effects/LoudnessMeter.h"
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -68,6 +71,9 @@ public:
 
 	virtual std::shared_ptr<EffectNode> clone() const = 0;      // duplicate node
 
+    // samples of delay this node adds to the audio (lookahead etc), reported to the host by the processor
+    virtual int getLatencySamples() const { return 0; }
+
     // XML serialization
     virtual std::unique_ptr<juce::XmlElement> toXml() const = 0;
     virtual void loadFromXml(const juce::XmlElement& xml) = 0;
@@ -76,6 +82,7 @@ public:
 
 	const juce::String& getNodeType()  const { return nodeType; }           // type of node
 	const juce::ValueTree& getNodeState() const { return nodeState; }       // state of node
+	juce::String getUuid() const { return nodeState.getProperty("uuid").toString(); }   // id that stays with the node, used to match ui to it
 	juce::ValueTree& getMutableNodeState() { return nodeState; }            //  mutable state of node
 
 	const juce::ValueTree& getNodeStateConst() const { return nodeState; }  // const state of node
@@ -131,6 +138,20 @@ public:
         parents.clear();
     }
 
+    ///////////////////////////// loudness metering - Austin
+    // a LUFS / true peak meter can be attached before this node's effect, after it, or both. Off until asked for
+    enum class MeterPoint { input = 0, output = 1 };
+
+    void setMeterEnabled(MeterPoint point, bool enabled) {
+        const auto index = (size_t)point;
+        if (enabled && !meterEnabled[index].load())
+            meters[index].requestReset();       // fresh readings every time it's switched on
+        meterEnabled[index].store(enabled);
+    }
+    bool isMeterEnabled(MeterPoint point) const { return meterEnabled[(size_t)point].load(); }
+    const LoudnessMeter& getMeter(MeterPoint point) const { return meters[(size_t)point]; }
+    void resetMeters() { for (auto& m : meters) m.requestReset(); }
+
     // debug print 
     void printNodeInfo() const {
         juce::Logger::outputDebugString("Node: " + effectName + " | Mode: " + juce::String(static_cast<int>(chainMode)));
@@ -147,6 +168,19 @@ protected:
 	juce::AudioBuffer<float> uniteMixBuffer;    // buffer for unite mode
 	int uniteAccumulated = 0;                   // number of inputs accumulated
 
+	// loudness meters, read only on the audio thread. Their filters follow the sample rate without allocating
+    std::array<LoudnessMeter, 2> meters;
+    std::array<std::atomic<bool>, 2> meterEnabled {};
+
+    void meterBlock(MeterPoint point, const juce::AudioBuffer<float>& buffer, double sampleRate) {
+        auto& meter = meters[(size_t)point];
+        if (!meterEnabled[(size_t)point].load(std::memory_order_relaxed))
+            return;
+        if (meter.getSampleRate() != sampleRate)
+            meter.prepare(sampleRate);
+        meter.process(buffer);
+    }
+
 	// valuetree listener callback
     void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override {
         juce::ignoreUnused(tree, property);
@@ -158,9 +192,11 @@ inline void EffectNode::processAndForward(AudioPluginAudioProcessor& proc, juce:
     // make a copy of the input
     juce::AudioBuffer<float> temp(buffer);
     temp.makeCopyOf(buffer, true);
+    meterBlock(MeterPoint::input, temp, proc.getSampleRate());
     if (!bypassed) {
         process(proc, temp);
     }
+    meterBlock(MeterPoint::output, temp, proc.getSampleRate());
 
     //  chain mode rout behavior
     switch (chainMode) {
@@ -4,6 +4,7 @@
 #include <JuceHeader.h>
 #include "Pitchblade/PluginProcessor.h"
 #include "Pitchblade/panels/EffectNode.h"
+#include "Pitchblade/effects/Equalizer.h"
 // Visualizer lives separately (VisualizerPanel tabs)
 #include "Pitchblade/ui/EqualizerVisualizer.h"
 
@@ -37,6 +38,7 @@ private:
                  midFreqLabel,  midGainLabel,
                  highFreqLabel, highGainLabel;
     juce::Label equalizerLabel;
+    juce::ToggleButton linearPhaseButton {"Linear Phase"};
 
     void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
 };
@@ -48,24 +50,25 @@ public:
     explicit EqualizerNode(AudioPluginAudioProcessor& proc)
         : EffectNode(proc, "EqualizerNode", "Equalizer")
     {
-        juce::ValueTree st("EqualizerNode");
+        // defaults go into the node's own tree, the one its listener is on
+        auto& st = getMutableNodeState();
         st.setProperty("LowFreq", 200.0f, nullptr);
         st.setProperty("LowGain", 0.0f, nullptr);
         st.setProperty("MidFreq", 1000.0f, nullptr);
         st.setProperty("MidGain", 0.0f, nullptr);
         st.setProperty("HighFreq", 6000.0f, nullptr);
         st.setProperty("HighGain", 0.0f, nullptr);
-        st.setProperty("uuid", juce::Uuid().toString(), nullptr);
-
-        // make sure the global tree exists
-        if (!processor.apvts.state.hasType("EffectNodes"))
-            processor.apvts.state = juce::ValueTree("EffectNodes");
+        st.setProperty("LinearPhase", false, nullptr);
 
         // attach this new tree to EffectNodes as a new child
-        processor.apvts.state.addChild(st, -1, nullptr);
+        processor.addNodeState(st);
 
-        // assign this new unique state to this node
-        nodeState = st;
+        // the EQ has its values before the first block, with or without the panel
+        pushAllToDsp();
+
+        // each node has its own EQ, so a chain that is being built or fading out never changes the one playing
+        const double sr = proc.getSampleRate() > 0.0 ? proc.getSampleRate() : 44100.0;
+        equalizer.prepare(sr, proc.getBlockSize(), std::max(2, proc.getTotalNumOutputChannels()));
     }
 
     // use node state for the panel
@@ -75,18 +78,26 @@ public:
 
     // Provide a visualizer component for VisualizerPanel
     std::unique_ptr<juce::Component> createVisualizer(AudioPluginAudioProcessor&) override {
-        try { return std::make_unique<EqualizerVisualizer>(processor); }
+        try { return std::make_unique<EqualizerVisualizer>(processor, equalizer); }
         catch (...) { return nullptr; }
     }
 
     // keep existing DSP path 
     // push local state into the DSP and process
    void process(AudioPluginAudioProcessor& proc, juce::AudioBuffer<float>& buffer) override {
+    juce::ignoreUnused(proc);
     // Do not read ValueTree properties on the audio thread (not thread-safe).
-    // The UI updates the Equalizer parameters via thread-safe setters when knobs move.
-    proc.getEqualizer().processBlock(buffer);
+    // The node's listener updates the Equalizer parameters via thread-safe setters when they change.
+    equalizer.processBlock(buffer);
 }
 
+    // Linear phase mode delays the signal by half its kernel plus one convolution block
+    int getLatencySamples() const override {
+        return equalizer.getLatencySamples();
+    }
+
+    Equalizer& getEqualizer() { return equalizer; }
+
     //reynas daisychain and presets stuff /////////////////////////////////////////
 
     // clone
@@ -116,6 +127,7 @@ public:
         xml->setAttribute("MidGain", (float)st.getProperty("MidGain", 0.0f));
         xml->setAttribute("HighFreq", (float)st.getProperty("HighFreq", 6000.0f));
         xml->setAttribute("HighGain", (float)st.getProperty("HighGain", 0.0f));
+        xml->setAttribute("LinearPhase", (int)st.getProperty("LinearPhase", 0));
         return xml;
     }
 
@@ -128,5 +140,37 @@ public:
         st.setProperty("MidGain", (float)xml.getDoubleAttribute("MidGain", 0.0), nullptr);
         st.setProperty("HighFreq", (float)xml.getDoubleAttribute("HighFreq", 6000.0), nullptr);
         st.setProperty("HighGain", (float)xml.getDoubleAttribute("HighGain", 0.0), nullptr);
+        st.setProperty("LinearPhase", (bool)xml.getIntAttribute("LinearPhase", 0), nullptr);
+
+        // the whole preset goes to the EQ here, the panel doesn't have to be opened
+        // this node's EQ isn't playing yet when a preset is built, so it's safe from the loader thread
+        pushAllToDsp();
+    }
+
+private:
+    Equalizer equalizer;
+
+    void pushAllToDsp() {
+        const auto& st = getNodeState();
+        equalizer.setLowFreq((float)st.getProperty("LowFreq", 200.0f));
+        equalizer.setLowGainDb((float)st.getProperty("LowGain", 0.0f));
+        equalizer.setMidFreq((float)st.getProperty("MidFreq", 1000.0f));
+        equalizer.setMidGainDb((float)st.getProperty("MidGain", 0.0f));
+        equalizer.setHighFreq((float)st.getProperty("HighFreq", 6000.0f));
+        equalizer.setHighGainDb((float)st.getProperty("HighGain", 0.0f));
+        equalizer.setLinearPhase((bool)st.getProperty("LinearPhase", false));
+    }
+
+    // Called whenever the panel, a preset, a clone or the A/B morph changes a value
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override {
+        if (tree != getNodeState()) return;
+        const auto v = tree.getProperty(property);
+        if (property == juce::Identifier("LowFreq"))          equalizer.setLowFreq((float)v);
+        else if (property == juce::Identifier("LowGain"))     equalizer.setLowGainDb((float)v);
+        else if (property == juce::Identifier("MidFreq"))     equalizer.setMidFreq((float)v);
+        else if (property == juce::Identifier("MidGain"))     equalizer.setMidGainDb((float)v);
+        else if (property == juce::Identifier("HighFreq"))    equalizer.setHighFreq((float)v);
+        else if (property == juce::Identifier("HighGain"))    equalizer.setHighGainDb((float)v);
+        else if (property == juce::Identifier("LinearPhase")) equalizer.setLinearPhase((bool)v);
     }
 };
@@ -61,6 +61,11 @@ public:
 
         if (!state.hasProperty("FORMANT_MIX"))
             state.setProperty("FORMANT_MIX", 1.0f, nullptr);     // slider range  0 to 1
+
+        // Own shifter + detector, so a chain that is fading out never shares state with the one playing
+        const double sr = proc.getSampleRate() > 0.0 ? proc.getSampleRate() : 44100.0;
+        shifter.prepare (sr, std::max (1, proc.getBlockSize()), std::max (2, proc.getTotalNumInputChannels()));
+        detector.prepare (sr);
     }
 
     void process (AudioPluginAudioProcessor& proc, juce::AudioBuffer<float>& buffer) override {
@@ -76,8 +81,8 @@ public:
         }
 
         // Get shifter + detector
-        auto& sh = proc.getFormantShifter();
-        auto& det = proc.getFormantDetector();
+        auto& sh = shifter;
+        auto& det = detector;
 
         // Make sure shifter sees the current amount
         sh.setShiftAmount (shift);   // [-50..50] -> internal ratio
@@ -149,6 +154,9 @@ public:
 private:
     AudioPluginAudioProcessor& processor;
 
+    FormantShifter shifter;
+    FormantDetector detector;
+
     //buffer to hold the dry input for dry/wet mixing
     juce::AudioBuffer<float> dryBuffer;
     // Visualization-only: wet copy for formant detection (independent of mix)
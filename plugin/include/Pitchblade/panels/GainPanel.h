@@ -43,13 +43,13 @@ class GainVisualizer : public RealTimeGraphVisualizer
 {
 public:
     explicit GainVisualizer(AudioPluginAudioProcessor& proc, GainNode& node)
-        : RealTimeGraphVisualizer(proc.apvts, "dB", {-100.0f, 0.0f}, false, 6),
+        : RealTimeGraphVisualizer("dB", {-100.0f, 0.0f}, false, 6),
           processor(proc),
           gainNode(node)
     {    }
     ~GainVisualizer() {}
     // Update the graph
-    void timerCallback() override;
+    void frameCallback() override;
 private:
     AudioPluginAudioProcessor& processor;
     GainNode& gainNode;
@@ -71,11 +71,8 @@ public:
         // initialize default properties
         if (!getMutableNodeState().hasProperty("Gain"))
             getMutableNodeState().setProperty("Gain", 0.0f, nullptr);
-		// ensure EffectNodes tree exists
-        if (!processor.apvts.state.hasType("EffectNodes"))
-            processor.apvts.state = juce::ValueTree("EffectNodes");
 		// add this node to processor state tree
-        processor.apvts.state.addChild(getMutableNodeState(), -1, nullptr);
+        processor.addNodeState(getMutableNodeState());
     }
 
 	// dsp read from local state instead of apvts
@@ -0,0 +1,156 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include "Pitchblade/PluginProcessor.h"
+
+class MultibandCompressorNode;
+
+//Defines the UI panel /////////////////////////////////////////////
+class MultibandCompressorPanel : public juce::Component, public juce::ValueTree::Listener
+{
+public:
+    explicit MultibandCompressorPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state, const juce::String& nodeTitle);
+    ~MultibandCompressorPanel() override;
+
+    void resized() override;
+    void paint(juce::Graphics&) override;
+    juce::String panelTitle;
+
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+
+private:
+    // Reference back to main processor
+    AudioPluginAudioProcessor& processor;
+
+    //Band count selector
+    juce::ComboBox bandsBox;
+
+    //Sliders shared by every band
+    juce::Slider attackSlider, releaseSlider;
+    //One crossover between each pair of bands
+    std::array<juce::Slider, 3> crossoverSliders;
+    //Per band sliders
+    std::array<juce::Slider, 4> thresholdSliders, ratioSliders;
+
+    //Labels
+    juce::Label titleLabel, bandsLabel, attackLabel, releaseLabel;
+    std::array<juce::Label, 3> crossoverLabels;
+    std::array<juce::Label, 4> bandLabels;
+
+    juce::ValueTree localState;
+
+    //Grey out the bands and crossovers that are not in use
+    void updateBandVisibility();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultibandCompressorPanel)
+};
+
+// Creating visualizer node for the multiband compressor
+#include "Pitchblade/ui/VisualizerPanel.h"
+#include "Pitchblade/ui/RealTimeGraphVisualizer.h"
+
+//Same idea as the compressor visualizer, it polls the output level and graphs it
+class MultibandCompressorVisualizer : public RealTimeGraphVisualizer {
+private:
+    AudioPluginAudioProcessor& processor;
+    MultibandCompressorNode& compressorNode;
+public:
+    explicit MultibandCompressorVisualizer(AudioPluginAudioProcessor& proc, MultibandCompressorNode& node)
+        : RealTimeGraphVisualizer("dB", {-100.0f, 0.0f}, false, 6),
+            processor(proc),
+            compressorNode(node)
+    {    }
+
+    //Update the graph
+    void frameCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultibandCompressorVisualizer)
+};
+
+//Austin (copying reyna's formatting)
+#include "Pitchblade/panels/EffectNode.h"
+#include "Pitchblade/effects/MultibandCompressorProcessor.h"
+
+class MultibandCompressorNode : public EffectNode
+{
+public:
+    //Create node with name and reference to main processor
+    explicit MultibandCompressorNode(AudioPluginAudioProcessor& proc) : EffectNode(proc, "MultibandCompressorNode", "Multiband Compressor"), processor(proc) {
+        // initialize default properties
+        auto& s = getMutableNodeState();
+        if (!s.hasProperty("MbCompBands"))
+            s.setProperty("MbCompBands", 3, nullptr);
+        if (!s.hasProperty("MbCompAttack"))
+            s.setProperty("MbCompAttack", 10.0f, nullptr);
+        if (!s.hasProperty("MbCompRelease"))
+            s.setProperty("MbCompRelease", 100.0f, nullptr);
+        for (int i = 0; i < 3; ++i)
+            if (!s.hasProperty(crossoverId(i)))
+                s.setProperty(crossoverId(i), defaultCrossovers[(size_t)i], nullptr);
+        for (int i = 0; i < 4; ++i) {
+            if (!s.hasProperty(thresholdId(i)))
+                s.setProperty(thresholdId(i), 0.0f, nullptr);
+            if (!s.hasProperty(ratioId(i)))
+                s.setProperty(ratioId(i), 3.0f, nullptr);
+        }
+
+        //add this node to processor state tree
+        processor.addNodeState(getMutableNodeState());
+
+        //Preparing the compressor
+        compressorDSP.prepare(proc.getSampleRate());
+    }
+
+    // dsp processing step for the multiband compressor
+    void process(AudioPluginAudioProcessor& proc, juce::AudioBuffer<float>& buffer) override;
+
+    // return UI panel linked to node
+    std::unique_ptr<juce::Component> createPanel(AudioPluginAudioProcessor& proc) override {
+        return std::make_unique<MultibandCompressorPanel>(proc, getMutableNodeState(), effectName);
+    }
+
+    // return visualizer
+    std::unique_ptr<juce::Component> createVisualizer(AudioPluginAudioProcessor& proc) override {
+        return std::make_unique<MultibandCompressorVisualizer>(proc, *this);
+    }
+
+    //Allows visualizer to get the shared value
+    std::atomic<float>& getOutputLevelAtomic(){
+        return compressorDSP.currentOutputLevelDb;
+    }
+
+    //Property names for the per band and per crossover values. Index starts at 0 but the names start at 1
+    static const juce::Identifier& crossoverId(int index);
+    static const juce::Identifier& thresholdId(int band);
+    static const juce::Identifier& ratioId(int band);
+
+    static constexpr std::array<float, 3> defaultCrossovers { 200.0f, 1000.0f, 5000.0f };
+
+    ////////////////////////////////////////////////////////////  reyna
+
+    // clone node
+    std::shared_ptr<EffectNode> clone() const override {
+        auto copiedTree = getNodeState().createCopy();                    // Copy ValueTree state
+        copiedTree.setProperty("uuid", juce::Uuid().toString(), nullptr); // new uuid for clone
+
+        auto* self = const_cast<MultibandCompressorNode*>(this);                                 // to access processor ref
+        auto clonePtr = std::make_shared<MultibandCompressorNode>(self->processor);              // create new node
+        clonePtr->getMutableNodeState().copyPropertiesAndChildrenFrom(copiedTree, nullptr);      // copy state
+
+        // Keep clone in processor state tree
+        self->processor.apvts.state.addChild(clonePtr->getMutableNodeState(), -1, nullptr);
+        clonePtr->setDisplayName(effectName); // name will be made unique in daisychain
+        return clonePtr;
+    }
+
+    // XML serialization for saving/loading
+    std::unique_ptr<juce::XmlElement> toXml() const override;
+    void loadFromXml(const juce::XmlElement& xml) override;
+
+private:
+	//nodes own dsp processor + reference to main processor for param access
+    AudioPluginAudioProcessor& processor;
+    MultibandCompressorProcessor compressorDSP;
+};
@@ -26,10 +26,10 @@ private:
     AudioPluginAudioProcessor& processor;
 
     // Sliders for noise gate
-    juce::Slider thresholdSlider, attackSlider, releaseSlider;
+    juce::Slider thresholdSlider, attackSlider, releaseSlider, lookaheadSlider;
 
     // Labels
-    juce::Label noiseGateLabel, thresholdLabel, attackLabel, releaseLabel;
+    juce::Label noiseGateLabel, thresholdLabel, attackLabel, releaseLabel, lookaheadLabel;
 
     juce::ValueTree localState;
 
@@ -44,7 +44,7 @@ class NoiseGateNode;
 class NoiseGateVisualizer : public RealTimeGraphVisualizer, public juce::ValueTree::Listener{
 public:
     explicit NoiseGateVisualizer(AudioPluginAudioProcessor& proc, NoiseGateNode& node, juce::ValueTree& state)
-        : RealTimeGraphVisualizer(proc.apvts, "dB", {-100.0f, 0.0f}, false, 6),
+        : RealTimeGraphVisualizer("dB", {-100.0f, 0.0f}, false, 6),
           processor(proc),
           noiseGateNode(node),
           localState(state)
@@ -60,7 +60,7 @@ public:
     ~NoiseGateVisualizer() override;
 
     // Update the graph by polling the node
-    void timerCallback() override ;
+    void frameCallback() override ;
 
     // Update threshold line if property changes
     void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
@@ -84,12 +84,7 @@ class NoiseGateNode : public EffectNode {
 public:
 	//create node with name n reference to main processor
     explicit NoiseGateNode(AudioPluginAudioProcessor& proc) : EffectNode(proc, "NoiseGateNode", "Noise Gate"), processor(proc) {
-        
-        if (!processor.apvts.state.hasType("EffectNodes")) {    
-			processor.apvts.state = juce::ValueTree("EffectNodes"); // ensure EffectNodes tree exists - reyna
-        }
 
-		auto& state = getMutableNodeState();    // get mutable state - reyna
         // initialize default properties
         if (!getMutableNodeState().hasProperty("GateThreshold"))
             getMutableNodeState().setProperty("GateThreshold", -100.0f, nullptr);
@@ -97,13 +92,10 @@ public:
             getMutableNodeState().setProperty("GateAttack", 25.0f, nullptr);
         if (!getMutableNodeState().hasProperty("GateRelease"))
             getMutableNodeState().setProperty("GateRelease", 100.0f, nullptr);
-        // ensure EffectNodes tree exists
-        if (!processor.apvts.state.hasType("EffectNodes"))
-            processor.apvts.state = juce::ValueTree("EffectNodes");
-        // add this node to processor state tree
-        processor.apvts.state.addChild(getMutableNodeState(), -1, nullptr);
-
-        processor.apvts.state.addChild(state, -1, nullptr); // add to processor state tree
+        if (!getMutableNodeState().hasProperty("GateLookahead"))
+            getMutableNodeState().setProperty("GateLookahead", 0.0f, nullptr);
+        // add this node to processor state tree - reyna
+        processor.addNodeState(getMutableNodeState());
 
         //Preparing the gate
         gateDSP.prepare(proc.getSampleRate());
@@ -117,10 +109,12 @@ public:
         const float threshold = (float)getNodeState().getProperty("GateThreshold", -100.0f);
         const float attack = (float)getNodeState().getProperty("GateAttack", 25.0f);
         const float release = (float)getNodeState().getProperty("GateRelease", 100.0f);
+        const float lookahead = (float)getNodeState().getProperty("GateLookahead", 0.0f);
 
         gateDSP.setThreshold(threshold);
         gateDSP.setAttack(attack);
         gateDSP.setRelease(release);
+        gateDSP.setLookahead(lookahead);
         gateDSP.process(buffer);
 
         //Calculate output level for visualizer
@@ -143,6 +137,11 @@ public:
         return gateDSP.currentOutputLevelDb;
     }
 
+    //Lookahead delay, so the host can line everything back up
+    int getLatencySamples() const override {
+        return gateDSP.getLatencySamples();
+    }
+
     ////////////////////////////////////////////////////////////  reyna
 
     // clone node
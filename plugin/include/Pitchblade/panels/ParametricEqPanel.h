@@ -0,0 +1,114 @@
+#pragma once
+// Author: huda
+#include <JuceHeader.h>
+#include <array>
+#include "Pitchblade/PluginProcessor.h"
+#include "Pitchblade/panels/EffectNode.h"
+#include "Pitchblade/effects/ParametricEq.h"
+
+// ===================== Panel (UI) =====================
+// 16 bands won't fit as rows of knobs, so one band is edited at a time and picked from the band selector
+class ParametricEqPanel : public juce::Component, public juce::ValueTree::Listener
+{
+public:
+    ParametricEqPanel(AudioPluginAudioProcessor& p, juce::ValueTree& state, const juce::String& nodeTitle);
+    ~ParametricEqPanel() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    juce::String panelTitle;
+
+private:
+    AudioPluginAudioProcessor& processor;
+    juce::ValueTree localState;  // valuetree for node parameters
+
+    int selectedBand = 0;
+
+    juce::ComboBox bandsBox, bandSelector, typeBox;
+    juce::ToggleButton enabledButton { "On" };
+    juce::Slider freqSlider, gainSlider, qSlider;
+    juce::Label titleLabel, bandsLabel, bandLabel, typeLabel, freqLabel, gainLabel, qLabel;
+
+    // Shows the selected band's values on the controls
+    void loadSelectedBand();
+    // Grey out the gain knob for band types that don't have one
+    void updateGainEnabled();
+
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParametricEqPanel)
+};
+
+class ParametricEqNode : public EffectNode
+{
+public:
+    // create node with default state and register under EffectNodes
+    explicit ParametricEqNode(AudioPluginAudioProcessor& proc)
+        : EffectNode(proc, "ParametricEqNode", "Parametric EQ")
+    {
+        auto& st = getMutableNodeState();
+        if (!st.hasProperty(bandsId()))
+            st.setProperty(bandsId(), 8, nullptr);
+        for (int b = 0; b < ParametricEq::maxBands; ++b)
+        {
+            if (!st.hasProperty(typeId(b)))    st.setProperty(typeId(b), (int)ParametricEq::BandType::bell, nullptr);
+            if (!st.hasProperty(freqId(b)))    st.setProperty(freqId(b), ParametricEq::defaultFrequency(b), nullptr);
+            if (!st.hasProperty(gainId(b)))    st.setProperty(gainId(b), 0.0f, nullptr);
+            if (!st.hasProperty(qId(b)))       st.setProperty(qId(b), 1.0f, nullptr);
+            if (!st.hasProperty(enabledId(b))) st.setProperty(enabledId(b), true, nullptr);
+        }
+
+        // attach this tree to EffectNodes as a new child
+        processor.addNodeState(st);
+
+        // 80 values is a lot to read from the ValueTree every block, so the DSP is only told when one changes
+        pushAllToDsp();
+        eqDSP.prepare(proc.getSampleRate(), proc.getBlockSize(), std::max(2, proc.getTotalNumOutputChannels()));
+    }
+
+    void process(AudioPluginAudioProcessor& proc, juce::AudioBuffer<float>& buffer) override
+    {
+        juce::ignoreUnused(proc);
+        eqDSP.processBlock(buffer);
+    }
+
+    std::unique_ptr<juce::Component> createPanel(AudioPluginAudioProcessor& proc) override
+    {
+        return std::make_unique<ParametricEqPanel>(proc, getMutableNodeState(), effectName);
+    }
+
+    // Property names. Index starts at 0 but the names start at 1
+    static const juce::Identifier& bandsId();
+    static const juce::Identifier& typeId(int band);
+    static const juce::Identifier& freqId(int band);
+    static const juce::Identifier& gainId(int band);
+    static const juce::Identifier& qId(int band);
+    static const juce::Identifier& enabledId(int band);
+
+    //reynas daisychain and presets stuff /////////////////////////////////////////
+
+    std::shared_ptr<EffectNode> clone() const override
+    {
+        auto copiedTree = getNodeState().createCopy();
+        copiedTree.setProperty("uuid", juce::Uuid().toString(), nullptr);
+
+        auto* self = const_cast<ParametricEqNode*>(this);
+        auto clonePtr = std::make_shared<ParametricEqNode>(self->processor);
+        clonePtr->getMutableNodeState().copyPropertiesAndChildrenFrom(copiedTree, nullptr);
+
+        self->processor.apvts.state.addChild(clonePtr->getMutableNodeState(), -1, nullptr);
+        clonePtr->setDisplayName(effectName);
+        clonePtr->bypassed = bypassed;
+        return clonePtr;
+    }
+
+    std::unique_ptr<juce::XmlElement> toXml() const override;
+    void loadFromXml(const juce::XmlElement& xml) override;
+
+private:
+    ParametricEq eqDSP;
+
+    void pushAllToDsp();
+    // Called on the message thread whenever the panel, a preset or a clone changes a value
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+};
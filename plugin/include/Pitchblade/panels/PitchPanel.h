@@ -12,7 +12,7 @@ class PitchPanel : public juce::Component,
                    public juce::ValueTree::Listener
 {
 public:
-    explicit PitchPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state);
+    PitchPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state, PitchCorrector& corrector);
 
     void resized() override;
     void paint(juce::Graphics& g) override;
@@ -43,6 +43,7 @@ private:
     juce::ValueTree localState;
 
     AudioPluginAudioProcessor& processor;
+    PitchCorrector& pitchCorrector;   // the node's own corrector
 
     juce::Label pitchName;
     
@@ -60,39 +61,19 @@ class PitchNode;
 class PitchVisualizer : public RealTimeGraphVisualizer, public juce::ValueTree::Listener{
 public:
     explicit PitchVisualizer(AudioPluginAudioProcessor& proc, PitchNode& node, juce::ValueTree& state)
-        : RealTimeGraphVisualizer(proc.apvts, "note", {55.f, 3520.f}, true, 7),
+        : RealTimeGraphVisualizer("note", {55.f, 3520.f}, true, 7),
             processor(proc),
             pitchNode(node),
             localState(state)
     {
         //Listen for changes
         localState.addListener(this);
-
-        int initialIndex = *proc.apvts.getRawParameterValue("GLOBAL_FRAMERATE");
-
-        switch(initialIndex){
-            case 0:
-                startTimerHz(5);
-                break;
-            case 1:
-                startTimerHz(15);
-                break;
-            case 2:
-                startTimerHz(30);
-                break;
-            case 3:
-                startTimerHz(60);
-                break;
-            default:
-                startTimerHz(30);
-                break;
-        }
     }
 
     ~PitchVisualizer() override;
 
     //Update the graph
-    void timerCallback() override;
+    void frameCallback() override;
 
     void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
 private:
@@ -127,10 +108,7 @@ public:
         if (!getMutableNodeState().hasProperty("PitchType"))
             getMutableNodeState().setProperty("PitchType", 0, nullptr);
 
-        if (!processor.apvts.state.hasType("EffectNodes"))
-            processor.apvts.state = juce::ValueTree("EffectNodes");
-
-        processor.apvts.state.addChild(getMutableNodeState(), -1, nullptr);
+        processor.addNodeState(getMutableNodeState());
         pitchDSP.prepare(proc.getSampleRate(), proc.getBlockSize());
 
     }
@@ -155,15 +133,15 @@ public:
         pitchDSP.setScaleType(type);
 
         //pull current note
-        proc.getPitchCorrector().processBlock(buffer);   
-        float pitchHz = proc.getPitchCorrector().getCurrentPitch();
+        pitchDSP.processBlock(buffer);   
+        float pitchHz = pitchDSP.getCurrentPitch();
         pitchDSP.currentOutputPitch.store(pitchHz);
         DBG(pitchHz);
     }
 
     std::unique_ptr<juce::Component> createPanel(AudioPluginAudioProcessor& proc) override
     {
-        return std::make_unique<PitchPanel>(proc, getMutableNodeState());
+        return std::make_unique<PitchPanel>(proc, getMutableNodeState(), pitchDSP);
     }
 
     std::unique_ptr<juce::Component> createVisualizer(AudioPluginAudioProcessor& proc) override {
@@ -11,6 +11,15 @@
     The PresetsPanel does not modify DSP directly. It only triggers preset
     save or load actions and tells the PluginEditor to rebuild the UI after
     preset changes
+
+    Below the buttons is a searchable list of the preset library (see
+    PresetLibrary). Typing filters by name, tag or effect, the drop down
+    limits the list to presets using one effect, and double clicking a
+    preset loads it
+
+    The A/B row keeps a second chain (B) loaded next to the current one.
+    B can be a preset or a copy of the chain as it is now, and the slider
+    morphs between the two
 */
 
 
@@ -18,18 +27,22 @@
 #include <JuceHeader.h>
 #include "Pitchblade/ui/ColorPalette.h"
 #include "Pitchblade/PluginProcessor.h"
+#include "Pitchblade/PresetLibrary.h"
 
 //panel that shows preset management
 // load presets, save presets, default presets
 
-class PresetsPanel : public juce::Component {
+class PresetsPanel : public juce::Component, private juce::ListBoxModel, private juce::ChangeListener {
 public:
     explicit PresetsPanel(AudioPluginAudioProcessor& proc);
-    ~PresetsPanel() override = default;
+    ~PresetsPanel() override;
 
     void paint(juce::Graphics& g) override;
     void resized() override;
 
+    // presets shown for the current search and filter
+    int getNumShownPresets() const { return (int)shown.size(); }
+
     std::function<void()> onPresetActionFinished; // callback after preset action
 
 private:
@@ -40,12 +53,38 @@ private:
     juce::TextButton defaultButton{ "Use Default Preset" };
     juce::Label statusLabel;    // for switching presets, mesg to let u know if it worked
 
+    // A/B morph
+    juce::TextButton loadBButton{ "Load B" };
+    juce::TextButton captureBButton{ "Current as B" };
+    juce::TextButton clearBButton{ "Clear B" };
+    juce::Slider morphSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> morphAttachment;
+    juce::Rectangle<int> morphArea;     // slider row, A and B are drawn at its ends
+
 	// file chooser for loading/saving presets
     std::unique_ptr<juce::FileChooser> chooser;
 
+    // preset library, shared with every other instance
+    juce::SharedResourcePointer<PresetLibrary> library;
+    juce::TextEditor searchBox;
+    juce::ComboBox typeFilter;      // id 1 is every effect, then one per node type
+    std::vector<PresetLibrary::Entry> shown;
+    juce::ListBox presetList{ "Presets", this };
+
     void handleSavePreset();
     void handleLoadPreset();
     void handleDefaultPreset();
+    void loadPreset(const juce::File& file);
+    void handleLoadMorphTarget();
+
+    // library list
+    void refreshList();
+    void refreshTypeFilter();
+    int getNumRows() override;
+    void paintListBoxItem(int row, juce::Graphics& g, int width, int height, bool rowIsSelected) override;
+    void listBoxItemDoubleClicked(int row, const juce::MouseEvent&) override;
+    void returnKeyPressed(int lastRowSelected) override;
+    void changeListenerCallback(juce::ChangeBroadcaster*) override;
 
     void showDefaultMenu();
 
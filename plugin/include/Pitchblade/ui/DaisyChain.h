@@ -15,6 +15,7 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include <tuple>
 #include "Pitchblade/ui/DaisyChainItem.h"
 #include "Pitchblade/panels/EffectNode.h"
 
@@ -59,6 +60,7 @@ public:
     void showAddMenu();
     void showDuplicateMenu();
     void showDeleteMenu();
+    void showMeterMenu(const juce::String& effectName, juce::Component* target);   // right click on an effect
 
 	// for single formant/pitch effects only
     bool hasFormant() const;
@@ -94,8 +96,26 @@ public:
     std::vector<std::shared_ptr<EffectNode>>& effectNodes;                      // refern to processor's chain
 
 private:
+	// viewport that tells the chain when it scrolls so rows coming into view get added
+    struct ChainViewport : public juce::Viewport {
+        std::function<void()> onVisibleAreaChanged;
+        void visibleAreaChanged(const juce::Rectangle<int>&) override { if (onVisibleAreaChanged) onVisibleAreaChanged(); }
+    };
+
+	// long chains only keep the rows in view (plus one each side) inside the scroll area
+	// every row still has its item in items, the rest are just not in the component tree
+    void updateRowTops();                   // row positions from row heights
+    void updateVisibleRows();               // add rows in view, take out rows that aren't
+    int rowAtY(int y) const;                // row under a y in the list
+
+	// effect name -> row index, so drops don't search every row
+    void updateRowIndex();
+    std::tuple<int, bool, bool> findIndexedRow(const juce::String& name) const;    // rowIndex, isRightCell, found
+
 	std::vector<Row> rows;              // current layout model
-	juce::Viewport scrollArea;          // scroll area for daisy chain
+	std::vector<int> rowTops;           // top of each row in the list, last entry is the list height
+	juce::HashMap<juce::String, int> rowIndex;  // where each effect is in rows
+	ChainViewport scrollArea;           // scroll area for daisy chain
 	juce::Component effectsContainer;   // container for effect items
 	bool globalBypassed = false;        // global bypass state
 
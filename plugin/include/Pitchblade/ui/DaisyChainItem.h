@@ -21,6 +21,24 @@
 
 class DaisyChain;
 
+// effect name button that keeps right clicks for the row's meter menu, so they don't open the effect - Austin
+class EffectNameButton : public juce::TextButton {
+public:
+    std::function<void()> onRightClick;
+
+    void mouseDown(const juce::MouseEvent& e) override {
+        if (e.mods.isPopupMenu()) {
+            if (onRightClick) onRightClick();
+            return;
+        }
+        juce::TextButton::mouseDown(e);
+    }
+    void mouseUp(const juce::MouseEvent& e) override {
+        if (e.mods.isPopupMenu()) return;
+        juce::TextButton::mouseUp(e);
+    }
+};
+
 //merges effect buttons and bypass buttons into one row item for daisychain drag n drop
 class DaisyChainItem : public juce::Component, public juce::DragAndDropTarget {
 public:
@@ -46,6 +64,10 @@ public:
 		button.setButtonText(effectName);
 		addAndMakeVisible(button);
 
+        // right click either effect for its loudness meter menu - Austin
+        button.onRightClick = [this] { if (onMeterMenu) onMeterMenu(getName(), &button); };
+        rightButton.onRightClick = [this] { if (onMeterMenu) onMeterMenu(rightEffectName, &rightButton); };
+
 		// make buttons transparent
         button.setOpaque(false);
         rightButton.setOpaque(false);
@@ -379,21 +401,23 @@ public:
 
 	// getters
     int getIndex() const { return myIndex; }
+    void setIndex(int index) { myIndex = index; }      // when a kept row moves
     std::function<void(int, bool)> onBypassChanged;     //row index, bypass
 	std::function<void(int, int)> onModeChanged;        //row index, mode id
     std::function<void(int, bool)> onSecondaryBypassChanged;
+    std::function<void(const juce::String&, juce::Component*)> onMeterMenu;   // effect name, button to show the menu on
 
 	juce::String rightEffectName;   // name of right effect if double
 
 	// left cell widgets / single row widgets
     juce::Label      grip;
-    juce::TextButton button;
+    EffectNameButton button;
     juce::TextButton modeButton;
     juce::TextButton bypass;
 
 
     // right cell widgets (only shown when double)
-    juce::TextButton rightButton;
+    EffectNameButton rightButton;
     juce::TextButton rightMode;
     juce::TextButton rightBypass;
     juce::Label rightGrip;
@@ -10,6 +10,7 @@
 #include <JuceHeader.h>
 #include "Pitchblade/PluginProcessor.h"
 #include "Pitchblade/panels/EffectNode.h"
+#include "Pitchblade/ui/NodeTabs.h"
 
 //tabs for each effect
 class EffectPanel : public juce::Component {
@@ -20,13 +21,15 @@ public:
     void showEffect(int index);
     void paint(juce::Graphics&) override;
 
-	//refresh tabs when effects are added/removed
+	//refresh tabs when effects are added/removed. panels are only created once shown
     void refreshTabs();
 
 private:
     AudioPluginAudioProcessor& processor;
     // tabbed component for effect panels
     juce::TabbedComponent tabs{ juce::TabbedButtonBar::TabsAtTop };
+    // owns the panels, makes each when first shown, after tabs so it goes first
+    NodeTabs nodeTabs{ tabs, juce::Colours::transparentBlack };
 	// reference to global effect nodes
     std::vector<std::shared_ptr<EffectNode>> effectNodes;
 };
\ No newline at end of file
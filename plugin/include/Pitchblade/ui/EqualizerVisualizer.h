@@ -4,11 +4,13 @@
 #include <JuceHeader.h>
 #include "Pitchblade/PluginProcessor.h"
 #include "Pitchblade/ui/FrequencyGraphVisualizer.h"
+#include "Pitchblade/ui/FrameClock.h"
 
 // Renders the static EQ frequency response curve for the current Equalizer settings
-class EqualizerVisualizer : public juce::Component, private juce::Timer {
+class EqualizerVisualizer : public juce::Component, private FrameClockClient {
 public:
-    explicit EqualizerVisualizer(AudioPluginAudioProcessor& proc);
+    // draws a node's own Equalizer
+    EqualizerVisualizer(AudioPluginAudioProcessor& proc, Equalizer& eq);
     ~EqualizerVisualizer() override;
 
     void resized() override;
@@ -19,14 +21,31 @@ public:
     std::vector<juce::Point<float>> getLastResponsePoints() const;
 
 private:
-    void timerCallback() override;
+    void frameCallback() override;
     void updateResponseCurve();
 
     AudioPluginAudioProcessor& processor;
+    Equalizer& equalizer;
     std::unique_ptr<FrequencyGraphVisualizer> graph; // draws frequency vs dB
     std::vector<juce::Point<float>> lastResponse;
     mutable juce::CriticalSection responseLock;
 
+    // The frequency grid only changes on resize or a new sample rate, so it is worked out once then.
+    // phi is sin^2(w/2) at each point, all the per point trig the magnitude maths needs
+    std::vector<float> gridFrequencies;
+    std::vector<float> gridPhi;
+    std::vector<float> magnitudeSquared;
+    double gridSampleRate = 0.0;
+
+    // The curve is only redone when the EQ's parameter version moves
+    uint32_t drawnVersion = 0;
+    bool responseValid = false;
+
+    // The graph eases towards new data a bit each time it's pushed, so after a change the same curve is
+    // pushed for a few more ticks until it lands, then the frames do nothing
+    int settleTicksLeft = 0;
+    static constexpr int settleTicks = 15;
+
     // Overlay to replace the y-axis labels with [-24, +24] dB
     class YAxisLabelOverlay : public juce::Component {
     public:
@@ -34,6 +53,6 @@ private:
     };
     std::unique_ptr<YAxisLabelOverlay> yLabels;
 
-    // Helper to build log-spaced frequency array between 20 Hz and 20 kHz
-    static void buildLogFrequencies(std::vector<float>& freqs, int numPoints);
+    // Rebuilds the log-spaced grid between 20 Hz and 20 kHz, one point per pixel of width
+    void buildGrid(double sampleRate);
 };
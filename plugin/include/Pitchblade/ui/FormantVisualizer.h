@@ -5,13 +5,13 @@
 #include "Pitchblade/PluginProcessor.h"
 #include "Pitchblade/ui/ColorPalette.h"
 #include "Pitchblade/ui/FrequencyGraphVisualizer.h"
+#include "Pitchblade/ui/FrameClock.h"
 
 //Author: huda
 // Visualizes detected formant frequencies as vertical markers over a log-frequency axis.
 // Pulls latest formants from the processor and repaints at the global framerate.
 class FormantVisualizer : public juce::Component,
-                          private juce::Timer,
-                          private juce::AudioProcessorValueTreeState::Listener
+                          private FrameClockClient
 {
 public:
     FormantVisualizer(AudioPluginAudioProcessor& processorRef,
@@ -22,11 +22,8 @@ public:
     void resized() override;
 
 private:
-    // Timer to drive UI refreshes based on GLOBAL_FRAMERATE
-    void timerCallback() override;
-
-    // Listen to GLOBAL_FRAMERATE changes
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    // Called by the editor's frame clock at the global framerate while on screen
+    void frameCallback() override;
 
     // Data/Config
     AudioPluginAudioProcessor& processor;
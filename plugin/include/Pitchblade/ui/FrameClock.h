@@ -0,0 +1,95 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+
+class FrameClockClient;
+
+//One clock for every visualizer and meter in an editor, instead of a juce::Timer each
+//It runs off the display's vertical blank, so frames line up with the screen, and ticks every client that is due in the same callback.
+//Their repaints all land before the next paint, so the editor draws once per frame however many things are moving
+//Clients are only ticked while they are on screen, and nothing is ticked at all while the editor is hidden or minimised
+//It also owns the GLOBAL_FRAMERATE listener, so clients following the setting don't each need one
+class FrameClock : private juce::AudioProcessorValueTreeState::Listener{
+public:
+    //Anything that owns a clock (the editor). Clients find their clock by looking up the component tree for one of these
+    class Host{
+    public:
+        virtual ~Host() = default;
+        virtual FrameClock& getFrameClock() = 0;
+    };
+
+    FrameClock(juce::Component& editorToWatch, juce::AudioProcessorValueTreeState& vts);
+    ~FrameClock() override;
+
+    //Rate from the framerate setting, in hz
+    int getFrameRateHz() const { return frameRateHz; }
+
+    //Turns a GLOBAL_FRAMERATE choice into hz
+    static int rateForSetting(int settingIndex);
+
+private:
+    friend class FrameClockClient;
+    void addClient(FrameClockClient& client);
+    void removeClient(FrameClockClient& client);
+
+    //Called every vertical blank with the time in seconds
+    void onVBlank(double timestampSec);
+
+    //Tells every client it's off screen, for when the editor goes away
+    void pauseAll();
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    juce::Component& editor;
+    juce::AudioProcessorValueTreeState& apvts;
+    juce::ListenerList<FrameClockClient> clients;
+    int frameRateHz = 30;
+    bool paused = false;
+
+    //Declared last so it's gone before anything it calls
+    juce::VBlankAttachment vBlank;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameClock)
+};
+
+//Base for anything that used to run its own timer to refresh. Give it the component it draws in, and override frameCallback
+//It attaches itself to the nearest FrameClock above that component whenever the component is added to or moved in the tree
+class FrameClockClient : private juce::ComponentListener{
+public:
+    //A fixed rate in hz, or 0 to follow the framerate setting
+    explicit FrameClockClient(juce::Component& componentToWatch, int fixedRateHz = 0);
+    ~FrameClockClient() override;
+
+    //Called once per frame at the client's rate, only while the component is showing
+    virtual void frameCallback() = 0;
+
+    //Called when the component goes off or comes back on screen, so anything that only runs while visible can stop and start
+    virtual void frameVisibilityChanged(bool isNowShowing){ juce::ignoreUnused(isNowShowing); }
+
+    //Time between this client's frames in milliseconds
+    int getFrameIntervalMs() const;
+
+    void setFixedFrameRate(int newRateHz){ fixedRateHz = newRateHz; }
+
+private:
+    friend class FrameClock;
+
+    int getRateHz() const;
+
+    //Called by the clock every vertical blank
+    void clockTick(double timestampSec);
+    void clockPaused();
+
+    void componentParentHierarchyChanged(juce::Component& component) override;
+    void attachToNearestClock();
+
+    juce::Component& owner;
+    FrameClock* clock = nullptr;
+    int fixedRateHz = 0;
+
+    double nextFrameSec = 0.0;
+    bool wasShowing = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameClockClient)
+};
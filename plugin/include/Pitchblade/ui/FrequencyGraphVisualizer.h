@@ -3,38 +3,80 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <vector>
 #include "Pitchblade/ui/ColorPalette.h"
+#include "Pitchblade/ui/FrameClock.h"
 
 //This visualizer displays amplitude over frequency
-class FrequencyGraphVisualizer : public juce::Component, public juce::Timer, public juce::AudioProcessorValueTreeState::Listener{
+//The grid and labels only change with the size, so they are drawn once into an image. Spectrum points are sorted into pixel columns
+//when they arrive (using a point to column map that is only rebuilt when the frequencies or the size change), so paint draws at most
+//one vertex per pixel however many FFT bins there are
+class FrequencyGraphVisualizer : public juce::Component, public FrameClockClient{
 private:
     //Draws y axis labels, x axis labels, grid, and borders
     void drawLabels(juce::Graphics& g);
 
-    //Builds a path from spectrumData and draws it
-    void drawSpectrum(juce::Graphics& g);
-
-    //Builds a path from secondarySpectrumData and draws it
-    void drawSecondarySpectrum(juce::Graphics& g);
-
     //Draws horizontal and vertical threshold lines
     void drawThresholdLines(juce::Graphics& g);
 
     //Data stuff
-    //Since x axis matters more now, I decided to use points. Each point is (frequency, amplitude)
-    std::vector<juce::Point<float>> spectrumData;
-    std::vector<juce::Point<float>> secondarySpectrumData;
+    //One pixel column of a spectrum. x is where the loudest point in the column sits. The quietest is kept too, so columns where
+    //lots of bins land can show their spread
+    struct Column{
+        float x;
+        float minDb;
+        float maxDb;
+        int count;
+    };
+
+    //Everything for one spectrum line
+    struct Trace{
+        //Points as they are shown, (frequency, amplitude), after the envelope. Only the updating side touches this
+        std::vector<juce::Point<float>> smoothed;
+
+        //Pixel column (from the graph's left edge) and x for each point. Column is -1 when the point is outside the frequency range
+        std::vector<int> pointColumn;
+        std::vector<float> pointX;
+
+        //Frequencies and layout the map was made for
+        std::vector<float> mappedFrequencies;
+        int mappedLayout = -1;
+
+        //Filled outside the lock, then swapped with columns
+        std::vector<Column> building;
+
+        //What paint draws. Guarded by dataMutex
+        std::vector<Column> columns;
+    };
 
-    //Data storage for smoothed values (graph was jumping too much and it was annoying to look at)
-    std::vector<juce::Point<float>> displayedSpectrumData;
-    std::vector<juce::Point<float>> displayedSecondarySpectrumData;
+    Trace primary;
+    Trace secondary;
+
+    //Eases the trace towards newData (graph was jumping too much and it was annoying to look at), then bins it into columns
+    void smoothAndBin(Trace& trace, const std::vector<juce::Point<float>>& newData);
+
+    //Sorts trace.smoothed into pixel columns and hands them to paint
+    void binColumns(Trace& trace);
+
+    //Draws a trace's columns. The main spectrum gets the gradient fill and the spread of busy columns, the secondary is just a line
+    void drawTrace(juce::Graphics& g, const std::vector<Column>& columns, juce::Colour lineColour, bool isPrimary);
 
     //Envelope time in milliseconds for the data lag to make the graph look smoother
     const float accelerationTimeMs = 50;
 
-    //Mutex to protect data vectors
+    //Mutex for handing finished columns to paint. Smoothing and binning happen before it is taken, so it's only held for a swap
     juce::CriticalSection dataMutex;
 
+    //Goes up on every resize, so the traces know their column maps are out of date
+    int layoutVersion = 0;
+
+    //Set when there are new columns or thresholds, so frames where nothing changed don't repaint
+    bool needsRepaint = true;
+
+    //Cached grid, labels and border, at a whole number of physical pixels per logical one
+    juce::Image gridImage;
+    int gridImageScale = 1;
+
     //Display mode. 0 means no special things. 1 means horizontal and vertical threshold lines. 2 means secondary spectrum
     int displayMode = 0;
 
@@ -72,28 +114,23 @@ private:
     //Frequencies to draw grid lines at
     const std::vector<float> freqGridLines = {20, 30, 40, 50, 60, 70, 80, 90, 100, 200, 300, 400, 500, 600, 700, 800, 900, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000, 20000};
 
-    //Value tree state
-    juce::AudioProcessorValueTreeState& apvts;
 public:
     //Constructor
-    FrequencyGraphVisualizer(juce::AudioProcessorValueTreeState& vts, int numYLabels = 5, int dispMode = 0);
+    FrequencyGraphVisualizer(int numYLabels = 5, int dispMode = 0);
 
     ~FrequencyGraphVisualizer() override;
 
     void paint(juce::Graphics& g) override;
     void resized() override;
 
-    //Called at framerate interval, triggers repaint()
-    void timerCallback() override;
+    //Called at framerate interval while on screen, triggers repaint()
+    void frameCallback() override;
 
     //Public API stuff
-    //Pushes spectrum info to the point vectors
+    //Pushes spectrum info to the graph. Called from the message thread (the panels' timers)
     void updateSpectrumData(const std::vector<juce::Point<float>>& newData);
     void updateSecondarySpectrumData(const std::vector<juce::Point<float>>& newData);
 
     //Set threshold lines
     void setThreshold(float frequency, float amplitude);
-
-    //Update FPS
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include "Pitchblade/ui/ColorPalette.h"
+#include "Pitchblade/ui/FrameClock.h"
 
 // Each direction refers to how the value increases. So for Up, max value is at the top.
 enum RotationMode{
@@ -30,8 +31,8 @@ private:
     Colour color{};
 };
 
-// A collection of levels
-class LevelMeter : public juce::Component, public juce::Timer{
+// A collection of levels. Refreshes at the framerate setting
+class LevelMeter : public juce::Component, public FrameClockClient{
 public:
     // Initialize level meter with a link to a function that returns a float
     LevelMeter(std::function<float()>&& valueFunction, float, float, RotationMode);
@@ -40,7 +41,7 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
 
-    void timerCallback() override;
+    void frameCallback() override;
 private:
 	std::function<float()> valueSupplier;	
     std::vector<std::unique_ptr<Level>> levels;
@@ -0,0 +1,40 @@
+// Written by Austin Hills
+
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+#include "Pitchblade/panels/EffectNode.h"
+#include "Pitchblade/ui/ColorPalette.h"
+#include "Pitchblade/ui/FrameClock.h"
+
+//Wraps a node's visualizer tab and shows a line of loudness readings under it for each meter attached to the node
+//Meters are attached from the right click menu in the daisy chain. With none attached this is just the visualizer
+//The readings are only atomics on the node's meters, so this never touches the audio thread
+class LoudnessReadout : public juce::Component, private FrameClockClient{
+public:
+    LoudnessReadout(std::weak_ptr<EffectNode> nodeToShow, std::unique_ptr<juce::Component> visualizerContent);
+    ~LoudnessReadout() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    //The meters only publish every 100 ms, so there is no point checking faster than 10 hz
+    void frameCallback() override;
+
+    //Draws one line of readings for a meter point
+    void drawReadings(juce::Graphics& g, juce::Rectangle<int> area, const juce::String& label, const LoudnessMeter& meter) const;
+
+    static juce::String formatLufs(float value);
+
+    std::weak_ptr<EffectNode> node;
+    std::unique_ptr<juce::Component> content;
+
+    //Which meters were on at the last layout, so the visualizer is only resized when one is added or removed
+    bool showInput = false;
+    bool showOutput = false;
+
+    static constexpr int LINE_HEIGHT = 18;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoudnessReadout)
+};
@@ -0,0 +1,86 @@
+// reyna
+/*
+    NodeTabs keeps a TabbedComponent's tabs matched to the effect nodes, one tab
+    per node, keyed by the node's uuid.
+
+    When the chain changes it only creates tabs for new nodes and deletes the
+    ones whose node is gone. Tabs for nodes that are still there are moved into
+    their new place, so reordering or adding to a long chain doesn't rebuild
+    every panel and visualizer.
+
+    Each tab is an empty slot until it's first shown, then the slot makes its
+    panel or visualizer. A few hidden ones are kept so switching back is quick,
+    the rest are deleted, and any left hidden for a while are deleted too.
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Pitchblade/panels/EffectNode.h"
+
+class NodeTabs : private juce::Timer {
+public:
+    // makes the tab content for a node
+    using Factory = std::function<std::unique_ptr<juce::Component>(const std::shared_ptr<EffectNode>&)>;
+
+    NodeTabs(juce::TabbedComponent& tabsToManage, juce::Colour tabColour);
+    ~NodeTabs() override;
+
+    // makes the tabs match nodes, in order. The tab that was showing stays showing if its node is still there
+    // create is called later, when a tab is first shown
+    void sync(const std::vector<std::shared_ptr<EffectNode>>& nodes, Factory create);
+
+    // removes every tab and deletes the content
+    void clear();
+
+    // how many tabs have their content made right now
+    int getNumCreated() const;
+
+private:
+    // hidden content kept around, most recently shown first
+    static constexpr int MAX_HIDDEN = 3;
+    // hidden content older than this is deleted
+    static constexpr juce::uint32 HIDDEN_TIMEOUT_MS = 30000;
+
+    // what actually sits in the tab. makes its content when shown
+    class Slot : public juce::Component {
+    public:
+        Slot(NodeTabs& ownerTabs, std::shared_ptr<EffectNode> nodeToShow) : owner(ownerTabs), node(std::move(nodeToShow)) {}
+
+        void visibilityChanged() override;
+        void resized() override { if (content) content->setBounds(getLocalBounds()); }
+
+        void create();
+        void release() { content.reset(); }
+        bool hasContent() const { return content != nullptr; }
+
+        NodeTabs& owner;
+        std::shared_ptr<EffectNode> node;               // held so content never outlives the node it points at
+        std::unique_ptr<juce::Component> content;
+        juce::uint32 hiddenSince = 0;
+    };
+
+    struct Entry {
+        juce::String uuid;
+        std::unique_ptr<Slot> slot;
+    };
+
+    int findTab(const juce::Component* content) const;
+
+    // called by slots as they're shown and hidden
+    void slotShown(Slot& slot);
+    void slotHidden(Slot& slot);
+
+    // deletes hidden content past MAX_HIDDEN or past the timeout
+    void trimHidden();
+    void timerCallback() override { trimHidden(); }
+
+    juce::TabbedComponent& tabs;
+    juce::Colour colour;
+    Factory factory;
+    bool syncing = false;           // tabs shown while moving things around don't make content
+    std::vector<Entry> entries;     // same order as the tabs
+};
@@ -3,35 +3,57 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include <deque>
-//deque essentially has a lot of the same functionality as vectors, but it has better performance when adding or removing elements from the front. It is designed for queue-like behavior
+#include <atomic>
+#include <cstdint>
+#include <vector>
 #include "Pitchblade/ui/ColorPalette.h"
+#include "Pitchblade/ui/FrameClock.h"
 
 
 //This visualizer class is a generic visualizer for any data stream. Its primary functionality is as a first-in, first-out queue, displaying a fixed number of recent data points
-//It uses a timer to gather new data and repaint itself on a regular interval
+//It uses the editor's frame clock to gather new data and repaint itself on a regular interval
 //Its y-axis is customizable, and it has an optional horizontal dotted line, which can be used to display user-defined thresholds.
-class RealTimeGraphVisualizer : public juce::Component, public juce::Timer, public juce::AudioProcessorValueTreeState::Listener{
+//Each data point is one pixel column, so the graph is kept as an image that scrolls: every frame the image moves left by the number
+//of new points and only those new columns are drawn. The labels and background are drawn once per resize. A frame at 60 fps is a couple
+//of image copies and a column or two of drawing, instead of rebuilding and stroking a path through every point
+class RealTimeGraphVisualizer : public juce::Component, public FrameClockClient{
 private:
     //Draws y-axis labels and bounding box for the graph
     void drawLabels(juce::Graphics& g);
 
-    //Draws graph path from the data queue
-    void drawGraph(juce::Graphics& g);
+    //Redraws every visible point into the graph image
+    void redrawGraphImage();
+
+    //Scrolls the graph image and draws only the points pushed since the last frame
+    void updateGraphImage();
+
+    //Draws the line and fill through numPoints points, the first of which is at column firstColumn of the graph image.
+    //The graphics context is expected to be in graph coordinates and clipped to the columns being drawn
+    void drawPoints(juce::Graphics& g, const float* values, int firstColumn, int numPoints);
 
     //Draws the threshold line
     void drawThresholdLine(juce::Graphics& g);
 
-    //Data queue. As described in the include (line 6), this is more efficient for a queue being used for a scrolling graph than a vector would be
-    std::deque<float> dataQueue;
+    //Data ring. One thread pushes and the message thread reads while painting, with no lock. The capacity is a power of two and at
+    //least twice the graph width, so the writer is never close to the part of the ring the reader is copying
+    std::vector<float> ring;
+    std::uint64_t ringMask = 0;
+    std::atomic<std::uint64_t> writeCount {0};
+
+    //Copies the numPoints points pushed just before the end'th point out of the ring, oldest first
+    void readLatest(float* dest, int numPoints, std::uint64_t end) const;
 
-    //A mutex to protect the dataQueue. This prevents race conditions that occur when this reads a value at the same time as the processor pushing this value
-    //Furthermore, apparently JUCE uses two main threads, with one being the audio thread, which handles everything in the processblock,
-    //and a message thread, which handles everything else. The audio thread is initialized by the DAW
-    //I didn't think OS would help me this quickly. Never used threads before that class, and now I need to deal with them the very next semester
-    juce::CriticalSection dataMutex;
+    //Makes sure the ring can hold twice the graph width. Keeps what's in it
+    void ensureRingCapacity(int minimumPoints);
 
-    //Maximum number of data points stored in the queue. This is equal to the pixel width of the graph drawing area
+    //Cached drawing. backgroundImage has the fill, labels and border. graphImage has the line and its fill, and is see-through elsewhere
+    juce::Image backgroundImage;
+    juce::Image graphImage;
+    int imageScale = 1;                 //physical pixels per logical pixel the images were made for
+    std::uint64_t drawnCount = 0;       //how many points had been pushed when the graph image was last brought up to date
+    std::vector<float> scratch;         //points copied out of the ring for drawing
+
+    //Maximum number of data points shown. This is equal to the pixel width of the graph drawing area
     int maxDataPoints = 0;
 
     //Text for y-axis
@@ -63,27 +85,21 @@ private:
 
     //Number of y axis labels to draw
     int numYAxisLabels = 4;
-
-    //Value tree state
-    juce::AudioProcessorValueTreeState& apvts;
 public:
-    //Constructor. Label is the text next to the y-axis. Range is the minimum and maximum values for the y-axis. Update interval is the refresh rate in hz
-    RealTimeGraphVisualizer(juce::AudioProcessorValueTreeState& vts, const juce::String& label, juce::Range<float> range,bool isLog = false, int numOfYAxisLabels = 5);
+    //Constructor. Label is the text next to the y-axis. Range is the minimum and maximum values for the y-axis. It refreshes at the framerate setting
+    RealTimeGraphVisualizer(const juce::String& label, juce::Range<float> range,bool isLog = false, int numOfYAxisLabels = 5);
     ~RealTimeGraphVisualizer() override;
 
     void paint(juce::Graphics& g) override;
     void resized() override;
 
-    //This function is called at the framerate, and it triggers a repaint()
-    void timerCallback() override;
+    //This function is called at the framerate while the graph is on screen, and it triggers a repaint()
+    void frameCallback() override;
 
     //Public API stuff
-    //Pushes a new data point into the queue for the visualizer
+    //Pushes a new data point into the graph. Never locks or allocates. Push from one thread at a time
     void pushData(float newDataPoint);
 
     //Sets a horizontal dotted line at a specific y-value. Can be hidden by setting enabled to false
     void setThreshold(float yValue, bool enabled = true);
-
-    //Update FPS
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
 };
\ No newline at end of file
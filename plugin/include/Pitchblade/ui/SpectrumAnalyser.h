@@ -0,0 +1,48 @@
+//Austin Hills
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "Pitchblade/effects/AnalysisTap.h"
+#include "Pitchblade/effects/StftEngine.h"
+
+//UI side of an AnalysisTap. Pulls the newest samples, runs the FFT, and turns the result into (frequency, dB) points for FrequencyGraphVisualizer
+//This is the work the de-esser and de-noiser used to do on the audio thread. Everything is allocated up front, and it only registers
+//with the tap while the owning visualizer is on screen so the audio thread can skip the tap otherwise
+class SpectrumAnalyser{
+private:
+    AnalysisTap& tap;
+    bool listening = false;
+
+    //FFT stuff. The window is shared with everything else using this size, the FFT is this analyser's own
+    std::shared_ptr<const StftPlan> plan;
+    const int fftSize;
+    juce::dsp::FFT fft;
+    std::vector<float> fftData;
+    //Scales the magnitudes to match a normalised window when asked for one
+    float magnitudeScale = 1.0f;
+
+    //Magnitude of each bin before it's turned into points
+    std::vector<float> magnitudes;
+    std::vector<float> decibels;
+
+    //Write count the last frame was taken at, so the FFT is skipped if no new audio has arrived
+    std::uint64_t lastWriteCount = 0;
+
+public:
+    //normaliseWindow should match the window the processor itself uses, so the two traces line up on the same graph
+    SpectrumAnalyser(AnalysisTap& analysisTap, int fftOrder = 11, bool normaliseWindow = true);
+    ~SpectrumAnalyser();
+
+    //Registers or unregisters with the tap. Call with isShowing() from the visualizer's timer
+    void setListening(bool shouldListen);
+
+    int getNumBins() const { return fftSize / 2 + 1; }
+
+    //Analyses the newest frame from the tap. Returns false if there was nothing new, in which case points is left alone
+    bool process(std::vector<juce::Point<float>>& points);
+
+    //Turns one magnitude per bin into smoothed (frequency, dB) points. Also used for magnitude frames like the noise profile
+    void magnitudesToPoints(const float* binMagnitudes, std::vector<juce::Point<float>>& points);
+};
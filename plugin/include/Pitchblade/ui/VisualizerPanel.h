@@ -3,6 +3,7 @@
 #include <JuceHeader.h>
 #include "Pitchblade/panels/EffectNode.h"
 #include "Pitchblade/PluginProcessor.h"
+#include "Pitchblade/ui/NodeTabs.h"
 
 //panel that shows audio visuals
 class VisualizerPanel : public juce::Component
@@ -25,13 +26,12 @@ public:
 	void clearVisualizer();
     void refreshTabs();
  
-    void clearTabs() {
-        while (tabs.getNumTabs() > 0)
-            tabs.removeTab(0);
-    }
+    void clearTabs() { nodeTabs.clear(); }
+    int getNumCreatedVisualizers() const { return nodeTabs.getNumCreated(); }  // visualizers are made when first shown
 
 private:
 	AudioPluginAudioProcessor& processor;               // reference to main processor so visulaizer can access effect data
 	std::vector<std::shared_ptr<EffectNode>>& effectNodes;          // global effect nodes
     juce::TabbedComponent tabs{ juce::TabbedButtonBar::TabsAtTop };
+    NodeTabs nodeTabs{ tabs, juce::Colours::black };        // owns the visualizers and makes them when shown, after tabs so it goes first
 };
\ No newline at end of file
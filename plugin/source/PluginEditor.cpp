@@ -33,6 +33,7 @@ static std::vector<ProcRow> toProcRows(const std::vector<DaisyChain::Row>& uiRow
 
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor& p): AudioProcessorEditor(&p),processorRef(p), 
+                                                                    frameClock(*this, p.apvts),
                                                                     daisyChain(p, p.getEffectNodes()),
                                                                     effectPanel(p, p.getEffectNodes()), 
                                                                     visualizer(p, p.getEffectNodes()),
@@ -67,12 +68,14 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
         closeOverlaysIfOpen();
         daisyChain.setReorderLocked(false);
         };
-    {
+    bool hasNodes = false;
+    {   // panels take their own snapshot, so only hold the lock for the check
         std::lock_guard<std::recursive_mutex> lock(processorRef.getMutex());
-        if (!processorRef.getEffectNodes().empty()){
-            effectPanel.refreshTabs();
-            visualizer.refreshTabs();
-        }
+        hasNodes = !processorRef.getEffectNodes().empty();
+    }
+    if (hasNodes) {
+        effectPanel.refreshTabs();
+        visualizer.refreshTabs();
     }
 
 	//tooltip manager / reyna ///////////////////////////////////////////
@@ -224,7 +227,6 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
                     editor->closeOverlaysIfOpen();
             }
 
-            visualizer.clearVisualizer();   // safely clear old node references
             // reconnect buttons after reorder
             for (int i = 0; i < daisyChain.items.size(); ++i) {
                 // for single and double rows
@@ -321,12 +323,13 @@ void AudioPluginAudioProcessorEditor::rebuildAndSyncUI() {
         daisyChain.setRows(uiRows);
     }
 
-    std::lock_guard<std::recursive_mutex> lg(processorRef.getMutex());
-    juce::Logger::outputDebugString("Rebuilding DaisyChain + Panels");
+    // no lock held here, each part copies what it needs under the lock and does its ui work after
+    // rows, panels and visualizers are matched to nodes by uuid, so only changed nodes get new components
+    juce::Logger::outputDebugString("Syncing DaisyChain + Panels");
 
     //daisyChain.resetRowsToNodes();    // rows matches current effectNodes for daisychain ui
-    daisyChain.rebuild();             // rebuild rows + reset callbacks
-    effectPanel.refreshTabs();        // rebind tab components
+    daisyChain.rebuild();             // sync rows + reset callbacks
+    effectPanel.refreshTabs();        // sync tab components
     visualizer.refreshTabs();         // sync visualizers
     resized();                        
     repaint();
@@ -337,19 +340,23 @@ void AudioPluginAudioProcessorEditor::rebuildAndSyncUI() {
 
             const juce::String effectName = row->getName(); // find rows left effect name
             row->button.onClick = [this, effectName]() {
-
-                std::lock_guard<std::recursive_mutex> lg(processorRef.getMutex());
-                auto& nodes = processorRef.getEffectNodes();
-
-                // Find the actual effect index by its name
-                for (int n = 0; n < (int)nodes.size(); ++n) {
-                    if (nodes[n] && nodes[n]->effectName == effectName) {
-                        effectPanel.showEffect(n);
-                        visualizer.showVisualizer(n);
-                        setActiveEffectByName(effectName);
-                        break;
+                // Find the actual effect index by its name, then switch tabs without the lock
+                int index = -1;
+                {
+                    std::lock_guard<std::recursive_mutex> lg(processorRef.getMutex());
+                    auto& nodes = processorRef.getEffectNodes();
+                    for (int n = 0; n < (int)nodes.size(); ++n) {
+                        if (nodes[n] && nodes[n]->effectName == effectName) {
+                            index = n;
+                            break;
+                        }
                     }
                 }
+                if (index >= 0) {
+                    effectPanel.showEffect(index);
+                    visualizer.showVisualizer(index);
+                    setActiveEffectByName(effectName);
+                }
             };
             // handle right side if double row
             if (!row->rightEffectName.isEmpty()) {
@@ -684,6 +691,7 @@ void AudioPluginAudioProcessorEditor::setAllEffectsBypassed(bool shouldBypass) {
             if (node)
                 node->bypassed = shouldBypass;
         }
+        processorRef.chainLatencyChanged();
     }
 
     // update DaisyChain to match node bypass states
@@ -10,6 +10,8 @@
 //huda
 #include "Pitchblade/panels/FormantPanel.h"
 #include "Pitchblade/panels/EqualizerPanel.h"
+#include "Pitchblade/panels/MultibandCompressorPanel.h"
+#include "Pitchblade/panels/ParametricEqPanel.h"
 //hayley
 #include "Pitchblade/panels/PitchPanel.h"
 
@@ -25,8 +27,6 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        ), 
-                       // Create the internal pitch correction processor
-                       pitchProcessor(pitchDetector, pitchShifter), 
 
     // Create the AudioProcessorValueTreeState that stores all parameters.
     // It owns every parameter defined in createParameterLayout and handles
@@ -38,10 +38,18 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
         if (!apvts.state.hasType("EffectNodes")) {
             apvts.state = juce::ValueTree("EffectNodes");   
         }
+        morphAmount = apvts.getRawParameterValue("GLOBAL_MORPH");
+        apvts.state.addListener(this);
     }
 
 // Destructor: ensures processor is suspended when the its deleted
-AudioPluginAudioProcessor::~AudioPluginAudioProcessor(){ suspendProcessing(true); }
+AudioPluginAudioProcessor::~AudioPluginAudioProcessor(){
+    suspendProcessing(true);
+    apvts.state.removeListener(this);
+    morphControl.stopTimer();
+    presetLoader.stopThread(4000);  // a preset being built still needs everything here
+    cancelPendingUpdate();
+}
 
 //============================================================================== reyna
 // global APVTS parameter layout
@@ -85,12 +93,18 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
         "DEESSER_RELEASE", "DeEsser Release", juce::NormalisableRange<float>(1.0f, 300.0f, 0.1f), 5.0f));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "DEESSER_FREQUENCY", "DeEsser Frequency", juce::NormalisableRange<float>(2000.0f, 12000.0f, 10.0f), 6000.0f));
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "DEESSER_SPLIT_BAND", "DeEsser Split Band", false));
 
     //De-Noiser : austin
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "DENOISER_REDUCTION", "DeNoiser Reduction", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.0f));
     params.push_back(std::make_unique<juce::AudioParameterBool>(
         "DENOISER_LEARN", "DeNoiser Learn", false));
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "DENOISER_ADAPTIVE", "DeNoiser Adaptive", false));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "DENOISER_MODE", "DeNoiser FFT Mode", juce::StringArray { "Low Latency", "Balanced", "High Resolution" }, 1));
 
 	// Formant Shifter : huda
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
@@ -129,6 +143,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
     params.push_back(std::make_unique<juce::AudioParameterInt>(
         "GLOBAL_FRAMERATE", "Global Framerate", 1, 4, 3));
 
+    // A/B morph: reyna
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "GLOBAL_MORPH", "A/B Morph", juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.0f));
+
     return { params.begin(), params.end() };
 }
 
@@ -152,34 +170,28 @@ std::vector<AudioPluginAudioProcessor::Row> AudioPluginAudioProcessor::getCurren
     return pendingRows;
 }
 
-// apply pending layout on audio thread
-// reconnect effect nodes based on pending rows
-void AudioPluginAudioProcessor::applyPendingLayout() {
-	std::scoped_lock lock(audioMutex);   // lock mutex for thread safety
-    if (!layoutRequested.exchange(false))
-        return;
-
-	std::vector<std::shared_ptr<EffectNode>> old = effectNodes; // copy of current list
-
+// connect nodes by rows and return them in row order - reyna
+// split, double down and unite modes come from where each node sits in the rows
+std::vector<std::shared_ptr<EffectNode>> AudioPluginAudioProcessor::connectRows(const std::vector<std::shared_ptr<EffectNode>>& nodes, const std::vector<Row>& rows) {
     // reset connections and mode
-    for (auto& n : old) if (n) {
+    for (auto& n : nodes) if (n) {
 		n->clearConnections(); n->chainMode = ChainMode::Down;  
     }
 
     // helper to get nodes by row
 	auto getRowNodes = [&](const Row& r) -> std::pair<std::shared_ptr<EffectNode>, std::shared_ptr<EffectNode>> {   
-        return { findByName(old, r.left), r.right.isNotEmpty() ? findByName(old, r.right) : nullptr };
+        return { findByName(nodes, r.left), r.right.isNotEmpty() ? findByName(nodes, r.right) : nullptr };
         };
 
     // previous left/right nodes
 	std::shared_ptr<EffectNode> prevL = nullptr, prevR = nullptr;   
     bool prevWasDouble = false;
 
-	for (int i = 0; i < (int)pendingRows.size(); ++i) { // iterate rows
-        const auto& r = pendingRows[i];
+	for (int i = 0; i < (int)rows.size(); ++i) { // iterate rows
+        const auto& r = rows[i];
         auto [L, R] = getRowNodes(r);
         const bool currDouble = (bool)R;
-        const bool nextDouble = (i + 1 < (int)pendingRows.size()) && pendingRows[i + 1].right.isNotEmpty();
+        const bool nextDouble = (i + 1 < (int)rows.size()) && rows[i + 1].right.isNotEmpty();
 
 		// connect based on current/previous row types //////
 		if (currDouble) { // if double row
@@ -215,18 +227,33 @@ void AudioPluginAudioProcessor::applyPendingLayout() {
 
 	// rebuild new effect node list
     std::vector<std::shared_ptr<EffectNode>> newList;
-    newList.reserve(pendingRows.size() * 2);
-    for (auto& r : pendingRows) { 	                                            // add nodes in order of rows
-		if (auto n = findByName(old, r.left)) { newList.push_back(n); }	        // add left node
+    newList.reserve(rows.size() * 2);
+    for (auto& r : rows) { 	                                                    // add nodes in order of rows
+		if (auto n = findByName(nodes, r.left)) { newList.push_back(n); }	    // add left node
         if (!r.right.isEmpty()) {
-            if (auto m = findByName(old, r.right)) { newList.push_back(m); }    // add right node if exists
+            if (auto m = findByName(nodes, r.right)) { newList.push_back(m); }  // add right node if exists
         }
     }
+    return newList;
+}
+
+// apply pending layout on audio thread
+// reconnect effect nodes based on pending rows
+void AudioPluginAudioProcessor::applyPendingLayout() {
+    if (!layoutRequested.load())
+        return;     // nothing to do, don't touch the lock
+	std::scoped_lock lock(audioMutex);   // lock mutex for thread safety
+    if (!layoutRequested.exchange(false))
+        return;
+
+	std::vector<std::shared_ptr<EffectNode>> old = effectNodes; // copy of current list
+    auto newList = connectRows(old, pendingRows);
 
 	// update effect node list and root
     if (!newList.empty()) {
         effectNodes = std::move(newList);
         activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(effectNodes);
+        chainLatencyChanged();
         rootNode = effectNodes.front();
     }
 
@@ -246,15 +273,32 @@ void AudioPluginAudioProcessor::applyPendingLayout() {
 void AudioPluginAudioProcessor::savePresetToFile(const juce::File& file) {
 	std::lock_guard<std::recursive_mutex> lock(audioMutex);    // lock mutex for thread safety
 
-	// create XML root
-    juce::XmlElement presetRoot("PitchbladePreset");
-    presetRoot.setAttribute("version", 1.0);
-
     applyPendingLayout();
 
+    // layout rows come from the daisy chain when it's open
+    std::vector<Row> rows = pendingRows;
+    auto* ed = dynamic_cast<AudioPluginAudioProcessorEditor*>(getActiveEditor());
+    if (ed != nullptr) {
+        rows.clear();
+        for (auto& r : ed->getDaisyChain().getCurrentLayout())
+            rows.push_back({ r.left, r.right });
+    }
+
+    auto presetRoot = createPresetXml(effectNodes, rows, false);
+    file.getParentDirectory().createDirectory();
+    presetRoot->writeTo(file);
+    juce::Logger::outputDebugString("Saved preset to: " + file.getFullPathName());
+}
+
+// preset tree for the current chain, shared by preset files and the host session
+std::unique_ptr<juce::XmlElement> AudioPluginAudioProcessor::createPresetXml(const std::vector<std::shared_ptr<EffectNode>>& nodeList, const std::vector<Row>& rows, bool withUuids) {
+	// create XML root
+    auto presetRoot = std::make_unique<juce::XmlElement>("PitchbladePreset");
+    presetRoot->setAttribute("version", 1.0);
+
     // save each active node explicitly
     juce::XmlElement* nodes = new juce::XmlElement("EffectNodes");
-    for (auto& node : effectNodes) {
+    for (auto& node : nodeList) {
         if (!node) continue;
 
 		auto nodeXml = node->toXml(); //effectnode subclass toXml
@@ -263,65 +307,106 @@ void AudioPluginAudioProcessor::savePresetToFile(const juce::File& file) {
             nodeXml->setAttribute("bypass", node->bypassed);
             // chaining mode (1-4)
             nodeXml->setAttribute("chainMode", (int)node->chainMode);
+            // sessions keep uuids so the ui finds the same nodes again
+            if (withUuids)
+                nodeXml->setAttribute("uuid", node->getUuid());
 
             nodes->addChildElement(nodeXml.release());
         }
     }
 
 	// add nodes to root
-    presetRoot.addChildElement(nodes);
+    presetRoot->addChildElement(nodes);
 
-    //store layout rows
-    juce::XmlElement* layout = new juce::XmlElement("ChainLayout");
-    auto* ed = dynamic_cast<AudioPluginAudioProcessorEditor*>(getActiveEditor());
-    if (ed != nullptr) {
-        for (auto& r : ed->getDaisyChain().getCurrentLayout()) {
+    //store layout rows. Left out when there are none, so loading falls back to linear
+    if (!rows.empty()) {
+        juce::XmlElement* layout = new juce::XmlElement("ChainLayout");
+        for (auto& r : rows) {
             juce::XmlElement* row = new juce::XmlElement("Row");
             row->setAttribute("left", r.left);
             if (r.right.isNotEmpty())
                 row->setAttribute("right", r.right);
             layout->addChildElement(row);
         }
+        presetRoot->addChildElement(layout);
     }
 
     // also store global params
-    presetRoot.addChildElement(layout);
     juce::XmlElement* globals = new juce::XmlElement("GlobalParameters");
     globals->setAttribute("GLOBAL_FRAMERATE",
         (int)*apvts.getRawParameterValue("GLOBAL_FRAMERATE"));
-    presetRoot.addChildElement(globals);
+    presetRoot->addChildElement(globals);
+    return presetRoot;
+}
 
-    file.getParentDirectory().createDirectory();
-    presetRoot.writeTo(file);
-    juce::Logger::outputDebugString("Saved preset to: " + file.getFullPathName());
+// node states made while the preset loader builds a chain go here instead of into apvts.state
+// apvts.state is only safe to change on the message thread, so they're added when the chain is swapped in
+static thread_local std::vector<juce::ValueTree>* deferredNodeStates = nullptr;
+
+void AudioPluginAudioProcessor::addNodeState(const juce::ValueTree& nodeState) {
+    if (deferredNodeStates != nullptr) {
+        deferredNodeStates->push_back(nodeState);
+        return;
+    }
+    // ensure EffectNodes tree exists
+    if (!apvts.state.hasType("EffectNodes"))
+        apvts.state = juce::ValueTree("EffectNodes");
+    apvts.state.addChild(nodeState, -1, nullptr);
+}
+
+// make an empty node from its xml tag
+static std::shared_ptr<EffectNode> createNodeOfType(AudioPluginAudioProcessor& proc, const juce::String& name) {
+    if      (name == "GainNode")        return std::make_shared<GainNode>(proc);
+    else if (name == "NoiseGateNode")   return std::make_shared<NoiseGateNode>(proc);
+    else if (name == "CompressorNode")  return std::make_shared<CompressorNode>(proc);
+    else if (name == "DeEsserNode")     return std::make_shared<DeEsserNode>(proc);
+    else if (name == "DeNoiserNode")    return std::make_shared<DeNoiserNode>(proc);
+    else if (name == "EqualizerNode")   return std::make_shared<EqualizerNode>(proc);  
+    else if (name == "MultibandCompressorNode") return std::make_shared<MultibandCompressorNode>(proc);
+    else if (name == "ParametricEqNode") return std::make_shared<ParametricEqNode>(proc);
+    else if (name == "PitchNode")       return std::make_shared<PitchNode>(proc);
+    else if (name == "FormantNode")     return std::make_shared<FormantNode>(proc);
+    return nullptr;
 }
 
 // loading presets from file
+// parsing and building every node happens on the loader thread, the audio thread only ever sees the finished chain
 void AudioPluginAudioProcessor::loadPresetFromFile(const juce::File& file) {
-	std::lock_guard<std::recursive_mutex> lock(audioMutex);                 // lock mutex for thread safety
+    presetLoader.load(file);
+}
+
+// same swap as the loader, so the next processBlock starts the crossfade
+void AudioPluginAudioProcessor::loadPresetForTest(const juce::File& file) {
+    if (auto chain = buildChainFromFile(file))
+        installChain(*chain, true);
+}
+
+// build a whole chain from a preset file without touching the running one
+std::unique_ptr<AudioPluginAudioProcessor::LoadedChain> AudioPluginAudioProcessor::buildChainFromFile(const juce::File& file) {
 	std::unique_ptr<juce::XmlElement> xml(juce::XmlDocument::parse(file));  // parse XML from file
-    if (!xml) return;
-	// load global params
-    auto* nodes = xml->getChildByName("EffectNodes");
-    if (!nodes) return;
+    if (!xml) return nullptr;
 
-    // clear existing nodes before rebuilding
-    effectNodes.clear();
+    auto chain = buildChainFromXml(*xml, false);
+    if (chain) chain->file = file;
+    return chain;
+}
+
+// build a whole chain from a preset tree in one pass: nodes, params, rows and connections
+// presets get fresh uuids, sessions keep the ones they were saved with
+std::unique_ptr<AudioPluginAudioProcessor::LoadedChain> AudioPluginAudioProcessor::buildChainFromXml(const juce::XmlElement& presetRoot, bool keepUuids) {
+    auto* nodes = presetRoot.getChildByName("EffectNodes");
+    if (!nodes) return nullptr;
+
+    auto chain = std::make_unique<LoadedChain>();
+
+    // node constructors hand their states to the chain instead of apvts while this runs
+    std::vector<std::shared_ptr<EffectNode>> built;
+    deferredNodeStates = &chain->nodeStates;
 
 	// load each node
     forEachXmlChildElement(*nodes, nodeXml) {
-        auto name = nodeXml->getTagName();
-        std::shared_ptr<EffectNode> node;
-
-        if      (name == "GainNode")        node = std::make_shared<GainNode>(*this);
-        else if (name == "NoiseGateNode")   node = std::make_shared<NoiseGateNode>(*this);
-        else if (name == "CompressorNode")  node = std::make_shared<CompressorNode>(*this);
-        else if (name == "DeEsserNode")     node = std::make_shared<DeEsserNode>(*this);
-        else if (name == "DeNoiserNode")    node = std::make_shared<DeNoiserNode>(*this);
-        else if (name == "EqualizerNode")   node = std::make_shared<EqualizerNode>(*this);  
-        else if (name == "PitchNode")       node = std::make_shared<PitchNode>(*this);
-        else if (name == "FormantNode")     node = std::make_shared<FormantNode>(*this);
-        else continue;
+        auto node = createNodeOfType(*this, nodeXml->getTagName());
+        if (!node) continue;
 
         //load node list
         node->loadFromXml(*nodeXml);
@@ -334,64 +419,472 @@ void AudioPluginAudioProcessor::loadPresetFromFile(const juce::File& file) {
 
         // node API from EffectNode
         auto& vt = node->getMutableNodeState(); 
-        vt.setProperty("uuid", juce::Uuid().toString(), nullptr);
+        if (keepUuids && nodeXml->hasAttribute("uuid"))
+            vt.setProperty("uuid", nodeXml->getStringAttribute("uuid"), nullptr);
+        else
+            vt.setProperty("uuid", juce::Uuid().toString(), nullptr);
 
         // give node back its unique name
         if(nodeXml->hasAttribute("name"))
             node->effectName = nodeXml->getStringAttribute("name");
 
-        effectNodes.push_back(node);
+        built.push_back(node);
     }
+    deferredNodeStates = nullptr;
+
     // read chaining layout
-    auto* layout = xml->getChildByName("ChainLayout");
-    if (layout != nullptr) {
-        std::vector<Row> loadedRows;
+    auto* layout = presetRoot.getChildByName("ChainLayout");
+    if (layout != nullptr && layout->getNumChildElements() > 0) {
 		// read each row
         forEachXmlChildElement(*layout, rowXml) {
             AudioPluginAudioProcessor::Row r;
             r.left = rowXml->getStringAttribute("left");
             r.right = rowXml->getStringAttribute("right");
-            loadedRows.push_back(r);
+            chain->rows.push_back(r);
         }
-
-        // tell the audio thread to rebuild connections from these rows
-        requestLayout(loadedRows);
-        // keep these rows as the current layout for the UI
-        pendingRows = loadedRows;
-        activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(effectNodes);
-        rootNode = effectNodes.empty() ? nullptr : effectNodes.front();
     } else {
         // no chainLayout in the preset: fall back to simple linear routing
-        for (auto& node : effectNodes)
-            if (node) node->clearConnections();
-
-		// simple linear connect
-        for (int i = 0; i + 1 < (int)effectNodes.size(); ++i)
-            effectNodes[i]->connectTo(effectNodes[i + 1]);
-
-		// update active nodes and root
-        activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(effectNodes);
-        rootNode = effectNodes.empty() ? nullptr : effectNodes.front();
-
-        // give that simple layout to the UI
-        pendingRows.clear();
-        for (auto& node : effectNodes) {
+        for (auto& node : built) {
             if (!node) continue;
             Row r;
             r.left = node->effectName;
-            r.right = {};
-            pendingRows.push_back(r);
+            chain->rows.push_back(r);
+        }
+    }
+
+	// load global params
+    if (auto* globals = presetRoot.getChildByName("GlobalParameters"))
+        chain->frameRate = globals->getIntAttribute("GLOBAL_FRAMERATE", 0);
+
+    // wire it here so the swap is just a pointer change
+    chain->nodes = connectRows(built, chain->rows);
+    return chain;
+}
+
+// queue a preset, newest wins. The chain and B are queued separately
+void AudioPluginAudioProcessor::PresetLoader::load(const juce::File& file, bool asMorphTarget) {
+    {
+        const std::lock_guard<std::mutex> lock(requestLock);
+        if (asMorphTarget) {
+            requestedMorph = file;
+            hasMorphRequest = true;
+        } else {
+            requested = file;
+            hasRequest = true;
         }
-        // layout already applied by the direct connectTo calls above
-        layoutRequested.store(false);
     }
+    if (!isThreadRunning())
+        startThread();
+    notify();
+}
+
+void AudioPluginAudioProcessor::PresetLoader::run() {
+    while (!threadShouldExit()) {
+        juce::File file;
+        bool forMorph = false;
+        {
+            const std::lock_guard<std::mutex> lock(requestLock);
+            if (hasRequest) {
+                file = requested;
+                hasRequest = false;
+            } else if (hasMorphRequest) {
+                file = requestedMorph;
+                hasMorphRequest = false;
+                forMorph = true;
+            }
+        }
+        if (file == juce::File()) {
+            wait(-1);
+            continue;
+        }
+
+        auto chain = owner.buildChainFromFile(file);
+        if (!chain || threadShouldExit())
+            continue;
+        chain->morphTarget = forMorph;
+
+        // a newer preset was picked while this one built, skip straight to it
+        {
+            const std::lock_guard<std::mutex> lock(requestLock);
+            if (forMorph ? hasMorphRequest : hasRequest)
+                continue;
+        }
+
+        // wait for the message thread to take the last one, so a chain and a B built back to back both get there
+        while (!threadShouldExit()) {
+            {
+                const std::lock_guard<std::mutex> lock(owner.loadedChainLock);
+                if (owner.loadedChain == nullptr) {
+                    owner.loadedChain = std::move(chain);
+                    break;
+                }
+            }
+            owner.triggerAsyncUpdate();
+            wait(10);
+        }
+        owner.triggerAsyncUpdate();
+    }
+}
+
+// message thread: hand the finished chain to the audio thread
+// the lock is only held to swap pointers, nothing is parsed or built under it
+void AudioPluginAudioProcessor::swapInLoadedChain() {
+    std::unique_ptr<LoadedChain> loaded;
+    {
+        const std::lock_guard<std::mutex> lock(loadedChainLock);
+        loaded = std::move(loadedChain);
+    }
+    if (!loaded) return;
+
+    if (loaded->morphTarget) {
+        installMorphTarget(*loaded);
+        juce::Logger::outputDebugString("loaded morph target from: " + loaded->file.getFullPathName());
+        return;
+    }
+
+    installChain(*loaded, true);
 
     // update ui 
-    juce::MessageManager::callAsync([this]() {
-        if (auto* editor = dynamic_cast<AudioPluginAudioProcessorEditor*>(getActiveEditor()))
-            editor->rebuildAndSyncUI();
-        });
-    juce::Logger::outputDebugString("loaded preset from: " + file.getFullPathName());
+    if (auto* editor = dynamic_cast<AudioPluginAudioProcessorEditor*>(getActiveEditor()))
+        editor->rebuildAndSyncUI();
+    juce::Logger::outputDebugString("loaded preset from: " + loaded->file.getFullPathName());
+}
+
+// make a built chain the current one
+void AudioPluginAudioProcessor::installChain(LoadedChain& chain, bool crossfade) {
+    // the old chain's node states go, so apvts.state only ever holds the current chain
+    for (int i = apvts.state.getNumChildren(); --i >= 0;)
+        if (!apvts.state.getChild(i).hasType("PARAM"))
+            apvts.state.removeChild(i, nullptr);
+    for (auto& st : chain.nodeStates)
+        addNodeState(st);
+
+    if (chain.frameRate > 0) {
+        if (auto* p = apvts.getParameter("GLOBAL_FRAMERATE"))
+            p->setValueNotifyingHost(p->convertTo0to1((float)chain.frameRate));
+    }
+
+    auto nodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(chain.nodes);
+    std::lock_guard<std::recursive_mutex> lock(audioMutex);
+    effectNodes = chain.nodes;
+    pendingRows = chain.rows;       // keep these rows as the current layout for the UI
+    layoutRequested.store(false);   // already wired when it was built
+    rootNode = effectNodes.empty() ? nullptr : effectNodes.front();
+
+    if (crossfade) {
+        incomingNodes = std::move(nodes);
+        chainSwapPending.store(true);
+    } else {
+        discardIncomingChain();
+        activeNodes = std::move(nodes);
+        chainLatencyChanged();
+    }
+}
+
+// audio thread: swap in a loaded chain between blocks
+// waits for the previous fade to finish, and never waits on the lock
+void AudioPluginAudioProcessor::takeIncomingChain() {
+    if (!chainSwapPending.load() || fadingNodes != nullptr || retiredReady.load())
+        return;
+
+    std::unique_lock<std::recursive_mutex> lock(audioMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;     // try again next block
+
+    chainSwapPending.store(false);
+    if (!incomingNodes)
+        return;
+
+    // the old chain fades out under the new one
+    auto old = std::move(activeNodes);
+    activeNodes = std::move(incomingNodes);
+    chainLatencyChanged();
+
+    if (old && !old->empty() && !isBypassed() && crossfadeBuffer.getNumSamples() > 0) {
+        // every node has its own dsp, so the old chain plays out the fade as it was
+        fadingNodes = std::move(old);
+        fadeSamplesDone = 0;
+    } else if (old) {
+        fadingNodes = std::move(old);
+        retireFadingChain();
+    }
+}
+
+// audio thread: run the old chain on its copy of the input and fade from it to the new chain's output
+// the gains follow a raised cosine and add up to one, so a chain that barely changed doesn't dip or bump
+void AudioPluginAudioProcessor::crossfadeOut(juce::AudioBuffer<float>& buffer) {
+    const int numCh = juce::jmin(buffer.getNumChannels(), crossfadeBuffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+
+    juce::AudioBuffer<float> old(crossfadeBuffer.getArrayOfWritePointers(), numCh, numSamples);
+    if (!fadingNodes->empty() && fadingNodes->front())
+        fadingNodes->front()->processAndForward(*this, old);
+
+    for (int ch = 0; ch < numCh; ++ch) {
+        auto* out = buffer.getWritePointer(ch);
+        const auto* from = old.getReadPointer(ch);
+        for (int i = 0; i < numSamples; ++i) {
+            const float t = juce::jmin(1.0f, (float)(fadeSamplesDone + i) / (float)fadeLengthSamples);
+            const float inGain = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * t);
+            out[i] = out[i] * inGain + from[i] * (1.0f - inGain);
+        }
+    }
+
+    fadeSamplesDone += numSamples;
+    if (fadeSamplesDone >= fadeLengthSamples)
+        retireFadingChain();
+}
+
+// audio thread: pass the faded out chain to the message thread to be deleted
+void AudioPluginAudioProcessor::retireFadingChain() {
+    retiredNodes = std::move(fadingNodes);
+    retiredReady.store(true);
+    triggerAsyncUpdate();
+}
+
+// drop a loaded chain that hasn't reached the audio thread yet. Called with audioMutex held
+void AudioPluginAudioProcessor::discardIncomingChain() {
+    chainSwapPending.store(false);
+    incomingNodes.reset();
+}
+
+//============================================================================== A/B morph - reyna
+// build B from a preset file on the loader thread
+void AudioPluginAudioProcessor::loadMorphTargetFromFile(const juce::File& file) {
+    presetLoader.load(file, true);
+}
+
+// B becomes a copy of the chain as it is now, so changes to A can be heard against it
+void AudioPluginAudioProcessor::captureMorphTarget() {
+    std::unique_ptr<juce::XmlElement> current;
+    {
+        std::lock_guard<std::recursive_mutex> lock(audioMutex);
+        current = createPresetXml(effectNodes, pendingRows, false);
+    }
+    if (auto chain = buildChainFromXml(*current, false))
+        installMorphTarget(*chain);
+}
+
+// message thread: B's node states stay out of apvts, B is never saved with the session
+void AudioPluginAudioProcessor::installMorphTarget(LoadedChain& chain) {
+    clearMorphTarget();
+
+    morphTarget = chain.nodes;
+    morphRows = chain.rows;
+
+    updateMorphPairing();
+    morphControl.startTimerHz(30);
+}
+
+void AudioPluginAudioProcessor::clearMorphTarget() {
+    morphControl.stopTimer();
+    setMorphAudioChain(nullptr);
+    morphPairs.clear();
+    morphPairedNodes.clear();
+    morphPairedRows.clear();
+    morphTarget.clear();
+    morphRows.clear();
+    lastMorphApplied = -1.0f;
+}
+
+// type of the node on each side of each row, "" for an empty right side
+static juce::StringArray rowTypes(const std::vector<std::shared_ptr<EffectNode>>& nodes, const std::vector<AudioPluginAudioProcessor::Row>& rows) {
+    juce::StringArray types;
+    for (auto& r : rows) {
+        for (auto* name : { &r.left, &r.right }) {
+            if (name->isEmpty()) {
+                types.add({});
+                continue;
+            }
+            auto node = findByName(nodes, *name);
+            types.add(node ? node->getNodeType() + ":" + juce::String((int)node->chainMode) : juce::String("?"));
+        }
+    }
+    return types;
+}
+
+// a node state's properties, as a snapshot
+static juce::NamedValueSet propertiesOf(const juce::ValueTree& tree) {
+    juce::NamedValueSet values;
+    for (int i = 0; i < tree.getNumProperties(); ++i) {
+        auto id = tree.getPropertyName(i);
+        values.set(id, tree.getProperty(id));
+    }
+    return values;
+}
+
+// message thread: blend params if B has the same node types in the same rows as A, otherwise crossfade the audio
+void AudioPluginAudioProcessor::updateMorphPairing() {
+    std::vector<std::shared_ptr<EffectNode>> aNodes;
+    std::vector<Row> aRows;
+    {
+        std::lock_guard<std::recursive_mutex> lock(audioMutex);
+        aNodes = effectNodes;
+        aRows = pendingRows;
+    }
+
+    morphPairs.clear();
+    morphPairedNodes.clear();
+    for (auto& n : aNodes)
+        morphPairedNodes.push_back(n.get());
+    morphPairedRows = aRows;
+    lastMorphApplied = -1.0f;
+
+    // no rows yet means the chain is still the plain linear one
+    if (aRows.empty()) {
+        for (auto& n : aNodes)
+            aRows.push_back({ n->effectName, {} });
+    }
+
+    const bool blend = !morphTarget.empty() && !aRows.empty() && aRows.size() == morphRows.size()
+                       && rowTypes(aNodes, aRows) == rowTypes(morphTarget, morphRows);
+
+    if (blend) {
+        for (size_t i = 0; i < aRows.size(); ++i) {
+            for (auto side : { 0, 1 }) {
+                auto& aName = side == 0 ? aRows[i].left : aRows[i].right;
+                auto& bName = side == 0 ? morphRows[i].left : morphRows[i].right;
+                if (aName.isEmpty()) continue;
+
+                MorphPair p;
+                p.a = findByName(aNodes, aName);
+                p.b = findByName(morphTarget, bName);
+                if (!p.a || !p.b) continue;
+                p.fromA = propertiesOf(p.a->getNodeState());
+                p.bypassA = p.a->bypassed;
+                morphPairs.push_back(std::move(p));
+            }
+        }
+        setMorphAudioChain(nullptr);    // B only lends its params, it never runs
+        return;
+    }
+
+    setMorphAudioChain(morphTarget.empty() ? nullptr : std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(morphTarget));
+}
+
+// control rate, on the message thread
+void AudioPluginAudioProcessor::updateMorph() {
+    if (morphTarget.empty()) return;
+
+    // A was rebuilt, reordered or had nodes added, pair again
+    bool changed = false;
+    {
+        std::lock_guard<std::recursive_mutex> lock(audioMutex);
+        changed = effectNodes.size() != morphPairedNodes.size() || pendingRows.size() != morphPairedRows.size();
+        for (size_t i = 0; !changed && i < effectNodes.size(); ++i)
+            changed = effectNodes[i].get() != morphPairedNodes[i];
+        for (size_t i = 0; !changed && i < pendingRows.size(); ++i)
+            changed = pendingRows[i].left != morphPairedRows[i].left || pendingRows[i].right != morphPairedRows[i].right;
+    }
+    if (changed)
+        updateMorphPairing();
+
+    applyMorphParams(morphAmount != nullptr ? morphAmount->load() : 0.0f);
+}
+
+// write the blend of A and B into A's nodes. Numbers are interpolated, anything else switches halfway
+// children of the node state (lists of bands etc) are left alone
+void AudioPluginAudioProcessor::applyMorphParams(float amount) {
+    if (morphPairs.empty()) return;
+
+    static const juce::Identifier uuidId("uuid"), nameId("name");
+    for (auto& p : morphPairs) {
+        auto& live = p.a->getMutableNodeState();
+
+        // sitting at A (or just paired), A's values are whatever the user has set
+        if (amount <= 0.0f && lastMorphApplied <= 0.0f) {
+            p.fromA = propertiesOf(live);
+            p.bypassA = p.a->bypassed;
+        }
+        // sitting at B, edits made there are B's now
+        if (amount >= 1.0f && amount == lastMorphApplied) {
+            for (int i = 0; i < live.getNumProperties(); ++i) {
+                auto id = live.getPropertyName(i);
+                if (id != uuidId && id != nameId)
+                    p.b->getMutableNodeState().setProperty(id, live.getProperty(id), nullptr);
+            }
+            p.b->bypassed = p.a->bypassed;
+            continue;
+        }
+        if (amount == lastMorphApplied) continue;
+
+        auto& to = p.b->getNodeState();
+        for (int i = 0; i < p.fromA.size(); ++i) {
+            auto id = p.fromA.getName(i);
+            if (id == uuidId || id == nameId || !to.hasProperty(id)) continue;
+
+            const auto& a = p.fromA.getValueAt(i);
+            const auto& b = to.getProperty(id);
+            const bool numbers = (a.isDouble() || a.isInt() || a.isInt64()) && (b.isDouble() || b.isInt() || b.isInt64());
+            juce::var value = amount < 0.5f ? a : b;
+            if (numbers) {
+                const double blended = (double)a + ((double)b - (double)a) * amount;
+                value = a.isDouble() ? juce::var(blended) : juce::var((int)std::lround(blended));
+            }
+            live.setProperty(id, value, nullptr);
+        }
+        const bool bypassNow = amount < 0.5f ? p.bypassA : p.b->bypassed;
+        if (p.a->bypassed != bypassNow) {
+            p.a->bypassed = bypassNow;
+            chainLatencyChanged();
+        }
+    }
+    lastMorphApplied = amount;
+}
+
+// message thread: the audio thread picks B up between blocks
+void AudioPluginAudioProcessor::setMorphAudioChain(NodeList nodes) {
+    std::lock_guard<std::recursive_mutex> lock(audioMutex);
+    incomingMorph = std::move(nodes);
+    morphSwapPending.store(true);
+}
+
+// audio thread: take B or drop it between blocks. The one it replaces is deleted on the message thread
+void AudioPluginAudioProcessor::takeMorphChain() {
+    if (!morphSwapPending.load() || retiredMorphReady.load())
+        return;
+
+    std::unique_lock<std::recursive_mutex> lock(audioMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;     // try again next block
+
+    morphSwapPending.store(false);
+    retiredMorph = std::move(morphNodes);
+    morphNodes = std::move(incomingMorph);
+    if (retiredMorph) {
+        retiredMorphReady.store(true);
+        triggerAsyncUpdate();
+    }
+}
+
+// audio thread: run B on its copy of the input and crossfade. cos and sin gains keep the power constant
+// when the two chains don't match. A is asleep when it's fully faded out and the buffer is still the input
+void AudioPluginAudioProcessor::mixMorph(juce::AudioBuffer<float>& buffer, bool aAsleep) {
+    const bool bAsleep = !morphGain.isSmoothing() && morphGain.getCurrentValue() <= 0.0f;
+    if (bAsleep) return;
+
+    const int numCh = juce::jmin(buffer.getNumChannels(), morphChannelOffset);
+    const int numSamples = buffer.getNumSamples();
+    juce::AudioBuffer<float> b(crossfadeBuffer.getArrayOfWritePointers() + morphChannelOffset, numCh, numSamples);
+    if (!morphNodes->empty() && morphNodes->front())
+        morphNodes->front()->processAndForward(*this, b);
+
+    if (aAsleep) {
+        for (int ch = 0; ch < numCh; ++ch)
+            buffer.copyFrom(ch, 0, b, ch, 0, numSamples);
+        return;
+    }
+
+    const float halfPi = juce::MathConstants<float>::halfPi;
+    for (int i = 0; i < numSamples; ++i) {
+        const float g = morphGain.getNextValue();
+        const float gainA = std::cos(halfPi * g);
+        const float gainB = std::sin(halfPi * g);
+        for (int ch = 0; ch < numCh; ++ch) {
+            auto* out = buffer.getWritePointer(ch);
+            out[i] = out[i] * gainA + b.getSample(ch, i) * gainB;
+        }
+    }
 }
 
 //============================================================================== 
@@ -459,40 +952,82 @@ void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     juce::ignoreUnused (sampleRate, samplesPerBlock);
     currentBlockSize = samplesPerBlock; // Austin
 
-	//intialize dsp processors
-    formantDetector.prepare(sampleRate);                        //Initialization for FormantDetector for real-time processing - huda
-    pitchProcessor.prepare(sampleRate, samplesPerBlock);        //hayley
-    formantShifter.prepare (sampleRate, samplesPerBlock, getTotalNumInputChannels()); //huda 
-    equalizer.prepare(sampleRate, samplesPerBlock, getTotalNumInputChannels()); //huda
-
 	// lock mutex for thread safety - reyna
     std::lock_guard<std::recursive_mutex> lock(audioMutex);
 
+    // room for the old chain's copy of a block while a preset crossfades in (20 ms) - reyna
+    // the second half is B's copy for the A/B morph, so both share the one allocation
+    morphChannelOffset = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    crossfadeBuffer.setSize(morphChannelOffset * 2, samplesPerBlock);
+    fadeLengthSamples = juce::jmax(1, (int)(sampleRate * 0.02));
+    fadingNodes.reset();
+    discardIncomingChain();
+
+    // B is handed over straight away while nothing is playing
+    morphGain.reset(sampleRate, 0.02);
+    morphGain.setCurrentAndTargetValue(morphAmount != nullptr ? morphAmount->load() : 0.0f);
+    if (morphSwapPending.exchange(false)) {
+        retiredMorph = std::move(morphNodes);
+        morphNodes = std::move(incomingMorph);
+        retiredMorphReady.store(retiredMorph != nullptr);
+    }
+
 	//effect node building - reyna
-	// create all default effect nodes and store in effectNodes vector
-    effectNodes.clear();
-    effectNodes.push_back(std::make_shared<GainNode>(*this));
-    effectNodes.push_back(std::make_shared<NoiseGateNode>(*this));
-    effectNodes.push_back(std::make_shared<CompressorNode>(*this));
-    effectNodes.push_back(std::make_shared<DeEsserNode>(*this));
-    effectNodes.push_back(std::make_shared<DeNoiserNode>(*this));
-    effectNodes.push_back(std::make_shared<FormantNode>(*this));
-    effectNodes.push_back(std::make_shared<PitchNode>(*this));
-    effectNodes.push_back(std::make_shared<EqualizerNode>(*this));
+    // a session restored before the first prepare is built now, once, at the real rate
+    const bool formatChanged = sampleRate != preparedRate || samplesPerBlock != preparedBlockSize;
+    const bool firstPrepare = preparedRate <= 0.0;
+    preparedRate = sampleRate;
+    preparedBlockSize = samplesPerBlock;
+
+    std::unique_ptr<LoadedChain> chain;
+    if (pendingSession != nullptr) {
+        chain = buildChainFromXml(*pendingSession, true);
+        pendingSession.reset();
+    } else if (!firstPrepare && formatChanged) {
+        // the chain the user has is kept, rebuilt so every node prepares at the new rate
+        auto current = createPresetXml(effectNodes, pendingRows, true);
+        chain = buildChainFromXml(*current, true);
+    }
 
-    //connect chain
-	// set up default chain: Gain > Noise gate > formant > Pitch
-	for (auto& n : effectNodes) 
-        if (n) n->clearConnections();   //clear any existing connections
+    // B was built for the old rate too, it's rebuilt on the message thread
+    if (!firstPrepare && formatChanged && !morphTarget.empty()) {
+        morphRebuildPending.store(true);
+        triggerAsyncUpdate();
+    }
 
-	// simple linear connect 
-    for (size_t i = 0; i + 1 < effectNodes.size(); ++i) {
-        effectNodes[i]->connectTo(effectNodes[i + 1]);
+    if (chain != nullptr) {
+        installChain(*chain, false);
+    } else if (!firstPrepare) {
+        // same format, the running chain carries on
+        activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(effectNodes);
+    } else {
+        // create all default effect nodes and store in effectNodes vector
+        effectNodes.clear();
+        effectNodes.push_back(std::make_shared<GainNode>(*this));
+        effectNodes.push_back(std::make_shared<NoiseGateNode>(*this));
+        effectNodes.push_back(std::make_shared<CompressorNode>(*this));
+        effectNodes.push_back(std::make_shared<DeEsserNode>(*this));
+        effectNodes.push_back(std::make_shared<DeNoiserNode>(*this));
+        effectNodes.push_back(std::make_shared<FormantNode>(*this));
+        effectNodes.push_back(std::make_shared<PitchNode>(*this));
+        effectNodes.push_back(std::make_shared<EqualizerNode>(*this));
+
+        //connect chain
+        // set up default chain: Gain > Noise gate > formant > Pitch
+        for (auto& n : effectNodes) 
+            if (n) n->clearConnections();   //clear any existing connections
+
+        // simple linear connect 
+        for (size_t i = 0; i + 1 < effectNodes.size(); ++i) {
+            effectNodes[i]->connectTo(effectNodes[i + 1]);
+        }
+
+        // shared pointer to active nodes for audio thread
+        activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(effectNodes); 
+        rootNode = effectNodes.front();
     }
 
-    // shared pointer to active nodes for audio thread
-	activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(effectNodes); 
-    rootNode = effectNodes.front();
+    chainLatencyChanged();
 
 	// rebuild UI safely
     if (auto* ed = dynamic_cast<AudioPluginAudioProcessorEditor*>(getActiveEditor())) {
@@ -540,13 +1075,52 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     juce::ScopedNoDenormals noDenormals;
 
     applyPendingLayout();
+    takeIncomingChain();    // a loaded preset is swapped in here, between blocks
+    takeMorphChain();       // and B for the A/B morph
+
+    // anything that changed the latency before this block has been picked up by the nodes once it's done - Austin
+    const bool recountLatency = latencyChanged.exchange(false);
+
+    // A/B morph with a chain that doesn't line up with A: B gets its own copy of the input - reyna
+    const bool morphing = morphNodes != nullptr && !isBypassed() && buffer.getNumSamples() <= crossfadeBuffer.getNumSamples();
+    bool aAsleep = false;
+    if (morphing) {
+        morphGain.setTargetValue(morphAmount->load());
+        aAsleep = !morphGain.isSmoothing() && morphGain.getCurrentValue() >= 1.0f;
+        const bool bAsleep = !morphGain.isSmoothing() && morphGain.getCurrentValue() <= 0.0f;
+        if (!bAsleep) {
+            for (int ch = 0; ch < juce::jmin(buffer.getNumChannels(), morphChannelOffset); ++ch)
+                crossfadeBuffer.copyFrom(morphChannelOffset + ch, 0, buffer, ch, 0, buffer.getNumSamples());
+        }
+    }
 
 	// process audio through daisy chain - reyna
-    if (!isBypassed() && activeNodes && !activeNodes->empty()) {
+    if (!aAsleep && !isBypassed() && activeNodes && !activeNodes->empty()) {
+        // while a preset fades in the old chain gets its own copy of the input
+        const bool fading = fadingNodes != nullptr && buffer.getNumSamples() <= crossfadeBuffer.getNumSamples();
+        if (fading) {
+            for (int ch = 0; ch < juce::jmin(buffer.getNumChannels(), crossfadeBuffer.getNumChannels()); ++ch)
+                crossfadeBuffer.copyFrom(ch, 0, buffer, ch, 0, buffer.getNumSamples());
+        }
+
 		auto chain = activeNodes;   // copy shared
 		auto root = chain->front(); //  get root node
         if (root) root->processAndForward(*this, buffer);
-    } 
+
+        if (fading) crossfadeOut(buffer);
+        else if (fadingNodes) retireFadingChain();   // block too big to fade, just switch
+    } else if (fadingNodes) {
+        retireFadingChain();
+    }
+
+    if (morphing)
+        mixMorph(buffer, aAsleep);
+
+    // keep the host's latency in sync with any lookahead in the chain - Austin
+    if (recountLatency) {
+        latencyRecount.store(true);
+        triggerAsyncUpdate();
+    }
 
     //juce boilerplate
     for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i) {
@@ -554,6 +1128,62 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     }
 }
 
+//============================================================================== latency - Austin
+// latency from this node to the end of the chain
+// serial nodes add up, parallel branches take the longest one
+static int latencyFromNode(const std::shared_ptr<EffectNode>& node, int depth) {
+    if (!node || depth > 64) return 0;  // guard against a bad layout looping forever
+
+    int longestChild = 0;
+    for (auto& child : node->children)
+        longestChild = std::max(longestChild, latencyFromNode(child, depth + 1));
+
+    const int own = node->bypassed ? 0 : node->getLatencySamples();
+    return own + longestChild;
+}
+
+// message thread: counts the chain under the lock, so the graph can't change while it's walked
+void AudioPluginAudioProcessor::updateChainLatency() {
+    int total = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(audioMutex);
+        if (!isBypassed() && activeNodes && !activeNodes->empty())
+            total = latencyFromNode(activeNodes->front(), 0);
+    }
+
+    if (chainLatencySamples.exchange(total) != total)
+        setLatencySamples(total);
+}
+
+// parameter values aren't node settings, so they're skipped
+void AudioPluginAudioProcessor::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) {
+    juce::ignoreUnused(property);
+    if (!tree.hasType("PARAM"))
+        chainLatencyChanged();
+}
+
+void AudioPluginAudioProcessor::handleAsyncUpdate() {
+    if (latencyRecount.exchange(false))
+        updateChainLatency();
+
+    // preset loading - reyna
+    swapInLoadedChain();            // a preset finished building
+    if (retiredReady.load()) {      // an old chain finished fading out, delete it here instead of on the audio thread
+        retiredNodes.reset();
+        retiredReady.store(false);
+    }
+    if (retiredMorphReady.load()) { // same for a B the audio thread let go of
+        retiredMorph.reset();
+        retiredMorphReady.store(false);
+    }
+    if (morphRebuildPending.exchange(false) && !morphTarget.empty()) {
+        // B's nodes prepare at the new rate
+        auto current = createPresetXml(morphTarget, morphRows, false);
+        if (auto chain = buildChainFromXml(*current, false))
+            installMorphTarget(*chain);
+    }
+}
+
 //==============================================================================
 bool AudioPluginAudioProcessor::hasEditor() const {
     return true; // (change this to false if you choose to not supply an editor)
@@ -565,17 +1195,81 @@ juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor() {
 
 //==============================================================================
 // State saving/loading - reyna
+// a session is a short header and then the chain's preset tree, written as a binary ValueTree:
+//   int magic, int version, bool compressed, tree (gzipped if compressed)
+// the tree has node types, uuids, per node params, bypass, chain modes, rows and globals, so a restore is one build
+static constexpr int sessionMagic = 0x53534250;     // "PBSS"
+static constexpr int sessionVersion = 2;            // version 1 was the whole apvts state as xml
+static constexpr size_t compressAbove = 4096;       // small chains aren't worth the zip
+
 void AudioPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData) {
-	auto xml = apvts.copyState().createXml();   // get ValueTree as XML
-	copyXmlToBinary(*xml, destData);            // copy to binary blob
+    std::unique_ptr<juce::XmlElement> preset;
+    {
+        std::lock_guard<std::recursive_mutex> lock(audioMutex);
+        // restored but not prepared yet, the chain is still waiting to be built
+        preset = pendingSession != nullptr ? std::make_unique<juce::XmlElement>(*pendingSession)
+                                           : createPresetXml(effectNodes, pendingRows, true);
+    }
+
+    juce::MemoryOutputStream tree;
+    juce::ValueTree::fromXml(*preset).writeToStream(tree);
+    const bool compressed = tree.getDataSize() > compressAbove;
+
+    juce::MemoryOutputStream out(destData, false);
+    out.writeInt(sessionMagic);
+    out.writeInt(sessionVersion);
+    out.writeBool(compressed);
+    if (compressed) {
+        juce::GZIPCompressorOutputStream zipped(out);
+        zipped.write(tree.getData(), tree.getDataSize());
+        zipped.flush();
+    } else {
+        out.write(tree.getData(), tree.getDataSize());
+    }
 }
 
 // loading state from binary blob - reyna
 void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes) {
-	// parse XML from binary blob
-    std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
-    if (xml) {
-        apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    juce::MemoryInputStream in(data, (size_t)juce::jmax(0, sizeInBytes), false);
+    if (sizeInBytes < 9 || in.readInt() != sessionMagic) {
+        // sessions from before the binary format
+        std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
+        if (xml) {
+            apvts.replaceState(juce::ValueTree::fromXml(*xml));
+        }
+        return;
+    }
+    if (in.readInt() > sessionVersion)
+        return;     // saved by a newer build, leave the chain alone
+
+    juce::ValueTree tree;
+    if (in.readBool()) {
+        juce::GZIPDecompressorInputStream unzipped(in);
+        tree = juce::ValueTree::readFromStream(unzipped);
+    } else {
+        tree = juce::ValueTree::readFromStream(in);
+    }
+    auto preset = tree.createXml();
+    if (!preset) return;
+
+    // hosts usually restore before preparing. The chain is built once at the first prepare instead of twice
+    if (preparedRate <= 0.0) {
+        std::lock_guard<std::recursive_mutex> lock(audioMutex);
+        pendingSession = std::move(preset);
+        return;
+    }
+
+    auto chain = buildChainFromXml(*preset, true);
+    if (!chain) return;
+    installChain(*chain, true);     // fades in like a preset if audio is running
+
+	// rebuild UI safely
+    if (auto* ed = dynamic_cast<AudioPluginAudioProcessorEditor*>(getActiveEditor())) {
+        juce::Component::SafePointer<AudioPluginAudioProcessorEditor> safe(ed);
+        juce::MessageManager::callAsync([safe]() {
+            if (auto* e = safe.getComponent())
+                e->rebuildAndSyncUI();
+            });
     }
 }
 
@@ -594,6 +1288,7 @@ void AudioPluginAudioProcessor::loadDefaultPreset(const juce::String& type) {
     std::lock_guard<std::recursive_mutex> lock(audioMutex);
 
     juce::Logger::outputDebugString("Loading default preset type: " + type);
+    discardIncomingChain();     // replaces any preset still on its way in
 
 	// reset the current effectNodes vector to default
     effectNodes.clear();
@@ -618,6 +1313,7 @@ void AudioPluginAudioProcessor::loadDefaultPreset(const juce::String& type) {
 
 	// update active nodes and root
     activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>(effectNodes);
+    chainLatencyChanged();
     rootNode = effectNodes.front();
 
 	// rebuild UI safely
@@ -644,6 +1340,7 @@ void AudioPluginAudioProcessor::loadDefaultPreset(const juce::String& type) {
 // empty daisychain preset
 void AudioPluginAudioProcessor::clearAllNodes() {
     const std::lock_guard<std::recursive_mutex> lock(getMutex());
+    discardIncomingChain();     // replaces any preset still on its way in
     // clear dsp
     effectNodes.clear();
     // clear layout rows
@@ -655,6 +1352,7 @@ void AudioPluginAudioProcessor::clearAllNodes() {
     // thread safe empty graph
     rootNode = nullptr;
     activeNodes = std::make_shared<std::vector<std::shared_ptr<EffectNode>>>();
+    chainLatencyChanged();
     // rebuild UI
     if (auto* ed = dynamic_cast<AudioPluginAudioProcessorEditor*>(getActiveEditor())) {
         auto& dc = ed->getDaisyChain();
@@ -675,4 +1373,5 @@ bool AudioPluginAudioProcessor::isBypassed() const {
 
 void AudioPluginAudioProcessor::setBypassed(bool newState) {
     bypassed = newState;
+    chainLatencyChanged();
 }
@@ -0,0 +1,270 @@
+// reyna
+#include "Pitchblade/PresetLibrary.h"
+#include <algorithm>
+#include <map>
+
+// index file layout version, bump when the entry properties change
+static constexpr int indexVersion = 2;
+
+// 64 bit FNV-1a over the file, enough to spot the same preset saved twice or a changed file
+static juce::String hashData(const juce::MemoryBlock& data) {
+    juce::uint64 h = 14695981039346656037ull;
+    auto* bytes = static_cast<const juce::uint8*>(data.getData());
+    for (size_t i = 0; i < data.getSize(); ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return juce::String::toHexString((juce::int64)h).paddedLeft('0', 16);
+}
+
+PresetLibrary::PresetLibrary()
+    : PresetLibrary(getDefaultFolder(),
+                    juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                        .getChildFile("Pitchblade/PresetIndex.bin")) {}
+
+PresetLibrary::PresetLibrary(const juce::File& presetsFolder, const juce::File& cacheFile)
+    : juce::Thread("Preset library"), folder(presetsFolder), indexFile(cacheFile) {
+    // the index is all that's read here, so search works straight away
+    loadIndex();
+    rescan();
+}
+
+PresetLibrary::~PresetLibrary() {
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+}
+
+juce::File PresetLibrary::getDefaultFolder() {
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Pitchblade/Presets");
+}
+
+//============================================================================== scanning
+void PresetLibrary::rescan() {
+    {
+        const std::lock_guard<std::mutex> lock(scanLock);
+        ++requestedScan;
+        scanning.store(true);
+        scanDone.reset();
+    }
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+    notify();
+}
+
+bool PresetLibrary::waitForScan(int timeoutMs) {
+    return scanDone.wait(timeoutMs);
+}
+
+void PresetLibrary::run() {
+    while (!threadShouldExit()) {
+        int scanId = 0;
+        {
+            const std::lock_guard<std::mutex> lock(scanLock);
+            scanId = requestedScan;
+        }
+        if (scanId == finishedScan) {
+            wait(-1);
+            continue;
+        }
+
+        // what the index already knows, by path
+        std::map<juce::String, Entry> known;
+        {
+            const std::lock_guard<std::mutex> lock(entriesLock);
+            for (auto& e : entries)
+                known.emplace(e.file.getFullPathName(), e);
+        }
+
+        // only files that are new or changed since the index was written get opened
+        std::vector<Entry> found;
+        int parsed = 0;
+        for (const auto& item : juce::RangedDirectoryIterator(folder, true, "*.xml", juce::File::findFiles)) {
+            if (threadShouldExit()) return;
+
+            const auto file = item.getFile();
+            const auto modified = item.getModificationTime().toMilliseconds();
+            const auto size = item.getFileSize();
+
+            auto it = known.find(file.getFullPathName());
+            if (it != known.end() && it->second.modified == modified && it->second.size == size) {
+                found.push_back(std::move(it->second));
+                continue;
+            }
+
+            // files that aren't presets are kept as well, so they aren't opened again next time
+            auto e = readPreset(file);
+            ++parsed;
+            e.modified = modified;
+            e.size = size;
+            found.push_back(std::move(e));
+        }
+
+        std::sort(found.begin(), found.end(), [](const Entry& a, const Entry& b) {
+            return a.name.compareNatural(b.name) < 0;
+        });
+
+        // files were added, changed or removed
+        const bool changed = parsed > 0 || found.size() != known.size();
+        parsedLastScan.store(parsed);
+        if (changed) {
+            saveIndex(found);
+            {
+                const std::lock_guard<std::mutex> lock(entriesLock);
+                entries = std::move(found);
+            }
+            sendChangeMessage();
+        }
+
+        const std::lock_guard<std::mutex> lock(scanLock);
+        finishedScan = scanId;
+        if (finishedScan == requestedScan) {
+            scanning.store(false);
+            scanDone.signal();
+        }
+    }
+}
+
+// opens one preset for its metadata
+PresetLibrary::Entry PresetLibrary::readPreset(const juce::File& file) const {
+    Entry e;
+    e.file = file;
+    e.isPreset = false;
+
+    juce::MemoryBlock data;
+    if (!file.loadFileAsData(data))
+        return e;
+
+    std::unique_ptr<juce::XmlElement> xml(juce::XmlDocument::parse(data.toString()));
+    if (!xml || !xml->hasTagName("PitchbladePreset"))
+        return e;
+
+    e.isPreset = true;
+    e.name = xml->getStringAttribute("name", file.getFileNameWithoutExtension());
+    e.hash = hashData(data);
+
+    // tags from the preset, then from the folders it's in
+    e.tags.addTokens(xml->getStringAttribute("tags"), ",", "\"");
+    e.tags.addTokens(file.getParentDirectory().getRelativePathFrom(folder), "/\\", "");
+    e.tags.trim();
+    e.tags.removeEmptyStrings();
+    e.tags.removeString(".");
+    e.tags.removeDuplicates(true);
+
+    if (auto* nodes = xml->getChildByName("EffectNodes")) {
+        for (auto* nodeXml : nodes->getChildIterator())
+            e.nodeTypes.addIfNotAlreadyThere(nodeXml->getTagName());
+    }
+
+    makeSearchText(e);
+    return e;
+}
+
+void PresetLibrary::makeSearchText(Entry& e) {
+    e.searchText = (e.name + " " + e.tags.joinIntoString(" ") + " " + e.nodeTypes.joinIntoString(" ")).toLowerCase();
+}
+
+//============================================================================== searching
+std::vector<PresetLibrary::Entry> PresetLibrary::search(const juce::String& text, const juce::String& nodeType) const {
+    juce::StringArray words;
+    words.addTokens(text.toLowerCase(), " ", "\"");
+    words.removeEmptyStrings();
+
+    std::vector<Entry> out;
+    const std::lock_guard<std::mutex> lock(entriesLock);
+    for (auto& e : entries) {
+        if (!e.isPreset || (nodeType.isNotEmpty() && !e.nodeTypes.contains(nodeType)))
+            continue;
+
+        bool all = true;
+        for (auto& w : words) {
+            if (!e.searchText.contains(w)) {
+                all = false;
+                break;
+            }
+        }
+        if (all)
+            out.push_back(e);
+    }
+    return out;
+}
+
+int PresetLibrary::getNumPresets() const {
+    const std::lock_guard<std::mutex> lock(entriesLock);
+    return (int)std::count_if(entries.begin(), entries.end(), [](const Entry& e) { return e.isPreset; });
+}
+
+juce::StringArray PresetLibrary::getAllNodeTypes() const {
+    juce::StringArray types;
+    {
+        const std::lock_guard<std::mutex> lock(entriesLock);
+        for (auto& e : entries)
+            for (auto& t : e.nodeTypes)
+                types.addIfNotAlreadyThere(t);
+    }
+    types.sort(true);
+    return types;
+}
+
+//============================================================================== index file
+// the index is a gzipped binary ValueTree, one child per xml file. Paths are kept relative to the presets folder
+void PresetLibrary::loadIndex() {
+    juce::FileInputStream in(indexFile);
+    if (!in.openedOk())
+        return;
+
+    juce::GZIPDecompressorInputStream unzipped(in);
+    auto tree = juce::ValueTree::readFromStream(unzipped);
+    if (!tree.hasType("PresetIndex") || (int)tree.getProperty("version") != indexVersion)
+        return;
+
+    std::vector<Entry> loaded;
+    loaded.reserve((size_t)tree.getNumChildren());
+    for (const auto& child : tree) {
+        Entry e;
+        e.file = folder.getChildFile(child.getProperty("path").toString());
+        e.name = child.getProperty("name").toString();
+        e.tags.addLines(child.getProperty("tags").toString());
+        e.nodeTypes.addLines(child.getProperty("types").toString());
+        e.tags.removeEmptyStrings();
+        e.nodeTypes.removeEmptyStrings();
+        e.modified = (juce::int64)child.getProperty("modified");
+        e.size = (juce::int64)child.getProperty("size");
+        e.hash = child.getProperty("hash").toString();
+        e.isPreset = (bool)child.getProperty("isPreset", true);
+        makeSearchText(e);
+        loaded.push_back(std::move(e));
+    }
+
+    const std::lock_guard<std::mutex> lock(entriesLock);
+    entries = std::move(loaded);
+}
+
+void PresetLibrary::saveIndex(const std::vector<Entry>& list) const {
+    juce::ValueTree tree("PresetIndex");
+    tree.setProperty("version", indexVersion, nullptr);
+    for (auto& e : list) {
+        juce::ValueTree child("Preset");
+        child.setProperty("path", e.file.getRelativePathFrom(folder), nullptr);
+        child.setProperty("name", e.name, nullptr);
+        child.setProperty("tags", e.tags.joinIntoString("\n"), nullptr);
+        child.setProperty("types", e.nodeTypes.joinIntoString("\n"), nullptr);
+        child.setProperty("modified", e.modified, nullptr);
+        child.setProperty("size", e.size, nullptr);
+        child.setProperty("hash", e.hash, nullptr);
+        child.setProperty("isPreset", e.isPreset, nullptr);
+        tree.appendChild(child, nullptr);
+    }
+
+    // written to a temp file first so a crash never leaves half an index
+    indexFile.getParentDirectory().createDirectory();
+    juce::TemporaryFile temp(indexFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return;
+        juce::GZIPCompressorOutputStream zipped(out);
+        tree.writeToStream(zipped);
+    }
+    temp.overwriteTargetFileWithTemporary();
+}
@@ -10,12 +10,14 @@ CompressorProcessor::CompressorProcessor(){}
 void CompressorProcessor::prepare(const double sRate){
     sampleRate = sRate;
     updateAttackAndRelease();
+    kernel.prepare(sampleRate);
 }
 
 // Setters for user controlled parameters
 // This one in particular does not convert the value from decibels like the noise gate did, as it will be useful to have it in dB later on
 void CompressorProcessor::setThreshold(float thresholdInDB){
     thresholdDB = thresholdInDB;
+    kernel.computer.thresholdDB = thresholdDB;
 }
 
 // For the ratio, it is assumed that the ratio value will be to 1, meaning that no values below 1 are accepted because those will work in the opposite direction
@@ -25,6 +27,7 @@ void CompressorProcessor::setRatio(float ratioValue){
     }else{
         ratio = ratioValue;
     }
+    kernel.computer.ratio = ratio;
 }
 
 void CompressorProcessor::setAttack(float attackInMS){
@@ -37,63 +40,23 @@ void CompressorProcessor::setRelease(float releaseInMS){
     updateAttackAndRelease();
 }
 
+void CompressorProcessor::setLookahead(float lookaheadInMS){
+    kernel.setLookahead(lookaheadInMS);
+}
+
+int CompressorProcessor::getLatencySamples() const{
+    return kernel.getLatencySamples();
+}
+
 // Calculates the smoothing coefficients for the envelope detector. See NoiseGateProcessor.cpp for a clearer explanation, as this reuses the code from there
 void CompressorProcessor::updateAttackAndRelease(){
-    attackCoeff = exp(-3.5f / (0.001f * attackTime * sampleRate + 0.0000001f));
-    releaseCoeff = exp(-0.9f / (0.001f * releaseTime * sampleRate + 0.0000001f));
+    kernel.computer.ballistics.attackCoeff = exp(-3.5f / (0.001f * attackTime * sampleRate + 0.0000001f));
+    kernel.computer.ballistics.releaseCoeff = exp(-0.9f / (0.001f * releaseTime * sampleRate + 0.0000001f));
 }
 
 // The main processing loop. This operates very similarly to the noise gate
+// The kernel tracks the loudest channel with the envelope, then converts the envelope to dB. If it's above the threshold,
+// the difference is scaled by the ratio to get how much to reduce the gain by, which is then converted back to a multiplier for all channels
 void CompressorProcessor::process(juce::AudioBuffer<float>& buffer){
-
-    juce::ScopedNoDenormals noDenormals;
-
-    // Gathering information on the buffer
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
-
-    //This function iterates through the samples, checking the channel with the maximum volume in the given sample
-    //That value is stored and then used to determine what the state of the envelope should be
-    for(int i = 0; i < numSamples; i++){
-        float maxSample = 0.0f;
-        for(int j = 0;j < numChannels; j++){
-            maxSample = std::max(maxSample, abs(buffer.getSample(j, i)));
-        }
-
-        //Adjust the envelope with respect to the maximum volume
-        //This uses the same calculation as the noise gate does. See that for a deeper explanation of the envelope's curve
-        //The only difference is that it is multiplied by the maxSample rather than a targetEnvelope
-        //The goal is to track the maxSample on a curve to then use it in calculations of gain to apply
-        if(maxSample > envelope){
-            //The envelope moves toward the louder sample
-            envelope = attackCoeff * envelope + (1.0f - attackCoeff) * maxSample;
-        }else{
-            envelope = releaseCoeff * envelope + (1.0f - releaseCoeff) * maxSample;
-        }
-
-        //Calculating the gain multiplier based on the envelope value
-        //Initializing
-        float gainReductionDB = 0.0f;
-
-        //converting the envelope decibels into gain. This uses -100 as a floor value, representing silence
-        float envelopeDB = juce::Decibels::gainToDecibels(envelope,-100.0f);
-
-        //If the envelope is above the threshold, calculate the gain reduction
-        if(envelopeDB > thresholdDB){
-            //This function utilizes the threshold and envelope values in decibels to see the difference
-            //Then it utilizes the ratio defined by the user to calculate how much to reduce the gain by
-            gainReductionDB = (envelopeDB - thresholdDB) * (1.0f - (1.0f / ratio));
-        }
-
-        //Convert the dB reduction into a linear gain multiplier
-        //The gainReductionDB is negative because the sound needs to be reduced
-        float gainMultiplier = juce::Decibels::decibelsToGain(-gainReductionDB);
-
-        //Now, the gain is actually applied to all channels for the current sample
-        for(int j = 0;j < numChannels; j++){
-            float* channelData = buffer.getWritePointer(j);
-            channelData[i] *= gainMultiplier;
-        }
-    }
-
+    kernel.process(buffer);
 }
\ No newline at end of file
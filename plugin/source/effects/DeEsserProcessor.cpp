@@ -3,25 +3,24 @@
 #include "Pitchblade/effects/DeEsserProcessor.h"
 
 DeEsserProcessor::DeEsserProcessor()
-    : forwardFFT(fftOrder),
-        window(fftSize,juce::dsp::WindowingFunction<float>::hann)
 {
-    //Initialize buffers
-    fftInputBuffer.resize(fftSize,0.0f);
-    fftData.resize(fftSize * 2,0.0f);
-
-    //Visualizer stuff
-    currentSpectrumData.resize(fftSize / 2 + 1);
+    //Start the kernel off with the default settings
+    kernel.computer.thresholdDB = threshold;
+    kernel.computer.ratio = ratio;
 }
 
 void DeEsserProcessor::prepare(double sRate, int samplesPerBlock){
     sampleRate = sRate;
     updateAttackAndRelease();
     updateFilter();
+    kernel.prepare(sampleRate);
 
     //Reset envelopes
-    envelope = 0.0f;
-    rippleEnvelope = 0.0f;
+    kernel.reset();
+
+    //TC-15 and TC-17
+    //Fixed release coefficient for ripple smoother
+    kernel.detector.rippleReleaseCoeff = std::exp(-1.0f / (0.001f * 10.0f * sampleRate));
 
     //Prepare the IIR filters with the process spec
     juce::dsp::ProcessSpec spec;
@@ -29,25 +28,24 @@ void DeEsserProcessor::prepare(double sRate, int samplesPerBlock){
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = 2;
 
-    for(auto& filter : sidechainFilters){
+    for(auto& filter : kernel.detector.sidechainFilters){
         filter.prepare(spec);
         filter.reset();
     }
 
     //Visualizer related
-    std::fill(fftInputBuffer.begin(),fftInputBuffer.end(),0.0f);
-    std::fill(fftData.begin(),fftData.end(),0.0f);
-    fftInputBufferPos = 0;
-    currentSpectrumData.resize(fftSize / 2 + 1);
+    analysisTap.prepare(sampleRate);
 }
 
 //Setters for user controlled parameters
 void DeEsserProcessor::setThreshold(float thresholdDB){
     threshold=thresholdDB;
+    kernel.computer.thresholdDB = threshold;
 }
 
 void DeEsserProcessor::setRatio(float ratioValue){
     ratio=ratioValue;
+    kernel.computer.ratio = ratio;
 }
 
 void DeEsserProcessor::setAttack(float attackMs){
@@ -61,15 +59,36 @@ void DeEsserProcessor::setRelease(float releaseMs){
 }
 
 void DeEsserProcessor::setFrequency(float frequencyInHz){
+    //The node sets this every block, and redesigning the filters allocates, so only do it when the frequency moves
+    if(frequencyInHz == frequency){
+        return;
+    }
     frequency = frequencyInHz;
     updateFilter();
 }
 
+void DeEsserProcessor::setLookahead(float lookaheadMs){
+    kernel.setLookahead(lookaheadMs);
+}
+
+void DeEsserProcessor::setSplitBand(bool shouldSplit){
+    auto& stage = kernel.gainStage;
+    if(stage.splitBand != shouldSplit){
+        stage.splitBand = shouldSplit;
+        //The bell hasn't been running in wideband mode, so start it from silence
+        stage.reset();
+    }
+}
+
+int DeEsserProcessor::getLatencySamples() const{
+    return kernel.getLatencySamples();
+}
+
 //Calculates the smoothing coefficients for the envelope
 void DeEsserProcessor::updateAttackAndRelease(){
     //For TC-15 and 17, I updated the attack to be more aggressive
-    attackCoeff = exp(-7.0f / (0.001f * attackTime * sampleRate + 0.0000001f));
-    releaseCoeff = exp(-1.0f / (0.001f * releaseTime * sampleRate + 0.0000001f));
+    kernel.computer.ballistics.attackCoeff = exp(-7.0f / (0.001f * attackTime * sampleRate + 0.0000001f));
+    kernel.computer.ballistics.releaseCoeff = exp(-1.0f / (0.001f * releaseTime * sampleRate + 0.0000001f));
 }
 
 //Calculates the coefficients for the sidechain band-pass filter
@@ -79,160 +98,113 @@ void DeEsserProcessor::updateFilter(){
     auto coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate,frequency,1.0f);
 
     //Assign the new coefficients to both stereo filters
-    for(auto& filter : sidechainFilters){
+    for(auto& filter : kernel.detector.sidechainFilters){
         filter.coefficients = coefficients;
     }
-}
 
-//Main processing loop
-void DeEsserProcessor::process(juce::AudioBuffer<float>& buffer){
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
-
-    //TC-15 and TC-17
-    //Fixed release coefficient for ripple smoother
-    const float rippleReleaseCoeff = std::exp(-1.0f / (0.001f * 10.0f * sampleRate));
-
-    for(int i = 0;i < numSamples; i++){
-        //Find loudest sibilant sample across all channels
-        float sidechainSample = 0.0f;
-        float monoInputSample = 0.0f; //Needed for visualizer
-        for(int j = 0; j < numChannels; j++){
-            //Get the unfiltered audio sample
-            float originalSample = buffer.getSample(j,i);
-            monoInputSample += originalSample;
-
-            //Apply the sidechain filter to isolate sibilant frequencies
-            //This does not affect the main audio
-            float filteredSample = sidechainFilters[j].processSample(originalSample);
-
-            //Find the peak
-            sidechainSample = std::max(sidechainSample, std::abs(filteredSample));
-        }
+    //The split-band bell uses the same centre and Q as the detector. This only runs when the frequency or sample rate changes
+    kernel.gainStage.setBell(sampleRate, frequency, 1.0f);
+}
 
-        //Average mono sample
-        if(numChannels > 0){
-            monoInputSample /= (float)numChannels;
-        }
+//Works out the state variable filter coefficients for the split-band bell
+void DeEsserProcessor::SibilanceGainStage::setBell(double sampleRate, float frequencyInHz, float q){
+    //Keep the centre safely under Nyquist so tan doesn't blow up
+    const double centre = std::min((double)frequencyInHz, 0.49 * sampleRate);
+    g = (float)std::tan(juce::MathConstants<double>::pi * centre / sampleRate);
+    k = 1.0f / q;
+    a1 = 1.0f / (1.0f + g * (g + k));
+    a2 = g * a1;
+    a3 = g * a2;
+}
 
-        //TC-15 and TC-17
-        //Converts the sine wave into a stable peak value
-        if (sidechainSample > rippleEnvelope) {
-            rippleEnvelope = sidechainSample;
-        } else {
-            rippleEnvelope = rippleReleaseCoeff * rippleEnvelope + (1.0f - rippleReleaseCoeff) * sidechainSample;
-        }
+void DeEsserProcessor::SibilanceGainStage::reset(){
+    ic1.fill(0.0f);
+    ic2.fill(0.0f);
+}
 
-        //Envelope detection. The envelope tracks the loudness of the sibilance
-        //TC-15 and TC-17
-        //Changed this from sidechainSample to rippleEnvelope, since it's more stable
-        if(rippleEnvelope > envelope){
-            envelope = attackCoeff * envelope + (1.0f - attackCoeff) * rippleEnvelope;
-        }else{
-            envelope = releaseCoeff * envelope + (1.0f - releaseCoeff) * rippleEnvelope;
+//Apply pass for the kernel
+void DeEsserProcessor::SibilanceGainStage::apply(float* const* channels, int numChannels, int numSamples, const float* gain){
+    if(!splitBand){
+        for(int ch = 0; ch < numChannels; ch++){
+            juce::FloatVectorOperations::multiply(channels[ch], gain, numSamples);
         }
+        return;
+    }
 
-        //Gain calculation (identical to compressor)
-        float gainReductionDB = 0.0f;
-        float envelopeDB = juce::Decibels::gainToDecibels(envelope,-100.0f);
-
-        if(envelopeDB > threshold){
-            gainReductionDB = (envelopeDB - threshold) * (1.0f - (1.0f / ratio));
+    //Only the first two channels have bell state, same as the sidechain filters. Anything past that falls back to wideband
+    const int numSplit = std::min(numChannels, (int)ic1.size());
+    for(int ch = 0; ch < numSplit; ch++){
+        float* data = channels[ch];
+        float s1 = ic1[ch];
+        float s2 = ic2[ch];
+        for(int i = 0; i < numSamples; i++){
+            const float x = data[i];
+            const float v3 = x - s2;
+            const float v1 = a1 * s1 + a2 * v3;
+            const float v2 = s2 + a2 * s1 + a3 * v3;
+            s1 = 2.0f * v1 - s1;
+            s2 = 2.0f * v2 - s2;
+            //k * v1 is the band-pass output with unity gain at the centre
+            data[i] = x - (1.0f - gain[i]) * k * v1;
         }
+        ic1[ch] = s1;
+        ic2[ch] = s2;
+    }
+    for(int ch = numSplit; ch < numChannels; ch++){
+        juce::FloatVectorOperations::multiply(channels[ch], gain, numSamples);
+    }
+}
 
-        float gainMultiplier = juce::Decibels::decibelsToGain(-gainReductionDB);
+//Resets the detector state
+void DeEsserProcessor::SibilanceDetector::reset(){
+    rippleEnvelope = 0.0f;
+    for(auto& filter : sidechainFilters){
+        filter.reset();
+    }
+}
 
-        //Apply gain
-        for(int j = 0; j < numChannels; j++){
-            float* channelData = buffer.getWritePointer(j);
-            channelData[i] *= gainMultiplier;
+//Detector pass for the kernel. Finds the loudest sibilant sample across all channels
+void DeEsserProcessor::SibilanceDetector::detect(const float* const* channels, int numChannels, int numSamples, float* sidechain){
+    std::fill(sidechain, sidechain + numSamples, 0.0f);
+
+    //Apply the sidechain filter to isolate sibilant frequencies
+    //This does not affect the main audio. Only the first two channels have filters, which covers mono and stereo
+    const int numFiltered = std::min(numChannels, (int)sidechainFilters.size());
+    for(int j = 0; j < numFiltered; j++){
+        auto& filter = sidechainFilters[j];
+        const float* data = channels[j];
+        for(int i = 0; i < numSamples; i++){
+            //Find the peak
+            sidechain[i] = std::max(sidechain[i], std::abs(filter.processSample(data[i])));
         }
+    }
 
-        //Apply the gain to the mono sample as well
-        float processedMonoSample = monoInputSample * gainMultiplier;
-
-        //Visualizer buffering
-        //Overlap add input for visualizer
-        fftInputBuffer[fftInputBufferPos++] = processedMonoSample;
-
-        //Process frame
-        if(fftInputBufferPos == fftSize){
-            processVisualizerFrame();
-
-            //Shift input buffer
-            std::memmove(fftInputBuffer.data(),fftInputBuffer.data() + hopSize,overlap * sizeof(float));
-            //Clear the end of the buffer
-            std::fill(fftInputBuffer.data() + overlap,fftInputBuffer.data() + fftSize, 0.0f);
-            //Reset the write pointer
-            fftInputBufferPos = overlap;
+    //TC-15 and TC-17
+    //Converts the sine wave into a stable peak value. The kernel's envelope then follows this instead of the raw sidechain, since it's more stable
+    for(int i = 0; i < numSamples; i++){
+        if(sidechain[i] > rippleEnvelope){
+            rippleEnvelope = sidechain[i];
+        }else{
+            rippleEnvelope = rippleReleaseCoeff * rippleEnvelope + (1.0f - rippleReleaseCoeff) * sidechain[i];
         }
-
+        sidechain[i] = rippleEnvelope;
     }
-
 }
 
-//New visualizer functions
-void DeEsserProcessor::processVisualizerFrame(){
-    juce::ScopedNoDenormals noDenormals;
-    //Window the input buffer
-    std::copy(fftInputBuffer.begin(),fftInputBuffer.end(),fftData.begin());
-    window.multiplyWithWindowingTable(fftData.data(),fftSize);
-
-    //Clear imaginary part
-    std::fill(fftData.data() + fftSize,fftData.data() + fftSize * 2, 0.0f);
-
-    //Perform forward FFT
-    forwardFFT.performRealOnlyForwardTransform(fftData.data());
-
-    const int numBins = fftSize / 2 + 1;
-    std::vector<juce::Point<float>> spectrumSnapshot(numBins);
-
-    // Handle first and last bins
-    {
-        float magnitude0 = fftData[0];
-        float magnitude1024 = fftData[1];
-        spectrumSnapshot[0].setXY(20.0f,juce::Decibels::gainToDecibels(magnitude0,-100.0f));
-        spectrumSnapshot[numBins-1].setXY((float)(numBins - 1) * sampleRate / (float)fftSize,juce::Decibels::gainToDecibels(magnitude1024,-100.0f));
-    }
+//Main processing loop
+void DeEsserProcessor::process(juce::AudioBuffer<float>& buffer){
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = buffer.getNumChannels();
 
-    //Cycling through
-    for(int i = 1; i < (numBins-1); i++){
-        float real = fftData[i * 2];
-        float imag = fftData[i * 2 + 1];
-        float magnitude = std::sqrt(real * real + imag * imag);
-        
-        spectrumSnapshot[i].setXY((float)i * sampleRate / (float)fftSize,juce::Decibels::gainToDecibels(magnitude, -100.0f));
-    }
+    //Detect, compute gain and apply it to all channels
+    kernel.process(buffer);
 
-    //Apply smoothing
-    const int smoothingAmount = 3;
-    std::vector<juce::Point<float>> smoothedSpectrum(numBins);
-    for (int i = 0; i < numBins; ++i)
-    {
-        float spectrumSum = 0.0f;
-        int numPoints = 0;
-        for (int j = -smoothingAmount; j <= smoothingAmount; ++j)
-        {
-            int index = i + j;
-            if (index >= 0 && index < numBins)
-            {
-                spectrumSum += spectrumSnapshot[index].getY();
-                numPoints++;
-            }
-        }
-        smoothedSpectrum[i].setXY(spectrumSnapshot[i].getX(), spectrumSum / (float)numPoints);
+    if(numChannels == 0){
+        return;
     }
 
-    //Lock the mutex and swap the data
-    {
-        juce::ScopedLock lock(dataMutex);
-        currentSpectrumData = std::move(smoothedSpectrum);
+    //Only copy audio out for the visualizer while it is on screen
+    if(analysisTap.isActive()){
+        analysisTap.pushMono(buffer.getArrayOfReadPointers(), numChannels, numSamples);
     }
 }
-
-//Getter for visualizer data
-std::vector<juce::Point<float>> DeEsserProcessor::getSpectrumData()
-{
-    juce::ScopedLock lock(dataMutex);
-    return currentSpectrumData;
-}
\ No newline at end of file
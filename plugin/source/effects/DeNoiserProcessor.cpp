@@ -1,40 +1,109 @@
 //Austin Hills
 
 #include "Pitchblade/effects/DeNoiserProcessor.h"
+#include <complex>
 
 //Constructor
-DeNoiserProcessor::DeNoiserProcessor() :
-    forwardFFT(fftOrder),
-    //Adding the below will fix the errors relating to added gain in the denoiser. Going to do fully when unit testing
-    window(fftSize,juce::dsp::WindowingFunction<float>::hann, false)
-{
-    //Initialize buffers
-    inputBuffer.resize(fftSize,0.0f);
-    outputBuffer.resize(fftSize,0.0f);
-    fftData.resize(fftSize * 2,0.0f);
-    noiseProfile.resize(fftSize / 2 + 1,0.0f);
+DeNoiserProcessor::DeNoiserProcessor(){
+    //Buffers, FFTs and windows are all made in prepare
+    displayProfile.resize(displayBins,0.0f);
+    prepare(sampleRate);
+}
 
-    //Visualizer stuff
-    currentSpectrumData.resize(fftSize / 2 + 1);
-    noiseProfileData.resize(fftSize / 2 + 1);
+int DeNoiserProcessor::orderForMode(FFTMode modeValue, double sRate){
+    //One step up for each doubling past 48k, so 96k gets twice the size and 192k four times
+    //Before prepare the rate is 0, and log2 of that can't be turned into an int, so it counts as 48k
+    const int rateSteps = sRate > 48000.0 ? (int)std::round(std::log2(sRate / 48000.0)) : 0;
+    return modeOrders[(size_t)modeValue] + rateSteps;
 }
 
-void DeNoiserProcessor::prepare(const double sRate){
+void DeNoiserProcessor::prepare(const double sRate, int numChannels){
     sampleRate = sRate;
 
-    //reset buffers and state
-    std::fill(inputBuffer.begin(),inputBuffer.end(),0.0f);
-    std::fill(outputBuffer.begin(),outputBuffer.end(),0.0f);
-    std::fill(noiseProfile.begin(),noiseProfile.end(),0.0f);
-    std::fill(fftData.begin(),fftData.end(),0.0f);
+    //Make an STFT engine for every mode, so a mode change later on only has to point at a different one
+    int maxBins = 0;
+    for(int m = 0; m < numModes; m++){
+        const int order = orderForMode((FFTMode)m, sampleRate);
+        engines[(size_t)m].prepare(order, (1 << order) / 4, numChannels);
+        maxBins = std::max(maxBins, engines[(size_t)m].getNumBins());
+    }
+
+    //Size everything for the biggest mode
+    noiseProfile.resize((size_t)maxBins,0.0f);
+    noiseProfileScratch.resize((size_t)maxBins,0.0f);
+
+    //Per bin gain buffers
+    binMagnitudes.resize((size_t)maxBins,0.0f);
+    targetGains.resize((size_t)maxBins,1.0f);
+    smoothedTargets.resize((size_t)maxBins,1.0f);
+    binGains.resize((size_t)maxBins,1.0f);
 
-    inputBufferPos = 0;
-    outputBufferPos = 0;
-    noiseProfileSamples = 0;
+    noiseTracker.reserve(maxBins);
 
     //Visualizer stuff
-    currentSpectrumData.resize(fftSize / 2 + 1);
-    noiseProfileData.resize(fftSize / 2 + 1);
+    analysisTap.prepare(sampleRate);
+
+    //Start from a clean slate in the current mode
+    applyMode(0);
+}
+
+void DeNoiserProcessor::applyMode(int previousBins){
+    stft = &engines[(size_t)mode];
+    stft->reset();
+    fftSize = stft->getFFTSize();
+    numBins = stft->getNumBins();
+
+    //Carry the noise profile over to the new bin layout, or clear it if there isn't one
+    if(previousBins > 0){
+        std::copy(noiseProfile.begin(),noiseProfile.begin() + previousBins,noiseProfileScratch.begin());
+        resampleProfile(noiseProfileScratch.data(),previousBins,noiseProfile.data(),numBins);
+    }else{
+        std::fill(noiseProfile.begin(),noiseProfile.end(),0.0f);
+        noiseProfileSamples = 0;
+        hasNoiseProfile = false;
+    }
+
+    //Start with every bin fully open
+    std::fill(binGains.begin(),binGains.end(),1.0f);
+
+    //Gain smoothing coefficients, per hop
+    const double hopMs = 1000.0 * stft->getHopSize() / sampleRate;
+    gainRiseCoeff = (float)std::exp(-hopMs / GAIN_RISE_MS);
+    gainFallCoeff = (float)std::exp(-hopMs / GAIN_FALL_MS);
+
+    //Noise tracking works per frame as well. It picks up from the carried over profile
+    noiseTracker.prepare(numBins, hopMs);
+    if(hasNoiseProfile && !isLearning){
+        noiseTracker.seed(noiseProfile.data());
+    }
+
+    publishNoiseProfile();
+}
+
+void DeNoiserProcessor::resampleProfile(const float* source, int sourceBins, float* dest, int destBins){
+    //Each destination bin covers this many source bins
+    const float ratio = (float)(sourceBins - 1) / (float)(destBins - 1);
+    const float scale = std::sqrt(1.0f / ratio);
+
+    for(int i = 0; i < destBins; i++){
+        const float centre = (float)i * ratio;
+        float value = 0.0f;
+        if(ratio <= 1.0f){
+            //Going to more bins, so blend the two nearest
+            const int low = std::min((int)centre, sourceBins - 2);
+            const float fraction = centre - (float)low;
+            value = source[low] + fraction * (source[low + 1] - source[low]);
+        }else{
+            //Going to fewer bins, so average every source bin this one covers
+            const int first = std::max(0, (int)std::ceil(centre - ratio * 0.5f));
+            const int last = std::min(sourceBins - 1, (int)std::floor(centre + ratio * 0.5f));
+            for(int j = first; j <= last; j++){
+                value += source[j];
+            }
+            value /= (float)std::max(1, last - first + 1);
+        }
+        dest[i] = value * scale;
+    }
 }
 
 //Setters for user controlled parameters
@@ -42,246 +111,154 @@ void DeNoiserProcessor::setReduction(float reduction){
     reductionAmount = reduction;
 }
 
+void DeNoiserProcessor::setFFTMode(FFTMode newMode){
+    if(newMode != mode){
+        const int previousBins = numBins;
+        mode = newMode;
+        //A profile that is partway through learning is a running total, which resamples just as well as a finished one
+        applyMode((hasNoiseProfile || isLearning) ? previousBins : 0);
+    }
+}
+
 void DeNoiserProcessor::setLearning(bool learning){
     if(learning){
         //If starting to learn, reset the noise profile
         if(!isLearning){
             std::fill(noiseProfile.begin(),noiseProfile.end(),0.0f);
             noiseProfileSamples = 0;
+            hasNoiseProfile = false;
+            isLearning = true;
+            publishNoiseProfile();
         }
-        isLearning = true;
     }else{
         //If stopping learning, average the collected profile
-        if(isLearning && (noiseProfileSamples > 0)){
-            for(int i = 0; i < noiseProfile.size(); i++){
-                float& bin = noiseProfile[i];
-                bin /= (float)noiseProfileSamples;
+        if(isLearning){
+            if(noiseProfileSamples > 0){
+                for(int i = 0; i < numBins; i++){
+                    float& bin = noiseProfile[i];
+                    bin /= (float)noiseProfileSamples;
+                }
+                hasNoiseProfile = true;
+
+                //Tracking carries on from what was just learned
+                noiseTracker.seed(noiseProfile.data());
             }
+            isLearning = false;
+
+            //The profile only changes while learning, so this is where the finished one is sent to the visualizer
+            publishNoiseProfile();
         }
+    }
+}
+
+void DeNoiserProcessor::setAdaptive(bool adaptive){
+    if(adaptive && !isAdaptive){
+        //Pick up from the current profile if there is one, otherwise start from whatever the next frame is
+        if(hasNoiseProfile){
+            noiseTracker.seed(noiseProfile.data());
+        }else{
+            noiseTracker.reset();
+        }
+    }
+    isAdaptive = adaptive;
+}
+
+void DeNoiserProcessor::publishNoiseProfile(){
+    //Lay the profile out for the visualizer's FFT size
+    resampleProfile(noiseProfile.data(), numBins, displayProfile.data(), displayBins);
 
-        isLearning = false;
+    //While learning, the profile is still a running total, so divide it down to match what it will be once learning stops
+    if(isLearning && noiseProfileSamples > 0){
+        juce::FloatVectorOperations::multiply(displayProfile.data(), 1.0f / (float)noiseProfileSamples, displayBins);
     }
+    noiseProfileTap.publish(displayProfile.data());
 }
 
 //Main processing loop
 void DeNoiserProcessor::process(juce::AudioBuffer<float>& buffer){
     juce::ScopedNoDenormals noDenormals;
 
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
+    //The engine handles the windowing and overlap add, and calls back here once per hop
+    stft->process(buffer, [this](std::complex<float>* const* spectra, int numChannels){
+        processFrame(spectra, numChannels);
+    });
 
-    for(int i = 0; i < numSamples; i++){
-        //Get mono mix sample
-        float inputSample = 0.0f;
-        for(int j = 0; j < numChannels; j++){
-            inputSample += buffer.getSample(j,i);
-        }
-        if(numChannels > 0){
-            inputSample /= (float)numChannels;
-        }
-
-        //Overlap add input
-        inputBuffer[inputBufferPos++] = inputSample;
-
-        //Get output sample
-        float outputSample = outputBuffer[outputBufferPos++];
-
-        //Write output sample to all channels
-        for(int j = 0; j < numChannels; j++){
-            buffer.setSample(j,i,outputSample);
-        }
-
-        //Process frame
-        //If the input buffer's position is equal to the size of the fft, then send it off for processing
-        if(inputBufferPos == fftSize){
-            //Moving output buffer logic up to see if it fixes the choppy audio. It's like gambling
-            std::memmove(outputBuffer.data(),outputBuffer.data() + hopSize,overlap * sizeof(float));
-            std::fill(outputBuffer.data() + overlap,outputBuffer.data() + fftSize,0.0f);
-            outputBufferPos = 0;
-            
-            processFrame();
-
-            //Shift input buffer to prepare for the next samples
-            std::memmove(inputBuffer.data(),inputBuffer.data() + hopSize,overlap * sizeof(float));
-            //Clear the end of the buffer
-            std::fill(inputBuffer.data() + overlap,inputBuffer.data() + fftSize, 0.0f);
-            //Reset the write pointer
-            inputBufferPos = overlap;
-        }
+    //Only copy audio out for the visualizer while it is on screen
+    if(analysisTap.isActive()){
+        analysisTap.pushMono(buffer.getArrayOfReadPointers(), std::min(buffer.getNumChannels(), stft->getNumChannels()), buffer.getNumSamples());
     }
 }
 
 //Processing of the frame, either for learning or cleaning data
-void DeNoiserProcessor::processFrame(){
+void DeNoiserProcessor::processFrame(std::complex<float>* const* spectra, int numChannels){
     juce::ScopedNoDenormals noDenormals; //I really hope this fixes the static
-    //Window the input buffer
-    std::copy(inputBuffer.begin(),inputBuffer.end(),fftData.begin());
-    window.multiplyWithWindowingTable(fftData.data(),fftSize);
-
-    //Clear imaginary part
-    std::fill(fftData.data() + fftSize,fftData.data() + fftSize * 2, 0.0f);
-
-    //Perform forward FFT
-    forwardFFT.performRealOnlyForwardTransform(fftData.data());
-
-    //Process magnitudes and phases so fftData contains complex numbers in packed format
-    const int numBins = fftSize / 2 + 1;
-
-    //Visualizer temp vectors to avoid locking mutex during processing
-    std::vector<juce::Point<float>> spectrumSnapshot(numBins);
-    std::vector<juce::Point<float>> noiseSnapshot(numBins);
-    
-    //Storing the value of isLearning within this context so that the next part happens faster
-    bool learning = isLearning;
-
-    //Was having crackling issues, and I thought that separating the special cases (first and last bins) would help
-    //Using curly brackets to separate it so I can use variable names without worrying if they are repeated later on
-    {
-        float magnitude0 = fftData[0];
-        float magnitude1024 = fftData[1];
-
-        float noiseMag0 = noiseProfile[0];
-        float noiseMag1024 = noiseProfile[numBins - 1];
-
-        if(learning){
-            noiseProfile[0] += magnitude0;
-            noiseProfile[numBins - 1] += magnitude1024;
-        }else{
-            float reduction0 = noiseMag0 * (reductionAmount * POWER_MULTIPLIER);
-            float reduction1024 = noiseMag1024 * (reductionAmount * POWER_MULTIPLIER);
 
-            float reducedMag0 = std::max(0.0f,magnitude0-reduction0);
-            float reducedMag1024 = std::max(0.0f,magnitude1024-reduction1024);
-
-            float floor0 = magnitude0 * 0.001f;
-            float floor1024 = magnitude1024 * 0.001f;
-            
-            fftData[0] = std::max(reducedMag0,floor0);
-            fftData[1] = std::max(reducedMag1024,floor1024);
+    //Find the magnitude of every bin, averaged across channels. This drives both the noise profile and the shared gain mask
+    //No phase is needed, since the gain below is applied straight to the real and imag parts
+    std::fill(binMagnitudes.begin(),binMagnitudes.end(),0.0f);
+    for(int ch = 0; ch < numChannels; ch++){
+        const auto* bins = spectra[ch];
+        for(int i = 0; i < numBins; i++){
+            binMagnitudes[i] += std::sqrt(std::norm(bins[i]));
         }
-
-        //Gathering stuff for visualizer
-        spectrumSnapshot[0].setXY(20.0f,juce::Decibels::gainToDecibels(magnitude0,-100.0f));
-        spectrumSnapshot[numBins-1].setXY((float)(numBins - 1) * sampleRate / (float)fftSize,juce::Decibels::gainToDecibels(magnitude1024,-100.0f));
-        noiseSnapshot[0].setXY(20.0f,juce::Decibels::gainToDecibels(noiseMag0,-100.0f));
-        noiseSnapshot[numBins-1].setXY((float)(numBins - 1) * sampleRate / (float)fftSize,juce::Decibels::gainToDecibels(noiseMag1024,-100.0f));
     }
-
-    //Cycling through
-    for(int i = 1; i < (numBins-1); i++){
-        float real;
-        float imag;
-        //Unpacking parts for the ith frequency bins
-        real = fftData[i * 2];
-        imag = fftData[i * 2 + 1];
-
-        //Magnitude is the strength of the frequency
-        float magnitude = std::sqrt(real * real + imag * imag);
-        //Phase is the timing if the frequency's wave (from what I understand). Messing with this will do bad things to the audio, so leave it unchanged
-        float phase = std::atan2(imag, real);
-
-        if(learning){
-            //Accumulate info for noise profile
-            noiseProfile[i] += magnitude;
-        }else{
-            //Spectral subtraction
-            //This part is the actual denoising part that uses the noiseProfile and reductionAmount as keys to determine how much and what to reduce
-            float noiseMag = noiseProfile[i];
-            //Calculates the amount to subtract from a given frequency based on the average magnitude during learning.
-            //Multiplying allows the sweet spot to be close to 50% of the slider with the ability to subtract more if desired 
-            float reduction = noiseMag * (reductionAmount * POWER_MULTIPLIER);
-
-            //Make reduce the magnitude of the frequency using the reduction. If that results in a value below 0, just use 0 instead
-            float reducedMag = std::max(0.0f, magnitude - reduction);
-
-            //If the sound is complete silence, then don't completely make it empty. Give a little bit of noise (can be removed with noise gate)
-            //This is to prevent artifacting in the sound 
-            float floor = magnitude * 0.001f;
-
-            //This is the final decision, and it chooses the greater value between the reducedMag and the floor value
-            magnitude = std::max(reducedMag,floor);
-        }
-
-        //Reconstruct the frequencies
-        //Calculate new real part
-        fftData[i * 2] = magnitude * std::cos(phase);
-        //Calculate new imag part
-        fftData[i * 2 + 1] = magnitude * std::sin(phase);
-
-        //Visualizer stuff
-        spectrumSnapshot[i].setXY((float)i * sampleRate / (float)fftSize,juce::Decibels::gainToDecibels(magnitude, -100.0f));
-        noiseSnapshot[i].setXY((float)i * sampleRate / (float)fftSize,juce::Decibels::gainToDecibels(noiseProfile[i],-100.0f));
-
+    if(numChannels > 1){
+        juce::FloatVectorOperations::multiply(binMagnitudes.data(),1.0f / (float)numChannels,numBins);
     }
 
-    //increment noiseProfileSamples if it is learning for use in averaging later on
-    if(learning){
+    if(isLearning){
+        //Accumulate info for noise profile
+        juce::FloatVectorOperations::add(noiseProfile.data(),binMagnitudes.data(),numBins);
+
+        //increment noiseProfileSamples if it is learning for use in averaging later on
         noiseProfileSamples++;
-    }
 
-    //Performing the inverse FFT function! This is putting those pieces back together into an actual bit of audio!
-    forwardFFT.performRealOnlyInverseTransform(fftData.data());
+        //Let the visualizer watch the profile build up
+        if(analysisTap.isActive()){
+            publishNoiseProfile();
+        }
+    }else{
+        //Let the profile follow the noise floor as it drifts
+        if(isAdaptive){
+            noiseTracker.process(binMagnitudes.data(),noiseProfile.data());
+            hasNoiseProfile = true;
 
-    //Apply the window to the processed audio sitting in fftData
-    window.multiplyWithWindowingTable(fftData.data(),fftSize);
+            if(analysisTap.isActive()){
+                publishNoiseProfile();
+            }
+        }
 
-    //Normalize the audio so its level is correct
-    juce::FloatVectorOperations::multiply(fftData.data(),1.0f/1.5f,fftSize);
+        //Spectral subtraction as a gain
+        //Subtracting the scaled noise magnitude from the magnitude is the same as multiplying the bin by (1 - reduction / magnitude)
+        //Multiplying allows the sweet spot to be close to 50% of the slider with the ability to subtract more if desired
+        const float reductionScale = reductionAmount * POWER_MULTIPLIER;
+        for(int i = 0; i < numBins; i++){
+            const float gain = 1.0f - reductionScale * noiseProfile[i] / std::max(binMagnitudes[i], 1.0e-20f);
+            //If the sound is complete silence, then don't completely make it empty. This is to prevent artifacting in the sound
+            targetGains[i] = std::max(gain, GAIN_FLOOR);
+        }
 
-    //Add the processed sample back to the output buffer
-    for(int i = 0; i < fftSize; i++){
-        outputBuffer[i] += fftData[i];
-    }
+        //Smooth the gains across frequency. A single bin that pokes out of the noise for one frame is what makes the warbly "musical noise"
+        //Averaging it with its neighbours keeps it from standing out on its own
+        smoothedTargets[0] = 0.75f * targetGains[0] + 0.25f * targetGains[1];
+        for(int i = 1; i < numBins - 1; i++){
+            smoothedTargets[i] = 0.25f * targetGains[i - 1] + 0.5f * targetGains[i] + 0.25f * targetGains[i + 1];
+        }
+        smoothedTargets[numBins - 1] = 0.25f * targetGains[numBins - 2] + 0.75f * targetGains[numBins - 1];
 
-    //The graph was too spikey, so I figured I'd apply some smoothing to make it more readable
-    const int smoothingAmount = 3;
-
-    //Stores smoothed stuff
-    std::vector<juce::Point<float>> smoothedSpectrum(numBins);
-    std::vector<juce::Point<float>> smoothedNoise(numBins);
-
-    //Smoothing
-    for (int i = 0; i < numBins; ++i)
-    {
-        float spectrumSum = 0.0f;
-        float noiseSum = 0.0f;
-        int numPoints = 0;
-
-        // Create a moving average
-        for (int j = -smoothingAmount; j <= smoothingAmount; ++j)
-        {
-            int index = i + j;
-            if (index >= 0 && index < numBins)
-            {
-                spectrumSum += spectrumSnapshot[index].getY();
-                noiseSum += noiseSnapshot[index].getY();
-                numPoints++;
-            }
+        //Smooth the gains over time as well. Gains come back up quickly so speech onsets aren't softened, and go down slowly
+        for(int i = 0; i < numBins; i++){
+            const float target = smoothedTargets[i];
+            const float coeff = target > binGains[i] ? gainRiseCoeff : gainFallCoeff;
+            binGains[i] = target + coeff * (binGains[i] - target);
         }
-        
-        // Get the average and store it
-        // We keep the original frequency (X) but use the new averaged amplitude (Y)
-        smoothedSpectrum[i].setXY(spectrumSnapshot[i].getX(), spectrumSum / (float)numPoints);
-        smoothedNoise[i].setXY(noiseSnapshot[i].getX(), noiseSum / (float)numPoints);
-    }
 
-    //Lock the mutex and swap the data
-    {
-        juce::ScopedLock lock(dataMutex);
-        currentSpectrumData = std::move(smoothedSpectrum);
-        noiseProfileData = std::move(smoothedNoise);
+        //Apply the same gain to every channel, to the real and imag parts together
+        for(int ch = 0; ch < numChannels; ch++){
+            auto* bins = spectra[ch];
+            for(int i = 0; i < numBins; i++){
+                bins[i] *= binGains[i];
+            }
+        }
     }
 }
-
-//Visualizer getters
-std::vector<juce::Point<float>> DeNoiserProcessor::getSpectrumData()
-{
-    juce::ScopedLock lock(dataMutex);
-    return currentSpectrumData; // Returns a copy
-}
-
-std::vector<juce::Point<float>> DeNoiserProcessor::getNoiseProfileData()
-{
-    juce::ScopedLock lock(dataMutex);
-    return noiseProfileData; // Returns a copy
-}
\ No newline at end of file
@@ -8,203 +8,250 @@ static inline float dbToGain(float dB)
     return juce::Decibels::decibelsToGain(dB, -60.0f);
 }
 
+Equalizer::~Equalizer()
+{
+    builder.signalThreadShouldExit();
+    builder.notify();
+    builder.stopThread(2000);
+}
+
 void Equalizer::prepare(double sampleRate, int maxBlockSize, int numChannels)
 {
+    juce::ignoreUnused(maxBlockSize);
+
+    // the builder writes into the convolver, so it has to be stopped while things are resized
+    builder.signalThreadShouldExit();
+    builder.notify();
+    builder.stopThread(2000);
+
     sr = sampleRate;
     channels = juce::jmax(1, numChannels);
     isPrepared = true;
 
-    // initialise smoothed gains (store dB values, smooth on audio thread)
-    lowGainSmooth.reset(sr, smoothingTimeSeconds);
-    midGainSmooth.reset(sr, smoothingTimeSeconds);
-    highGainSmooth.reset(sr, smoothingTimeSeconds);
-    lowGainSmooth.setCurrentAndTargetValue(lowGainDb.load());
-    midGainSmooth.setCurrentAndTargetValue(midGainDb.load());
-    highGainSmooth.setCurrentAndTargetValue(highGainDb.load());
-
-    // track last applied freqs
-    lastLowFreqHz  = lowFreqHz.load();
-    lastMidFreqHz  = midFreqHz.load();
-    lastHighFreqHz = highFreqHz.load();
-
-    // allocate filter states per band/channel
-    auto makeBand = [this](Band& b)
+    lowBand.shape  = Shape::lowShelf;
+    midBand.shape  = Shape::peak;
+    highBand.shape = Shape::highShelf;
+
+    // initialise smoothed values and design each band once for where its knobs are now
+    auto setupBand = [this](Band& b, float hz, float dB)
     {
-        b.filters.clear();
-        b.filters.resize((size_t)channels);
-        for (auto& f : b.filters)
-           { f.reset();}
+        b.gainSmooth.reset(sr, smoothingTimeSeconds);
+        b.freqSmooth.reset(sr, smoothingTimeSeconds);
+        b.gainSmooth.setCurrentAndTargetValue(dB);
+        b.freqSmooth.setCurrentAndTargetValue(hz);
+
+        b.coeffs = designBand(b, hz, dB);
+        b.designedHz = hz;
+        b.designedDb = dB;
+        b.active = std::abs(dB) >= 0.01f;
+
+        // allocate filter states per channel
+        b.states.assign((size_t)channels, BiquadState{});
     };
 
-    makeBand(lowBand);
-    makeBand(midBand);
-    makeBand(highBand);
+    setupBand(lowBand,  lowFreqHz.load(),  lowGainDb.load());
+    setupBand(midBand,  midFreqHz.load(),  midGainDb.load());
+    setupBand(highBand, highFreqHz.load(), highGainDb.load());
 
-    // prepare each per channel duplicator for single channel processing
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sr;
-    spec.maximumBlockSize = (juce::uint32)maxBlockSize;
-    spec.numChannels = 1; // each duplicator instance handles one channel
+    // linear phase: one step up in kernel size for each doubling past 48k, the same as the de-noiser's FFT
+    const int rateSteps = sr > 48000.0 ? (int)std::round(std::log2(sr / 48000.0)) : 0;
+    kernelOrder = baseKernelOrder + rateSteps;
+    kernelPlan = StftPlan::get(kernelOrder);
+    kernelFft = std::make_unique<juce::dsp::FFT>(kernelOrder);
+    kernelData.assign((size_t)(2 << kernelOrder), 0.0f);
+    kernelTaps.assign((size_t)(1 << kernelOrder), 0.0f);
+    convolver.prepare(partitionOrder, 1 << kernelOrder, channels);
 
-    for (auto& f : lowBand.filters)  f.prepare(spec);
-    for (auto& f : midBand.filters)  f.prepare(spec);
-    for (auto& f : highBand.filters) f.prepare(spec);
+    // first kernel is built here so linear phase never starts empty
+    buildKernel();
+    kernelDirty = false;
+    wasLinearPhase = false;
 
-    updateFilters();
+    builder.startThread();
 }
 
 void Equalizer::reset()
 {
-    for (auto& f : lowBand .filters) f.reset();
-    for (auto& f : midBand .filters) f.reset();
-    for (auto& f : highBand.filters) f.reset();
+    convolver.reset();
+    for (auto& s : lowBand .states) s.reset();
+    for (auto& s : midBand .states) s.reset();
+    for (auto& s : highBand.states) s.reset();
 }
 
 void Equalizer::setLowFreq(float hz)
 {
     lowFreqHz = juce::jlimit(20.0f, 1000.0f, hz);
+    requestKernel();
 }
 
 void Equalizer::setLowGainDb(float dB)
 {
     lowGainDb = juce::jlimit(-24.0f, 24.0f, dB);
+    requestKernel();
 }
 
 void Equalizer::setMidFreq(float hz)
 {
     midFreqHz = juce::jlimit(200.0f, 6000.0f, hz);
+    requestKernel();
 }
 
 void Equalizer::setMidGainDb(float dB)
 {
     midGainDb = juce::jlimit(-24.0f, 24.0f, dB);
+    requestKernel();
 }
 
 void Equalizer::setHighFreq(float hz)
 {
     highFreqHz = juce::jlimit(1000.0f, 18000.0f, hz);
+    requestKernel();
 }
 
 void Equalizer::setHighGainDb(float dB)
 {
     highGainDb = juce::jlimit(-24.0f, 24.0f, dB);
+    requestKernel();
 }
 
-void Equalizer::updateFilters()
+void Equalizer::setLinearPhase(bool shouldBeLinear)
 {
-    if (!isPrepared)
-        return;
+    linearPhase = shouldBeLinear;
+    requestKernel();
+}
+
+int Equalizer::getLatencySamples() const noexcept
+{
+    return linearPhase.load() ? (1 << kernelOrder) / 2 + convolver.getLatencySamples() : 0;
+}
+
+void Equalizer::requestKernel()
+{
+    parameterVersion.fetch_add(1, std::memory_order_release);
+    kernelDirty = true;
+    if (linearPhase.load())
+        builder.notify();
+}
 
-    float lowGain = lowGainDb.load();
-    float midGain = midGainDb.load();
-    float highGain = highGainDb.load();
-
-    // Use shelving and peaking with linear gain factors (convert from dB)
-    auto lowC = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-        sr, lowFreqHz.load(), midQ, juce::Decibels::decibelsToGain(lowGain));
-    auto midC = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        sr, midFreqHz.load(), midQ, juce::Decibels::decibelsToGain(midGain));
-    auto highC = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-        sr, highFreqHz.load(), midQ, juce::Decibels::decibelsToGain(highGain));
-    // Copy into existing state to avoid RT pointer swaps
-    for (auto& f : lowBand.filters)
+void Equalizer::KernelBuilder::run()
+{
+    while (!threadShouldExit())
     {
-        if (f.state) *f.state = *lowC; else f.state = lowC;
+        wait(-1);
+
+        // knobs can keep moving while a kernel is built, so go again until it has caught up
+        while (!threadShouldExit() && owner.linearPhase.load() && owner.kernelDirty.exchange(false))
+            owner.buildKernel();
     }
-    for (auto& f : midBand.filters)
+}
+
+void Equalizer::buildKernel()
+{
+    const int size = 1 << kernelOrder;
+
+    // Magnitude of the three bands together at every bin. Zero phase, so the spectrum is just real numbers
+    const auto low  = designBand(lowBand,  lowFreqHz.load(),  lowGainDb.load());
+    const auto mid  = designBand(midBand,  midFreqHz.load(),  midGainDb.load());
+    const auto high = designBand(highBand, highFreqHz.load(), highGainDb.load());
+
+    std::fill(kernelData.begin(), kernelData.end(), 0.0f);
+    for (int k = 0; k <= size / 2; ++k)
     {
-        if (f.state) *f.state = *midC; else f.state = midC;
+        const double frequency = (double)k * sr / (double)size;
+        kernelData[(size_t)(2 * k)] = low.magnitudeAt(frequency, sr) * mid.magnitudeAt(frequency, sr) * high.magnitudeAt(frequency, sr);
     }
-    for (auto& f : highBand.filters)
+    kernelFft->performRealOnlyInverseTransform(kernelData.data());
+
+    // The zero phase response is centred on sample 0 and wraps around. Rotating it by half makes it causal and
+    // symmetric about the middle, and the hann window tapers the ends so the truncation doesn't ripple
+    const int half = size / 2;
+    for (int n = 0; n < size; ++n)
+        kernelTaps[(size_t)n] = kernelData[(size_t)((n + half) & (size - 1))] * kernelPlan->window[(size_t)n];
+
+    convolver.loadKernel(kernelTaps.data(), size);
+}
+
+BiquadCoefficients Equalizer::designBand(const Band& band, float hz, float dB) const noexcept
+{
+    const float gain = dbToGain(dB);
+    switch (band.shape)
     {
-        if (f.state) *f.state = *highC; else f.state = highC;
+        case Shape::lowShelf:  return BiquadCoefficients::lowShelf (sr, hz, midQ, gain);
+        case Shape::highShelf: return BiquadCoefficients::highShelf(sr, hz, midQ, gain);
+        case Shape::peak:
+        default:               return BiquadCoefficients::peak     (sr, hz, midQ, gain);
     }
 }
 
-void Equalizer::processBlock(juce::AudioBuffer<float>& buffer) noexcept
+void Equalizer::processBand(Band& band, juce::AudioBuffer<float>& buffer, int nCh, int start, int num, float targetHz, float targetDb) noexcept
 {
-    if (!isPrepared || buffer.getNumChannels() == 0)
+    band.gainSmooth.setTargetValue(targetDb);
+    band.freqSmooth.setTargetValue(targetHz);
+
+    // Nothing has moved since the coefficients were made, so just run them (or skip the band if it's at 0 dB)
+    if (!band.gainSmooth.isSmoothing() && !band.freqSmooth.isSmoothing()
+        && band.designedHz == targetHz && band.designedDb == targetDb)
+    {
+        if (band.active)
+            for (int ch = 0; ch < nCh; ++ch)
+                band.states[(size_t)ch].process(buffer.getWritePointer(ch) + start, num, band.coeffs);
         return;
+    }
 
-    const int nCh   = juce::jmin(channels, buffer.getNumChannels());
-    const int nSmps = buffer.getNumSamples();
+    // A knob is moving: redesign once per sub-block at the smoothed values, and blend towards it sample by sample
+    for (int pos = 0; pos < num; pos += subBlockSize)
+    {
+        const int len = juce::jmin(subBlockSize, num - pos);
+        const float hz = band.freqSmooth.skip(len);
+        const float dB = band.gainSmooth.skip(len);
+        const auto next = designBand(band, hz, dB);
 
-    // Update smoothing targets from GUI atomics and compute current values
-    lowGainSmooth.setTargetValue(lowGainDb.load());
-    midGainSmooth.setTargetValue(midGainDb.load());
-    highGainSmooth.setTargetValue(highGainDb.load());
-    const float curLowDb  = lowGainSmooth.getCurrentValue();
-    const float curMidDb  = midGainSmooth.getCurrentValue();
-    const float curHighDb = highGainSmooth.getCurrentValue();
+        // Only process if gain is not near zero (or is on its way there)
+        const bool nextActive = std::abs(dB) >= 0.01f;
+        if (band.active || nextActive)
+            for (int ch = 0; ch < nCh; ++ch)
+                band.states[(size_t)ch].process(buffer.getWritePointer(ch) + start + pos, len, band.coeffs, next);
 
-    // Read current Hz directly (no smoothing to avoid warble)
-    const float curLowHz  = lowFreqHz.load();
-    const float curMidHz  = midFreqHz.load();
-    const float curHighHz = highFreqHz.load();
+        // Once a band is skipped, clear its memory so it doesn't click when it comes back
+        if (band.active && !nextActive)
+            for (auto& s : band.states) s.reset();
 
-    // Update coefficients at block rate using smoothed values
-    {
-        auto lowC = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-            sr, curLowHz, midQ, juce::Decibels::decibelsToGain(curLowDb));
-        auto midC = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-            sr, curMidHz, midQ, juce::Decibels::decibelsToGain(curMidDb));
-        auto highC = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-            sr, curHighHz, midQ, juce::Decibels::decibelsToGain(curHighDb));
-
-        for (auto& f : lowBand .filters) { if (f.state) *f.state = *lowC; else f.state = lowC; }
-        for (auto& f : midBand .filters) { if (f.state) *f.state = *midC; else f.state = midC; }
-        for (auto& f : highBand.filters) { if (f.state) *f.state = *highC; else f.state = highC; }
+        band.coeffs = next;
+        band.designedHz = hz;
+        band.designedDb = dB;
+        band.active = nextActive;
     }
+}
 
-    // Check if all gains are essentially zero - if so, just pass through
-    float lowG = std::abs(curLowDb);
-    float midG = std::abs(curMidDb);
-    float highG = std::abs(curHighDb);
-    
-    if (lowG < 0.01f && midG < 0.01f && highG < 0.01f)
-    {
-        // All gains near zero, pass through unchanged
-        lowGainSmooth.skip(nSmps);
-        midGainSmooth.skip(nSmps);
-        highGainSmooth.skip(nSmps);
-        // advance smoothing (no processing)
-        lowGainSmooth.skip(nSmps);
-        midGainSmooth.skip(nSmps);
-        highGainSmooth.skip(nSmps);
+void Equalizer::processBlock(juce::AudioBuffer<float>& buffer) noexcept
+{
+    if (!isPrepared || buffer.getNumChannels() == 0)
         return;
-    }
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    const int nCh   = juce::jmin(channels, buffer.getNumChannels());
+    const int nSmps = buffer.getNumSamples();
 
-    // Apply each band's filter to each channel in series
-    for (int ch = 0; ch < nCh; ++ch)
+    // Linear phase runs the FIR instead of the filters. The two paths have different delays so there's nothing
+    // sensible to blend on a switch; the convolver just starts clean
+    if (linearPhase.load())
     {
-        auto channelBlock = block.getSingleChannelBlock((size_t)ch);
-        
-        // Only process if gain is not near zero
-        if (lowG > 0.01f)
-        {
-            lowBand.filters[(size_t)ch].process(
-                juce::dsp::ProcessContextReplacing<float>(channelBlock));
-        }
-        
-        if (midG > 0.01f)
-        {
-            midBand.filters[(size_t)ch].process(
-                juce::dsp::ProcessContextReplacing<float>(channelBlock));
-        }
-        
-        if (highG > 0.01f)
-        {
-            highBand.filters[(size_t)ch].process(
-                juce::dsp::ProcessContextReplacing<float>(channelBlock));
-        }
+        if (!wasLinearPhase)
+            convolver.reset();
+        wasLinearPhase = true;
+
+        convolver.process(buffer);
+        for (int ch = nCh; ch < buffer.getNumChannels(); ++ch)
+            buffer.clear(ch, 0, nSmps);
+        return;
     }
+    if (wasLinearPhase)
+        reset();
+    wasLinearPhase = false;
 
-    // advance smoothing for this processed block
-    lowGainSmooth.skip(nSmps);
-    midGainSmooth.skip(nSmps);
-    highGainSmooth.skip(nSmps);
+    // Apply each band to each channel in series. Targets come from the GUI atomics
+    processBand(lowBand,  buffer, nCh, 0, nSmps, lowFreqHz.load(),  lowGainDb.load());
+    processBand(midBand,  buffer, nCh, 0, nSmps, midFreqHz.load(),  midGainDb.load());
+    processBand(highBand, buffer, nCh, 0, nSmps, highFreqHz.load(), highGainDb.load());
 
     // clear any channels we didn't touch
     for (int ch = nCh; ch < buffer.getNumChannels(); ++ch)
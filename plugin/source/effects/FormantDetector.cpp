@@ -8,19 +8,18 @@
 FormantDetector::FormantDetector(int order)
     : fftOrder(order),
       fftSize(1 << fftOrder), // fftSize = 2^fftOrder
-      fft(fftOrder),
-      window(fftSize, 0.0f),
-      fftData(2 * fftSize, 0.0f)
+      magnitude(fftSize / 2, 0.0f)
 {
-    // Initialize Hann window: smooths edges to reduce spectral leakage
-    for (int i = 0; i < fftSize; ++i)
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / (fftSize - 1)));
+    // Hann window and FFT come from the STFT engine. Mono, with a new frame every quarter of the FFT
+    stft.prepare(fftOrder, fftSize / 4, 1);
+    candidates.reserve(fftSize / 2);
 }
 
 void FormantDetector::prepare(double sampleRateIn)
 {
     // Prepare internal buffers and set sample rate
     sampleRate = sampleRateIn;
+    stft.reset();
     formants.clear();
 }
 
@@ -46,51 +45,29 @@ void FormantDetector::processBlock(const juce::AudioBuffer<float>& buffer)
     // Adjust this if needed; ~1e-3 is about -60 dBFS, 1e-4 is about -80 dBFS.
     constexpr float rmsSilenceThreshold = 1e-3f;
 
+    //Feed the first channel through the STFT engine, and find the spectral peaks
+    //representing formants in every frame it completes. Quiet blocks still go in,
+    //so the frames never mix in old audio
+    const float* channelData = buffer.getReadPointer(0);
+    stft.analyse(&channelData, 1, numSamples,
+                 [this] (std::complex<float>* const* spectra, int)
+                 {
+                     findFormantPeaks(spectra[0]);
+                 });
+
     if (totalRms < rmsSilenceThreshold)
-    {
         formants.clear();
-        return;
-    }
-
-    //Compute FFT on incoming audio block
-    computeFFT(buffer);
-
-    //Find spectral peaks representing formants
-    findFormantPeaks();
 }
 
-
-void FormantDetector::computeFFT(const juce::AudioBuffer<float>& buffer)
-{
-    // Copy first channel into fftData with windowing applied
-    int numSamples = std::min(buffer.getNumSamples(), fftSize);
-    auto* channelData = buffer.getReadPointer(0);
-
-    for (int i = 0; i < numSamples; ++i)
-        fftData[i] = channelData[i] * window[i];
-
-    // Zero-pad if buffer is smaller than FFT size
-    for (int i = numSamples; i < fftSize; ++i)
-        fftData[i] = 0.0f;
-
-    // Perform FFT (in-place, complex numbers interleaved as real/imag)
-    fft.performRealOnlyForwardTransform(fftData.data());
-}
-
-void FormantDetector::findFormantPeaks()
+void FormantDetector::findFormantPeaks(const std::complex<float>* bins)
 {
     formants.clear();
 
     // Magnitude spectrum
     const int halfSize = fftSize / 2;
-    std::vector<float> magnitude(halfSize);
 
     for (int i = 0; i < halfSize; ++i)
-    {
-        float real = fftData[2 * i];
-        float imag = fftData[2 * i + 1];
-        magnitude[i] = std::sqrt(real * real + imag * imag);
-    }
+        magnitude[i] = std::abs(bins[i]);
 
     constexpr float fMinHz = 300.0f;
     constexpr float fMaxHz = 5000.0f;
@@ -116,7 +93,7 @@ void FormantDetector::findFormantPeaks()
     const float peakThreshold = maxMag * relativePeakThreshold;
 
     //Collect local maxima that exceed the threshold
-    std::vector<std::pair<float, int>> candidates; // (mag, bin)
+    candidates.clear(); // (mag, bin)
     for (int i = minBin + 1; i < maxBin; ++i)
     {
         float mPrev = magnitude[i - 1];
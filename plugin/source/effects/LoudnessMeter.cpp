@@ -0,0 +1,252 @@
+// Written by Austin Hills
+
+#include "Pitchblade/effects/LoudnessMeter.h"
+
+//Zeroth order modified Bessel function, for the Kaiser window
+static double besselI0(double x){
+    double sum = 1.0;
+    double term = 1.0;
+    for(int k = 1; k < 32; k++){
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+LoudnessMeter::LoudnessMeter(){
+    //Interpolation filter for true peak: a Kaiser windowed sinc, 48 taps, cut off at the original Nyquist (the same size BS.1770 suggests)
+    constexpr int numTaps = OVERSAMPLING * TAPS_PER_PHASE;
+    constexpr double beta = 5.0;
+    std::array<double, numTaps> taps {};
+    const double centre = (numTaps - 1) * 0.5;
+    for(int n = 0; n < numTaps; n++){
+        const double t = ((double)n - centre) / OVERSAMPLING;
+        const double sinc = t == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+        const double r = ((double)n - centre) / centre;
+        taps[(size_t)n] = sinc * besselI0(beta * std::sqrt(juce::jmax(0.0, 1.0 - r * r))) / besselI0(beta);
+    }
+
+    //Split into phases, one per lane, each scaled so it passes DC at unity.
+    //Register j multiplies the sample j places after the oldest one in the history, so the taps go in backwards
+    auto& lanes = phaseTapsScalar;
+    for(int p = 0; p < OVERSAMPLING; p++){
+        double phaseSum = 0.0;
+        for(int k = 0; k < TAPS_PER_PHASE; k++){
+            phaseSum += taps[(size_t)(k * OVERSAMPLING + p)];
+        }
+        for(int k = 0; k < TAPS_PER_PHASE; k++){
+            lanes[(size_t)(TAPS_PER_PHASE - 1 - k)][(size_t)p] = (float)(taps[(size_t)(k * OVERSAMPLING + p)] / phaseSum);
+        }
+    }
+    if constexpr(PHASES_IN_ONE_REGISTER){
+        for(int j = 0; j < TAPS_PER_PHASE; j++){
+            alignas(16) float values[OVERSAMPLING];
+            std::copy(lanes[(size_t)j].begin(), lanes[(size_t)j].end(), values);
+            phaseTaps[(size_t)j] = Vec::fromRawArray(values);
+        }
+    }
+}
+
+//Stage 1 of K-weighting: the high shelf that models the head. These are the BS.1770 formulas, so at 48 kHz they give the table values exactly
+BiquadCoefficients LoudnessMeter::kWeightingShelf(double sampleRate){
+    const double f0 = 1681.974450955533;
+    const double gainDb = 3.999843853973347;
+    const double q = 0.7071752369554196;
+
+    const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+    const double vh = std::pow(10.0, gainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+
+    return { (float)((vh + vb * k / q + k * k) / a0),
+             (float)(2.0 * (k * k - vh) / a0),
+             (float)((vh - vb * k / q + k * k) / a0),
+             (float)(2.0 * (k * k - 1.0) / a0),
+             (float)((1.0 - k / q + k * k) / a0) };
+}
+
+//Stage 2: the "RLB" high pass that takes out the very low end
+BiquadCoefficients LoudnessMeter::kWeightingHighPass(double sampleRate){
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+
+    const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+    const double a0 = 1.0 + k / q + k * k;
+
+    return { 1.0f, -2.0f, 1.0f,
+             (float)(2.0 * (k * k - 1.0) / a0),
+             (float)((1.0 - k / q + k * k) / a0) };
+}
+
+void LoudnessMeter::prepare(double newSampleRate){
+    sampleRate = newSampleRate;
+    shelfCoeffs = kWeightingShelf(sampleRate);
+    highPassCoeffs = kWeightingHighPass(sampleRate);
+    stepLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+    reset();
+}
+
+void LoudnessMeter::reset(){
+    for(auto& state : channelStates){
+        state.shelf.reset();
+        state.highPass.reset();
+        state.history.fill(0.0f);
+        state.historyPos = 0;
+    }
+
+    stepFill = 0;
+    stepSum = 0.0;
+    stepPowers.fill(0.0);
+    stepPos = 0;
+    stepsSeen = 0;
+    binPower.fill(0.0);
+    binCount.fill(0);
+    maxPeak = 0.0f;
+
+    momentaryLufs.store(SILENCE_LUFS);
+    shortTermLufs.store(SILENCE_LUFS);
+    integratedLufs.store(SILENCE_LUFS);
+    truePeakDb.store(SILENCE_LUFS);
+}
+
+void LoudnessMeter::process(const float* const* channels, int numChannels, int numSamples) noexcept{
+    if(resetRequested.exchange(false, std::memory_order_acq_rel)){
+        reset();
+    }
+    if(sampleRate <= 0.0){
+        return;
+    }
+
+    const int channelsToMeter = juce::jmin(numChannels, MAX_CHANNELS);
+    Vec peak = Vec::expand(0.0f);
+
+    //Work in runs that stop at the end of each 100 ms step
+    int position = 0;
+    while(position < numSamples){
+        const int count = juce::jmin(numSamples - position, stepLength - stepFill);
+
+        //Channels are all weighted 1.0, which is right for mono and stereo
+        for(int ch = 0; ch < channelsToMeter; ch++){
+            stepSum += processChannel(channelStates[(size_t)ch], channels[ch] + position, count, peak);
+        }
+
+        stepFill += count;
+        position += count;
+        if(stepFill == stepLength){
+            finishStep();
+        }
+    }
+
+    float blockPeak = 0.0f;
+    for(size_t lane = 0; lane < Vec::SIMDNumElements; lane++){
+        blockPeak = juce::jmax(blockPeak, peak.get(lane));
+    }
+    if(blockPeak > maxPeak){
+        maxPeak = blockPeak;
+        truePeakDb.store(juce::Decibels::gainToDecibels(maxPeak, SILENCE_LUFS), std::memory_order_relaxed);
+    }
+}
+
+double LoudnessMeter::processChannel(ChannelState& state, const float* samples, int numSamples, Vec& peak) noexcept{
+    double sum = 0.0;
+    auto& history = state.history;
+    int pos = state.historyPos;
+
+    for(int i = 0; i < numSamples; i++){
+        const float x = samples[i];
+
+        //K-weighting. The filters are serial, so this part is one sample at a time
+        const float weighted = state.highPass.process(state.shelf.process(x, shelfCoeffs), highPassCoeffs);
+        sum += (double)weighted * (double)weighted;
+
+        //True peak. All four oversampled points between this sample and the last come out of one register,
+        //so it's 12 multiply adds per input sample instead of 48
+        pos = pos + 1 == TAPS_PER_PHASE ? 0 : pos + 1;
+        history[(size_t)pos] = x;
+        history[(size_t)(pos + TAPS_PER_PHASE)] = x;
+        const float* window = history.data() + pos + 1;
+
+        //The samples themselves count too, so a peak is never read lower than a plain sample peak meter would
+        if constexpr(PHASES_IN_ONE_REGISTER){
+            Vec interpolated = phaseTaps[0] * Vec::expand(window[0]);
+            for(int j = 1; j < TAPS_PER_PHASE; j++){
+                interpolated = interpolated + phaseTaps[(size_t)j] * Vec::expand(window[j]);
+            }
+            peak = Vec::max(peak, Vec::max(Vec::abs(interpolated), Vec::expand(std::abs(x))));
+        } else {
+            float samplePeak = std::abs(x);
+            for(int p = 0; p < OVERSAMPLING; p++){
+                float interpolated = 0.0f;
+                for(int j = 0; j < TAPS_PER_PHASE; j++){
+                    interpolated += phaseTapsScalar[(size_t)j][(size_t)p] * window[j];
+                }
+                samplePeak = juce::jmax(samplePeak, std::abs(interpolated));
+            }
+            peak = Vec::max(peak, Vec::expand(samplePeak));
+        }
+    }
+
+    state.historyPos = pos;
+    return sum;
+}
+
+void LoudnessMeter::finishStep() noexcept{
+    stepPos = (stepPos + 1) % SHORT_TERM_STEPS;
+    stepPowers[(size_t)stepPos] = stepSum / (double)stepLength;
+    stepSum = 0.0;
+    stepFill = 0;
+    stepsSeen = juce::jmin(stepsSeen + 1, SHORT_TERM_STEPS);
+
+    //Short-term uses what it has until 3 s have gone by
+    auto meanOfLast = [this](int steps){
+        double sum = 0.0;
+        for(int i = 0; i < steps; i++){
+            sum += stepPowers[(size_t)((stepPos - i + SHORT_TERM_STEPS) % SHORT_TERM_STEPS)];
+        }
+        return sum / (double)steps;
+    };
+    shortTermLufs.store(powerToLufs(meanOfLast(stepsSeen)), std::memory_order_relaxed);
+
+    //Momentary and integrated need a full 400 ms window
+    if(stepsSeen < MOMENTARY_STEPS){
+        return;
+    }
+    const double windowPower = meanOfLast(MOMENTARY_STEPS);
+    const float windowLufs = powerToLufs(windowPower);
+    momentaryLufs.store(windowLufs, std::memory_order_relaxed);
+
+    //Absolute gate: quieter windows never count
+    if(windowLufs > ABSOLUTE_GATE_LUFS){
+        const int bin = juce::jlimit(0, NUM_BINS - 1, (int)((windowLufs - ABSOLUTE_GATE_LUFS) / BIN_WIDTH_LU));
+        binPower[(size_t)bin] += windowPower;
+        binCount[(size_t)bin]++;
+        updateIntegrated();
+    }
+}
+
+void LoudnessMeter::updateIntegrated() noexcept{
+    //The relative gate sits 10 LU under the loudness of everything that got past the absolute gate
+    double totalPower = 0.0;
+    std::uint64_t totalCount = 0;
+    for(int b = 0; b < NUM_BINS; b++){
+        totalPower += binPower[(size_t)b];
+        totalCount += binCount[(size_t)b];
+    }
+    if(totalCount == 0){
+        return;
+    }
+    const float relativeGate = powerToLufs(totalPower / (double)totalCount) + RELATIVE_GATE_LU;
+
+    double gatedPower = 0.0;
+    std::uint64_t gatedCount = 0;
+    for(int b = 0; b < NUM_BINS; b++){
+        const float binCentre = ABSOLUTE_GATE_LUFS + ((float)b + 0.5f) * BIN_WIDTH_LU;
+        if(binCentre > relativeGate){
+            gatedPower += binPower[(size_t)b];
+            gatedCount += binCount[(size_t)b];
+        }
+    }
+    if(gatedCount > 0){
+        integratedLufs.store(powerToLufs(gatedPower / (double)gatedCount), std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,292 @@
+// Written by Austin Hills
+
+#include "Pitchblade/effects/MultibandCompressorProcessor.h"
+
+namespace
+{
+    //Plain biquad coefficients, already divided by a0
+    struct BiquadCoeffs{
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    //These are the same formulas juce::dsp::IIR::Coefficients uses for makeLowPass, makeHighPass and makeAllPass
+    //They're worked out by hand here so that nothing gets allocated when a crossover moves
+    //A Linkwitz-Riley crossover is two Butterworth sections (Q of 1/sqrt(2)) in a row. Its low and high outputs add up to
+    //a 2nd order allpass with the same Q, which is what the bands below the crossover get so everything stays in phase
+    BiquadCoeffs makeCrossoverSection(double sampleRate, float frequency, int type){
+        const double n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const double nSq = n * n;
+        const double invQ = juce::MathConstants<double>::sqrt2;
+        const double c1 = 1.0 / (1.0 + invQ * n + nSq);
+
+        BiquadCoeffs c;
+        c.a1 = (float)(c1 * 2.0 * (1.0 - nSq));
+        c.a2 = (float)(c1 * (1.0 - invQ * n + nSq));
+
+        if(type == 0){
+            //Low pass
+            c.b0 = (float)c1;
+            c.b1 = (float)(c1 * 2.0);
+            c.b2 = (float)c1;
+        }else if(type == 1){
+            //High pass
+            c.b0 = (float)(c1 * nSq);
+            c.b1 = (float)(-c1 * 2.0 * nSq);
+            c.b2 = (float)(c1 * nSq);
+        }else{
+            //All pass
+            c.b0 = c.a2;
+            c.b1 = c.a1;
+            c.b2 = 1.0f;
+        }
+        return c;
+    }
+}
+
+//Constructor
+MultibandCompressorProcessor::MultibandCompressorProcessor(){
+    for(auto& reduction : bandGainReductionDb){
+        reduction.store(0.0f);
+    }
+    prepare(sampleRate);
+}
+
+//Prepare the processor with the current sample rate
+void MultibandCompressorProcessor::prepare(const double sRate){
+    sampleRate = sRate;
+
+    //Clear all the filter and envelope state
+    for(auto& channelState : filterState){
+        for(auto& state : channelState){
+            state.s1 = Vec::expand(0.0f);
+            state.s2 = Vec::expand(0.0f);
+        }
+    }
+    envelope = Vec::expand(0.0f);
+
+    filtersNeedUpdate = true;
+    updateAttackAndRelease();
+}
+
+//Setters for user controlled parameters
+void MultibandCompressorProcessor::setNumBands(int numBandsValue){
+    numBandsValue = juce::jlimit(2, maxBands, numBandsValue);
+    if(numBandsValue != numBands){
+        numBands = numBandsValue;
+        filtersNeedUpdate = true;
+    }
+}
+
+void MultibandCompressorProcessor::setCrossover(int index, float frequencyInHz){
+    if(index < 0 || index >= maxBands - 1){
+        return;
+    }
+    if(crossovers[(size_t)index] != frequencyInHz){
+        crossovers[(size_t)index] = frequencyInHz;
+        filtersNeedUpdate = true;
+    }
+}
+
+void MultibandCompressorProcessor::setThreshold(int band, float thresholdInDB){
+    if(band >= 0 && band < maxBands){
+        thresholds[(size_t)band] = thresholdInDB;
+    }
+}
+
+//Same as the compressor, ratios below 1 are not accepted
+void MultibandCompressorProcessor::setRatio(int band, float ratioValue){
+    if(band >= 0 && band < maxBands){
+        ratios[(size_t)band] = std::max(ratioValue, 1.0f);
+    }
+}
+
+void MultibandCompressorProcessor::setAttack(float attackInMS){
+    if(attackInMS != attackTime){
+        attackTime = attackInMS;
+        updateAttackAndRelease();
+    }
+}
+
+void MultibandCompressorProcessor::setRelease(float releaseInMS){
+    if(releaseInMS != releaseTime){
+        releaseTime = releaseInMS;
+        updateAttackAndRelease();
+    }
+}
+
+//Uses the same curve as CompressorProcessor so the bands feel the same as the single band compressor
+void MultibandCompressorProcessor::updateAttackAndRelease(){
+    attackCoeff = Vec::expand(std::exp(-3.5f / (0.001f * attackTime * (float)sampleRate + 0.0000001f)));
+    releaseCoeff = Vec::expand(std::exp(-0.9f / (0.001f * releaseTime * (float)sampleRate + 0.0000001f)));
+}
+
+MultibandCompressorProcessor::Vec MultibandCompressorProcessor::fromLanes(const std::array<float, numLanes>& values){
+    Vec result = Vec::expand(0.0f);
+    for(int lane = 0; lane < numLanes; lane++){
+        result.set((size_t)lane, values[(size_t)lane]);
+    }
+    return result;
+}
+
+//Works out the filter bank coefficients for every lane
+//For crossover k, the band just below it gets the low pass, every band above gets the high pass,
+//and the bands further below get the matching allpass so all bands line up in phase and add back to a flat response
+void MultibandCompressorProcessor::updateFilters(){
+    filtersNeedUpdate = false;
+
+    //Keep the crossovers in order and away from Nyquist
+    const float maxFrequency = 0.45f * (float)sampleRate;
+    float previous = 20.0f;
+    std::array<float, maxBands - 1> frequencies {};
+    for(int k = 0; k < numBands - 1; k++){
+        frequencies[(size_t)k] = juce::jlimit(previous * 1.05f, maxFrequency, crossovers[(size_t)k]);
+        previous = frequencies[(size_t)k];
+    }
+
+    const BiquadCoeffs identity;
+
+    for(int k = 0; k < numBands - 1; k++){
+        const auto lowPass = makeCrossoverSection(sampleRate, frequencies[(size_t)k], 0);
+        const auto highPass = makeCrossoverSection(sampleRate, frequencies[(size_t)k], 1);
+        const auto allPass = makeCrossoverSection(sampleRate, frequencies[(size_t)k], 2);
+
+        for(int section = 0; section < stagesPerCrossover; section++){
+            std::array<float, numLanes> b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+
+            for(int lane = 0; lane < numLanes; lane++){
+                const BiquadCoeffs* c = &identity;
+                if(lane < numBands){
+                    if(lane == k)       c = &lowPass;
+                    else if(lane > k)   c = &highPass;
+                    else                c = section == 0 ? &allPass : &identity;
+                }
+                b0[(size_t)lane] = c->b0;
+                b1[(size_t)lane] = c->b1;
+                b2[(size_t)lane] = c->b2;
+                a1[(size_t)lane] = c->a1;
+                a2[(size_t)lane] = c->a2;
+            }
+
+            auto& stage = stages[(size_t)(k * stagesPerCrossover + section)];
+            stage.b0 = fromLanes(b0);
+            stage.b1 = fromLanes(b1);
+            stage.b2 = fromLanes(b2);
+            stage.a1 = fromLanes(a1);
+            stage.a2 = fromLanes(a2);
+        }
+    }
+}
+
+//Processes the input buffer
+void MultibandCompressorProcessor::process(juce::AudioBuffer<float>& buffer){
+    juce::ScopedNoDenormals noDenormals;
+
+    if(filtersNeedUpdate){
+        updateFilters();
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = std::min(buffer.getNumChannels(), maxChannels);
+    if(numChannels == 0){
+        return;
+    }
+
+    std::array<float*, maxChannels> channels {};
+    for(int ch = 0; ch < numChannels; ch++){
+        channels[(size_t)ch] = buffer.getWritePointer(ch);
+    }
+
+    for(int start = 0; start < numSamples; start += chunkSize){
+        const int count = std::min(chunkSize, numSamples - start);
+        std::array<float*, maxChannels> chunk {};
+        for(int ch = 0; ch < numChannels; ch++){
+            chunk[(size_t)ch] = channels[(size_t)ch] + start;
+        }
+        processChunk(chunk.data(), numChannels, count);
+    }
+}
+
+//The main processing loop, done in four passes over the chunk
+void MultibandCompressorProcessor::processChunk(float* const* channels, int numChannels, int numSamples){
+    const int numStages = (numBands - 1) * stagesPerCrossover;
+
+    //Pass 1: split into bands. Each sample is copied into every lane, then the whole filter bank runs on all bands at once
+    for(int ch = 0; ch < numChannels; ch++){
+        auto& states = filterState[(size_t)ch];
+        auto& bands = bandSignals[(size_t)ch];
+        const float* input = channels[ch];
+
+        for(int i = 0; i < numSamples; i++){
+            Vec x = Vec::expand(input[i]);
+            for(int s = 0; s < numStages; s++){
+                const auto& c = stages[(size_t)s];
+                auto& state = states[(size_t)s];
+
+                //Transposed direct form II
+                const Vec y = c.b0 * x + state.s1;
+                state.s1 = c.b1 * x - c.a1 * y + state.s2;
+                state.s2 = c.b2 * x - c.a2 * y;
+                x = y;
+            }
+            bands[(size_t)i] = x;
+        }
+    }
+
+    //Pass 2: envelope for each band, tracking the loudest channel. Same as the compressor, just 4 bands wide
+    const Vec one = Vec::expand(1.0f);
+    for(int i = 0; i < numSamples; i++){
+        Vec level = Vec::abs(bandSignals[0][(size_t)i]);
+        for(int ch = 1; ch < numChannels; ch++){
+            level = Vec::max(level, Vec::abs(bandSignals[(size_t)ch][(size_t)i]));
+        }
+
+        //Pick attack where the band is getting louder and release where it isn't
+        const auto rising = Vec::greaterThan(level, envelope);
+        const Vec coeff = (attackCoeff & rising) + (releaseCoeff & ~rising);
+        envelope = coeff * envelope + (one - coeff) * level;
+
+        envelope.copyToRawArray(envelopeLanes.data() + i * numLanes);
+    }
+
+    //Pass 3: gain computer in the log domain, using the same math as the single band compressor
+    //Unused lanes get a gain of 0 so they drop out of the sum
+    //This pass stays one lane at a time. fastLog2 and fastExp2 pull the exponent in and out of the float bits,
+    //and juce::dsp::SIMDRegister has no way to reinterpret a float register as integers or shift it
+    std::array<float, numLanes> laneThreshold {}, laneSlope {}, laneActive {};
+    for(int lane = 0; lane < numLanes; lane++){
+        if(lane < numBands){
+            laneThreshold[(size_t)lane] = thresholds[(size_t)lane];
+            laneSlope[(size_t)lane] = 1.0f - (1.0f / ratios[(size_t)lane]);
+            laneActive[(size_t)lane] = 1.0f;
+        }
+    }
+
+    const DynamicsCore::HardKnee knee;
+    for(int i = 0; i < numSamples; i++){
+        for(int lane = 0; lane < numLanes; lane++){
+            const int index = i * numLanes + lane;
+            const float envelopeDB = DynamicsCore::fastGainToDecibels(envelopeLanes[(size_t)index]);
+            const float gainReductionDB = knee.overshoot(envelopeDB - laneThreshold[(size_t)lane]) * laneSlope[(size_t)lane];
+            gainLanes[(size_t)index] = DynamicsCore::fastDecibelsToGain(-gainReductionDB) * laneActive[(size_t)lane];
+        }
+    }
+
+    //Pass 4: apply each band's gain and add the bands back together
+    for(int ch = 0; ch < numChannels; ch++){
+        const auto& bands = bandSignals[(size_t)ch];
+        float* output = channels[ch];
+        for(int i = 0; i < numSamples; i++){
+            const Vec gain = Vec::fromRawArray(gainLanes.data() + i * numLanes);
+            output[i] = (bands[(size_t)i] * gain).sum();
+        }
+    }
+
+    //Report the latest gain reduction for each band
+    if(numSamples > 0){
+        const int last = (numSamples - 1) * numLanes;
+        for(int band = 0; band < maxBands; band++){
+            const float gain = band < numBands ? gainLanes[(size_t)(last + band)] : 1.0f;
+            bandGainReductionDb[(size_t)band].store(juce::Decibels::gainToDecibels(gain, -100.0f));
+        }
+    }
+}
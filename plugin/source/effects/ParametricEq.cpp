@@ -0,0 +1,319 @@
+#include "Pitchblade/effects/ParametricEq.h"
+//Author: huda
+// N-band parametric EQ on a pipelined SIMD biquad cascade
+
+// Bell and shelf bands do nothing at 0 dB, so they can be skipped
+static inline bool usesGain(ParametricEq::BandType type)
+{
+    return type == ParametricEq::BandType::bell
+        || type == ParametricEq::BandType::lowShelf
+        || type == ParametricEq::BandType::highShelf;
+}
+
+ParametricEq::ParametricEq()
+{
+    laneIndex = Vec::expand(0.0f);
+    for (int lane = 0; lane < numLanes; ++lane)
+        laneIndex.set((size_t)lane, (float)lane);
+
+    for (int b = 0; b < maxBands; ++b)
+        params[(size_t)b].freqHz = defaultFrequency(b);
+}
+
+float ParametricEq::defaultFrequency(int band) noexcept
+{
+    // 30 Hz to 16 kHz, evenly spaced in octaves
+    return 30.0f * std::pow(16000.0f / 30.0f, (float)band / (float)(maxBands - 1));
+}
+
+void ParametricEq::prepare(double sampleRate, int maxBlockSize, int numChannels)
+{
+    juce::ignoreUnused(maxBlockSize);
+    sr = sampleRate > 0.0 ? sampleRate : 44100.0;
+    states.assign((size_t)juce::jmax(1, numChannels), {});
+    reset();
+
+    // initialise smoothed values and design each band once for where its knobs are now
+    numBands = juce::jlimit(1, maxBands, numBandsTarget.load());
+    for (int b = 0; b < maxBands; ++b)
+    {
+        auto& band = bands[(size_t)b];
+        const auto& p = params[(size_t)b];
+
+        band.gainSmooth.reset(sr, smoothingTimeSeconds);
+        band.freqSmooth.reset(sr, smoothingTimeSeconds);
+        band.qSmooth.reset(sr, smoothingTimeSeconds);
+        band.gainSmooth.setCurrentAndTargetValue(p.gainDb.load());
+        band.freqSmooth.setCurrentAndTargetValue(p.freqHz.load());
+        band.qSmooth.setCurrentAndTargetValue(p.q.load());
+        band.type = (BandType)p.type.load();
+        band.enabled = b < numBands && p.enabled.load();
+        band.designedEnabled = !band.enabled; // forces a design below
+    }
+
+    updateCoefficients(0);
+    isPrepared = true;
+}
+
+void ParametricEq::reset()
+{
+    for (auto& channel : states)
+        for (auto& s : channel)
+        {
+            s.s1 = Vec::expand(0.0f);
+            s.s2 = Vec::expand(0.0f);
+        }
+}
+
+void ParametricEq::setNumBands(int count)
+{
+    numBandsTarget = juce::jlimit(1, maxBands, count);
+}
+
+void ParametricEq::setBandType(int band, BandType type)
+{
+    if (band >= 0 && band < maxBands)
+        params[(size_t)band].type = juce::jlimit(0, numBandTypes - 1, (int)type);
+}
+
+void ParametricEq::setBandFrequency(int band, float hz)
+{
+    if (band >= 0 && band < maxBands)
+        params[(size_t)band].freqHz = juce::jlimit(20.0f, 20000.0f, hz);
+}
+
+void ParametricEq::setBandGainDb(int band, float dB)
+{
+    if (band >= 0 && band < maxBands)
+        params[(size_t)band].gainDb = juce::jlimit(-24.0f, 24.0f, dB);
+}
+
+void ParametricEq::setBandQ(int band, float q)
+{
+    if (band >= 0 && band < maxBands)
+        params[(size_t)band].q = juce::jlimit(0.1f, 18.0f, q);
+}
+
+void ParametricEq::setBandEnabled(int band, bool enabled)
+{
+    if (band >= 0 && band < maxBands)
+        params[(size_t)band].enabled = enabled;
+}
+
+BiquadCoefficients ParametricEq::designBand(double sampleRate, BandType type, float hz, float dB, float q) noexcept
+{
+    const float gain = juce::Decibels::decibelsToGain(dB);
+    switch (type)
+    {
+        case BandType::lowShelf:  return BiquadCoefficients::lowShelf (sampleRate, hz, q, gain);
+        case BandType::highShelf: return BiquadCoefficients::highShelf(sampleRate, hz, q, gain);
+        case BandType::lowCut:    return BiquadCoefficients::highPass (sampleRate, hz, q);
+        case BandType::highCut:   return BiquadCoefficients::lowPass  (sampleRate, hz, q);
+        case BandType::notch:     return BiquadCoefficients::notch    (sampleRate, hz, q);
+        case BandType::bell:
+        default:                  return BiquadCoefficients::peak     (sampleRate, hz, q, gain);
+    }
+}
+
+bool ParametricEq::pullParameters() noexcept
+{
+    numBands = juce::jlimit(1, maxBands, numBandsTarget.load());
+
+    bool moving = false;
+    for (int b = 0; b < maxBands; ++b)
+    {
+        auto& band = bands[(size_t)b];
+        const auto& p = params[(size_t)b];
+
+        band.type = (BandType)p.type.load();
+        band.enabled = b < numBands && p.enabled.load();
+        band.gainSmooth.setTargetValue(p.gainDb.load());
+        band.freqSmooth.setTargetValue(p.freqHz.load());
+        band.qSmooth.setTargetValue(p.q.load());
+
+        moving = moving || band.gainSmooth.isSmoothing() || band.freqSmooth.isSmoothing() || band.qSmooth.isSmoothing()
+                        || band.type != band.designedType || band.enabled != band.designedEnabled;
+    }
+    return moving;
+}
+
+void ParametricEq::updateCoefficients(int numSamplesToSkip) noexcept
+{
+    for (auto& band : bands)
+    {
+        const float hz = numSamplesToSkip > 0 ? band.freqSmooth.skip(numSamplesToSkip) : band.freqSmooth.getCurrentValue();
+        const float dB = numSamplesToSkip > 0 ? band.gainSmooth.skip(numSamplesToSkip) : band.gainSmooth.getCurrentValue();
+        const float q  = numSamplesToSkip > 0 ? band.qSmooth.skip(numSamplesToSkip)    : band.qSmooth.getCurrentValue();
+
+        // Only redesign when something actually moved
+        if (band.type == band.designedType && band.enabled == band.designedEnabled
+            && hz == band.designedHz && dB == band.designedDb && q == band.designedQ)
+            continue;
+
+        band.identity = !band.enabled || (usesGain(band.type) && std::abs(dB) < 0.01f);
+        band.coeffs = band.identity ? BiquadCoefficients::identity() : designBand(sr, band.type, hz, dB, q);
+        band.designedType = band.type;
+        band.designedEnabled = band.enabled;
+        band.designedHz = hz;
+        band.designedDb = dB;
+        band.designedQ = q;
+    }
+
+    for (int g = 0; g < maxGroups; ++g)
+        loadGroup(g);
+}
+
+void ParametricEq::loadGroup(int group) noexcept
+{
+    auto& into = groupCoeffs[(size_t)group];
+    bool active = false;
+    into = { Vec::expand(1.0f), Vec::expand(0.0f), Vec::expand(0.0f), Vec::expand(0.0f), Vec::expand(0.0f) };
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        const int b = group * numLanes + lane;
+        if (b >= maxBands)
+            break;
+
+        const auto& band = bands[(size_t)b];
+        into.b0.set((size_t)lane, band.coeffs.b0);
+        into.b1.set((size_t)lane, band.coeffs.b1);
+        into.b2.set((size_t)lane, band.coeffs.b2);
+        into.a1.set((size_t)lane, band.coeffs.a1);
+        into.a2.set((size_t)lane, band.coeffs.a2);
+        active = active || !band.identity;
+    }
+
+    // a group of bands that all pass straight through is skipped
+    groupActive[(size_t)group] = active;
+}
+
+// Moves every lane up one and puts sample in lane 0, so the cascade never leaves the register between steps
+static inline ParametricEq::Vec shiftIn(const ParametricEq::Vec& y, float sample) noexcept
+{
+   #if defined (__SSE2__)
+    const auto shifted = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(y.value), 4));
+    return ParametricEq::Vec::fromNative(_mm_move_ss(shifted, _mm_set_ss(sample)));
+   #elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+    return ParametricEq::Vec::fromNative(vextq_f32(vdupq_n_f32(sample), y.value, 3));
+   #else
+    auto x = ParametricEq::Vec::expand(sample);
+    for (size_t lane = 1; lane < ParametricEq::Vec::SIMDNumElements; ++lane)
+        x.set(lane, y.get(lane - 1));
+    return x;
+   #endif
+}
+
+void ParametricEq::processGroup(const LaneCoefficients& start, const LaneCoefficients* step, LaneState& state,
+                                float* data, int numSamples) const noexcept
+{
+    constexpr int lastLane = numLanes - 1;
+    const int numSteps = numSamples + lastLane;
+
+    LaneCoefficients c = start;
+    Vec s1 = state.s1;
+    Vec s2 = state.s2;
+    // Last step's output. Shifted up a lane, it is this step's input for every lane but the first
+    Vec y = Vec::expand(0.0f);
+
+    auto runStep = [&](int t, auto filling)
+    {
+        const Vec x = shiftIn(y, t < numSamples ? data[t] : 0.0f);
+
+        if (step != nullptr && t < numSamples)
+        {
+            c.b0 = c.b0 + step->b0;
+            c.b1 = c.b1 + step->b1;
+            c.b2 = c.b2 + step->b2;
+            c.a1 = c.a1 + step->a1;
+            c.a2 = c.a2 + step->a2;
+        }
+
+        // Transposed direct form II, every lane at once
+        y = c.b0 * x + s1;
+        const Vec nextS1 = c.b1 * x - c.a1 * y + s2;
+        const Vec nextS2 = c.b2 * x - c.a2 * y;
+
+        if constexpr (decltype(filling)::value)
+        {
+            // While filling or draining, lanes without a real sample this step keep their memory as it was
+            const auto busy = Vec::greaterThan(Vec::expand((float)t + 0.5f), laneIndex)
+                            & Vec::greaterThan(laneIndex, Vec::expand((float)(t - numSamples) + 0.5f));
+            s1 = (nextS1 & busy) + (s1 & ~busy);
+            s2 = (nextS2 & busy) + (s2 & ~busy);
+        }
+        else
+        {
+            s1 = nextS1;
+            s2 = nextS2;
+        }
+
+        // The last lane finishes the sample that went into lane 0 lastLane steps ago
+        if (t >= lastLane)
+            data[t - lastLane] = y.get((size_t)lastLane);
+    };
+
+    int t = 0;
+    for (; t < juce::jmin(lastLane, numSamples); ++t) runStep(t, std::true_type {});
+    for (; t < numSamples; ++t)                        runStep(t, std::false_type {});
+    for (; t < numSteps; ++t)                          runStep(t, std::true_type {});
+
+    state.s1 = s1;
+    state.s2 = s2;
+}
+
+void ParametricEq::processBlock(juce::AudioBuffer<float>& buffer) noexcept
+{
+    if (!isPrepared || buffer.getNumChannels() == 0)
+        return;
+
+    juce::ScopedNoDenormals noDenormals;
+
+    const int nCh   = juce::jmin((int)states.size(), buffer.getNumChannels());
+    const int nSmps = buffer.getNumSamples();
+
+    bool moving = pullParameters();
+
+    for (int pos = 0; pos < nSmps;)
+    {
+        // Nothing is moving, so run the rest of the block with the coefficients as they are
+        if (!moving)
+        {
+            for (int g = 0; g < maxGroups; ++g)
+                if (groupActive[(size_t)g])
+                    for (int ch = 0; ch < nCh; ++ch)
+                        processGroup(groupCoeffs[(size_t)g], nullptr, states[(size_t)ch][(size_t)g],
+                                     buffer.getWritePointer(ch) + pos, nSmps - pos);
+            break;
+        }
+
+        // A knob is moving: redesign once per sub-block, and blend the registers towards it sample by sample
+        const int len = juce::jmin(subBlockSize, nSmps - pos);
+        const auto from = groupCoeffs;
+        const auto wasActive = groupActive;
+        updateCoefficients(len);
+
+        const Vec perSample = Vec::expand(1.0f / (float)len);
+        for (int g = 0; g < maxGroups; ++g)
+        {
+            const auto& a = from[(size_t)g];
+            const auto& b = groupCoeffs[(size_t)g];
+
+            if (wasActive[(size_t)g] || groupActive[(size_t)g])
+            {
+                const LaneCoefficients step { (b.b0 - a.b0) * perSample, (b.b1 - a.b1) * perSample, (b.b2 - a.b2) * perSample,
+                                              (b.a1 - a.a1) * perSample, (b.a2 - a.a2) * perSample };
+                for (int ch = 0; ch < nCh; ++ch)
+                    processGroup(a, &step, states[(size_t)ch][(size_t)g], buffer.getWritePointer(ch) + pos, len);
+            }
+
+            // Once a group is skipped, clear its memory so it doesn't click when it comes back
+            if (!groupActive[(size_t)g])
+                for (auto& channel : states)
+                    channel[(size_t)g] = { Vec::expand(0.0f), Vec::expand(0.0f) };
+        }
+
+        pos += len;
+        moving = pullParameters();
+    }
+}
@@ -0,0 +1,215 @@
+#include "Pitchblade/effects/PartitionedConvolver.h"
+//Author: huda
+
+void PartitionedConvolver::prepare(int partitionOrder, int maxKernelLength, int numChannels)
+{
+    partitionSize = 1 << partitionOrder;
+    fftSize = partitionSize * 2;
+    numBins = partitionSize + 1;
+    numPartitions = juce::jmax(1, (maxKernelLength + partitionSize - 1) / partitionSize);
+    if (fft == nullptr || fft->getSize() != fftSize)
+    {
+        fft = std::make_unique<juce::dsp::FFT>(partitionOrder + 1);
+        loadFft = std::make_unique<juce::dsp::FFT>(partitionOrder + 1);
+    }
+
+    for (auto& kernel : kernels)
+    {
+        kernel.partitions.assign((size_t)(numPartitions * numBins), Complex {});
+        kernel.numUsed = 0;
+    }
+    slots = packSlots(noSlot, noSlot, noSlot);
+
+    channels.resize((size_t)juce::jmax(1, numChannels));
+    for (auto& channel : channels)
+    {
+        channel.input.assign((size_t)partitionSize, 0.0f);
+        channel.output.assign((size_t)partitionSize, 0.0f);
+        channel.history.assign((size_t)fftSize, 0.0f);
+        channel.spectra.assign((size_t)(numPartitions * numBins), Complex {});
+    }
+
+    fftData.assign((size_t)fftSize * 2, 0.0f);
+    fadeOutput.assign((size_t)partitionSize, 0.0f);
+    accumulator.assign((size_t)numBins, Complex {});
+    loadData.assign((size_t)fftSize * 2, 0.0f);
+
+    reset();
+}
+
+void PartitionedConvolver::reset()
+{
+    for (auto& channel : channels)
+    {
+        std::fill(channel.input.begin(), channel.input.end(), 0.0f);
+        std::fill(channel.output.begin(), channel.output.end(), 0.0f);
+        std::fill(channel.history.begin(), channel.history.end(), 0.0f);
+        std::fill(channel.spectra.begin(), channel.spectra.end(), Complex {});
+    }
+    ringPos = 0;
+    fillPos = 0;
+}
+
+void PartitionedConvolver::loadKernel(const float* taps, int numTaps)
+{
+    // Any slot the audio thread isn't using or about to use is free. The audio thread only ever takes the
+    // published slot, so the one picked here stays free until it is published below
+    const uint32_t current = slots.load(std::memory_order_acquire);
+    uint32_t slot = 0;
+    while (slot == activeSlot(current) || slot == fadingSlot(current) || slot == publishedSlot(current))
+        ++slot;
+
+    auto& kernel = kernels[slot];
+    const int used = juce::jlimit(1, numPartitions, (numTaps + partitionSize - 1) / partitionSize);
+
+    for (int p = 0; p < used; ++p)
+    {
+        // each partition goes in the first half of the frame with zeros after it
+        std::fill(loadData.begin(), loadData.end(), 0.0f);
+        const int start = p * partitionSize;
+        const int count = juce::jmin(partitionSize, numTaps - start);
+        if (count > 0)
+            std::copy(taps + start, taps + start + count, loadData.begin());
+
+        loadFft->performRealOnlyForwardTransform(loadData.data());
+        const auto* spectrum = reinterpret_cast<const Complex*>(loadData.data());
+        std::copy(spectrum, spectrum + numBins, kernel.partitions.begin() + p * numBins);
+    }
+    kernel.numUsed = used;
+
+    // Hand it over. If an older kernel was still waiting it is simply replaced
+    uint32_t expected = slots.load(std::memory_order_acquire);
+    while (!slots.compare_exchange_weak(expected, packSlots(activeSlot(expected), fadingSlot(expected), slot),
+                                        std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+    }
+}
+
+void PartitionedConvolver::process(juce::AudioBuffer<float>& buffer) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), (int)channels.size());
+
+    int position = 0;
+    while (position < numSamples)
+    {
+        // Work in straight runs up to the end of the block being gathered
+        const int count = juce::jmin(numSamples - position, partitionSize - fillPos);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& channel = channels[(size_t)ch];
+            float* data = buffer.getWritePointer(ch) + position;
+            std::copy(data, data + count, channel.input.begin() + fillPos);
+            std::copy(channel.output.begin() + fillPos, channel.output.begin() + fillPos + count, data);
+        }
+        fillPos += count;
+        position += count;
+
+        if (fillPos == partitionSize)
+        {
+            fillPos = 0;
+            processPartition(numChannels);
+        }
+    }
+}
+
+void PartitionedConvolver::processPartition(int numChannels) noexcept
+{
+    // Take a newly published kernel, unless the last one is still fading in
+    uint32_t state = slots.load(std::memory_order_acquire);
+    while (fadingSlot(state) == noSlot && publishedSlot(state) != noSlot)
+    {
+        // with nothing playing yet there is nothing to fade from
+        const uint32_t next = packSlots(publishedSlot(state), activeSlot(state), noSlot);
+        if (slots.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            state = next;
+            break;
+        }
+    }
+    const uint32_t active = activeSlot(state);
+    const uint32_t fading = fadingSlot(state);
+
+    ringPos = (ringPos + 1) % numPartitions;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = channels[(size_t)ch];
+
+        // Overlap-save: the frame is the previous block followed by this one
+        std::copy(channel.history.begin() + partitionSize, channel.history.end(), channel.history.begin());
+        std::copy(channel.input.begin(), channel.input.end(), channel.history.begin() + partitionSize);
+
+        std::copy(channel.history.begin(), channel.history.end(), fftData.begin());
+        std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+        fft->performRealOnlyForwardTransform(fftData.data());
+        const auto* spectrum = reinterpret_cast<const Complex*>(fftData.data());
+        std::copy(spectrum, spectrum + numBins, channel.spectra.begin() + ringPos * numBins);
+
+        if (active == noSlot)
+        {
+            std::fill(channel.output.begin(), channel.output.end(), 0.0f);
+            continue;
+        }
+
+        // Only the second half of the result is free of wrap around
+        accumulate(channel, kernels[active]);
+        inverse();
+        std::copy(fftData.begin() + partitionSize, fftData.begin() + fftSize, channel.output.begin());
+
+        if (fading != noSlot)
+        {
+            // Same input through the old kernel, then a straight line from old to new across the block
+            accumulate(channel, kernels[fading]);
+            inverse();
+            std::copy(fftData.begin() + partitionSize, fftData.begin() + fftSize, fadeOutput.begin());
+
+            const float step = 1.0f / (float)partitionSize;
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                const float amount = (float)(i + 1) * step;
+                channel.output[(size_t)i] = fadeOutput[(size_t)i] + amount * (channel.output[(size_t)i] - fadeOutput[(size_t)i]);
+            }
+        }
+    }
+
+    // The fade takes one block, after which the old slot is free again
+    if (fading != noSlot)
+    {
+        uint32_t expected = slots.load(std::memory_order_acquire);
+        while (!slots.compare_exchange_weak(expected, packSlots(activeSlot(expected), noSlot, publishedSlot(expected)),
+                                            std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+        }
+    }
+}
+
+void PartitionedConvolver::accumulate(const ChannelState& channel, const Kernel& kernel) noexcept
+{
+    std::fill(accumulator.begin(), accumulator.end(), Complex {});
+
+    // Partition p meets the input from p blocks ago
+    for (int p = 0; p < kernel.numUsed; ++p)
+    {
+        const int index = (ringPos - p + numPartitions) % numPartitions;
+        const Complex* x = channel.spectra.data() + index * numBins;
+        const Complex* h = kernel.partitions.data() + p * numBins;
+
+        // Written out by hand, since std::complex's operator* has extra checks for infinities that stop it vectorising
+        for (int k = 0; k < numBins; ++k)
+        {
+            const float re = x[k].real() * h[k].real() - x[k].imag() * h[k].imag();
+            const float im = x[k].real() * h[k].imag() + x[k].imag() * h[k].real();
+            accumulator[(size_t)k] += Complex(re, im);
+        }
+    }
+}
+
+void PartitionedConvolver::inverse() noexcept
+{
+    auto* spectrum = reinterpret_cast<Complex*>(fftData.data());
+    std::copy(accumulator.begin(), accumulator.end(), spectrum);
+    std::fill(fftData.begin() + numBins * 2, fftData.end(), 0.0f);
+    fft->performRealOnlyInverseTransform(fftData.data());
+}
@@ -0,0 +1,109 @@
+// Written by Austin Hills
+
+#include "Pitchblade/effects/StftEngine.h"
+#include <map>
+#include <mutex>
+
+std::shared_ptr<const StftPlan> StftPlan::get(int fftOrder){
+    //Plans are kept only as long as something is using them
+    static std::mutex lock;
+    static std::map<int, std::weak_ptr<const StftPlan>> plans;
+
+    const std::scoped_lock scopedLock(lock);
+    auto& cached = plans[fftOrder];
+    auto plan = cached.lock();
+    if(plan == nullptr){
+        plan = std::make_shared<const StftPlan>(fftOrder);
+        cached = plan;
+    }
+    return plan;
+}
+
+StftPlan::StftPlan(int fftOrder)
+    : order(fftOrder),
+        size(1 << fftOrder)
+{
+    window.resize((size_t)size);
+    for(int i = 0; i < size; i++){
+        window[(size_t)i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)i / (float)size);
+        windowSum += window[(size_t)i];
+    }
+}
+
+void StftEngine::prepare(int fftOrder, int hopSizeValue, int numChannels){
+    plan = StftPlan::get(fftOrder);
+    if(fft == nullptr || fft->getSize() != plan->size){
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    }
+    fftSize = plan->size;
+    hopSize = hopSizeValue;
+    numBins = fftSize / 2 + 1;
+    mask = fftSize - 1;
+    jassert(hopSize > 0 && fftSize % hopSize == 0 && hopSize * 4 <= fftSize);
+
+    //Overlap adding window squared frames every hop averages out to (sum of window squared) / hop
+    float windowSquaredSum = 0.0f;
+    for(float w : plan->window){
+        windowSquaredSum += w * w;
+    }
+    synthesisScale = (float)hopSize / windowSquaredSum;
+
+    channels.resize((size_t)std::max(numChannels, 1));
+    spectra.resize(channels.size());
+    for(size_t ch = 0; ch < channels.size(); ch++){
+        channels[ch].inputRing.resize((size_t)fftSize);
+        channels[ch].outputRing.resize((size_t)fftSize);
+        channels[ch].fftData.resize((size_t)fftSize * 2);
+        spectra[ch] = reinterpret_cast<Complex*>(channels[ch].fftData.data());
+    }
+
+    reset();
+}
+
+void StftEngine::reset(){
+    for(auto& channel : channels){
+        std::fill(channel.inputRing.begin(), channel.inputRing.end(), 0.0f);
+        std::fill(channel.outputRing.begin(), channel.outputRing.end(), 0.0f);
+        std::fill(channel.fftData.begin(), channel.fftData.end(), 0.0f);
+    }
+    ringPos = 0;
+    hopCounter = 0;
+}
+
+void StftEngine::analyseFrame(int numChannels){
+    const float* window = plan->window.data();
+    //ringPos is where the next sample goes, so it is also the oldest sample in the ring
+    const int firstRun = fftSize - ringPos;
+
+    for(int ch = 0; ch < numChannels; ch++){
+        auto& channel = channels[(size_t)ch];
+        float* fftData = channel.fftData.data();
+
+        //Unwrap the ring, oldest first
+        std::copy(channel.inputRing.data() + ringPos, channel.inputRing.data() + fftSize, fftData);
+        std::copy(channel.inputRing.data(), channel.inputRing.data() + ringPos, fftData + firstRun);
+        juce::FloatVectorOperations::multiply(fftData, window, fftSize);
+
+        //Clear imaginary part
+        std::fill(fftData + fftSize, fftData + fftSize * 2, 0.0f);
+
+        fft->performRealOnlyForwardTransform(fftData);
+    }
+}
+
+void StftEngine::synthesiseFrame(int numChannels){
+    const float* window = plan->window.data();
+    const int firstRun = fftSize - ringPos;
+
+    for(int ch = 0; ch < numChannels; ch++){
+        auto& channel = channels[(size_t)ch];
+        float* fftData = channel.fftData.data();
+
+        fft->performRealOnlyInverseTransform(fftData);
+        juce::FloatVectorOperations::multiply(fftData, window, fftSize);
+
+        //The frame lines up with the ring the same way the input was unwrapped, so it lands one frame after it came in
+        juce::FloatVectorOperations::addWithMultiply(channel.outputRing.data() + ringPos, fftData, synthesisScale, firstRun);
+        juce::FloatVectorOperations::addWithMultiply(channel.outputRing.data(), fftData + firstRun, synthesisScale, ringPos);
+    }
+}
@@ -16,6 +16,7 @@ CompressorPanel::CompressorPanel(AudioPluginAudioProcessor& proc, juce::ValueTre
     ratioSlider.setName("Ratio");
     attackSlider.setName("Attack");
     releaseSlider.setName("Release");
+    lookaheadSlider.setName("Lookahead");
    
 
     // Label
@@ -86,6 +87,13 @@ CompressorPanel::CompressorPanel(AudioPluginAudioProcessor& proc, juce::ValueTre
     releaseSlider.setTextValueSuffix(" ms");
     addAndMakeVisible(releaseSlider);
 
+    // Lookahead slider
+    lookaheadSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+    lookaheadSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 25);
+    lookaheadSlider.setNumDecimalPlacesToDisplay(1);
+    lookaheadSlider.setTextValueSuffix(" ms");
+    addAndMakeVisible(lookaheadSlider);
+
     ///////////////////
     // Link sliders to local state properties
     const float startThresholdDb = (float)localState.getProperty("CompThreshold", 0.0f);
@@ -115,6 +123,13 @@ CompressorPanel::CompressorPanel(AudioPluginAudioProcessor& proc, juce::ValueTre
     releaseSlider.onValueChange = [this]() {
         localState.setProperty("CompRelease", (float)releaseSlider.getValue(), nullptr);
         };
+
+    const float startLookaheadMs = (float)localState.getProperty("CompLookahead", 0.0f);
+    lookaheadSlider.setRange(0.0f, 10.0f, 0.1f);
+    lookaheadSlider.setValue(startLookaheadMs, juce::dontSendNotification);
+    lookaheadSlider.onValueChange = [this]() {
+        localState.setProperty("CompLookahead", (float)lookaheadSlider.getValue(), nullptr);
+        };
     
     // Add this panel as a listener to the local state
     localState.addListener(this);
@@ -179,14 +194,17 @@ void CompressorPanel::resized() {
     modeButton.setBounds(toggleArea.withTrimmedTop(-25).withSizeKeepingCentre(250, 40));
 
     // dials
-    int dialW = (rightCol.getWidth() / 2);
+    int dialW = (rightCol.getWidth() / 3);
     int dialH2 = (rightCol.getHeight());
 
     auto ratioArea = rightCol.removeFromLeft(dialW);
     place(ratioArea, ratioSlider, ratioLabel, true);
 
-    auto attackArea = rightCol;
+    auto attackArea = rightCol.removeFromLeft(dialW);
     place(attackArea, attackSlider, attackLabel, true);
+
+    auto lookaheadArea = rightCol;
+    place(lookaheadArea, lookaheadSlider, lookaheadLabel, true);
 }
 
 void CompressorPanel::updateSliderVisibility()
@@ -230,6 +248,8 @@ void CompressorPanel::valueTreePropertyChanged(juce::ValueTree& tree, const juce
             attackSlider.setValue((float)tree.getProperty("CompAttack"), juce::dontSendNotification);
         else if (property == juce::Identifier("CompRelease"))
             releaseSlider.setValue((float)tree.getProperty("CompRelease"), juce::dontSendNotification);
+        else if (property == juce::Identifier("CompLookahead"))
+            lookaheadSlider.setValue((float)tree.getProperty("CompLookahead"), juce::dontSendNotification);
         else if (property == juce::Identifier("CompLimiterMode"))
         {
             modeButton.setToggleState((bool)tree.getProperty("CompLimiterMode"), juce::dontSendNotification);
@@ -246,14 +266,14 @@ CompressorVisualizer::~CompressorVisualizer(){
     }
 
 //Update the graph
-void CompressorVisualizer::timerCallback(){
+void CompressorVisualizer::frameCallback(){
     float newDbLevel = compressorNode.getOutputLevelAtomic().load();
 
     //Push it to graph
     pushData(newDbLevel);
 
-    //Call the graph visualizer's timerCallback
-    RealTimeGraphVisualizer::timerCallback();
+    //Call the graph visualizer's frameCallback
+    RealTimeGraphVisualizer::frameCallback();
 }
 
 void CompressorVisualizer::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property){
@@ -276,6 +296,7 @@ std::unique_ptr<juce::XmlElement> CompressorNode::toXml() const {
     xml->setAttribute("CompAttack", (float)getNodeState().getProperty("CompAttack", 50.0f));
     xml->setAttribute("CompRelease", (float)getNodeState().getProperty("CompRelease", 250.0f));
     xml->setAttribute("CompLimiterMode", (int)getNodeState().getProperty("CompLimiterMode", 0));
+    xml->setAttribute("CompLookahead", (float)getNodeState().getProperty("CompLookahead", 0.0f));
     
     return xml;
 }
@@ -289,4 +310,5 @@ void CompressorNode::loadFromXml(const juce::XmlElement& xml) {
     s.setProperty("CompAttack", (float)xml.getDoubleAttribute("CompAttack", 50.0f), nullptr);
     s.setProperty("CompRelease", (float)xml.getDoubleAttribute("CompRelease", 250.0f), nullptr);
     s.setProperty("CompLimiterMode", (int)xml.getIntAttribute("CompLimiterMode", 0), nullptr);
+    s.setProperty("CompLookahead", (float)xml.getDoubleAttribute("CompLookahead", 0.0f), nullptr);
 }
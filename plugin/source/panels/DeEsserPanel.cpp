@@ -12,6 +12,7 @@ DeEsserPanel::DeEsserPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& sta
     attackSlider.setName("Attack");
     releaseSlider.setName("Release");
     frequencySlider.setName("Frequency");
+    lookaheadSlider.setName("Lookahead");
 
     // Main Label
     deEsserLabel.setText(panelTitle, juce::dontSendNotification);
@@ -78,6 +79,26 @@ DeEsserPanel::DeEsserPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& sta
     frequencyLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(frequencyLabel);
 
+    // Lookahead Slider
+    lookaheadSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+    lookaheadSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 25);
+    lookaheadSlider.setNumDecimalPlacesToDisplay(1);
+    lookaheadSlider.setTextValueSuffix(" ms");
+    addAndMakeVisible(lookaheadSlider);
+
+    // Lookahead Label
+    lookaheadLabel.setText("Lookahead", juce::dontSendNotification);
+    lookaheadLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(lookaheadLabel);
+
+    // Split band toggle
+    splitBandButton.setClickingTogglesState(true);
+    splitBandButton.setToggleState((bool)localState.getProperty("DeEsserSplitBand", false), juce::dontSendNotification);
+    splitBandButton.onClick = [this]() {
+        localState.setProperty("DeEsserSplitBand", splitBandButton.getToggleState(), nullptr);
+    };
+    addAndMakeVisible(splitBandButton);
+
     ///////////////////
     // Link sliders to local state properties
     const float startThresholdDb = (float)localState.getProperty("DeEsserThreshold", 0.0f);
@@ -114,6 +135,13 @@ DeEsserPanel::DeEsserPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& sta
     frequencySlider.onValueChange = [this]() {
         localState.setProperty("DeEsserFrequency", (float)frequencySlider.getValue(), nullptr);
         };
+
+    const float startLookaheadMs = (float)localState.getProperty("DeEsserLookahead", 0.0f);
+    lookaheadSlider.setRange(0.0, 10.0, 0.1);
+    lookaheadSlider.setValue(startLookaheadMs, juce::dontSendNotification);
+    lookaheadSlider.onValueChange = [this]() {
+        localState.setProperty("DeEsserLookahead", (float)lookaheadSlider.getValue(), nullptr);
+        };
     
     // Add this panel as a listener to the local state
     localState.addListener(this);
@@ -133,17 +161,20 @@ void DeEsserPanel::resized()
 {
     auto area = getLocalBounds();
 
-    // Title label at the top
-    deEsserLabel.setBounds(area.removeFromTop(30));
+    // Title label at the top, with the split band toggle on the right of it
+    auto titleArea = area.removeFromTop(30);
+    splitBandButton.setBounds(titleArea.removeFromRight(130).reduced(4, 2));
+    deEsserLabel.setBounds(titleArea);
 
     auto dials = area.reduced(10);
-    int dialWidth = dials.getWidth() / 5;
+    int dialWidth = dials.getWidth() / 6;
 
     auto frequencyArea = dials.removeFromLeft(dialWidth).reduced(5);
     auto thresholdArea = dials.removeFromLeft(dialWidth).reduced(5);
     auto ratioArea = dials.removeFromLeft(dialWidth).reduced(5);
     auto attackArea = dials.removeFromLeft(dialWidth).reduced(5);
-    auto releaseArea = dials.reduced(5);
+    auto releaseArea = dials.removeFromLeft(dialWidth).reduced(5);
+    auto lookaheadArea = dials.reduced(5);
 
     // Positioning frequency label and slider
     frequencyLabel.setBounds(frequencyArea.removeFromTop(20));
@@ -164,6 +195,10 @@ void DeEsserPanel::resized()
     // Positioning release label and slider
     releaseLabel.setBounds(releaseArea.removeFromTop(20));
     releaseSlider.setBounds(releaseArea);
+
+    // Positioning lookahead label and slider
+    lookaheadLabel.setBounds(lookaheadArea.removeFromTop(20));
+    lookaheadSlider.setBounds(lookaheadArea);
 }
 
 // value tree listener callback
@@ -181,26 +216,45 @@ void DeEsserPanel::valueTreePropertyChanged(juce::ValueTree& tree, const juce::I
             releaseSlider.setValue((float)tree.getProperty("DeEsserRelease"), juce::dontSendNotification);
         else if (property == juce::Identifier("DeEsserFrequency"))
             frequencySlider.setValue((float)tree.getProperty("DeEsserFrequency"), juce::dontSendNotification);
+        else if (property == juce::Identifier("DeEsserLookahead"))
+            lookaheadSlider.setValue((float)tree.getProperty("DeEsserLookahead"), juce::dontSendNotification);
+        else if (property == juce::Identifier("DeEsserSplitBand"))
+            splitBandButton.setToggleState((bool)tree.getProperty("DeEsserSplitBand"), juce::dontSendNotification);
     }
 }
 
+DeEsserVisualizer::DeEsserVisualizer(AudioPluginAudioProcessor& proc, DeEsserNode& node, juce::ValueTree& state)
+    : FrequencyGraphVisualizer(5, 1),
+        processor(proc),
+        deEsserNode(node),
+        localState(state),
+        analyser(node.getDSP().getAnalysisTap())
+{
+    localState.addListener(this);
+    updateThresholdLines();
+}
+
 DeEsserVisualizer::~DeEsserVisualizer(){
     if(localState.isValid()){
         localState.removeListener(this);
     }
 }
 
-void DeEsserVisualizer::timerCallback(){
-    //Get data from processor
-    auto spectrum = deEsserNode.getDSP().getSpectrumData();
+void DeEsserVisualizer::frameVisibilityChanged(bool isNowShowing){
+    //Only ask the processor for audio while this tab is actually on screen
+    analyser.setListening(isNowShowing);
+}
 
-    //Push data to visualizer
-    updateSpectrumData(spectrum);
+void DeEsserVisualizer::frameCallback(){
+    //Analyse the newest audio and push it to the graph
+    if(analyser.process(spectrumPoints)){
+        updateSpectrumData(spectrumPoints);
+    }
     
     // We are in mode 1, so no secondary spectrum data is needed.
     
     // This calls repaint()
-    FrequencyGraphVisualizer::timerCallback();
+    FrequencyGraphVisualizer::frameCallback();
 }
 
 void DeEsserVisualizer::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property){
@@ -229,6 +283,8 @@ std::unique_ptr<juce::XmlElement> DeEsserNode::toXml() const {
     xml->setAttribute("DeEsserAttack", (float)getNodeState().getProperty("DeEsserAttack", 5.0f));
     xml->setAttribute("DeEsserRelease", (float)getNodeState().getProperty("DeEsserRelease", 5.0f));
     xml->setAttribute("DeEsserFrequency", (float)getNodeState().getProperty("DeEsserFrequency", 6000.0f));
+    xml->setAttribute("DeEsserLookahead", (float)getNodeState().getProperty("DeEsserLookahead", 0.0f));
+    xml->setAttribute("DeEsserSplitBand", (int)getNodeState().getProperty("DeEsserSplitBand", 0));
     return xml;
 }
 
@@ -241,4 +297,6 @@ void DeEsserNode::loadFromXml(const juce::XmlElement& xml) {
     s.setProperty("DeEsserAttack", (float)xml.getDoubleAttribute("DeEsserAttack", 5.0f), nullptr);
     s.setProperty("DeEsserRelease", (float)xml.getDoubleAttribute("DeEsserRelease", 5.0f), nullptr);
     s.setProperty("DeEsserFrequency", (float)xml.getDoubleAttribute("DeEsserFrequency", 6000.0f), nullptr);
+    s.setProperty("DeEsserLookahead", (float)xml.getDoubleAttribute("DeEsserLookahead", 0.0f), nullptr);
+    s.setProperty("DeEsserSplitBand", (bool)xml.getIntAttribute("DeEsserSplitBand", 0), nullptr);
 }
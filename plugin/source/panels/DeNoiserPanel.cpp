@@ -41,6 +41,14 @@ DeNoiserPanel::DeNoiserPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& s
         }
     };
 
+    //Adaptive toggle
+    adaptiveButton.setClickingTogglesState(true);
+    adaptiveButton.setToggleState((bool)localState.getProperty("DenoiserAdaptive",false),juce::dontSendNotification);
+    adaptiveButton.onClick = [this]() {
+        localState.setProperty("DenoiserAdaptive",adaptiveButton.getToggleState(),nullptr);
+    };
+    addAndMakeVisible(adaptiveButton);
+
     //New status label
     statusLabel.setText("Learning. Do not make noise.", juce::dontSendNotification);
     statusLabel.setJustificationType(juce::Justification::centred);
@@ -58,6 +66,20 @@ DeNoiserPanel::DeNoiserPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& s
     reductionLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(reductionLabel);
 
+    //FFT mode box. Ids are the mode plus one, since ComboBox ids can't be 0
+    modeBox.addItem("Low Latency",1);
+    modeBox.addItem("Balanced",2);
+    modeBox.addItem("High Resolution",3);
+    modeBox.setSelectedId((int)localState.getProperty("DenoiserMode",1) + 1,juce::dontSendNotification);
+    modeBox.onChange = [this]() {
+        localState.setProperty("DenoiserMode",modeBox.getSelectedId() - 1,nullptr);
+    };
+    addAndMakeVisible(modeBox);
+
+    modeLabel.setText("FFT Mode",juce::dontSendNotification);
+    modeLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(modeLabel);
+
     //Link sliders to local state properties
     const float startReduction = (float)localState.getProperty("DenoiserReduction",0.5f);
     reductionSlider.setRange(0.0,1.0f,0.01f);
@@ -84,8 +106,10 @@ void DeNoiserPanel::paint(juce::Graphics& g){
 void DeNoiserPanel::resized(){
     auto area = getLocalBounds();
 
-    //Title label at the top
-    deNoiserLabel.setBounds(area.removeFromTop(50));
+    //Title label at the top, with the adaptive toggle on the right of it
+    auto titleArea = area.removeFromTop(50);
+    adaptiveButton.setBounds(titleArea.removeFromRight(110).reduced(4,12));
+    deNoiserLabel.setBounds(titleArea);
     learnButton.setBounds(area.removeFromTop(30).reduced(20,-5));
 
     //Bounds for status label below the button
@@ -101,12 +125,21 @@ void DeNoiserPanel::resized(){
     //Positioning reduction label and slider
     reductionLabel.setBounds(reductionArea.removeFromTop(10));
     reductionSlider.setBounds(reductionArea);
+
+    //Mode box to the right of the dial
+    auto modeArea = dials.reduced(5);
+    modeLabel.setBounds(modeArea.removeFromTop(20));
+    modeBox.setBounds(modeArea.removeFromTop(25));
 }
 
 void DeNoiserPanel::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property){
     if(tree == localState){
         if(property==juce::Identifier("DenoiserReduction")){
             reductionSlider.setValue((float)tree.getProperty("DenoiserReduction"),juce::dontSendNotification);
+        }else if(property==juce::Identifier("DenoiserMode")){
+            modeBox.setSelectedId((int)tree.getProperty("DenoiserMode") + 1,juce::dontSendNotification);
+        }else if(property==juce::Identifier("DenoiserAdaptive")){
+            adaptiveButton.setToggleState((bool)tree.getProperty("DenoiserAdaptive"),juce::dontSendNotification);
         }
     }
 }
@@ -149,22 +182,42 @@ void DeNoiserPanel::timerCallback(){
 }
 
 //Visualizer stuff
+DeNoiserVisualizer::DeNoiserVisualizer(AudioPluginAudioProcessor& proc, DeNoiserNode& node, juce::ValueTree& state)
+    : FrequencyGraphVisualizer(5, 2),
+        processor(proc),
+        deNoiserNode(node),
+        localState(state),
+        //Same FFT size the noise profile is published at and the de-noiser's unnormalised window, so the spectrum and the noise profile line up
+        analyser(node.getDSP().getAnalysisTap(), DeNoiserProcessor::getDisplayFFTOrder(), false)
+{
+    noiseMagnitudes.resize((size_t)node.getDSP().getNoiseProfileTap().getFrameSize(), 0.0f);
+}
+
 DeNoiserVisualizer::~DeNoiserVisualizer(){
     if(localState.isValid()){
         localState.removeListener(this);
     }
 }
 
-void DeNoiserVisualizer::timerCallback(){
-    //Get data from processor
-    auto spectrum = deNoiserNode.getDSP().getSpectrumData();
-    auto noise = deNoiserNode.getDSP().getNoiseProfileData();
+void DeNoiserVisualizer::frameVisibilityChanged(bool isNowShowing){
+    //Only ask the processor for audio while this tab is actually on screen
+    analyser.setListening(isNowShowing);
+}
+
+void DeNoiserVisualizer::frameCallback(){
+    //Analyse the newest audio and push it to the graph
+    if(analyser.process(spectrumPoints)){
+        updateSpectrumData(spectrumPoints);
+    }
 
-    //Push data to visualizer
-    updateSpectrumData(spectrum);
-    updateSecondarySpectrumData(noise);
+    //The noise profile only changes while learning, so only redo the points when there's a new one
+    if(deNoiserNode.getDSP().getNoiseProfileTap().pull(noiseMagnitudes.data()) || !hasNoiseProfile){
+        analyser.magnitudesToPoints(noiseMagnitudes.data(), noisePoints);
+        updateSecondarySpectrumData(noisePoints);
+        hasNoiseProfile = true;
+    }
 
-    FrequencyGraphVisualizer::timerCallback();
+    FrequencyGraphVisualizer::frameCallback();
 }
 
 void DeNoiserVisualizer::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property){
@@ -180,10 +233,14 @@ std::unique_ptr<juce::XmlElement> DeNoiserNode::toXml() const {
     auto xml = std::make_unique<juce::XmlElement>("DeNoiserNode");
     xml->setAttribute("name", effectName);
     xml->setAttribute("DenoiserReduction", (float)getNodeState().getProperty("DenoiserReduction", 0.0f));
+    xml->setAttribute("DenoiserAdaptive", (int)getNodeState().getProperty("DenoiserAdaptive", 0));
+    xml->setAttribute("DenoiserMode", (int)getNodeState().getProperty("DenoiserMode", 1));
     return xml;
 }
 
 void DeNoiserNode::loadFromXml(const juce::XmlElement& xml) {
     auto& s = getMutableNodeState();
     s.setProperty("DenoiserReduction", (float)xml.getDoubleAttribute("DenoiserReduction", 0.0f), nullptr);
+    s.setProperty("DenoiserAdaptive", (bool)xml.getIntAttribute("DenoiserAdaptive", 0), nullptr);
+    s.setProperty("DenoiserMode", juce::jlimit(0, DeNoiserProcessor::numModes - 1, xml.getIntAttribute("DenoiserMode", 1)), nullptr);
 }
\ No newline at end of file
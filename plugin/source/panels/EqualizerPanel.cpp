@@ -38,6 +38,14 @@ EqualizerPanel::EqualizerPanel (AudioPluginAudioProcessor& proc, juce::ValueTree
     equalizerLabel.setName("NodeTitle");
     addAndMakeVisible(equalizerLabel);
 
+    // Linear phase toggle, trades latency for no phase shift - huda
+    linearPhaseButton.setClickingTogglesState(true);
+    linearPhaseButton.setToggleState((bool)localState.getProperty("LinearPhase", false), juce::dontSendNotification);
+    linearPhaseButton.onClick = [this]() {
+        localState.setProperty("LinearPhase", linearPhaseButton.getToggleState(), nullptr);
+    };
+    addAndMakeVisible(linearPhaseButton);
+
     // make small dials for bottom row - reyna
     static SmallDialLookAndFeel smallDialLF;
     lowGain.setLookAndFeel(&smallDialLF);
@@ -53,17 +61,8 @@ EqualizerPanel::EqualizerPanel (AudioPluginAudioProcessor& proc, juce::ValueTree
 
     auto updateTree = [this](juce::Slider& s, const juce::String& key) {
         s.onValueChange = [this, &s, key]() {
-            // Update local state for persistence/serialization
+            // Update local state, the node pushes it on to its Equalizer
             localState.setProperty(key, (float)s.getValue(), nullptr);
-
-            // Also push the value directly to the audio DSP via thread-safe setters
-            // avoid reading/writing the ValueTree from the audio thread.
-            if (key == "LowFreq")   processor.getEqualizer().setLowFreq((float)s.getValue());
-            else if (key == "LowGain")   processor.getEqualizer().setLowGainDb((float)s.getValue());
-            else if (key == "MidFreq")   processor.getEqualizer().setMidFreq((float)s.getValue());
-            else if (key == "MidGain")   processor.getEqualizer().setMidGainDb((float)s.getValue());
-            else if (key == "HighFreq")  processor.getEqualizer().setHighFreq((float)s.getValue());
-            else if (key == "HighGain")  processor.getEqualizer().setHighGainDb((float)s.getValue());
         };
     };
     updateTree(lowFreq, "LowFreq");
@@ -73,21 +72,15 @@ EqualizerPanel::EqualizerPanel (AudioPluginAudioProcessor& proc, juce::ValueTree
     updateTree(highFreq, "HighFreq");
     updateTree(highGain, "HighGain");
 
-    // Push initial slider values into the DSP so the Equalizer reflects stored node state immediately.
-    processor.getEqualizer().setLowFreq((float)lowFreq.getValue());
-    processor.getEqualizer().setLowGainDb((float)lowGain.getValue());
-    processor.getEqualizer().setMidFreq((float)midFreq.getValue());
-    processor.getEqualizer().setMidGainDb((float)midGain.getValue());
-    processor.getEqualizer().setHighFreq((float)highFreq.getValue());
-    processor.getEqualizer().setHighGainDb((float)highGain.getValue());
-
     localState.addListener(this);
 }
 
 void EqualizerPanel::resized()
 {
     auto area = getLocalBounds();
-    equalizerLabel.setBounds(area.removeFromTop(30));
+    auto titleArea = area.removeFromTop(30);
+    linearPhaseButton.setBounds(titleArea.removeFromRight(130).reduced(4, 4));
+    equalizerLabel.setBounds(titleArea);
 
     auto r = getLocalBounds().reduced (60,3); // (side,top/bot)
 
@@ -171,11 +164,11 @@ EqualizerPanel::~EqualizerPanel() {
 void EqualizerPanel::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property)
 {
     if (tree != localState) return;
-    if (property == juce::Identifier("LowFreq"))   { auto v = (float)tree.getProperty("LowFreq");  lowFreq.setValue(v, juce::dontSendNotification);  processor.getEqualizer().setLowFreq(v); }
-    if (property == juce::Identifier("LowGain"))   { auto v = (float)tree.getProperty("LowGain");  lowGain.setValue(v, juce::dontSendNotification);  processor.getEqualizer().setLowGainDb(v); }
-    if (property == juce::Identifier("MidFreq"))   { auto v = (float)tree.getProperty("MidFreq");  midFreq.setValue(v, juce::dontSendNotification);  processor.getEqualizer().setMidFreq(v); }
-    if (property == juce::Identifier("MidGain"))   { auto v = (float)tree.getProperty("MidGain");  midGain.setValue(v, juce::dontSendNotification);  processor.getEqualizer().setMidGainDb(v); }
-    if (property == juce::Identifier("HighFreq"))  { auto v = (float)tree.getProperty("HighFreq"); highFreq.setValue(v, juce::dontSendNotification); processor.getEqualizer().setHighFreq(v); }
-    if (property == juce::Identifier("HighGain"))  { auto v = (float)tree.getProperty("HighGain"); highGain.setValue(v, juce::dontSendNotification); processor.getEqualizer().setHighGainDb(v); }
-
+    if (property == juce::Identifier("LowFreq"))   { auto v = (float)tree.getProperty("LowFreq");  lowFreq.setValue(v, juce::dontSendNotification); }
+    if (property == juce::Identifier("LowGain"))   { auto v = (float)tree.getProperty("LowGain");  lowGain.setValue(v, juce::dontSendNotification); }
+    if (property == juce::Identifier("MidFreq"))   { auto v = (float)tree.getProperty("MidFreq");  midFreq.setValue(v, juce::dontSendNotification); }
+    if (property == juce::Identifier("MidGain"))   { auto v = (float)tree.getProperty("MidGain");  midGain.setValue(v, juce::dontSendNotification); }
+    if (property == juce::Identifier("HighFreq"))  { auto v = (float)tree.getProperty("HighFreq"); highFreq.setValue(v, juce::dontSendNotification); }
+    if (property == juce::Identifier("HighGain"))  { auto v = (float)tree.getProperty("HighGain"); highGain.setValue(v, juce::dontSendNotification); }
+    if (property == juce::Identifier("LinearPhase")) { auto v = (bool)tree.getProperty("LinearPhase"); linearPhaseButton.setToggleState(v, juce::dontSendNotification); }
 }
@@ -86,8 +86,8 @@ void GainNode::loadFromXml(const juce::XmlElement& xml) {
 
 
 // Update the graph by polling the node for the latest level
-    void GainVisualizer::timerCallback() {
+    void GainVisualizer::frameCallback() {
         float newDbLevel = gainNode.getOutputLevelAtomic().load();
         pushData(newDbLevel);
-        RealTimeGraphVisualizer::timerCallback(); // Call base to trigger repaint
+        RealTimeGraphVisualizer::frameCallback(); // Call base to trigger repaint
     }
\ No newline at end of file
@@ -0,0 +1,305 @@
+// Written by Austin Hills
+
+#include "Pitchblade/panels/MultibandCompressorPanel.h"
+#include <JuceHeader.h>
+#include "Pitchblade/PluginProcessor.h"
+#include "Pitchblade/ui/ColorPalette.h"
+#include "Pitchblade/ui/CustomLookAndFeel.h"
+
+//Property names are built once so the audio thread does not have to build identifiers from strings every block
+const juce::Identifier& MultibandCompressorNode::crossoverId(int index){
+    static const std::array<juce::Identifier, 3> ids { "MbCompCrossover1", "MbCompCrossover2", "MbCompCrossover3" };
+    return ids[(size_t)index];
+}
+
+const juce::Identifier& MultibandCompressorNode::thresholdId(int band){
+    static const std::array<juce::Identifier, 4> ids { "MbCompThreshold1", "MbCompThreshold2", "MbCompThreshold3", "MbCompThreshold4" };
+    return ids[(size_t)band];
+}
+
+const juce::Identifier& MultibandCompressorNode::ratioId(int band){
+    static const std::array<juce::Identifier, 4> ids { "MbCompRatio1", "MbCompRatio2", "MbCompRatio3", "MbCompRatio4" };
+    return ids[(size_t)band];
+}
+
+//Set up of UI components
+MultibandCompressorPanel::MultibandCompressorPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state, const juce::String& nodeTitle)
+    : processor(proc), localState(state), panelTitle(nodeTitle) {
+
+    // Label
+    titleLabel.setText(panelTitle, juce::dontSendNotification);
+    addAndMakeVisible(titleLabel);
+    titleLabel.setName("NodeTitle");
+
+    static SmallDialLookAndFeel smallDialLF;
+
+    //Band count
+    bandsLabel.setText("Bands", juce::dontSendNotification);
+    bandsLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(bandsLabel);
+    bandsBox.addItem("2 Bands", 2);
+    bandsBox.addItem("3 Bands", 3);
+    bandsBox.addItem("4 Bands", 4);
+    bandsBox.setSelectedId((int)localState.getProperty("MbCompBands", 3), juce::dontSendNotification);
+    bandsBox.onChange = [this]() {
+        localState.setProperty("MbCompBands", bandsBox.getSelectedId(), nullptr);
+    };
+    addAndMakeVisible(bandsBox);
+
+    //Small helper to set up a dial the same way every time
+    auto setupDial = [this](juce::Slider& slider, const juce::String& name, const juce::String& suffix, int decimals) {
+        slider.setName(name);
+        slider.setLookAndFeel(&smallDialLF);
+        slider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+        slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 70, 18);
+        slider.setNumDecimalPlacesToDisplay(decimals);
+        slider.setTextValueSuffix(suffix);
+        addAndMakeVisible(slider);
+    };
+
+    // Attack and release are shared by all bands
+    setupDial(attackSlider, "Attack", " ms", 1);
+    attackSlider.setRange(1.0f, 200.0f, 1.0f);
+    attackSlider.setValue((float)localState.getProperty("MbCompAttack", 10.0f), juce::dontSendNotification);
+    attackSlider.onValueChange = [this]() {
+        localState.setProperty("MbCompAttack", (float)attackSlider.getValue(), nullptr);
+        };
+
+    setupDial(releaseSlider, "Release", " ms", 1);
+    releaseSlider.setRange(10.0f, 1000.0f, 1.0f);
+    releaseSlider.setValue((float)localState.getProperty("MbCompRelease", 100.0f), juce::dontSendNotification);
+    releaseSlider.onValueChange = [this]() {
+        localState.setProperty("MbCompRelease", (float)releaseSlider.getValue(), nullptr);
+        };
+
+    // Crossovers
+    for (int i = 0; i < (int)crossoverSliders.size(); ++i) {
+        auto& slider = crossoverSliders[(size_t)i];
+        const auto& id = MultibandCompressorNode::crossoverId(i);
+
+        setupDial(slider, "Crossover", " Hz", 0);
+        slider.setRange(40.0f, 16000.0f, 1.0f);
+        slider.setSkewFactorFromMidPoint(1000.0f);
+        slider.setValue((float)localState.getProperty(id, MultibandCompressorNode::defaultCrossovers[(size_t)i]), juce::dontSendNotification);
+        slider.onValueChange = [this, i]() {
+            localState.setProperty(MultibandCompressorNode::crossoverId(i), (float)crossoverSliders[(size_t)i].getValue(), nullptr);
+            };
+
+        crossoverLabels[(size_t)i].setText("X" + juce::String(i + 1), juce::dontSendNotification);
+        crossoverLabels[(size_t)i].setJustificationType(juce::Justification::centred);
+        addAndMakeVisible(crossoverLabels[(size_t)i]);
+    }
+
+    // Per band threshold and ratio
+    for (int b = 0; b < (int)thresholdSliders.size(); ++b) {
+        auto& threshold = thresholdSliders[(size_t)b];
+        auto& ratio = ratioSliders[(size_t)b];
+
+        setupDial(threshold, "Threshold", " dB", 1);
+        threshold.setRange(-100.0f, 0.0f, 0.1f);
+        threshold.setValue((float)localState.getProperty(MultibandCompressorNode::thresholdId(b), 0.0f), juce::dontSendNotification);
+        threshold.onValueChange = [this, b]() {
+            localState.setProperty(MultibandCompressorNode::thresholdId(b), (float)thresholdSliders[(size_t)b].getValue(), nullptr);
+            };
+
+        setupDial(ratio, "Ratio", " : 1", 1);
+        ratio.setRange(1.0f, 20.0f, 0.1f);
+        ratio.setValue((float)localState.getProperty(MultibandCompressorNode::ratioId(b), 3.0f), juce::dontSendNotification);
+        ratio.onValueChange = [this, b]() {
+            localState.setProperty(MultibandCompressorNode::ratioId(b), (float)ratioSliders[(size_t)b].getValue(), nullptr);
+            };
+
+        bandLabels[(size_t)b].setText("Band " + juce::String(b + 1), juce::dontSendNotification);
+        bandLabels[(size_t)b].setJustificationType(juce::Justification::centred);
+        addAndMakeVisible(bandLabels[(size_t)b]);
+    }
+
+    // Add this panel as a listener to the local state
+    localState.addListener(this);
+
+    updateBandVisibility();
+}
+
+MultibandCompressorPanel::~MultibandCompressorPanel() {
+    if (localState.isValid())
+        localState.removeListener(this);
+
+    //Dials share a static look and feel, so clear it before they are destroyed
+    attackSlider.setLookAndFeel(nullptr);
+    releaseSlider.setLookAndFeel(nullptr);
+    for (auto& s : crossoverSliders) s.setLookAndFeel(nullptr);
+    for (auto& s : thresholdSliders) s.setLookAndFeel(nullptr);
+    for (auto& s : ratioSliders) s.setLookAndFeel(nullptr);
+}
+
+void MultibandCompressorPanel::paint(juce::Graphics& g) {
+    g.drawRect(getLocalBounds(), 2);
+}
+
+void MultibandCompressorPanel::resized() {
+    auto area = getLocalBounds();
+
+    //panel label
+    titleLabel.setBounds(area.removeFromTop(30));
+
+    auto r = area.reduced(10, 6);
+
+    // left column - band count, attack and release
+    auto leftCol = r.removeFromLeft(r.getWidth() / 5);
+    bandsLabel.setBounds(leftCol.removeFromTop(20));
+    bandsBox.setBounds(leftCol.removeFromTop(26).reduced(4, 0));
+    leftCol.removeFromTop(6);
+    const int sharedH = leftCol.getHeight() / 2;
+    attackSlider.setBounds(leftCol.removeFromTop(sharedH).reduced(4));
+    releaseSlider.setBounds(leftCol.reduced(4));
+
+    // top row - crossovers
+    auto crossoverRow = r.removeFromTop(r.getHeight() / 3);
+    const int crossoverW = crossoverRow.getWidth() / (int)crossoverSliders.size();
+    for (size_t i = 0; i < crossoverSliders.size(); ++i) {
+        auto cell = crossoverRow.removeFromLeft(crossoverW);
+        crossoverLabels[i].setBounds(cell.removeFromLeft(30));
+        crossoverSliders[i].setBounds(cell.reduced(2));
+    }
+
+    // band columns - label, threshold and ratio
+    const int bandW = r.getWidth() / (int)thresholdSliders.size();
+    for (size_t b = 0; b < thresholdSliders.size(); ++b) {
+        auto col = r.removeFromLeft(bandW);
+        bandLabels[b].setBounds(col.removeFromTop(20));
+        const int dialH = col.getHeight() / 2;
+        thresholdSliders[b].setBounds(col.removeFromTop(dialH).reduced(2));
+        ratioSliders[b].setBounds(col.reduced(2));
+    }
+}
+
+void MultibandCompressorPanel::updateBandVisibility()
+{
+    const int numBands = juce::jlimit(2, 4, (int)localState.getProperty("MbCompBands", 3));
+
+    // Bands past the current count are greyed out, the same way the compressor greys out sliders in limiter mode - reyna
+    auto greyOut = [](juce::Component& c, bool active) {
+        c.setEnabled(active);
+        c.setAlpha(active ? 1.0f : 0.4f);
+    };
+
+    for (int i = 0; i < (int)crossoverSliders.size(); ++i) {
+        const bool active = i < numBands - 1;
+        greyOut(crossoverSliders[(size_t)i], active);
+        greyOut(crossoverLabels[(size_t)i], active);
+    }
+
+    for (int b = 0; b < (int)thresholdSliders.size(); ++b) {
+        const bool active = b < numBands;
+        greyOut(thresholdSliders[(size_t)b], active);
+        greyOut(ratioSliders[(size_t)b], active);
+        greyOut(bandLabels[(size_t)b], active);
+    }
+}
+
+void MultibandCompressorPanel::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property)
+{
+    if (tree != localState)
+        return;
+
+    if (property == juce::Identifier("MbCompBands")) {
+        bandsBox.setSelectedId((int)tree.getProperty("MbCompBands"), juce::dontSendNotification);
+        updateBandVisibility();
+        return;
+    }
+    if (property == juce::Identifier("MbCompAttack")) {
+        attackSlider.setValue((float)tree.getProperty("MbCompAttack"), juce::dontSendNotification);
+        return;
+    }
+    if (property == juce::Identifier("MbCompRelease")) {
+        releaseSlider.setValue((float)tree.getProperty("MbCompRelease"), juce::dontSendNotification);
+        return;
+    }
+
+    for (int i = 0; i < (int)crossoverSliders.size(); ++i) {
+        if (property == MultibandCompressorNode::crossoverId(i)) {
+            crossoverSliders[(size_t)i].setValue((float)tree.getProperty(property), juce::dontSendNotification);
+            return;
+        }
+    }
+
+    for (int b = 0; b < (int)thresholdSliders.size(); ++b) {
+        if (property == MultibandCompressorNode::thresholdId(b)) {
+            thresholdSliders[(size_t)b].setValue((float)tree.getProperty(property), juce::dontSendNotification);
+            return;
+        }
+        if (property == MultibandCompressorNode::ratioId(b)) {
+            ratioSliders[(size_t)b].setValue((float)tree.getProperty(property), juce::dontSendNotification);
+            return;
+        }
+    }
+}
+
+//Update the graph
+void MultibandCompressorVisualizer::frameCallback(){
+    float newDbLevel = compressorNode.getOutputLevelAtomic().load();
+
+    //Push it to graph
+    pushData(newDbLevel);
+
+    //Call the graph visualizer's frameCallback
+    RealTimeGraphVisualizer::frameCallback();
+}
+
+// dsp processing step for the multiband compressor
+void MultibandCompressorNode::process(AudioPluginAudioProcessor& proc, juce::AudioBuffer<float>& buffer) {
+    juce::ignoreUnused(proc);
+
+    const auto& s = getNodeState();
+
+    //Setters only flag the filters for a redesign when a value actually changes, so this is cheap to do every block
+    compressorDSP.setNumBands((int)s.getProperty("MbCompBands", 3));
+    compressorDSP.setAttack((float)s.getProperty("MbCompAttack", 10.0f));
+    compressorDSP.setRelease((float)s.getProperty("MbCompRelease", 100.0f));
+    for (int i = 0; i < 3; ++i)
+        compressorDSP.setCrossover(i, (float)s.getProperty(crossoverId(i), defaultCrossovers[(size_t)i]));
+    for (int b = 0; b < 4; ++b) {
+        compressorDSP.setThreshold(b, (float)s.getProperty(thresholdId(b), 0.0f));
+        compressorDSP.setRatio(b, (float)s.getProperty(ratioId(b), 3.0f));
+    }
+
+    compressorDSP.process(buffer);
+
+    //Calculate output level after processing and store it
+    const float peakAmplitude = buffer.getMagnitude(0, 0, buffer.getNumSamples());
+    compressorDSP.currentOutputLevelDb.store(juce::Decibels::gainToDecibels(peakAmplitude, -100.0f));
+}
+
+// XML serialization for saving/loading state
+
+std::unique_ptr<juce::XmlElement> MultibandCompressorNode::toXml() const {
+    auto xml = std::make_unique<juce::XmlElement>("MultibandCompressorNode");
+    xml->setAttribute("name", effectName);
+
+    const auto& s = getNodeState();
+    xml->setAttribute("MbCompBands", (int)s.getProperty("MbCompBands", 3));
+    xml->setAttribute("MbCompAttack", (float)s.getProperty("MbCompAttack", 10.0f));
+    xml->setAttribute("MbCompRelease", (float)s.getProperty("MbCompRelease", 100.0f));
+    for (int i = 0; i < 3; ++i)
+        xml->setAttribute(crossoverId(i), (float)s.getProperty(crossoverId(i), defaultCrossovers[(size_t)i]));
+    for (int b = 0; b < 4; ++b) {
+        xml->setAttribute(thresholdId(b), (float)s.getProperty(thresholdId(b), 0.0f));
+        xml->setAttribute(ratioId(b), (float)s.getProperty(ratioId(b), 3.0f));
+    }
+
+    return xml;
+}
+
+void MultibandCompressorNode::loadFromXml(const juce::XmlElement& xml) {
+    auto& s = getMutableNodeState();
+
+    s.setProperty("MbCompBands", xml.getIntAttribute("MbCompBands", 3), nullptr);
+    s.setProperty("MbCompAttack", (float)xml.getDoubleAttribute("MbCompAttack", 10.0f), nullptr);
+    s.setProperty("MbCompRelease", (float)xml.getDoubleAttribute("MbCompRelease", 100.0f), nullptr);
+    for (int i = 0; i < 3; ++i)
+        s.setProperty(crossoverId(i), (float)xml.getDoubleAttribute(crossoverId(i), defaultCrossovers[(size_t)i]), nullptr);
+    for (int b = 0; b < 4; ++b) {
+        s.setProperty(thresholdId(b), (float)xml.getDoubleAttribute(thresholdId(b), 0.0f), nullptr);
+        s.setProperty(ratioId(b), (float)xml.getDoubleAttribute(ratioId(b), 3.0f), nullptr);
+    }
+}
@@ -14,6 +14,7 @@ NoiseGatePanel::NoiseGatePanel(AudioPluginAudioProcessor& proc, juce::ValueTree&
     thresholdSlider.setName("Threshold");
     attackSlider.setName("GateAttack");
     releaseSlider.setName("Release");
+    lookaheadSlider.setName("Lookahead");
 
     // Label
     noiseGateLabel.setText(panelTitle, juce::dontSendNotification);
@@ -73,6 +74,15 @@ NoiseGatePanel::NoiseGatePanel(AudioPluginAudioProcessor& proc, juce::ValueTree&
     releaseSlider.setTextValueSuffix(" ms");
     addAndMakeVisible(releaseSlider);
 
+    ////////////////////
+
+    // Lookahead slider. Opens the gate a little early so the start of words doesn't get cut off - Austin
+    lookaheadSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+    lookaheadSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 25);
+    lookaheadSlider.setNumDecimalPlacesToDisplay(1);
+    lookaheadSlider.setTextValueSuffix(" ms");
+    addAndMakeVisible(lookaheadSlider);
+
     ///////////////////
 
     //reynas changes - adding value tree functionality
@@ -96,6 +106,13 @@ NoiseGatePanel::NoiseGatePanel(AudioPluginAudioProcessor& proc, juce::ValueTree&
     releaseSlider.onValueChange = [this]() {
         localState.setProperty("GateRelease", (float)releaseSlider.getValue(), nullptr);
         };
+
+    const float startLookaheadMs = (float)localState.getProperty("GateLookahead", 0.0f);
+    lookaheadSlider.setRange(0.0f, 10.0f, 0.1f);
+    lookaheadSlider.setValue(startLookaheadMs, juce::dontSendNotification);
+    lookaheadSlider.onValueChange = [this]() {
+        localState.setProperty("GateLookahead", (float)lookaheadSlider.getValue(), nullptr);
+        };
 }
 
 void NoiseGatePanel::resized()
@@ -105,15 +122,16 @@ void NoiseGatePanel::resized()
     // Label at top
     noiseGateLabel.setBounds(area.removeFromTop(30));
 
-    // Divide remaining width for 3 dials
+    // Divide remaining width for 4 dials
     auto dials = area.reduced(10);
-    int dialWidth = dials.getWidth() / 3;
+    int dialWidth = dials.getWidth() / 4;
 
     // Create areas for each slider and label
 
     auto thresholdArea = dials.removeFromLeft(dialWidth).reduced(5);
     auto attackArea = dials.removeFromLeft(dialWidth).reduced(5);
-    auto releaseArea = dials.reduced(5);
+    auto releaseArea = dials.removeFromLeft(dialWidth).reduced(5);
+    auto lookaheadArea = dials.reduced(5);
     
     //Positioning threshold label and slider
     thresholdLabel.setBounds(thresholdArea.removeFromTop(20));
@@ -126,6 +144,10 @@ void NoiseGatePanel::resized()
     //Positioning release label and slider
     releaseLabel.setBounds(releaseArea.removeFromTop(20));
     releaseSlider.setBounds(releaseArea);
+
+    //Positioning lookahead label and slider
+    lookaheadLabel.setBounds(lookaheadArea.removeFromTop(20));
+    lookaheadSlider.setBounds(lookaheadArea);
 }
 void NoiseGatePanel::paint(juce::Graphics& g) {
     g.drawRect(getLocalBounds(), 2);
@@ -148,6 +170,8 @@ void NoiseGatePanel::valueTreePropertyChanged(juce::ValueTree& tree, const juce:
             attackSlider.setValue((float)tree.getProperty("GateAttack"), juce::dontSendNotification);
         else if (property == juce::Identifier("GateRelease"))
             releaseSlider.setValue((float)tree.getProperty("GateRelease"), juce::dontSendNotification);
+        else if (property == juce::Identifier("GateLookahead"))
+            lookaheadSlider.setValue((float)tree.getProperty("GateLookahead"), juce::dontSendNotification);
     }
 }
 
@@ -160,6 +184,7 @@ std::unique_ptr<juce::XmlElement> NoiseGateNode::toXml() const {
     xml->setAttribute("GateThreshold", (float)getNodeState().getProperty("GateThreshold", -100.0f));
     xml->setAttribute("GateAttack", (float)getNodeState().getProperty("GateAttack", 25.0f));
     xml->setAttribute("GateRelease", (float)getNodeState().getProperty("GateRelease", 100.0f));
+    xml->setAttribute("GateLookahead", (float)getNodeState().getProperty("GateLookahead", 0.0f));
     return xml;
 }
 
@@ -169,6 +194,7 @@ void NoiseGateNode::loadFromXml(const juce::XmlElement& xml) {
     s.setProperty("GateThreshold", (float)xml.getDoubleAttribute("GateThreshold", -100.0f), nullptr);
     s.setProperty("GateAttack", (float)xml.getDoubleAttribute("GateAttack", 25.0f), nullptr);
     s.setProperty("GateRelease", (float)xml.getDoubleAttribute("GateRelease", 100.0f), nullptr);
+    s.setProperty("GateLookahead", (float)xml.getDoubleAttribute("GateLookahead", 0.0f), nullptr);
 }
 
 NoiseGateVisualizer::~NoiseGateVisualizer(){
@@ -177,10 +203,10 @@ NoiseGateVisualizer::~NoiseGateVisualizer(){
 }
 
 // Update the graph by polling the node
-void NoiseGateVisualizer::timerCallback(){ 
+void NoiseGateVisualizer::frameCallback(){ 
     float newDbLevel = noiseGateNode.getOutputLevelAtomic().load();
     pushData(newDbLevel);
-    RealTimeGraphVisualizer::timerCallback(); // Call base to trigger repaint
+    RealTimeGraphVisualizer::frameCallback(); // Call base to trigger repaint
 }
 
 // Update threshold line if property changes
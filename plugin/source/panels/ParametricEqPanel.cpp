@@ -0,0 +1,275 @@
+// huda
+#include "Pitchblade/panels/ParametricEqPanel.h"
+#include <JuceHeader.h>
+#include "Pitchblade/ui/ColorPalette.h"
+#include "Pitchblade/ui/CustomLookAndFeel.h"
+
+//Property names are built once so they aren't made from strings every time a value changes
+namespace
+{
+    using IdArray = std::array<juce::Identifier, ParametricEq::maxBands>;
+
+    IdArray makeIds(const juce::String& prefix)
+    {
+        IdArray ids;
+        for (int b = 0; b < ParametricEq::maxBands; ++b)
+            ids[(size_t)b] = juce::Identifier(prefix + juce::String(b + 1));
+        return ids;
+    }
+
+    const juce::StringArray typeNames { "Bell", "Low Shelf", "High Shelf", "Low Cut", "High Cut", "Notch" };
+}
+
+const juce::Identifier& ParametricEqNode::bandsId()
+{
+    static const juce::Identifier id("PeqBands");
+    return id;
+}
+
+const juce::Identifier& ParametricEqNode::typeId(int band)    { static const auto ids = makeIds("PeqType"); return ids[(size_t)band]; }
+const juce::Identifier& ParametricEqNode::freqId(int band)    { static const auto ids = makeIds("PeqFreq"); return ids[(size_t)band]; }
+const juce::Identifier& ParametricEqNode::gainId(int band)    { static const auto ids = makeIds("PeqGain"); return ids[(size_t)band]; }
+const juce::Identifier& ParametricEqNode::qId(int band)       { static const auto ids = makeIds("PeqQ");    return ids[(size_t)band]; }
+const juce::Identifier& ParametricEqNode::enabledId(int band) { static const auto ids = makeIds("PeqOn");   return ids[(size_t)band]; }
+
+// ===================== ParametricEqNode =====================
+void ParametricEqNode::pushAllToDsp()
+{
+    const auto& st = getNodeState();
+    eqDSP.setNumBands((int)st.getProperty(bandsId(), 8));
+    for (int b = 0; b < ParametricEq::maxBands; ++b)
+    {
+        eqDSP.setBandType(b, (ParametricEq::BandType)(int)st.getProperty(typeId(b), 0));
+        eqDSP.setBandFrequency(b, (float)st.getProperty(freqId(b), ParametricEq::defaultFrequency(b)));
+        eqDSP.setBandGainDb(b, (float)st.getProperty(gainId(b), 0.0f));
+        eqDSP.setBandQ(b, (float)st.getProperty(qId(b), 1.0f));
+        eqDSP.setBandEnabled(b, (bool)st.getProperty(enabledId(b), true));
+    }
+}
+
+void ParametricEqNode::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property)
+{
+    if (tree != getNodeState())
+        return;
+
+    if (property == bandsId())
+    {
+        eqDSP.setNumBands((int)tree.getProperty(property));
+        return;
+    }
+
+    for (int b = 0; b < ParametricEq::maxBands; ++b)
+    {
+        if      (property == typeId(b))    eqDSP.setBandType(b, (ParametricEq::BandType)(int)tree.getProperty(property));
+        else if (property == freqId(b))    eqDSP.setBandFrequency(b, (float)tree.getProperty(property));
+        else if (property == gainId(b))    eqDSP.setBandGainDb(b, (float)tree.getProperty(property));
+        else if (property == qId(b))       eqDSP.setBandQ(b, (float)tree.getProperty(property));
+        else if (property == enabledId(b)) eqDSP.setBandEnabled(b, (bool)tree.getProperty(property));
+        else continue;
+        return;
+    }
+}
+
+std::unique_ptr<juce::XmlElement> ParametricEqNode::toXml() const
+{
+    auto xml = std::make_unique<juce::XmlElement>("ParametricEqNode");
+    xml->setAttribute("name", effectName);
+
+    const auto& st = getNodeState();
+    xml->setAttribute(bandsId(), (int)st.getProperty(bandsId(), 8));
+    for (int b = 0; b < ParametricEq::maxBands; ++b)
+    {
+        xml->setAttribute(typeId(b),    (int)st.getProperty(typeId(b), 0));
+        xml->setAttribute(freqId(b),    (float)st.getProperty(freqId(b), ParametricEq::defaultFrequency(b)));
+        xml->setAttribute(gainId(b),    (float)st.getProperty(gainId(b), 0.0f));
+        xml->setAttribute(qId(b),       (float)st.getProperty(qId(b), 1.0f));
+        xml->setAttribute(enabledId(b), (bool)st.getProperty(enabledId(b), true));
+    }
+    return xml;
+}
+
+void ParametricEqNode::loadFromXml(const juce::XmlElement& xml)
+{
+    auto& st = getMutableNodeState();
+    st.setProperty(bandsId(), xml.getIntAttribute(bandsId(), 8), nullptr);
+    for (int b = 0; b < ParametricEq::maxBands; ++b)
+    {
+        st.setProperty(typeId(b),    xml.getIntAttribute(typeId(b), 0), nullptr);
+        st.setProperty(freqId(b),    (float)xml.getDoubleAttribute(freqId(b), ParametricEq::defaultFrequency(b)), nullptr);
+        st.setProperty(gainId(b),    (float)xml.getDoubleAttribute(gainId(b), 0.0), nullptr);
+        st.setProperty(qId(b),       (float)xml.getDoubleAttribute(qId(b), 1.0), nullptr);
+        st.setProperty(enabledId(b), xml.getBoolAttribute(enabledId(b), true), nullptr);
+    }
+}
+
+// ===================== ParametricEqPanel =====================
+ParametricEqPanel::ParametricEqPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state, const juce::String& nodeTitle)
+    : panelTitle(nodeTitle), processor(proc), localState(state)
+{
+    //panel label
+    titleLabel.setText(panelTitle, juce::dontSendNotification);
+    titleLabel.setName("NodeTitle");
+    addAndMakeVisible(titleLabel);
+
+    auto setupLabel = [this](juce::Label& l, const juce::String& text)
+    {
+        l.setText(text, juce::dontSendNotification);
+        l.setJustificationType(juce::Justification::centred);
+        addAndMakeVisible(l);
+    };
+    setupLabel(bandsLabel, "Bands");
+    setupLabel(bandLabel, "Edit");
+    setupLabel(typeLabel, "Type");
+    setupLabel(freqLabel, "Freq (Hz)");
+    setupLabel(gainLabel, "Gain (dB)");
+    setupLabel(qLabel, "Q");
+
+    // band count and band selector
+    for (int b = 1; b <= ParametricEq::maxBands; ++b)
+    {
+        bandsBox.addItem(juce::String(b), b);
+        bandSelector.addItem("Band " + juce::String(b), b);
+    }
+    bandsBox.setSelectedId((int)localState.getProperty(ParametricEqNode::bandsId(), 8), juce::dontSendNotification);
+    bandsBox.onChange = [this]()
+    {
+        localState.setProperty(ParametricEqNode::bandsId(), bandsBox.getSelectedId(), nullptr);
+    };
+    bandSelector.setSelectedId(1, juce::dontSendNotification);
+    bandSelector.onChange = [this]()
+    {
+        selectedBand = juce::jmax(0, bandSelector.getSelectedId() - 1);
+        loadSelectedBand();
+    };
+    addAndMakeVisible(bandsBox);
+    addAndMakeVisible(bandSelector);
+
+    // per band controls, all writing to whichever band is selected
+    for (int t = 0; t < typeNames.size(); ++t)
+        typeBox.addItem(typeNames[t], t + 1);
+    typeBox.onChange = [this]()
+    {
+        localState.setProperty(ParametricEqNode::typeId(selectedBand), typeBox.getSelectedId() - 1, nullptr);
+    };
+    addAndMakeVisible(typeBox);
+
+    enabledButton.onClick = [this]()
+    {
+        localState.setProperty(ParametricEqNode::enabledId(selectedBand), enabledButton.getToggleState(), nullptr);
+    };
+    addAndMakeVisible(enabledButton);
+
+    static SmallDialLookAndFeel smallDialLF;
+    auto setupDial = [this](juce::Slider& s, const juce::String& name, double min, double max, double step, int decimals)
+    {
+        s.setName(name);
+        s.setLookAndFeel(&smallDialLF);
+        s.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+        s.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 64, 18);
+        s.setRange(min, max, step);
+        s.setNumDecimalPlacesToDisplay(decimals);
+        s.setPopupMenuEnabled(true);
+        addAndMakeVisible(s);
+    };
+    setupDial(freqSlider, "Band Freq", 20.0, 20000.0, 1.0, 0);
+    freqSlider.setSkewFactorFromMidPoint(1000.0);
+    setupDial(gainSlider, "Band Gain", -24.0, 24.0, 0.1, 1);
+    setupDial(qSlider, "Band Q", 0.1, 18.0, 0.01, 2);
+    qSlider.setSkewFactorFromMidPoint(1.0);
+
+    freqSlider.onValueChange = [this]() { localState.setProperty(ParametricEqNode::freqId(selectedBand), (float)freqSlider.getValue(), nullptr); };
+    gainSlider.onValueChange = [this]() { localState.setProperty(ParametricEqNode::gainId(selectedBand), (float)gainSlider.getValue(), nullptr); };
+    qSlider.onValueChange    = [this]() { localState.setProperty(ParametricEqNode::qId(selectedBand),    (float)qSlider.getValue(),    nullptr); };
+
+    loadSelectedBand();
+    localState.addListener(this);
+}
+
+ParametricEqPanel::~ParametricEqPanel()
+{
+    if (localState.isValid())
+        localState.removeListener(this);
+
+    //Dials share a static look and feel, so clear it before they are destroyed
+    freqSlider.setLookAndFeel(nullptr);
+    gainSlider.setLookAndFeel(nullptr);
+    qSlider.setLookAndFeel(nullptr);
+}
+
+void ParametricEqPanel::loadSelectedBand()
+{
+    const int b = selectedBand;
+    typeBox.setSelectedId((int)localState.getProperty(ParametricEqNode::typeId(b), 0) + 1, juce::dontSendNotification);
+    enabledButton.setToggleState((bool)localState.getProperty(ParametricEqNode::enabledId(b), true), juce::dontSendNotification);
+    freqSlider.setValue((float)localState.getProperty(ParametricEqNode::freqId(b), ParametricEq::defaultFrequency(b)), juce::dontSendNotification);
+    gainSlider.setValue((float)localState.getProperty(ParametricEqNode::gainId(b), 0.0f), juce::dontSendNotification);
+    qSlider.setValue((float)localState.getProperty(ParametricEqNode::qId(b), 1.0f), juce::dontSendNotification);
+    updateGainEnabled();
+}
+
+void ParametricEqPanel::updateGainEnabled()
+{
+    // cuts and notches have no gain, greyed out the same way the multiband greys out unused bands - reyna
+    const auto type = (ParametricEq::BandType)(typeBox.getSelectedId() - 1);
+    const bool hasGain = type == ParametricEq::BandType::bell
+                      || type == ParametricEq::BandType::lowShelf
+                      || type == ParametricEq::BandType::highShelf;
+    gainSlider.setEnabled(hasGain);
+    gainSlider.setAlpha(hasGain ? 1.0f : 0.4f);
+    gainLabel.setAlpha(hasGain ? 1.0f : 0.4f);
+}
+
+void ParametricEqPanel::resized()
+{
+    auto area = getLocalBounds();
+    titleLabel.setBounds(area.removeFromTop(30));
+
+    auto r = area.reduced(10, 6);
+
+    // left column - band count, band being edited, its type and on/off
+    auto leftCol = r.removeFromLeft(r.getWidth() / 4);
+    bandsLabel.setBounds(leftCol.removeFromTop(20));
+    bandsBox.setBounds(leftCol.removeFromTop(26).reduced(4, 0));
+    leftCol.removeFromTop(4);
+    bandLabel.setBounds(leftCol.removeFromTop(20));
+    bandSelector.setBounds(leftCol.removeFromTop(26).reduced(4, 0));
+    leftCol.removeFromTop(4);
+    typeLabel.setBounds(leftCol.removeFromTop(20));
+    typeBox.setBounds(leftCol.removeFromTop(26).reduced(4, 0));
+    leftCol.removeFromTop(4);
+    enabledButton.setBounds(leftCol.removeFromTop(26).reduced(4, 0));
+
+    // the rest - frequency, gain and Q dials
+    const int dialW = r.getWidth() / 3;
+    auto place = [](juce::Rectangle<int> cell, juce::Slider& s, juce::Label& l)
+    {
+        l.setBounds(cell.removeFromTop(20));
+        s.setBounds(cell.reduced(4));
+    };
+    place(r.removeFromLeft(dialW), freqSlider, freqLabel);
+    place(r.removeFromLeft(dialW), gainSlider, gainLabel);
+    place(r, qSlider, qLabel);
+}
+
+void ParametricEqPanel::paint(juce::Graphics& g)
+{
+    g.drawRect(getLocalBounds(), 2);
+}
+
+void ParametricEqPanel::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property)
+{
+    if (tree != localState)
+        return;
+
+    if (property == ParametricEqNode::bandsId())
+    {
+        bandsBox.setSelectedId((int)tree.getProperty(property), juce::dontSendNotification);
+        return;
+    }
+
+    // only the band on screen needs its controls refreshed
+    const int b = selectedBand;
+    if (property == ParametricEqNode::typeId(b) || property == ParametricEqNode::freqId(b) || property == ParametricEqNode::gainId(b)
+        || property == ParametricEqNode::qId(b) || property == ParametricEqNode::enabledId(b))
+        loadSelectedBand();
+}
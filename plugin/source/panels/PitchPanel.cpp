@@ -2,12 +2,12 @@
 #include "Pitchblade/ui/ColorPalette.h"
 #include "Pitchblade/ui/CustomLookAndFeel.h"
 
-PitchPanel::PitchPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state)
-    : processor(proc), localState(state),
+PitchPanel::PitchPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state, PitchCorrector& corrector)
+    : processor(proc), localState(state), pitchCorrector(corrector),
     leftLevelMeter(
         std::make_unique<LevelMeter>(
             [&](){
-                return std::min(0.f, processor.getPitchCorrector().getSemitoneError());
+                return std::min(0.f, pitchCorrector.getSemitoneError());
             },
             0.f, -100.f, RotationMode::LEFT
         )
@@ -15,7 +15,7 @@ PitchPanel::PitchPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state)
     rightLevelMeter(
         std::make_unique<LevelMeter>(
             [&](){
-                return std::max(0.f, processor.getPitchCorrector().getSemitoneError());
+                return std::max(0.f, pitchCorrector.getSemitoneError());
             },
             0.f, 100.f, RotationMode::RIGHT
         )
@@ -102,13 +102,13 @@ PitchPanel::PitchPanel(AudioPluginAudioProcessor& proc, juce::ValueTree& state)
         int id = scaleOffsetBox.getSelectedId();
         int offset = id - 12;
         localState.setProperty("PitchOffset", offset, nullptr);
-        processor.getPitchCorrector().setScaleOffset(offset);
+        pitchCorrector.setScaleOffset(offset);
     };
 
     scaleTypeBox.onChange = [this]() {
         int id = scaleTypeBox.getSelectedId();
         localState.setProperty("PitchType", id, nullptr);
-        processor.getPitchCorrector().setScaleType(id);
+        pitchCorrector.setScaleType(id);
     };
 
     // Link sliders to state
@@ -226,16 +226,16 @@ void PitchPanel::drawDynamicLabels(juce::Graphics& g, juce::Rectangle<float> bou
 
     g.setFont(30.0f); 
     g.setColour(Colors::accent);
-    g.drawText(processor.getPitchCorrector().getCurrentNoteName(), 
+    g.drawText(pitchCorrector.getCurrentNoteName(), 
         0, juce::Justification::centred, 
         0, 0, juce::Justification::centred);
-    g.drawText(processor.getPitchCorrector().getTargetNoteName(), 
+    g.drawText(pitchCorrector.getTargetNoteName(), 
         bounds.getCentre().x - radius, bounds.getCentre().y * 1.5f - radius,
         targetPitchDisplayBounds.getWidth(), targetPitchDisplayBounds.getWidth(), juce::Justification::centred);
 
     g.setFont(15.0f);
     auto detectedPitchDisplayBounds = bounds.reduced(bounds.getWidth() * 0.45, bounds.getHeight() * 0.48);
-    g.drawText(processor.getPitchCorrector().getCurrentNoteName() + std::to_string(processor.getPitchCorrector().getCurrentPitch()),
+    g.drawText(pitchCorrector.getCurrentNoteName() + std::to_string(pitchCorrector.getCurrentPitch()),
         bounds.getCentre().x - radius, bounds.getCentre().y + bounds.getCentre().y/2 * 1.25f - radius, 
         targetPitchDisplayBounds.getWidth(), targetPitchDisplayBounds.getWidth(), juce::Justification::centred); //x, y, w, h)
     
@@ -276,7 +276,7 @@ PitchVisualizer::~PitchVisualizer(){
 }
 
 //Update the graph
-void PitchVisualizer::timerCallback(){
+void PitchVisualizer::frameCallback(){
     float newPitch = pitchNode.getPitchAtomic().load();
 
     //Push it to graph
@@ -287,8 +287,8 @@ void PitchVisualizer::timerCallback(){
         pushData(lastStablePitch);
     }
 
-    //Call the graph visualizer's timerCallback
-    RealTimeGraphVisualizer::timerCallback();
+    //Call the graph visualizer's frameCallback
+    RealTimeGraphVisualizer::frameCallback();
 }
 
 void PitchVisualizer::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property){
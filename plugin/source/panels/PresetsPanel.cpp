@@ -4,6 +4,7 @@
 // preset panel shows "save preset", "load preset", "default preset" buttons
 // allows user to save/load presets to/from xml files
 // default preset resets all parameters to default values 
+// the preset library below the buttons can be searched and filtered, double click loads
 
 PresetsPanel::PresetsPanel(AudioPluginAudioProcessor& proc) : processor(proc) {
 	// buttons
@@ -28,6 +29,45 @@ PresetsPanel::PresetsPanel(AudioPluginAudioProcessor& proc) : processor(proc) {
         statusLabel.setText("", juce::dontSendNotification); 
         });
 
+    // A/B morph
+    addAndMakeVisible(loadBButton);
+    addAndMakeVisible(captureBButton);
+    addAndMakeVisible(clearBButton);
+    loadBButton.onClick = [this]() { handleLoadMorphTarget(); };
+    captureBButton.onClick = [this]() {
+        processor.captureMorphTarget();
+        statusLabel.setText(processor.isMorphBlending() ? "B set, blending params" : "B set", juce::dontSendNotification);
+        };
+    clearBButton.onClick = [this]() {
+        processor.clearMorphTarget();
+        statusLabel.setText("B cleared", juce::dontSendNotification);
+        };
+
+    addAndMakeVisible(morphSlider);
+    morphSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    morphSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    morphAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processor.apvts, "GLOBAL_MORPH", morphSlider);
+
+    // library search
+    addAndMakeVisible(searchBox);
+    searchBox.setTextToShowWhenEmpty("Search presets", Colors::buttonText.withAlpha(0.5f));
+    searchBox.onTextChange = [this]() { refreshList(); };
+
+    addAndMakeVisible(typeFilter);
+    typeFilter.onChange = [this]() { refreshList(); };
+    refreshTypeFilter();
+
+    addAndMakeVisible(presetList);
+    presetList.setRowHeight(26);
+    presetList.setColour(juce::ListBox::backgroundColourId, Colors::panel);
+
+    // the index is already loaded, the scan tells us if anything changed
+    library->addChangeListener(this);
+    refreshList();
+}
+
+PresetsPanel::~PresetsPanel() {
+    library->removeChangeListener(this);
 }
 
 // paint and layout
@@ -55,6 +95,12 @@ void PresetsPanel::paint(juce::Graphics& g) {
     g.setColour(Colors::background);
     float y = (float)getLocalBounds().removeFromTop(42).getBottom();
     g.drawLine(10.0f, y, (float)getWidth() - 10.0f, y, 3.0f);
+
+    // ends of the morph slider
+    g.setColour(Colors::buttonText);
+    g.setFont(16.0f);
+    g.drawText("A", morphArea.withWidth(20), juce::Justification::centred);
+    g.drawText("B", morphArea.withTrimmedLeft(morphArea.getWidth() - 20), juce::Justification::centred);
 }
 
 // layout
@@ -69,6 +115,25 @@ void PresetsPanel::resized() {
     // Status label
     area.removeFromTop(5);
     statusLabel.setBounds(area.removeFromTop(30));
+
+    // A/B row: buttons, then A ---- B under them
+    area.removeFromTop(5);
+    auto abRow = area.removeFromTop(30);
+    const int abW = abRow.getWidth() / 3;
+    loadBButton.setBounds(abRow.removeFromLeft(abW).reduced(2, 0));
+    captureBButton.setBounds(abRow.removeFromLeft(abW).reduced(2, 0));
+    clearBButton.setBounds(abRow.reduced(2, 0));
+    morphArea = area.removeFromTop(30);
+    morphSlider.setBounds(morphArea.reduced(24, 0));
+
+    // library search, filter, then the list in whatever is left
+    area.removeFromTop(5);
+    auto searchRow = area.removeFromTop(30);
+    typeFilter.setBounds(searchRow.removeFromRight(searchRow.getWidth() / 3));
+    searchRow.removeFromRight(5);
+    searchBox.setBounds(searchRow);
+    area.removeFromTop(5);
+    presetList.setBounds(area);
 }
 
 /////////////////////////////////// preset handlers
@@ -90,6 +155,7 @@ void PresetsPanel::handleSavePreset() {
                 processor.savePresetToFile(result);
                 // update label
                 statusLabel.setText("Preset saved!", juce::dontSendNotification);
+                library->rescan();      // picks up the new file
             } else {
                 statusLabel.setText("Save canceled", juce::dontSendNotification);
             }
@@ -107,12 +173,35 @@ void PresetsPanel::handleLoadPreset() {
     chooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles, [this](const juce::FileChooser& c) {
             auto result = c.getResult();
             if (result.existsAsFile()) {
-                processor.loadPresetFromFile(result);
-                // label 
-                statusLabel.setText("Preset loaded!", juce::dontSendNotification);
-                juce::MessageManager::callAsync([this]() {
-                    if (onPresetActionFinished) onPresetActionFinished();
-                    });
+                loadPreset(result);
+            } else {
+                statusLabel.setText("Load canceled", juce::dontSendNotification);
+            }
+            chooser.reset();
+        });
+}
+
+// load a preset and tell the editor
+void PresetsPanel::loadPreset(const juce::File& file) {
+    processor.loadPresetFromFile(file);
+    // label 
+    statusLabel.setText("Preset loaded!", juce::dontSendNotification);
+    juce::MessageManager::callAsync([this]() {
+        if (onPresetActionFinished) onPresetActionFinished();
+        });
+}
+
+// pick a preset to load as B
+void PresetsPanel::handleLoadMorphTarget() {
+    auto initialDir = PresetLibrary::getDefaultFolder();
+    initialDir.createDirectory();
+
+    chooser = std::make_unique<juce::FileChooser>("Load Preset as B", initialDir, "*.xml");
+    chooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles, [this](const juce::FileChooser& c) {
+            auto result = c.getResult();
+            if (result.existsAsFile()) {
+                processor.loadMorphTargetFromFile(result);
+                statusLabel.setText("B: " + result.getFileNameWithoutExtension(), juce::dontSendNotification);
             } else {
                 statusLabel.setText("Load canceled", juce::dontSendNotification);
             }
@@ -151,3 +240,65 @@ void PresetsPanel::showDefaultMenu() {
         .withMinimumWidth(defaultButton.getWidth())
     );
 }
+
+/////////////////////////////////// preset library list
+
+// search the index again. It's all in memory, so this runs on every key press
+void PresetsPanel::refreshList() {
+    const auto type = typeFilter.getSelectedId() > 1 ? typeFilter.getText() : juce::String();
+    shown = library->search(searchBox.getText(), type);
+    presetList.updateContent();
+    presetList.repaint();
+}
+
+// one entry per effect used by any preset, keeps the current choice if it's still there
+void PresetsPanel::refreshTypeFilter() {
+    const auto current = typeFilter.getText();
+    typeFilter.clear(juce::dontSendNotification);
+    typeFilter.addItem("All effects", 1);
+    auto types = library->getAllNodeTypes();
+    for (int i = 0; i < types.size(); ++i)
+        typeFilter.addItem(types[i], i + 2);
+
+    const int index = types.indexOf(current);
+    typeFilter.setSelectedId(index >= 0 ? index + 2 : 1, juce::dontSendNotification);
+}
+
+int PresetsPanel::getNumRows() {
+    return (int)shown.size();
+}
+
+// name on the left, tags on the right
+void PresetsPanel::paintListBoxItem(int row, juce::Graphics& g, int width, int height, bool rowIsSelected) {
+    if (row < 0 || row >= (int)shown.size())
+        return;
+
+    auto& e = shown[(size_t)row];
+    if (rowIsSelected) {
+        g.setColour(Colors::accent.withAlpha(0.4f));
+        g.fillRect(0, 0, width, height);
+    }
+
+    auto area = juce::Rectangle<int>(0, 0, width, height).reduced(6, 0);
+    g.setFont(14.0f);
+    g.setColour(Colors::buttonText.withAlpha(0.6f));
+    g.drawText(e.tags.joinIntoString(", "), area.removeFromRight(width / 3), juce::Justification::centredRight, true);
+    g.setColour(Colors::buttonText);
+    g.drawText(e.name, area, juce::Justification::centredLeft, true);
+}
+
+void PresetsPanel::listBoxItemDoubleClicked(int row, const juce::MouseEvent&) {
+    if (row >= 0 && row < (int)shown.size())
+        loadPreset(shown[(size_t)row].file);
+}
+
+void PresetsPanel::returnKeyPressed(int lastRowSelected) {
+    if (lastRowSelected >= 0 && lastRowSelected < (int)shown.size())
+        loadPreset(shown[(size_t)lastRowSelected].file);
+}
+
+// the library finished a scan that changed something
+void PresetsPanel::changeListenerCallback(juce::ChangeBroadcaster*) {
+    refreshTypeFilter();
+    refreshList();
+}
@@ -15,6 +15,8 @@
 #include "Pitchblade/panels/FormantPanel.h"
 #include "Pitchblade/panels/PitchPanel.h"
 #include "Pitchblade/panels/EqualizerPanel.h"
+#include "Pitchblade/panels/MultibandCompressorPanel.h"
+#include "Pitchblade/panels/ParametricEqPanel.h"
 
 #include "Pitchblade/panels/EffectNode.h"
 
@@ -85,6 +87,7 @@ DaisyChain::DaisyChain(AudioPluginAudioProcessor& proc, std::vector<std::shared_
 	// scroll area for effects
     addAndMakeVisible(scrollArea);
     scrollArea.setViewedComponent(&effectsContainer, false);
+    scrollArea.onVisibleAreaChanged = [this]() { updateVisibleRows(); };
 	// menu callbacks
     addButton.onClick = [this]() { showAddMenu(); };
     duplicateButton.onClick = [this]() { showDuplicateMenu(); };
@@ -161,11 +164,19 @@ void DaisyChain::resetRowsToNodes() {
     }
 }
 
-// rebuilds the UI from current rows and effectNodes
+// syncs the UI with current rows and effectNodes
+// rows whose left effect is still there are kept and moved, only new effects get a new row
 void DaisyChain::rebuild() {
-    // clear UI rows
-    for (auto* it : items) effectsContainer.removeChildComponent(it);
-    items.clear(true);
+    // take the current rows out, keyed by their left node's uuid (name if the node is gone)
+    auto keyFor = [this](const juce::String& name) {
+        auto n = findNodeByName(name);
+        return n ? n->getUuid() : name;
+    };
+    std::vector<std::pair<juce::String, std::unique_ptr<DaisyChainItem>>> oldItems;
+    while (!items.isEmpty()) {
+        std::unique_ptr<DaisyChainItem> it(items.removeAndReturn(items.size() - 1));
+        oldItems.emplace_back(keyFor(it->getName()), std::move(it));
+    }
 
 	juce::Array<int> rightToClear;  // indices of rows to clear right slot if invalid
 	// will not mutate rows, just read from it to build UI
@@ -174,8 +185,19 @@ void DaisyChain::rebuild() {
     for (int i = 0; i < (int)rows.size(); ++i) {
         const auto& rowData = rows[i];                      // get name from current order list
 
-		auto* row = new DaisyChainItem(rowData.left, i);    // create row with effect name
-        effectsContainer.addAndMakeVisible(row);
+        // reuse the row for this effect if there is one
+        DaisyChainItem* row = nullptr;
+        const auto key = keyFor(rowData.left);
+        for (auto& [oldKey, oldRow] : oldItems) {
+            if (oldRow && oldKey == key && oldRow->getName() == rowData.left) {
+                row = oldRow.release();
+                row->setIndex(i);
+                break;
+            }
+        }
+        if (row == nullptr) {
+		    row = new DaisyChainItem(rowData.left, i);      // create row with effect name, added to the list once in view
+        }
         items.add(row);
 
         // prevent drag when overlays are open
@@ -194,6 +216,7 @@ void DaisyChain::rebuild() {
             // find node by name and update its bypass state
             if (auto n = findNodeByName(name)) {
                 n->bypassed = state;
+                processorRef.chainLatencyChanged();
             }
 
             row->updateBypassVisual(state);
@@ -226,9 +249,11 @@ void DaisyChain::rebuild() {
 			auto nodeR = findNodeByName(rowData.right); // find right node by name
             if (!nodeR) { 
 				rightToClear.add(i);                                    // mark for clearing if node not found
+                if (row->hasRight) row->clearSecondaryEffect();
             } else {
-				// set right effect
-                row->setSecondaryEffect(rowData.right);
+				// set right effect, only if it changed
+                if (!row->hasRight || row->rightEffectName != rowData.right)
+                    row->setSecondaryEffect(rowData.right);
                 if (nodeR) nodeR->chainMode = ChainMode::DoubleDown;    // secondary mode is always DoubleDown in a double row
 
                 const bool rightBypassed = nodeR->bypassed;             // get right bypass state
@@ -237,6 +262,7 @@ void DaisyChain::rebuild() {
                     // find node by name and update its bypass state
                     if (auto n = findNodeByName(name)) {
                         n->bypassed = state;
+                        processorRef.chainLatencyChanged();
                     }
                     row->updateSecondaryBypassVisual(state);     // update visual
 
@@ -249,6 +275,7 @@ void DaisyChain::rebuild() {
         } else {
 			// clear right if no right effect
             rightToClear.add(i);
+            if (row->hasRight) row->clearSecondaryEffect();     // kept row lost its right effect
         }
 
         // chaining mode //////////////////////////////////
@@ -267,6 +294,8 @@ void DaisyChain::rebuild() {
 			processorRef.requestLayout(toProcessorRows(rows));                          // notify processor of layout change
         };
 
+        row->onMeterMenu = [this](const juce::String& name, juce::Component* target) { showMeterMenu(name, target); };
+
         row->onReorder = [this](int kind, juce::String dragName, int targetRow) { // reorder callback from drag n drop ui
 			if (reorderLocked) return; // prevent reordering if locked
             handleReorder(kind, dragName, targetRow);
@@ -280,6 +309,11 @@ void DaisyChain::rebuild() {
             };
     };
 
+	// rows for effects that are gone
+    for (auto& [oldKey, oldRow] : oldItems)
+        if (oldRow) effectsContainer.removeChildComponent(oldRow.get());
+    oldItems.clear();
+
 	// clear invalid right slots
 	// apply after building all rows to avoid index issues
     for (int idx : rightToClear) {
@@ -287,12 +321,36 @@ void DaisyChain::rebuild() {
             rows[(size_t)idx].right.clear();
     }
 
+    updateRowIndex();
+
 	// finalize
     resized();
     repaint();
 	if (globalBypassed) { setGlobalBypassVisual(true); } //  global bypass visual state
 }
 
+// rebuild effect name -> row lookup
+void DaisyChain::updateRowIndex() {
+    rowIndex.clear();
+    for (int i = 0; i < (int)rows.size(); ++i) {
+        rowIndex.set(rows[(size_t)i].left, i);
+        if (rows[(size_t)i].hasRight())
+            rowIndex.set(rows[(size_t)i].right, i);
+    }
+}
+
+// find which row an effect is in using the index, rows can change before the next rebuild so check it's still right
+std::tuple<int, bool, bool> DaisyChain::findIndexedRow(const juce::String& name) const {
+    if (rowIndex.contains(name)) {
+        const int i = rowIndex[name];
+        if (i >= 0 && i < (int)rows.size()) {
+            if (rows[(size_t)i].left == name)  return { i, false, true };
+            if (rows[(size_t)i].right == name) return { i, true , true };
+        }
+    }
+    return findRowAndSide(rows, name);  // stale index, search
+}
+
 //reorders the global effects list and rebuilds UI
 void DaisyChain::handleReorder(int kind, const juce::String& dragName, int targetRow) {
     if (reorderLocked || rows.empty()) return;
@@ -301,7 +359,7 @@ void DaisyChain::handleReorder(int kind, const juce::String& dragName, int targe
     targetRow = juce::jlimit(0, (int)rows.size(), targetRow);
 
     // locate source name
-    auto [srcRow, srcIsRight, found] = findRowAndSide(rows, dragName);
+    auto [srcRow, srcIsRight, found] = findIndexedRow(dragName);
     if (!found) return;
 
     // remove source 
@@ -396,30 +454,59 @@ void DaisyChain::resized() {
 
     const int listRightPadding = scrollBarWidth + 28; // a little gap next to the bar
 
-	// layout each row in the effects container
-    const int singleH = 56;   // height for single
-	const int doubleH = 86;   // double down height
+	// only the rows in view are laid out, the container is sized for all of them
+    updateRowTops();
+    effectsContainer.setBounds(0, 0, scrollArea.getWidth(), rowTops.back());
+    updateVisibleRows();
+}
+
+// row heights
+static constexpr int singleRowH = 56;   // height for single
+static constexpr int doubleRowH = 86;   // double down height
+
+// work out where each row starts
+void DaisyChain::updateRowTops() {
+    rowTops.resize((size_t)items.size() + 1);
+    rowTops[0] = 0;
+    for (int i = 0; i < items.size(); ++i) {
+        auto* item = items[i];
+        const bool isDouble = item != nullptr && item->isDoubleRow;  // check if double row
+        rowTops[(size_t)i + 1] = rowTops[(size_t)i] + (isDouble ? doubleRowH : singleRowH);
+    }
+}
+
+// row at a y position in the list, clamped to the rows there are
+int DaisyChain::rowAtY(int y) const {
+    if (rowTops.size() < 2) return 0;
+    auto it = std::upper_bound(rowTops.begin(), rowTops.end(), y);
+    return juce::jlimit(0, (int)rowTops.size() - 2, (int)(it - rowTops.begin()) - 1);
+}
+
+// put rows that are in view into the list and take the rest out
+void DaisyChain::updateVisibleRows() {
+    if ((int)rowTops.size() != items.size() + 1)
+        updateRowTops();
+
+    const auto view = scrollArea.getViewArea();
+    const int first = rowAtY(view.getY()) - 1;          // one spare row each side so small scrolls don't pop
+    const int last = rowAtY(view.getBottom()) + 1;
     const int width = scrollArea.getWidth() - 8;
 
-    // layout each item
-    int y = 0;
-    for (int i = 0; i < items.size(); ++i) { 	
+    for (int i = 0; i < items.size(); ++i) {
         auto* item = items[i];
         if (!item) continue;
 
-		const bool isDouble = item->isDoubleRow;  // check if double row
-        const int width = scrollArea.getWidth() - 8;
+        // a row being dragged stays so the drag keeps its source
+        const bool keep = (i >= first && i <= last) || item->isMouseButtonDown(true);
+        const bool inList = item->getParentComponent() == &effectsContainer;
 
-        if (item->isDoubleRow) {
-            item->setBounds(0, y, width, doubleH);
-            y += doubleH;
-        } else {
-            item->setBounds(0, y, width, singleH);
-            y += singleH;
+        if (keep) {
+            item->setBounds(0, rowTops[(size_t)i], width, rowTops[(size_t)i + 1] - rowTops[(size_t)i]);
+            if (!inList) effectsContainer.addAndMakeVisible(item);
+        } else if (inList) {
+            effectsContainer.removeChildComponent(item);
         }
     }
-    // set the container to  height
-    effectsContainer.setBounds(0, 0, scrollArea.getWidth(), y);
 }
 
 // paint the daisy chain background and arrows
@@ -492,20 +579,20 @@ void DaisyChain::paint(juce::Graphics& g) {
             gr.strokePath(p, juce::PathStrokeType(2.0f));
         };
 
-	//drawing arrows between rows 
-    const int rowCount = (int)rows.size();
-    for (int i = 0; i + 1 < rowCount; ++i) {
-		// guarded pointers incase of invalid rows
-		DaisyChainItem* cur = (i < items.size() ? items[i] : nullptr);          // current
-		DaisyChainItem* next = (i + 1 < items.size() ? items[i + 1] : nullptr); // next
-        if (!cur || !next) continue;
+	//drawing arrows between rows in view
+    const int rowCount = juce::jmin((int)rows.size(), items.size());
+    if ((int)rowTops.size() < rowCount + 1) return;
 
-        // midpoint between bottom of current and top of next 
-        juce::Point<int> curBottom = getLocalPoint( cur, juce::Point<int>(cur->getWidth() / 2, cur->getHeight()));
-        juce::Point<int> nextTop = getLocalPoint( next, juce::Point<int>(next->getWidth() / 2, 0));
+    const auto view = scrollArea.getViewArea();
+    const int first = rowAtY(view.getY());
+    const int last = rowAtY(view.getBottom());
 
-        float xMid = 0.5f * (curBottom.x + nextTop.x);
-        float yMid = 0.5f * (curBottom.y + nextTop.y);
+    g.saveState();
+    g.reduceClipRegion(scrollArea.getBounds());
+    for (int i = first; i + 1 < rowCount && i <= last; ++i) {
+        // midpoint between bottom of current and top of next
+        float xMid = scrollArea.getX() + (scrollArea.getWidth() - 8) * 0.5f;
+        float yMid = (float)(scrollArea.getY() + rowTops[(size_t)i + 1] - view.getY());
 
         xMid += 2.0f; 
         juce::Point<float> mid(xMid, yMid);
@@ -520,6 +607,7 @@ void DaisyChain::paint(juce::Graphics& g) {
         else                                    { drawDownArrow(g, mid);
         }
     }
+    g.restoreState();
 }
 
 // flatten current rows into single list of effect names
@@ -671,7 +759,9 @@ void DaisyChain::showAddMenu() {
     menu.addItem(5, "De-Noiser");
     menu.addItem(6, "Formant",  !formantExists);    // disable when one already exists
     menu.addItem(7, "Pitch",    !pitchExists);
-    menu.addItem(8, "Equalizer");;
+    menu.addItem(8, "Equalizer");
+    menu.addItem(9, "Multiband Compressor");
+    menu.addItem(10, "Parametric EQ");
 
 	// set look and feel
     menu.setLookAndFeel(&getLookAndFeel());
@@ -696,6 +786,8 @@ void DaisyChain::showAddMenu() {
         case 6: newNode = std::make_shared<FormantNode>(processorRef); break;
         case 7: newNode = std::make_shared<PitchNode>(processorRef); break;
         case 8: newNode = std::make_shared<EqualizerNode>(processorRef); break;
+        case 9: newNode = std::make_shared<MultibandCompressorNode>(processorRef); break;
+        case 10: newNode = std::make_shared<ParametricEqNode>(processorRef); break;
         }
         if (!newNode) return;
 
@@ -790,6 +882,34 @@ void DaisyChain::showDuplicateMenu() {
             if (onReorderFinished) onReorderFinished();
         });
 }
+// menu to attach loudness meters to an effect's input or output - Austin
+// readings show under the effect's visualizer while a meter is on
+void DaisyChain::showMeterMenu(const juce::String& effectName, juce::Component* target) {
+    auto node = findNodeByName(effectName);
+    if (!node) return;
+
+    const bool inputOn = node->isMeterEnabled(EffectNode::MeterPoint::input);
+    const bool outputOn = node->isMeterEnabled(EffectNode::MeterPoint::output);
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Loudness meter");
+    menu.addItem(1, "Meter input", true, inputOn);
+    menu.addItem(2, "Meter output", true, outputOn);
+    menu.addSeparator();
+    menu.addItem(3, "Reset readings", inputOn || outputOn);
+    menu.setLookAndFeel(&getLookAndFeel());
+
+    // the chain can be rebuilt while the menu is open, so only hold on to the node weakly
+    std::weak_ptr<EffectNode> weakNode = node;
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(target), [weakNode, inputOn, outputOn](int result) {
+            auto n = weakNode.lock();
+            if (!n) return;
+            if (result == 1) n->setMeterEnabled(EffectNode::MeterPoint::input, !inputOn);
+            else if (result == 2) n->setMeterEnabled(EffectNode::MeterPoint::output, !outputOn);
+            else if (result == 3) n->resetMeters();
+        });
+}
+
 // menu to delete existing effect nodes
 void DaisyChain::showDeleteMenu() {
     if (reorderLocked) return;  // prevent adding if locked
@@ -51,18 +51,14 @@ void EffectPanel::paint(juce::Graphics& g) {
 
 }
 
-// rebuild tabs when effects are added/removed
+// sync tabs when effects are added/removed/moved
 void EffectPanel::refreshTabs() {
-    std::lock_guard<std::recursive_mutex> lock(processor.getMutex());
-    //rebuilds tabs based on gobal effects list
-    effectNodes = processor.getEffectNodes();
-    tabs.clearTabs();
-    for (auto& node : effectNodes) {
-        if (!node) continue; // skip invalid       
-		{   // create panel from node
-            auto panel = node->createPanel(processor);
-            if (panel)   
-                tabs.addTab(node->effectName, juce::Colours::transparentBlack, panel.release(), true);
-        }
+    {   // only hold the lock long enough to copy the node list
+        std::lock_guard<std::recursive_mutex> lock(processor.getMutex());
+        effectNodes = processor.getEffectNodes();
     }
+    //panels for nodes already there are kept, a new node's panel is made from the node when its tab is first shown
+    nodeTabs.sync(effectNodes, [this](const std::shared_ptr<EffectNode>& node) {
+        return node->createPanel(processor);
+        });
 }
\ No newline at end of file
@@ -3,12 +3,12 @@
 #include "Pitchblade/ui/EqualizerVisualizer.h"
 #include "Pitchblade/effects/Equalizer.h"
 
-EqualizerVisualizer::EqualizerVisualizer(AudioPluginAudioProcessor& proc)
-    : processor(proc)
+EqualizerVisualizer::EqualizerVisualizer(AudioPluginAudioProcessor& proc, Equalizer& eq)
+    : FrameClockClient(*this, 15), processor(proc), equalizer(eq)
 {
     // Use displayMode 1 to draw a horizontal 0 dB line and a vertical band marker
     // FrequencyGraphVisualizer y-axis is fixed to [-100, 0] dB.
-    graph = std::make_unique<FrequencyGraphVisualizer>(processor.apvts, 5, 1);
+    graph = std::make_unique<FrequencyGraphVisualizer>(5, 1);
     addAndMakeVisible(*graph);
 
     // Add overlay that repaints y-axis labels to match knob range [-24, +24] dB
@@ -19,11 +19,10 @@ EqualizerVisualizer::EqualizerVisualizer(AudioPluginAudioProcessor& proc)
 
     // Initial threshold aligned to 0 dB baseline after our display mapping
     // We map [-24..+24] dB to the full [-100..0] visual range, so 0 dB -> -50
-    graph->setThreshold(processor.getEqualizer().getMidFreq(), -50.0f);
+    graph->setThreshold(equalizer.getMidFreq(), -50.0f);
 
-    // Update regularly; cost is low (rebuilding 300 points)
-    // FrequencyGraphVisualizer handles its own repaint timer; we just refresh data
-    startTimerHz(15);
+    // The frame clock checks at 15 Hz whether anything changed; the curve itself is only rebuilt when a knob moves
+    // FrequencyGraphVisualizer repaints itself on its own frames; we just refresh data
 
     // Populate once immediately
     updateResponseCurve();
@@ -31,7 +30,6 @@ EqualizerVisualizer::EqualizerVisualizer(AudioPluginAudioProcessor& proc)
 
 EqualizerVisualizer::~EqualizerVisualizer()
 {
-    stopTimer();
 }
 
 void EqualizerVisualizer::resized()
@@ -40,12 +38,17 @@ void EqualizerVisualizer::resized()
         graph->setBounds(getLocalBounds());
     if (yLabels)
         yLabels->setBounds(getLocalBounds());
+
+    // new width means a new grid, so the curve has to be redone too
+    gridSampleRate = 0.0;
+    responseValid = false;
 }
 
 void EqualizerVisualizer::forceUpdateForTest()
 {
     // Keep threshold in sync and rebuild response immediately.
-    graph->setThreshold(processor.getEqualizer().getMidFreq(), -50.0f);
+    responseValid = false;
+    graph->setThreshold(equalizer.getMidFreq(), -50.0f);
     updateResponseCurve();
 }
 
@@ -55,82 +58,94 @@ std::vector<juce::Point<float>> EqualizerVisualizer::getLastResponsePoints() con
     return lastResponse;
 }
 
-void EqualizerVisualizer::timerCallback()
+void EqualizerVisualizer::frameCallback()
 {
-    // Keep the vertical threshold in sync with the mid frequency, baseline at -50 dB (mapped 0 dB)
-    graph->setThreshold(processor.getEqualizer().getMidFreq(), -50.0f);
-    updateResponseCurve();
+    const auto& eq = equalizer;
+    const double sr = processor.getSampleRate() > 0.0 ? processor.getSampleRate() : 44100.0;
+
+    if (!responseValid || eq.getParameterVersion() != drawnVersion || sr != gridSampleRate)
+    {
+        // Keep the vertical threshold in sync with the mid frequency, baseline at -50 dB (mapped 0 dB)
+        graph->setThreshold(eq.getMidFreq(), -50.0f);
+        updateResponseCurve();
+        settleTicksLeft = settleTicks;
+    }
+    else if (settleTicksLeft > 0)
+    {
+        --settleTicksLeft;
+        const juce::ScopedLock sl(responseLock);
+        graph->updateSpectrumData(lastResponse);
+    }
 }
 
-void EqualizerVisualizer::buildLogFrequencies(std::vector<float>& freqs, int numPoints)
+void EqualizerVisualizer::buildGrid(double sampleRate)
 {
-    freqs.clear();
-    freqs.reserve((size_t)numPoints);
+    // one point per pixel is as fine as the curve can be drawn. 300 before the first layout
+    const int numPoints = getWidth() > 1 ? getWidth() : 300;
     const float fStart = 20.0f;
-    const float fEnd= 20000.0f;
-    const float logStart = std::log10(fStart);
-    const float logEnd = std::log10(fEnd);
+    const float fEnd = 20000.0f;
+
+    gridFrequencies.resize((size_t)numPoints);
+    gridPhi.resize((size_t)numPoints);
+    magnitudeSquared.resize((size_t)numPoints);
+
+    // each point is the last one times a fixed ratio, rather than a pow() per point
+    const double ratio = std::pow((double)fEnd / (double)fStart, 1.0 / (double)juce::jmax(1, numPoints - 1));
+    double f = fStart;
     for (int i = 0; i < numPoints; ++i)
     {
-        float t = (numPoints <= 1 ? 0.0f : (float)i / (float)(numPoints - 1));
-        float f = std::pow(10.0f, juce::jmap(t, logStart, logEnd));
-        freqs.push_back(f);
+        gridFrequencies[(size_t)i] = (float)f;
+        const double s = std::sin(juce::MathConstants<double>::pi * f / sampleRate);
+        gridPhi[(size_t)i] = (float)(s * s);
+        f *= ratio;
     }
+
+    gridSampleRate = sampleRate;
 }
 
 void EqualizerVisualizer::updateResponseCurve()
 {
-    auto& eq = processor.getEqualizer();
+    auto& eq = equalizer;
 
-    // Get current parameters (thread-safe atomics)
-    const float lowHz = eq.getLowFreq();
-    const float midHz = eq.getMidFreq();
-    const float highHz = eq.getHighFreq();
-    const float lowDb = eq.getLowGainDb();
-    const float midDb = eq.getMidGainDb();
-    const float highDb = eq.getHighGainDb();
+    // Read the version first, so a knob that moves while this runs still gets picked up next tick
+    drawnVersion = eq.getParameterVersion();
+    responseValid = true;
 
     // Sample rate may be 0 before prepareToPlay; default to 44100
     double sr = processor.getSampleRate();
     if (sr <= 0.0)
         sr = 44100.0;
+    if (sr != gridSampleRate || gridFrequencies.empty())
+        buildGrid(sr);
 
     // Build coefficients mirroring the DSP path (Q=1.0 to match Equalizer)
     const float Q = 1.0f;
-    auto lowC = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sr, lowHz, Q, juce::Decibels::decibelsToGain(lowDb));
-    auto midC = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sr, midHz, Q, juce::Decibels::decibelsToGain(midDb));
-    auto highC = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, highHz, Q, juce::Decibels::decibelsToGain(highDb));
-
-    // Generate response over log-spaced frequencies
-    std::vector<float> freqs;
-    buildLogFrequencies(freqs, 300);
+    const auto lowC  = BiquadCoefficients::lowShelf (sr, eq.getLowFreq(),  Q, juce::Decibels::decibelsToGain(eq.getLowGainDb()));
+    const auto midC  = BiquadCoefficients::peak     (sr, eq.getMidFreq(),  Q, juce::Decibels::decibelsToGain(eq.getMidGainDb()));
+    const auto highC = BiquadCoefficients::highShelf(sr, eq.getHighFreq(), Q, juce::Decibels::decibelsToGain(eq.getHighGainDb()));
 
-    std::vector<juce::Point<float>> points;
-    points.reserve(freqs.size());
-
-    for (float f : freqs)
-    {
-        // Combine magnitudes in linear domain
-        float mag = 1.0f;
-        if (lowC) mag *= lowC ->getMagnitudeForFrequency(f, (float)sr);
-        if (midC)mag *= midC ->getMagnitudeForFrequency(f, (float)sr);
-        if (highC) mag *= highC->getMagnitudeForFrequency(f, (float)sr);
-
-        // Convert to dB and remap so [-24..+24] spans the full visualizer range [-100..0].
-        float db = juce::Decibels::gainToDecibels(mag, -100.0f);
-        db = juce::jlimit(-24.0f, 24.0f, db);
-        float displayDb = juce::jmap(db, -24.0f, 24.0f, -100.0f, 0.0f);
-
-        points.emplace_back(f, displayDb);
-    }
+    // Combine magnitudes in linear domain, squared so there is no square root until the dB conversion
+    const int numPoints = (int)gridFrequencies.size();
+    std::fill(magnitudeSquared.begin(), magnitudeSquared.end(), 1.0f);
+    lowC .multiplyMagnitudeSquared(gridPhi.data(), magnitudeSquared.data(), numPoints);
+    midC .multiplyMagnitudeSquared(gridPhi.data(), magnitudeSquared.data(), numPoints);
+    highC.multiplyMagnitudeSquared(gridPhi.data(), magnitudeSquared.data(), numPoints);
 
     {
         const juce::ScopedLock sl(responseLock);
-        lastResponse = points;
+        lastResponse.resize((size_t)numPoints);
+        for (int i = 0; i < numPoints; ++i)
+        {
+            // Convert to dB and remap so [-24..+24] spans the full visualizer range [-100..0].
+            float db = 10.0f * std::log10(juce::jmax(1.0e-10f, magnitudeSquared[(size_t)i]));
+            db = juce::jlimit(-24.0f, 24.0f, db);
+            const float displayDb = juce::jmap(db, -24.0f, 24.0f, -100.0f, 0.0f);
+            lastResponse[(size_t)i] = { gridFrequencies[(size_t)i], displayDb };
+        }
+
+        // Push to the graph (thread-safe inside the visualizer)
+        graph->updateSpectrumData(lastResponse);
     }
-
-    // Push to the graph (thread-safe inside the visualizer)
-    graph->updateSpectrumData(points);
 }
 
 // Parent paint remains minimal; overlay handles labels
@@ -165,38 +165,20 @@ float FormantVisualizer::FormantOverlay::mapXToVisibleFreq(float x, juce::Rectan
 //=========================== Container ===========================
 FormantVisualizer::FormantVisualizer(AudioPluginAudioProcessor& processorRef,
                                      juce::AudioProcessorValueTreeState& vts)
-    : processor(processorRef), apvts(vts)
+    : FrameClockClient(*this), processor(processorRef), apvts(vts)
 {
     // Background grid/axes from FrequencyGraphVisualizer
     // Pass 0 y-axis labels to hide y-axis labeling for formants
-    freqGraph = std::make_unique<FrequencyGraphVisualizer>(apvts, 0, 0);
+    freqGraph = std::make_unique<FrequencyGraphVisualizer>(0, 0);
     addAndMakeVisible(freqGraph.get());
 
     // Overlay markers
     overlay = std::make_unique<FormantOverlay>(processor, apvts);
     addAndMakeVisible(overlay.get());
-
-    // Listen to global framerate and start timer accordingly
-    apvts.addParameterListener("GLOBAL_FRAMERATE", this);
-
-    int initialIndex = apvts.getRawParameterValue("GLOBAL_FRAMERATE")
-                         ? (int) *apvts.getRawParameterValue("GLOBAL_FRAMERATE")
-                         : 2; // default ~30 Hz
-
-    switch (initialIndex)
-    {
-        case 0: startTimerHz(5);  break;
-        case 1: startTimerHz(15); break;
-        case 2: startTimerHz(30); break;
-        case 3: startTimerHz(60); break;
-        default: startTimerHz(30); break;
-    }
 }
 
 FormantVisualizer::~FormantVisualizer()
 {
-    stopTimer();
-    apvts.removeParameterListener("GLOBAL_FRAMERATE", this);
 }
 
 void FormantVisualizer::resized()
@@ -211,24 +193,8 @@ void FormantVisualizer::paint(juce::Graphics& g)
     // Container paints nothing; children handle drawing
 }
 
-void FormantVisualizer::timerCallback()
+void FormantVisualizer::frameCallback()
 {
-    if (isShowing() && overlay)
+    if (overlay)
         overlay->repaint();
 }
-
-void FormantVisualizer::parameterChanged(const juce::String& parameterID, float newValue)
-{
-    if (parameterID != "GLOBAL_FRAMERATE")
-        return;
-
-    int index = (int) newValue;
-    switch (index)
-    {
-        case 0: startTimerHz(5);  break;
-        case 1: startTimerHz(15); break;
-        case 2: startTimerHz(30); break;
-        case 3: startTimerHz(60); break;
-        default: startTimerHz(30); break;
-    }
-}
@@ -0,0 +1,156 @@
+// Written by Austin Hills
+
+#include "Pitchblade/ui/FrameClock.h"
+
+//Vertical blanks don't land exactly on a client's frame times, so a frame this close to being due counts as due
+static constexpr double FRAME_TOLERANCE_SEC = 0.002;
+
+FrameClock::FrameClock(juce::Component& editorToWatch, juce::AudioProcessorValueTreeState& vts)
+    : editor(editorToWatch),
+      apvts(vts),
+      vBlank(&editorToWatch, [this](double timestampSec){ onVBlank(timestampSec); })
+{
+    //Listen to framerate parameter
+    apvts.addParameterListener("GLOBAL_FRAMERATE", this);
+    if(auto* setting = apvts.getRawParameterValue("GLOBAL_FRAMERATE")){
+        frameRateHz = rateForSetting((int)setting->load());
+    }
+}
+
+FrameClock::~FrameClock(){
+    apvts.removeParameterListener("GLOBAL_FRAMERATE", this);
+
+    //Anything still attached must not call back into this
+    clients.call([](FrameClockClient& client){ client.clock = nullptr; });
+}
+
+int FrameClock::rateForSetting(int settingIndex){
+    switch(settingIndex){
+        case 1:
+            return 5;
+        case 2:
+            return 15;
+        case 3:
+            return 30;
+        case 4:
+            return 60;
+        default:
+            return 30;
+    }
+}
+
+void FrameClock::addClient(FrameClockClient& client){
+    clients.add(&client);
+}
+
+void FrameClock::removeClient(FrameClockClient& client){
+    clients.remove(&client);
+}
+
+void FrameClock::onVBlank(double timestampSec){
+    //Nothing gets ticked while the editor can't be seen. The clients are told once, so they can stop whatever they feed from
+    auto* peer = editor.getPeer();
+    if(!editor.isShowing() || peer == nullptr || peer->isMinimised()){
+        if(!paused){
+            paused = true;
+            pauseAll();
+        }
+        return;
+    }
+    paused = false;
+
+    //Everyone due this frame is ticked here, so all of their repaints go out in the same paint
+    clients.call([timestampSec](FrameClockClient& client){ client.clockTick(timestampSec); });
+}
+
+void FrameClock::pauseAll(){
+    clients.call([](FrameClockClient& client){ client.clockPaused(); });
+}
+
+//If the user changes the FPS in the settings, change it
+void FrameClock::parameterChanged(const juce::String& parameterID, float newValue){
+    if(parameterID == "GLOBAL_FRAMERATE"){
+        frameRateHz = rateForSetting((int)newValue);
+    }
+}
+
+FrameClockClient::FrameClockClient(juce::Component& componentToWatch, int rateHz)
+    : owner(componentToWatch), fixedRateHz(rateHz)
+{
+    owner.addComponentListener(this);
+    attachToNearestClock();
+}
+
+FrameClockClient::~FrameClockClient(){
+    owner.removeComponentListener(this);
+    if(clock != nullptr){
+        clock->removeClient(*this);
+    }
+}
+
+int FrameClockClient::getRateHz() const{
+    if(fixedRateHz > 0){
+        return fixedRateHz;
+    }
+    return clock != nullptr ? clock->getFrameRateHz() : 30;
+}
+
+int FrameClockClient::getFrameIntervalMs() const{
+    return 1000 / juce::jmax(1, getRateHz());
+}
+
+void FrameClockClient::clockTick(double timestampSec){
+    const bool showing = owner.isShowing();
+    if(showing != wasShowing){
+        wasShowing = showing;
+        nextFrameSec = 0.0;
+        frameVisibilityChanged(showing);
+    }
+    if(!showing || timestampSec + FRAME_TOLERANCE_SEC < nextFrameSec){
+        return;
+    }
+
+    //Frames are kept on a steady grid so the rate averages out right whatever the display's refresh rate is.
+    //If the grid has fallen a whole frame behind (after a stall), it starts again from now
+    const double period = 1.0 / (double)juce::jmax(1, getRateHz());
+    if(nextFrameSec > 0.0 && timestampSec - nextFrameSec < period){
+        nextFrameSec += period;
+    }else{
+        nextFrameSec = timestampSec + period;
+    }
+
+    frameCallback();
+}
+
+void FrameClockClient::clockPaused(){
+    if(wasShowing){
+        wasShowing = false;
+        frameVisibilityChanged(false);
+    }
+}
+
+void FrameClockClient::componentParentHierarchyChanged(juce::Component& component){
+    juce::ignoreUnused(component);
+    attachToNearestClock();
+}
+
+void FrameClockClient::attachToNearestClock(){
+    FrameClock* nearest = nullptr;
+    if(auto* host = owner.findParentComponentOfClass<FrameClock::Host>()){
+        nearest = &host->getFrameClock();
+    }
+    if(nearest == clock){
+        return;
+    }
+
+    if(clock != nullptr){
+        clock->removeClient(*this);
+    }
+    clock = nearest;
+    if(clock != nullptr){
+        clock->addClient(*this);
+    }
+
+    //Taken out of the editor means off screen as far as this is concerned
+    clockPaused();
+}
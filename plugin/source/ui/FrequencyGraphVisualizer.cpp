@@ -3,71 +3,53 @@
 #include "Pitchblade/ui/FrequencyGraphVisualizer.h"
 
 //Initializing by setting parameters as defined
-FrequencyGraphVisualizer::FrequencyGraphVisualizer(juce::AudioProcessorValueTreeState& vts, int numYLabels, int dispMode)
-    : apvts(vts)
+FrequencyGraphVisualizer::FrequencyGraphVisualizer(int numYLabels, int dispMode)
+    : FrameClockClient(*this)
 {
     displayMode = dispMode;
 
     numYAxisLabels = numYLabels;
 
+    //The grid image covers everything, so nothing behind this needs painting first
+    setOpaque(true);
+
     //Log transformed frequency range
     logFreqStart = log10(xAxisRange.getStart());
     logFreqEnd = log10(xAxisRange.getEnd());
-
-    //Listen to framerate parameter
-    apvts.addParameterListener("GLOBAL_FRAMERATE",this);
-
-    int initialIndex = *apvts.getRawParameterValue("GLOBAL_FRAMERATE");
-
-    switch(initialIndex){
-        case 1:
-            startTimerHz(5);
-            break;
-        case 2:
-            startTimerHz(15);
-            break;
-        case 3:
-            startTimerHz(30);
-            break;
-        case 4:
-            startTimerHz(60);
-            break;
-        default:
-            startTimerHz(30);
-            break;
-    }
-
 }
 
-//Ensuring that timer can't do anything if visualizer is destroyed
 FrequencyGraphVisualizer::~FrequencyGraphVisualizer()
 {
-    stopTimer();
-    apvts.removeParameterListener("GLOBAL_FRAMERATE", this);
 }
 
 //Big function to handle all of the visual stuff
 void FrequencyGraphVisualizer::paint(juce::Graphics& g){
-    // Fill background
-    g.fillAll(Colors::panel);
-
-    // Draw labels and grid
-    drawLabels(g);
+    //Grid and labels come from the cached image. It's made at a whole number of physical pixels per logical one, so it stays sharp
+    const int scale = juce::jmax(1, juce::roundToInt(g.getInternalContext().getPhysicalPixelScaleFactor()));
+    if(gridImage.isNull() || scale != gridImageScale){
+        gridImageScale = scale;
+        gridImage = juce::Image(juce::Image::RGB, juce::jmax(1, getWidth() * scale), juce::jmax(1, getHeight() * scale), false);
+        juce::Graphics gridGraphics(gridImage);
+        gridGraphics.addTransform(juce::AffineTransform::scale((float)scale));
+        gridGraphics.fillAll(Colors::panel);
+        drawLabels(gridGraphics);
+    }
+    g.drawImage(gridImage, getLocalBounds().toFloat());
 
     // Save current graphics state and clip everything outside of the graph's bounds
     g.saveState();
     g.reduceClipRegion(graphBounds);
 
-    // Draw graph. Lock the dataMutex to ensure data isn't modified
+    // Draw graph. The columns are ready to go, so the lock is only held while they're drawn
     {
         juce::ScopedLock lock(dataMutex);
-        
-        drawSpectrum(g);
+
+        drawTrace(g, primary.columns, Colors::accent, true);
 
         //If displayMode is set to secondary spectrum, draw that one as well
         if (displayMode == 2)
         {
-            drawSecondarySpectrum(g);
+            drawTrace(g, secondary.columns, Colors::accent.withAlpha(0.5f), false);
         }
     }
 
@@ -88,73 +70,121 @@ void FrequencyGraphVisualizer::resized(){
     xLabelBounds = bounds.removeFromBottom(labelHeight);
     yLabelBounds = bounds.removeFromLeft(labelWidth);
     graphBounds = bounds.reduced(0, 5);
+
+    //The grid has to be drawn again, and the points land in different columns now
+    gridImage = juce::Image();
+    layoutVersion++;
+    binColumns(primary);
+    binColumns(secondary);
 }
 
-void FrequencyGraphVisualizer::timerCallback()
+void FrequencyGraphVisualizer::frameCallback()
 {
-    // Only repaint if the visualizer is actually visible
-    if (isShowing())
+    // Only called while the visualizer is on screen. Everything that moves is clipped to the graph, so only that area is redrawn,
+    // and only when something in it changed
+    if (needsRepaint)
     {
-        repaint();
+        needsRepaint = false;
+        repaint(graphBounds);
     }
 }
 
-//This function is called from the audio thread to update the spectrum data
+//Called from the message thread to update the spectrum data
 void FrequencyGraphVisualizer::updateSpectrumData(const std::vector<juce::Point<float>>& newData)
 {
-    juce::ScopedLock lock(dataMutex);
-    spectrumData = newData;
+    smoothAndBin(primary, newData);
+}
+
+//Same as above but for the (optional) secondary spectrum
+void FrequencyGraphVisualizer::updateSecondarySpectrumData(const std::vector<juce::Point<float>>& newData)
+{
+    smoothAndBin(secondary, newData);
+}
 
+void FrequencyGraphVisualizer::smoothAndBin(Trace& trace, const std::vector<juce::Point<float>>& newData){
     //Enveloping because the data looked weird in its raw state
 
     //At start or if size change happens, copy the data
-    if(displayedSpectrumData.size() != spectrumData.size()){
-        displayedSpectrumData = spectrumData;
-        // return;
-    }
-
-    //Get frame-independent coefficient
-    float timerIntervalMs = (float)getTimerInterval();
-    float accelCoeff = juce::jlimit(0.0f,1.0f,timerIntervalMs/accelerationTimeMs);
+    if(trace.smoothed.size() != newData.size()){
+        trace.smoothed = newData;
+    }else{
+        //Get frame-independent coefficient
+        float timerIntervalMs = (float)getFrameIntervalMs();
+        float accelCoeff = juce::jlimit(0.0f,1.0f,timerIntervalMs/accelerationTimeMs);
 
-    for(int i = 0; i < spectrumData.size(); i++){
-        float targetY = spectrumData[i].getY();
-        float currentY = displayedSpectrumData[i].getY();
+        for(size_t i = 0; i < newData.size(); i++){
+            float targetY = newData[i].getY();
+            float currentY = trace.smoothed[i].getY();
 
-        float newY = currentY + (targetY - currentY) * accelCoeff;
+            float newY = currentY + (targetY - currentY) * accelCoeff;
 
-        displayedSpectrumData[i].setXY(spectrumData[i].getX(), newY);
+            trace.smoothed[i].setXY(newData[i].getX(), newY);
+        }
     }
 
-
+    binColumns(trace);
 }
 
-//Same as above but for the (optional) secondary spectrum
-void FrequencyGraphVisualizer::updateSecondarySpectrumData(const std::vector<juce::Point<float>>& newData)
-{
-    juce::ScopedLock lock(dataMutex);
-    secondarySpectrumData = newData;
+void FrequencyGraphVisualizer::binColumns(Trace& trace){
+    const auto& points = trace.smoothed;
+    const size_t numPoints = points.size();
+    const int width = graphBounds.getWidth();
 
-    //Enveloping because the data looked weird in its raw state
-
-    //At start or if size change happens, copy the data
-    if(displayedSecondarySpectrumData.size() != secondarySpectrumData.size()){
-        displayedSecondarySpectrumData = secondarySpectrumData;
-        // return;
+    //Rebuild the point to column map if the frequencies or the layout changed. The spectra always send the same frequencies,
+    //so this (and its log10 per point) normally only happens once
+    bool sameFrequencies = trace.mappedLayout == layoutVersion && trace.mappedFrequencies.size() == numPoints;
+    for(size_t i = 0; sameFrequencies && i < numPoints; i++){
+        sameFrequencies = trace.mappedFrequencies[i] == points[i].getX();
+    }
+    if(!sameFrequencies){
+        trace.mappedFrequencies.resize(numPoints);
+        trace.pointColumn.resize(numPoints);
+        trace.pointX.resize(numPoints);
+        for(size_t i = 0; i < numPoints; i++){
+            const float freq = points[i].getX();
+            trace.mappedFrequencies[i] = freq;
+            trace.pointColumn[i] = -1;
+
+            //Only points within the frequency range are drawn
+            if(width > 0 && freq >= xAxisRange.getStart() && freq <= xAxisRange.getEnd()){
+                const float x = mapFreqToX(freq);
+                trace.pointX[i] = x;
+                trace.pointColumn[i] = juce::jlimit(0, width - 1, (int)(x - (float)graphBounds.getX()));
+            }
+        }
+        trace.mappedLayout = layoutVersion;
     }
 
-    //Get frame-independent coefficient
-    float timerIntervalMs = (float)getTimerInterval();
-    float accelCoeff = juce::jlimit(0.0f,1.0f,timerIntervalMs/accelerationTimeMs);
-
-    for(int i = 0; i < secondarySpectrumData.size(); i++){
-        float targetY = secondarySpectrumData[i].getY();
-        float currentY = displayedSecondarySpectrumData[i].getY();
-
-        float newY = currentY + (targetY - currentY) * accelCoeff;
+    //Sort the points into columns. They come in going up in frequency, so a new column starts whenever the column number changes
+    auto& columns = trace.building;
+    columns.clear();
+    int lastColumn = -1;
+    for(size_t i = 0; i < numPoints; i++){
+        const int column = trace.pointColumn[i];
+        if(column < 0){
+            continue;
+        }
+        const float amp = points[i].getY();
+        if(column != lastColumn){
+            columns.push_back({ trace.pointX[i], amp, amp, 1 });
+            lastColumn = column;
+        }else{
+            auto& current = columns.back();
+            if(amp > current.maxDb){
+                current.maxDb = amp;
+                current.x = trace.pointX[i];
+            }
+            current.minDb = juce::jmin(current.minDb, amp);
+            current.count++;
+        }
+    }
 
-        displayedSecondarySpectrumData[i].setXY(secondarySpectrumData[i].getX(), newY);
+    //Hand them over. Both vectors keep their storage, so after the first few frames nothing allocates
+    {
+        juce::ScopedLock lock(dataMutex);
+        trace.columns.swap(trace.building);
     }
+    needsRepaint = true;
 }
 
 //This is called from the message thread when the threshold slider values have changed
@@ -162,6 +192,7 @@ void FrequencyGraphVisualizer::setThreshold(float frequency, float amplitude)
 {
     xThreshold = frequency;
     yThreshold = amplitude;
+    needsRepaint = true;
 }
 
 //Draw labels and grids
@@ -222,177 +253,59 @@ void FrequencyGraphVisualizer::drawLabels(juce::Graphics& g)
 }
 
 //Graph drawing function. The function assumes that the dataMutex is already locked
-void FrequencyGraphVisualizer::drawSpectrum(juce::Graphics& g){
+void FrequencyGraphVisualizer::drawTrace(juce::Graphics& g, const std::vector<Column>& columns, juce::Colour lineColour, bool isPrimary){
     //If there is nothing to draw, do not draw
-    if(displayedSpectrumData.empty()){
+    if(columns.empty()){
         return;
     }
 
-    g.setColour(Colors::accent);
+    //One vertex per pixel column, at the loudest point in it so narrow peaks don't get averaged away
     juce::Path spectrumPath;
-
-    //No duplicate pixels version. When multiple values want to be on the same x pixel, this averages them out
-    int lastXPixel = -1;
-    float ySum = 0.0f;
-    int yCount = 0;
-
-    for(int i = 0; i < displayedSpectrumData.size(); i++){
-        float freq = displayedSpectrumData[i].getX();
-        float amp = displayedSpectrumData[i].getY();
-
-        //Only process points within the frequency range
-        if(freq >= xAxisRange.getStart() && freq <= xAxisRange.getEnd()){
-            float x = mapFreqToX(freq);
-            float y = mapAmpToY(amp);
-            int currentXPixel = (int)x;
-
-            if(i == 0){
-                //If this is the first data point, just graph it
-                spectrumPath.startNewSubPath(x,y);
-                lastXPixel = currentXPixel;
-                ySum = y;
-                yCount = 1;
-            }else if (currentXPixel != lastXPixel){
-                //If this is a new pixel, then draw the average of the past pixel's points
-                if(yCount > 0){
-                    spectrumPath.lineTo(x,ySum/(float)yCount);
-                }else{
-                    spectrumPath.lineTo(x,y);
-                }
-                
-                lastXPixel = currentXPixel;
-                ySum = y;
-                yCount = 1;
-            }else{
-                //Same pixel as before. Add to the sum so it can be averaged
-                ySum += y;
-                yCount++;
-            }
-        }
-    }
-
-    //Draw last point
-    if(yCount > 0){
-        spectrumPath.lineTo((float)lastXPixel,ySum / (float)yCount);
+    spectrumPath.preallocateSpace((int)columns.size() * 3 + 3);
+    spectrumPath.startNewSubPath(columns.front().x, mapAmpToY(columns.front().maxDb));
+    for(size_t i = 1; i < columns.size(); i++){
+        spectrumPath.lineTo(columns[i].x, mapAmpToY(columns[i].maxDb));
     }
 
-    //Draw path with a 2 pixel stroke
-    g.strokePath(spectrumPath, juce::PathStrokeType(2.0f));
-
-    // add gradient under graph - reyna /////////
-    {
-        juce::Path fillPath;
-        float bottom = graphBounds.getBottom();
-        float left = graphBounds.getX();
-
-        // start bottom left
-        fillPath.startNewSubPath(left, bottom);
-        int lastX = -1;
-        float accY = 0.0f;
-        int accCount = 0;
-
-        for (int i = 0; i < displayedSpectrumData.size(); i++) {
-            float freq = displayedSpectrumData[i].getX();
-            float amp = displayedSpectrumData[i].getY();
-            if (freq >= xAxisRange.getStart() && freq <= xAxisRange.getEnd()) {
-                float x = mapFreqToX(freq);
-                float y = mapAmpToY(amp);
-                int px = (int)x;
-                if (i == 0) {
-                    fillPath.lineTo(x, y);
-                    lastX = px;
-                    accY = y;
-                    accCount = 1;
-                } else if (px != lastX) {
-                    float averagedY = (accCount > 0 ? accY / (float)accCount : y);
-                    fillPath.lineTo(x, averagedY);
-
-                    lastX = px;
-                    accY = y;
-                    accCount = 1;
-                } else {
-                    accY += y;
-                    accCount++;
-                }
-            }
+    if(isPrimary){
+        // add gradient under graph - reyna /////////
+        {
+            const float bottom = (float)graphBounds.getBottom();
+
+            juce::Path fillPath(spectrumPath);
+            fillPath.lineTo(columns.back().x, bottom);
+            fillPath.lineTo(columns.front().x, bottom);
+            fillPath.closeSubPath();
+
+            // gradient
+            juce::ColourGradient grad(
+                Colors::accentPink.withAlpha(0.35f), graphBounds.getX(), graphBounds.getY(),
+                Colors::panel.withAlpha(0.35f), graphBounds.getX(), graphBounds.getBottom(),
+                false
+            );
+
+            g.setGradientFill(grad);
+            g.fillPath(fillPath);
         }
 
-        if (accCount > 0)
-            fillPath.lineTo((float)lastX, accY / (float)accCount);
-
-        // close at bottom
-        fillPath.lineTo((float)lastX, bottom);
-        fillPath.closeSubPath();
-
-        // gradient
-        juce::ColourGradient grad(
-            Colors::accentPink.withAlpha(0.35f), graphBounds.getX(), graphBounds.getY(),
-            Colors::panel.withAlpha(0.35f), graphBounds.getX(), graphBounds.getBottom(),
-            false
-        );
-
-        g.setGradientFill(grad);
-        g.fillPath(fillPath);
-    } 
-}
-
-//Another graph drawing function. The function assumes that the dataMutex is already locked
-void FrequencyGraphVisualizer::drawSecondarySpectrum(juce::Graphics& g){
-    //If there is nothing to draw, do not draw
-    if(displayedSecondarySpectrumData.empty()){
-        return;
-    }
-
-    g.setColour(Colors::accent.withAlpha(0.5f));
-    juce::Path spectrumPath;
-
-    //No duplicate pixels version. When multiple values want to be on the same x pixel, this averages them out
-    int lastXPixel = -1;
-    float ySum = 0.0f;
-    int yCount = 0;
-
-    for(int i = 0; i < displayedSecondarySpectrumData.size(); i++){
-        float freq = displayedSecondarySpectrumData[i].getX();
-        float amp = displayedSecondarySpectrumData[i].getY();
-
-        //Only process points within the frequency range
-        if(freq >= xAxisRange.getStart() && freq <= xAxisRange.getEnd()){
-            float x = mapFreqToX(freq);
-            float y = mapAmpToY(amp);
-            int currentXPixel = (int)x;
-
-            if(i == 0){
-                //If this is the first data point, just graph it
-                spectrumPath.startNewSubPath(x,y);
-                lastXPixel = currentXPixel;
-                ySum = y;
-                yCount = 1;
-            }else if (currentXPixel != lastXPixel){
-                //If this is a new pixel, then draw the average of the past pixel's points
-                if(yCount > 0){
-                    spectrumPath.lineTo(x,ySum/(float)yCount);
-                }else{
-                    spectrumPath.lineTo(x,y);
+        //Up in the highs lots of bins share a column. Show how far apart they are as a faint bar under the line
+        juce::RectangleList<float> spread;
+        for(const auto& column : columns){
+            if(column.count > 1){
+                const float top = mapAmpToY(column.maxDb);
+                const float height = mapAmpToY(column.minDb) - top;
+                if(height > 1.0f){
+                    spread.addWithoutMerging({ column.x - 0.5f, top, 1.0f, height });
                 }
-                
-                lastXPixel = currentXPixel;
-                ySum = y;
-                yCount = 1;
-            }else{
-                //Same pixel as before. Add to the sum so it can be averaged
-                ySum += y;
-                yCount++;
             }
         }
-    }
-
-    //Draw last point
-    if(yCount > 0){
-        spectrumPath.lineTo((float)lastXPixel,ySum / (float)yCount);
+        g.setColour(lineColour.withAlpha(0.25f));
+        g.fillRectList(spread);
     }
 
     //Draw path with a 2 pixel stroke
-    g.strokePath(spectrumPath,juce::PathStrokeType(2.0f));
+    g.setColour(lineColour);
+    g.strokePath(spectrumPath, juce::PathStrokeType(2.0f));
 }
 
 //Draw threshold lines
@@ -437,27 +350,3 @@ float FrequencyGraphVisualizer::mapFreqToX(float freq) const{
     //Lots simpler than the other one since the range is fixed and starts at 20
     return juce::jmap(log10(freq),logFreqStart,logFreqEnd,graphX,graphR);
 }
-
-//If the user changes the FPS in the settings, change it
-void FrequencyGraphVisualizer::parameterChanged(const juce::String& parameterID, float newValue){
-    if(parameterID == "GLOBAL_FRAMERATE"){
-        stopTimer();
-        switch((int)newValue){
-        case 1:
-            startTimerHz(5);
-            break;
-        case 2:
-            startTimerHz(15);
-            break;
-        case 3:
-            startTimerHz(30);
-            break;
-        case 4:
-            startTimerHz(60);
-            break;
-        default:
-            startTimerHz(30);
-            break;
-    }
-    }
-}
\ No newline at end of file
@@ -2,13 +2,12 @@
 #include "Pitchblade/ui/LevelMeter.h"
 
 LevelMeter::LevelMeter(std::function<float()>&& valueFunction, float minRange, float maxRange, RotationMode rotationMode) : 
+        FrameClockClient(*this),
         valueSupplier(std::move(valueFunction)),
         sourceMin(minRange),
         sourceMax(maxRange),
         rotationMode(rotationMode)
 {
-    //todo: add in Austin's functionality with several Hz rates
-    startTimerHz(30);
 }
 
 LevelMeter::~LevelMeter() {}
@@ -58,7 +57,7 @@ void LevelMeter::resized()
     }		
 }
 
-void LevelMeter::timerCallback()
+void LevelMeter::frameCallback()
 {
     repaint();
 }
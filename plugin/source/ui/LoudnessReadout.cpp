@@ -0,0 +1,88 @@
+// Written by Austin Hills
+
+#include "Pitchblade/ui/LoudnessReadout.h"
+
+LoudnessReadout::LoudnessReadout(std::weak_ptr<EffectNode> nodeToShow, std::unique_ptr<juce::Component> visualizerContent)
+    : FrameClockClient(*this, 10), node(std::move(nodeToShow)), content(std::move(visualizerContent))
+{
+    if(content){
+        addAndMakeVisible(*content);
+    }
+    setInterceptsMouseClicks(false, true);
+}
+
+LoudnessReadout::~LoudnessReadout(){
+}
+
+void LoudnessReadout::frameCallback(){
+    auto shared = node.lock();
+    const bool inputOn = shared && shared->isMeterEnabled(EffectNode::MeterPoint::input);
+    const bool outputOn = shared && shared->isMeterEnabled(EffectNode::MeterPoint::output);
+
+    if(inputOn != showInput || outputOn != showOutput){
+        showInput = inputOn;
+        showOutput = outputOn;
+        resized();
+    }
+
+    //Only the readings strip changes, the visualizer repaints itself
+    if(showInput || showOutput){
+        repaint(getLocalBounds().removeFromBottom(LINE_HEIGHT * ((int)showInput + (int)showOutput)));
+    }
+}
+
+void LoudnessReadout::resized(){
+    auto area = getLocalBounds();
+    area.removeFromBottom(LINE_HEIGHT * ((int)showInput + (int)showOutput));
+    if(content){
+        content->setBounds(area);
+    }
+}
+
+void LoudnessReadout::paint(juce::Graphics& g){
+    if(!showInput && !showOutput){
+        return;
+    }
+    auto shared = node.lock();
+    if(!shared){
+        return;
+    }
+
+    auto strip = getLocalBounds().removeFromBottom(LINE_HEIGHT * ((int)showInput + (int)showOutput));
+    g.setColour(Colors::panel);
+    g.fillRect(strip);
+
+    if(showInput){
+        drawReadings(g, strip.removeFromTop(LINE_HEIGHT), "In", shared->getMeter(EffectNode::MeterPoint::input));
+    }
+    if(showOutput){
+        drawReadings(g, strip.removeFromTop(LINE_HEIGHT), "Out", shared->getMeter(EffectNode::MeterPoint::output));
+    }
+}
+
+void LoudnessReadout::drawReadings(juce::Graphics& g, juce::Rectangle<int> area, const juce::String& label, const LoudnessMeter& meter) const{
+    area = area.reduced(6, 1);
+    g.setFont(juce::Font(13.0f));
+
+    g.setColour(Colors::accentTeal);
+    g.drawText(label, area.removeFromLeft(30), juce::Justification::centredLeft);
+
+    //True peak goes pink when it's over the usual -1 dBTP delivery ceiling
+    const float truePeak = meter.getTruePeakDb();
+    auto peakArea = area.removeFromRight(area.getWidth() / 4);
+    g.setColour(truePeak > -1.0f ? Colors::accent : Colors::buttonText);
+    g.drawText("TP " + formatLufs(truePeak) + " dBTP", peakArea, juce::Justification::centredRight);
+
+    g.setColour(Colors::buttonText);
+    const int column = area.getWidth() / 3;
+    g.drawText("M " + formatLufs(meter.getMomentaryLufs()), area.removeFromLeft(column), juce::Justification::centredLeft);
+    g.drawText("S " + formatLufs(meter.getShortTermLufs()), area.removeFromLeft(column), juce::Justification::centredLeft);
+    g.drawText("I " + formatLufs(meter.getIntegratedLufs()) + " LUFS", area, juce::Justification::centredLeft);
+}
+
+juce::String LoudnessReadout::formatLufs(float value){
+    if(value <= LoudnessMeter::SILENCE_LUFS){
+        return "-inf";
+    }
+    return juce::String(value, 1);
+}
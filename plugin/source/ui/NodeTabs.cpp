@@ -0,0 +1,142 @@
+// reyna
+
+#include "Pitchblade/ui/NodeTabs.h"
+
+NodeTabs::NodeTabs(juce::TabbedComponent& tabsToManage, juce::Colour tabColour) : tabs(tabsToManage), colour(tabColour) {}
+
+NodeTabs::~NodeTabs() {
+    stopTimer();
+    // take slots out of the tabs before deleting them
+    tabs.clearTabs();
+}
+
+int NodeTabs::findTab(const juce::Component* content) const {
+    for (int i = 0; i < tabs.getNumTabs(); ++i)
+        if (tabs.getTabContentComponent(i) == content)
+            return i;
+    return -1;
+}
+
+void NodeTabs::sync(const std::vector<std::shared_ptr<EffectNode>>& nodes, Factory create) {
+    factory = std::move(create);
+    auto* showing = tabs.getCurrentContentComponent();
+    syncing = true;
+
+    // match nodes to the entries there now. Same uuid and same node object means the slot can stay
+    std::vector<Entry> old = std::move(entries);
+    entries.clear();
+    entries.reserve(nodes.size());
+
+    for (auto& node : nodes) {
+        if (!node) continue;    // skip invalid
+        const auto uuid = node->getUuid();
+
+        auto match = std::find_if(old.begin(), old.end(), [&](const Entry& e) {
+            return e.slot != nullptr && e.uuid == uuid && e.slot->node == node;
+            });
+
+        if (match != old.end())
+            entries.push_back(std::move(*match));   // moved out, so it's skipped below
+        else
+            entries.push_back({ uuid, std::make_unique<Slot>(*this, node) });
+    }
+
+    // drop tabs for nodes that are gone, then delete their slots
+    for (auto& e : old) {
+        if (!e.slot) continue;
+        const int index = findTab(e.slot.get());
+        if (index >= 0)
+            tabs.removeTab(index);
+    }
+    old.clear();
+
+    // put each tab in its place. Everything before i is already right, so each one is a move, an insert, or nothing
+    for (int i = 0; i < (int)entries.size(); ++i) {
+        auto* slot = entries[(size_t)i].slot.get();
+        const auto& name = slot->node->effectName;
+        const int at = findTab(slot);
+        if (at < 0)
+            tabs.addTab(name, colour, slot, false, i);
+        else if (at != i)
+            tabs.moveTab(at, i);
+
+        if (tabs.getTabNames()[i] != name)
+            tabs.setTabName(i, name);
+    }
+
+    // stay on the same tab if it's still there. Showing it makes its content if it has none yet
+    const int showingIndex = showing != nullptr ? findTab(showing) : -1;
+    if (showingIndex >= 0)
+        tabs.setCurrentTabIndex(showingIndex);
+    else if (tabs.getNumTabs() > 0)
+        tabs.setCurrentTabIndex(0);
+
+    syncing = false;
+    if (auto* current = dynamic_cast<Slot*>(tabs.getCurrentContentComponent()))
+        slotShown(*current);
+}
+
+void NodeTabs::clear() {
+    stopTimer();
+    tabs.clearTabs();
+    entries.clear();
+}
+
+int NodeTabs::getNumCreated() const {
+    int count = 0;
+    for (auto& e : entries)
+        if (e.slot && e.slot->hasContent())
+            ++count;
+    return count;
+}
+
+void NodeTabs::Slot::visibilityChanged() {
+    if (isVisible()) owner.slotShown(*this);
+    else             owner.slotHidden(*this);
+}
+
+void NodeTabs::Slot::create() {
+    if (content || !node || !owner.factory) return;
+    content = owner.factory(node);
+    if (content) {
+        addAndMakeVisible(*content);
+        content->setBounds(getLocalBounds());
+    }
+}
+
+void NodeTabs::slotShown(Slot& slot) {
+    slot.hiddenSince = 0;
+    if (!syncing)
+        slot.create();
+}
+
+void NodeTabs::slotHidden(Slot& slot) {
+    if (!slot.hasContent()) return;
+    // visualizers stop their analysis on their own once off screen, this just decides how long they're kept
+    slot.hiddenSince = juce::jmax((juce::uint32)1, juce::Time::getMillisecondCounter());
+    trimHidden();
+    if (!isTimerRunning())
+        startTimer(5000);
+}
+
+void NodeTabs::trimHidden() {
+    const auto now = juce::Time::getMillisecondCounter();
+
+    // hidden slots with content, newest first
+    std::vector<Slot*> hidden;
+    for (auto& e : entries)
+        if (e.slot && e.slot->hasContent() && e.slot->hiddenSince != 0)
+            hidden.push_back(e.slot.get());
+    std::sort(hidden.begin(), hidden.end(), [](const Slot* a, const Slot* b) { return a->hiddenSince > b->hiddenSince; });
+
+    int kept = 0;
+    for (auto* slot : hidden) {
+        if (kept < MAX_HIDDEN && now - slot->hiddenSince < HIDDEN_TIMEOUT_MS)
+            ++kept;
+        else
+            slot->release();
+    }
+
+    if (kept == 0)
+        stopTimer();
+}
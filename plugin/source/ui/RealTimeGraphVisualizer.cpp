@@ -3,61 +3,49 @@
 #include "Pitchblade/ui/RealTimeGraphVisualizer.h"
 
 //Initializing by setting the parameters as defined
-RealTimeGraphVisualizer::RealTimeGraphVisualizer(juce::AudioProcessorValueTreeState& vts, const juce::String& label, juce::Range<float> range, bool isLog, int numOfYAxisLabels)
-    : apvts(vts)
+RealTimeGraphVisualizer::RealTimeGraphVisualizer(const juce::String& label, juce::Range<float> range, bool isLog, int numOfYAxisLabels)
+    : FrameClockClient(*this)
 {
     yAxisLabel = label;
     yAxisRange = range;
     isLogarithmic = isLog;
     numYAxisLabels = numOfYAxisLabels;
 
-    //Listen to framerate parameter
-    apvts.addParameterListener("GLOBAL_FRAMERATE",this);
-
-    int initialIndex = *apvts.getRawParameterValue("GLOBAL_FRAMERATE");
-
-    switch(initialIndex){
-        case 1:
-            startTimerHz(5);
-            break;
-        case 2:
-            startTimerHz(15);
-            break;
-        case 3:
-            startTimerHz(30);
-            break;
-        case 4:
-            startTimerHz(60);
-            break;
-        default:
-            startTimerHz(30);
-            break;
-    }
+    //Everything gets drawn over, so nothing behind this needs painting first
+    setOpaque(true);
+
+    //Room for a graph up to 512 pixels wide before the first layout. resized grows it if the graph is wider
+    ensureRingCapacity(512);
 }
 
-//Ensuring that the timer can't do anything if the visualizer is destroyed
 RealTimeGraphVisualizer::~RealTimeGraphVisualizer(){
-    stopTimer();
-    apvts.removeParameterListener("GLOBAL_FRAMERATE",this);
 }
 
-//big function to handle all visual stuff
+//Paints the cached background and graph, then the threshold line on top
 void RealTimeGraphVisualizer::paint(juce::Graphics& g){
-    //Fill background
-    g.fillAll(Colors::panel);
-    
-    //Draw labels
-    drawLabels(g);
-
-    //Save current graphics state and clip everything outside of the graph's bounds
-    g.saveState();
-    g.reduceClipRegion(graphBounds);
-
-    //Draw graph. Lock the dataMutex to ensure the audio thread doesn't modify the queue while it is being read
-    //Curly brackets are used to create a new, inner scope, where objects can be created inside and not exist outside of it
-    {
-        juce::ScopedLock lock(dataMutex);
-        drawGraph(g);
+    //Images are made at a whole number of physical pixels per logical one, so scrolling always moves whole pixels
+    const int scale = juce::jmax(1, juce::roundToInt(g.getInternalContext().getPhysicalPixelScaleFactor()));
+    if(scale != imageScale){
+        imageScale = scale;
+        backgroundImage = juce::Image();
+        graphImage = juce::Image();
+    }
+
+    //Background fill, labels and border only change when the size does
+    if(backgroundImage.isNull() && !getLocalBounds().isEmpty()){
+        backgroundImage = juce::Image(juce::Image::RGB, getWidth() * imageScale, getHeight() * imageScale, false);
+        juce::Graphics bg(backgroundImage);
+        bg.addTransform(juce::AffineTransform::scale((float)imageScale));
+        bg.fillAll(Colors::panel);
+        drawLabels(bg);
+    }
+    if(backgroundImage.isValid()){
+        g.drawImage(backgroundImage, getLocalBounds().toFloat());
+    }
+
+    if(!graphBounds.isEmpty()){
+        updateGraphImage();
+        g.drawImage(graphImage, graphBounds.toFloat());
     }
 
     //Draw the threshold line
@@ -75,37 +63,119 @@ void RealTimeGraphVisualizer::resized(){
 
     graphBounds = bounds.reduced(0,5);
 
-    maxDataPoints = graphBounds.getWidth();
+    maxDataPoints = juce::jmax(0, graphBounds.getWidth());
+
+    //Though the window cannot currently be resized, if it ever is able to be, the ring has to hold the wider graph
+    ensureRingCapacity(maxDataPoints);
+    scratch.resize((size_t)maxDataPoints + 2);
+
+    //Both images are the wrong size now
+    backgroundImage = juce::Image();
+    graphImage = juce::Image();
+}
+
+void RealTimeGraphVisualizer::frameCallback(){
+    //The clock only calls this while the visualizer is on screen
+    //The labels never change between frames, so only the graph area is repainted
+    repaint(graphBounds);
+}
+
+//Pushes a new point. Only this writes to the ring, so the count can be read, the point written, then the count published
+void RealTimeGraphVisualizer::pushData(float newDataPoint){
+    const std::uint64_t count = writeCount.load(std::memory_order_relaxed);
+    ring[(size_t)(count & ringMask)] = newDataPoint;
+    writeCount.store(count + 1, std::memory_order_release);
+}
 
-    //Though the window cannot currently be resized, if it ever is able to be, then excess data points must be able to be pruned
-    juce::ScopedLock lock(dataMutex);
-    while(dataQueue.size() > maxDataPoints){
-        dataQueue.pop_front();
+void RealTimeGraphVisualizer::readLatest(float* dest, int numPoints, std::uint64_t end) const{
+    const std::uint64_t start = end - (std::uint64_t)numPoints;
+    for(int i = 0; i < numPoints; i++){
+        dest[i] = ring[(size_t)((start + (std::uint64_t)i) & ringMask)];
     }
+}
 
+void RealTimeGraphVisualizer::ensureRingCapacity(int minimumPoints){
+    size_t capacity = 1;
+    while(capacity < (size_t)minimumPoints * 2){
+        capacity <<= 1;
+    }
+    if(capacity <= ring.size()){
+        return;
+    }
+
+    //Carry the points over so the graph doesn't go blank. This runs on the message thread, like the pushes in this plugin
+    std::vector<float> bigger(capacity, 0.0f);
+    const std::uint64_t end = writeCount.load(std::memory_order_acquire);
+    const int kept = (int)juce::jmin<std::uint64_t>(end, (std::uint64_t)ring.size());
+    for(int i = 0; i < kept; i++){
+        const std::uint64_t index = end - (std::uint64_t)kept + (std::uint64_t)i;
+        bigger[(size_t)(index & (capacity - 1))] = ring[(size_t)(index & ringMask)];
+    }
+    ring.swap(bigger);
+    ringMask = capacity - 1;
 }
 
-void RealTimeGraphVisualizer::timerCallback(){
-    //Only repaint if the visualizer is actually visible, otherwise don't since it'll introduce unneeded processing time
-    if(isShowing()){
-        repaint();
+//Redraws every visible point. Used after a resize, or when more points came in than the graph is wide
+void RealTimeGraphVisualizer::redrawGraphImage(){
+    const std::uint64_t end = writeCount.load(std::memory_order_acquire);
+    const int visible = (int)juce::jmin<std::uint64_t>(end, (std::uint64_t)maxDataPoints);
+
+    graphImage = juce::Image(juce::Image::ARGB, graphBounds.getWidth() * imageScale, graphBounds.getHeight() * imageScale, true);
+    drawnCount = end;
+    if(visible == 0){
+        return;
     }
+
+    readLatest(scratch.data(), visible, end);
+    juce::Graphics g(graphImage);
+    g.addTransform(juce::AffineTransform::scale((float)imageScale));
+    drawPoints(g, scratch.data(), 0, visible);
 }
 
-//This function is called from the audio thread to push new data in
-void RealTimeGraphVisualizer::pushData(float newDataPoint){
-    //Lock mutex to gain access
-    juce::ScopedLock lock(dataMutex);
+//Brings the graph image up to date. Points fill in from the left, and once the graph is full the image scrolls left one pixel per point.
+//Only the columns the new points touch are cleared and drawn
+void RealTimeGraphVisualizer::updateGraphImage(){
+    const std::uint64_t end = writeCount.load(std::memory_order_acquire);
+    const std::uint64_t newPoints = end - drawnCount;
 
-    //Add new data in the back of the queue
-    dataQueue.push_back(newDataPoint);
+    if(graphImage.isNull() || newPoints >= (std::uint64_t)maxDataPoints){
+        redrawGraphImage();
+        return;
+    }
+    if(newPoints == 0){
+        return;
+    }
+
+    const int added = (int)newPoints;
+    const int visibleBefore = (int)juce::jmin<std::uint64_t>(drawnCount, (std::uint64_t)maxDataPoints);
+    const int visibleNow = (int)juce::jmin<std::uint64_t>(end, (std::uint64_t)maxDataPoints);
+    const int shift = visibleBefore + added - visibleNow;
+    const int width = graphBounds.getWidth();
+    const int height = graphBounds.getHeight();
 
-    //Purge old data if the queue is now larger than graph width
-    while(dataQueue.size() > maxDataPoints){
-        dataQueue.pop_front();
+    //Scroll what's there to the left. The columns left behind on the right are cleared below, as new points go there
+    if(shift > 0){
+        graphImage.moveImageSection(0, 0, shift * imageScale, 0, (width - shift) * imageScale, height * imageScale);
     }
 
-    //Mutex is unlocked automatically when it goes out of scope
+    //The stroke is 2 pixels wide and antialiased, so it reaches into the column either side of a point.
+    //The area redrawn starts two columns before the first new point, and the line is drawn from two points before that,
+    //so inside the area the result is the same as drawing the whole graph
+    const int firstNew = visibleNow - added;
+    const int dirtyStart = juce::jmax(0, firstNew - 2);
+    const int dirtyEnd = juce::jmin(width, visibleNow + 2);
+    const int firstPoint = juce::jmax(0, dirtyStart - 2);
+    const int numPoints = visibleNow - firstPoint;
+
+    graphImage.clear({ dirtyStart * imageScale, 0, (dirtyEnd - dirtyStart) * imageScale, height * imageScale });
+
+    readLatest(scratch.data(), numPoints, end);
+    juce::Graphics g(graphImage);
+    g.addTransform(juce::AffineTransform::scale((float)imageScale));
+    g.reduceClipRegion(dirtyStart, 0, dirtyEnd - dirtyStart, height);
+    drawPoints(g, scratch.data(), firstPoint, numPoints);
+
+    drawnCount = end;
 }
 
 //This function is called from the message thread when the threshold's slider value has changed
@@ -168,59 +238,42 @@ void RealTimeGraphVisualizer::drawLabels(juce::Graphics& g){
 
 }
 
-//Graph drawing function. The function assumes that the dataMutex is already locked
-void RealTimeGraphVisualizer::drawGraph(juce::Graphics& g){
-    //If there is nothing to draw, do not draw
-    if(dataQueue.empty()){
+//Draws a run of points, one pixel apart, in graph image coordinates
+void RealTimeGraphVisualizer::drawPoints(juce::Graphics& g, const float* values, int firstColumn, int numPoints){
+    if(numPoints <= 0){
         return;
     }
 
     juce::Path graphPath;
     juce::Path fillPath;        // added underneath fillpath to graph -reyna
 
-    g.setColour(Colors::accent);
-
-    //Get graph dimensions
-
-    const float graphW = (float)graphBounds.getWidth();
     const float graphH = (float)graphBounds.getHeight();
-    const float graphX = (float)graphBounds.getX();
     const float graphY = (float)graphBounds.getY();
-    const float graphB = (float)graphBounds.getBottom();
-
-    //Get the first data point to start the path
-    float firstValue = dataQueue.front();
 
     //jmap maps a value from one range to another. The data value is mapped to the coordinate range
     //Please note that the pixel range is from bottom to top
-    float startY = mapValuetoY(firstValue);
+    float currentX = (float)firstColumn;
+    float startY = mapValuetoY(values[0]) - graphY;
 
-    //Start the path at the first data point at the left side of the graph
-    graphPath.startNewSubPath(graphX,startY);
-
-    fillPath.startNewSubPath(graphX, graphB);
-    fillPath.lineTo(graphX, startY);
-
-    //Calculate how many pixels wide each data point is
-    float stepX = graphW / (float)maxDataPoints;
-    float currentX = graphX + stepX;
+    graphPath.startNewSubPath(currentX,startY);
+    fillPath.startNewSubPath(currentX, graphH);
+    fillPath.lineTo(currentX, startY);
 
     //Add remaining points to the path
-    for(size_t i = 1; i < dataQueue.size(); i++){
-        float value = dataQueue[i];
-        float y = mapValuetoY(value);
+    for(int i = 1; i < numPoints; i++){
+        currentX += 1.0f;
+        float y = mapValuetoY(values[i]) - graphY;
         graphPath.lineTo(currentX,y);
         fillPath.lineTo(currentX, y);
-        currentX+=stepX;
     }
 
-    fillPath.lineTo(currentX - stepX, graphB);
+    fillPath.lineTo(currentX, graphH);
     fillPath.closeSubPath();
 
     // fill gradient under the line - reyna
     juce::ColourGradient grad(
-        Colors::accentPink.withAlpha(0.5f), graphBounds.getX(), graphBounds.getY(),
-        Colors::panel.withAlpha(0.5f), graphBounds.getX(), graphBounds.getBottom(),
+        Colors::accentPink.withAlpha(0.5f), 0.0f, 0.0f,
+        Colors::panel.withAlpha(0.5f), 0.0f, graphH,
         false
     );
 
@@ -285,27 +338,3 @@ float RealTimeGraphVisualizer::mapValuetoY(float value) const{
         return juce::jmap(value,start,end,graphB,graphY);
     }
 }
-
-//If the user changes the FPS in the settings, change it
-void RealTimeGraphVisualizer::parameterChanged(const juce::String& parameterID, float newValue){
-    if(parameterID == "GLOBAL_FRAMERATE"){
-        stopTimer();
-        switch((int)newValue){
-        case 1:
-            startTimerHz(5);
-            break;
-        case 2:
-            startTimerHz(15);
-            break;
-        case 3:
-            startTimerHz(30);
-            break;
-        case 4:
-            startTimerHz(60);
-            break;
-        default:
-            startTimerHz(30);
-            break;
-    }
-    }
-}
\ No newline at end of file
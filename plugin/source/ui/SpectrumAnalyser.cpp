@@ -0,0 +1,89 @@
+//Austin Hills
+
+#include "Pitchblade/ui/SpectrumAnalyser.h"
+
+SpectrumAnalyser::SpectrumAnalyser(AnalysisTap& analysisTap, int fftOrder, bool normaliseWindow)
+    : tap(analysisTap),
+        plan(StftPlan::get(fftOrder)),
+        fftSize(1 << fftOrder),
+        fft(fftOrder)
+{
+    //A normalised window is scaled so it adds up to its length
+    magnitudeScale = normaliseWindow ? (float)fftSize / plan->windowSum : 1.0f;
+    fftData.resize((size_t)fftSize * 2, 0.0f);
+    magnitudes.resize((size_t)getNumBins(), 0.0f);
+    decibels.resize((size_t)getNumBins(), -100.0f);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser(){
+    setListening(false);
+}
+
+void SpectrumAnalyser::setListening(bool shouldListen){
+    if(shouldListen == listening){
+        return;
+    }
+    listening = shouldListen;
+    if(listening){
+        tap.addReader();
+    }else{
+        tap.removeReader();
+    }
+}
+
+bool SpectrumAnalyser::process(std::vector<juce::Point<float>>& points){
+    //Nothing new since last time, so keep the old graph
+    const auto writeCount = tap.getWriteCount();
+    if(!listening || writeCount == lastWriteCount){
+        return false;
+    }
+
+    //Window the newest frame
+    if(!tap.readLatest(fftData.data(), fftSize)){
+        return false;
+    }
+    lastWriteCount = writeCount;
+    juce::FloatVectorOperations::multiply(fftData.data(), plan->window.data(), fftSize);
+
+    //Clear imaginary part
+    std::fill(fftData.data() + fftSize, fftData.data() + fftSize * 2, 0.0f);
+
+    //Perform forward FFT
+    fft.performRealOnlyForwardTransform(fftData.data());
+
+    //The output is (real, imag) pairs for bins 0 to fftSize / 2
+    const int numBins = getNumBins();
+    for(int i = 0; i < numBins; i++){
+        const float real = fftData[(size_t)i * 2];
+        const float imag = fftData[(size_t)i * 2 + 1];
+        magnitudes[(size_t)i] = std::sqrt(real * real + imag * imag) * magnitudeScale;
+    }
+
+    magnitudesToPoints(magnitudes.data(), points);
+    return true;
+}
+
+void SpectrumAnalyser::magnitudesToPoints(const float* binMagnitudes, std::vector<juce::Point<float>>& points){
+    const int numBins = getNumBins();
+    const float binWidth = (float)tap.getSampleRate() / (float)fftSize;
+
+    for(int i = 0; i < numBins; i++){
+        decibels[(size_t)i] = juce::Decibels::gainToDecibels(binMagnitudes[i], -100.0f);
+    }
+
+    //The graph was too spikey, so apply a moving average to make it more readable
+    //Only resizes the first time, after that the same points are reused
+    const int smoothingAmount = 3;
+    points.resize((size_t)numBins);
+    for(int i = 0; i < numBins; i++){
+        const int first = std::max(0, i - smoothingAmount);
+        const int last = std::min(numBins - 1, i + smoothingAmount);
+        float sum = 0.0f;
+        for(int j = first; j <= last; j++){
+            sum += decibels[(size_t)j];
+        }
+        //The first bin is DC, so it's put at the left edge of the graph
+        const float frequency = i == 0 ? 20.0f : (float)i * binWidth;
+        points[(size_t)i].setXY(frequency, sum / (float)(last - first + 1));
+    }
+}
@@ -4,6 +4,7 @@
 #include "Pitchblade/PluginProcessor.h"
 #include "Pitchblade/ui/ColorPalette.h"
 #include "Pitchblade/panels/EffectNode.h"
+#include "Pitchblade/ui/LoudnessReadout.h"
 
 VisualizerPanel::VisualizerPanel(AudioPluginAudioProcessor& proc, std::vector<std::shared_ptr<EffectNode>>& nodes)
                                                                         : processor(proc), effectNodes(nodes) {
@@ -49,38 +50,33 @@ void VisualizerPanel::showVisualizer(int index) {
 
 // clear all visualizer tabs
 void VisualizerPanel::clearVisualizer() {
-    tabs.clearTabs();
+    nodeTabs.clear();
 }
 
-// refresh visualizer tabs based on current effect nodes
+// sync visualizer tabs with current effect nodes, a visualizer is only made once its tab is shown
 void VisualizerPanel::refreshTabs() {
-    tabs.clearTabs();
-
 	// make a safe copy of effect nodes
     std::vector<std::shared_ptr<EffectNode>> safeNodes; {
         std::lock_guard<std::recursive_mutex> lock(processor.getMutex());
         safeNodes = effectNodes;                     // copy shared_ptrs, still safe references
     }
 
-	// each node creates its own visualizer 
-    for (auto& node : safeNodes) {
-        if (!node) {
-			continue;   // skip null nodes
-        }
+	// each node creates its own visualizer when first shown
+    nodeTabs.sync(safeNodes, [this](const std::shared_ptr<EffectNode>& node) -> std::unique_ptr<juce::Component> {
         //auto visualizer = node->createVisualizer(processor);
 		std::unique_ptr<juce::Component> visualizer;        // prepare pointer
         try {
 			visualizer = node->createVisualizer(processor); // may throw
         } catch (...) {
 			visualizer = nullptr;                           // on error, set to null
-        } if (visualizer) {
-            tabs.addTab(node->effectName, juce::Colours::black, visualizer.release(), true);    
-        } else {
+        } if (!visualizer) {
             // default placeholder , currently for formant and pitch 
-            auto* placeholder = new juce::Label({}, node->effectName + " Visualizer");
+            auto placeholder = std::make_unique<juce::Label>(juce::String(), node->effectName + " Visualizer");
             placeholder->setJustificationType(juce::Justification::centred);
             placeholder->setFont(juce::Font(18.0f));
-            tabs.addTab(node->effectName, juce::Colours::black, placeholder, true);
+            visualizer = std::move(placeholder);
         }
-    }
-}
\ No newline at end of file
+        // loudness readings for any meters attached to the node go under the visualizer - Austin
+        return std::make_unique<LoudnessReadout>(node, std::move(visualizer));
+        });
+}
@@ -0,0 +1,77 @@
+//Austin
+
+#include <gtest/gtest.h>
+#include <JuceHeader.h>
+#include "Pitchblade/effects/AnalysisTap.h"
+#include "Pitchblade/effects/DeEsserProcessor.h"
+
+//The reader should get the newest samples back in the order they were written, even after the ring has wrapped
+TEST(AnalysisTapTest, ReadLatestReturnsNewestSamplesInOrder) {
+    AnalysisTap tap(64);
+    tap.prepare(44100.0);
+
+    std::vector<float> block(10);
+    float counter = 0.0f;
+    for(int b = 0; b < 20; b++){
+        for(auto& sample : block){
+            sample = counter++;
+        }
+        tap.push(block.data(), (int)block.size());
+    }
+
+    std::vector<float> latest(32);
+    ASSERT_TRUE(tap.readLatest(latest.data(), (int)latest.size()));
+    for(int i = 0; i < (int)latest.size(); i++){
+        ASSERT_FLOAT_EQ(latest[i], counter - (float)latest.size() + (float)i);
+    }
+}
+
+//Asking for more than has been written, or more than the ring holds, should fail instead of returning junk
+TEST(AnalysisTapTest, ReadLatestFailsWithoutEnoughData) {
+    AnalysisTap tap(64);
+    tap.prepare(44100.0);
+
+    std::vector<float> block(16, 1.0f);
+    tap.push(block.data(), (int)block.size());
+
+    std::vector<float> latest(128);
+    ASSERT_FALSE(tap.readLatest(latest.data(), 32));
+    ASSERT_FALSE(tap.readLatest(latest.data(), 128));
+    ASSERT_TRUE(tap.readLatest(latest.data(), 16));
+}
+
+//The snapshot tap should hand back the newest frame, and only report it as new once
+TEST(AnalysisTapTest, SnapshotTapKeepsNewestFrame) {
+    SnapshotTap tap(4);
+    std::vector<float> frame(4);
+    std::vector<float> result(4);
+
+    for(int f = 1; f <= 3; f++){
+        std::fill(frame.begin(), frame.end(), (float)f);
+        tap.publish(frame.data());
+    }
+
+    ASSERT_TRUE(tap.pull(result.data()));
+    ASSERT_FLOAT_EQ(result[0], 3.0f);
+    ASSERT_FLOAT_EQ(result[3], 3.0f);
+
+    //Nothing new, but the last frame is still there
+    ASSERT_FALSE(tap.pull(result.data()));
+    ASSERT_FLOAT_EQ(result[0], 3.0f);
+}
+
+//With no visualizer reading, the de-esser shouldn't copy anything out for display
+TEST(AnalysisTapTest, ProcessorOnlyFeedsTapWhileSomeoneIsReading) {
+    DeEsserProcessor processor;
+    processor.prepare(44100.0, 512);
+    juce::AudioBuffer<float> buffer(2, 512);
+    buffer.clear();
+
+    processor.process(buffer);
+    ASSERT_EQ(processor.getAnalysisTap().getWriteCount(), (std::uint64_t)0);
+
+    processor.getAnalysisTap().addReader();
+    processor.process(buffer);
+    ASSERT_EQ(processor.getAnalysisTap().getWriteCount(), (std::uint64_t)512);
+    processor.getAnalysisTap().removeReader();
+}
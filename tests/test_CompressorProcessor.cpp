@@ -114,4 +114,33 @@ TEST_F(CompressorProcessorTest, ReleaseTime){
     simulateConstantSignal(buffer, 50.0f, juce::Decibels::decibelsToGain(-40.0f));
 
     ASSERT_NEAR(buffer.getSample(0, 100),juce::Decibels::decibelsToGain(-40.0f),0.001f);
-}
\ No newline at end of file
+}
+
+//Lookahead lets the limiter catch a sudden jump before it gets through
+TEST_F(CompressorProcessorTest, LookaheadLimiterCatchesTransient){
+
+    juce::AudioBuffer<float> buffer(1, 512);
+
+    processor->prepare(44100);
+
+    processor->setThreshold(-20.0f);
+    processor->setRatio(2000.0f);
+    processor->setAttack(5.0f);
+    processor->setRelease(100.0f);
+    processor->setLookahead(5.0f);
+
+    //The delay should be reported so the host can compensate
+    ASSERT_EQ(processor->getLatencySamples(), (int)std::round(0.005 * 44100));
+
+    simulateConstantSignal(buffer, 200.0f, juce::Decibels::decibelsToGain(-40.0f));
+
+    //Jump up by 34 dB and check that nothing gets far past the threshold
+    float peak = 0.0f;
+    for(int i = 0; i < blocksForMS(100.0f); i++){
+        juce::FloatVectorOperations::fill(buffer.getWritePointer(0), juce::Decibels::decibelsToGain(-6.0f), buffer.getNumSamples());
+        processor->process(buffer);
+        peak = std::max(peak, buffer.getMagnitude(0, 0, buffer.getNumSamples()));
+    }
+
+    ASSERT_LT(juce::Decibels::gainToDecibels(peak), -19.0f);
+}
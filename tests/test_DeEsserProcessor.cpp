@@ -144,4 +144,69 @@ TEST_F(DeEsserProcessorTest, ReleaseTime) {
     simulateSineSignal(buffer, 50.0f, 6000.0f, juce::Decibels::decibelsToGain(-40.0f));
 
     ASSERT_NEAR(buffer.getMagnitude(0, samplesPerBlock),juce::Decibels::decibelsToGain(-40.0f),0.001f);
-}
\ No newline at end of file
+}
+
+//Split-band mode should still pull a sibilant tone down by the full amount
+TEST_F(DeEsserProcessorTest, SplitBandReducesSibilantTone) {
+    juce::AudioBuffer<float> buffer(1, samplesPerBlock);
+
+    processor->prepare(sampleRate, samplesPerBlock);
+
+    processor->setThreshold(-20.0f);
+    processor->setRatio(4.0f);
+    processor->setAttack(10.0f);
+    processor->setRelease(10.0f);
+    processor->setFrequency(6000.0f);
+    processor->setSplitBand(true);
+
+    simulateSineSignal(buffer, 500.0f, 6000.0f, juce::Decibels::decibelsToGain(-12.0f));
+
+    ASSERT_NEAR(buffer.getMagnitude(0, samplesPerBlock), juce::Decibels::decibelsToGain(-18.0f), 0.05f);
+}
+
+//While an "s" is being turned down, the low part of the voice underneath it should be left alone in split-band mode
+//Wideband mode turns the low part down too, which is the dulling split-band mode is meant to fix
+TEST_F(DeEsserProcessorTest, SplitBandLeavesLowFrequenciesAlone) {
+    const float amplitude = juce::Decibels::decibelsToGain(-12.0f);
+
+    //Runs a 300 Hz + 6 kHz mix and returns how much of the 300 Hz tone is left in the last block
+    auto lowToneLevel = [&](bool splitBand) {
+        processor->prepare(sampleRate, samplesPerBlock);
+        processor->setThreshold(-20.0f);
+        processor->setRatio(4.0f);
+        processor->setAttack(10.0f);
+        processor->setRelease(10.0f);
+        processor->setFrequency(6000.0f);
+        processor->setSplitBand(splitBand);
+
+        juce::AudioBuffer<float> buffer(1, samplesPerBlock);
+        const double lowIncrement = juce::MathConstants<double>::twoPi * 300.0 / sampleRate;
+        const double highIncrement = juce::MathConstants<double>::twoPi * 6000.0 / sampleRate;
+        int n = 0;
+        double re = 0.0, im = 0.0;
+
+        for (int block = 0; block < blocksForMS(500.0f); block++) {
+            for (int i = 0; i < samplesPerBlock; i++, n++) {
+                const float sample = amplitude * (float)(std::sin(lowIncrement * n) + std::sin(highIncrement * n));
+                buffer.getWritePointer(0)[i] = sample;
+            }
+            processor->process(buffer);
+
+            //Correlate the last block against the 300 Hz tone to find its level
+            re = 0.0;
+            im = 0.0;
+            for (int i = 0; i < samplesPerBlock; i++) {
+                const int index = n - samplesPerBlock + i;
+                re += buffer.getSample(0, i) * std::cos(lowIncrement * index);
+                im += buffer.getSample(0, i) * std::sin(lowIncrement * index);
+            }
+        }
+        return (float)(2.0 * std::sqrt(re * re + im * im) / samplesPerBlock);
+    };
+
+    const float splitLevel = lowToneLevel(true);
+    const float widebandLevel = lowToneLevel(false);
+
+    ASSERT_NEAR(juce::Decibels::gainToDecibels(splitLevel), -12.0f, 0.5f);
+    ASSERT_LT(juce::Decibels::gainToDecibels(widebandLevel), -14.0f);
+}
@@ -113,4 +113,199 @@ TEST_F(DeNoiserProcessorTest, ReLearnProfile) {
     simulateSineSignal(buffer, 500.0f, 1000, juce::Decibels::decibelsToGain(-40.0f));
 
     ASSERT_NEAR(buffer.getMagnitude(0, samplesPerBlock), juce::Decibels::decibelsToGain(-40.0f), 0.001f);
-}
\ No newline at end of file
+}
+
+//A tone well above the learned noise should come through at close to its original level, while the noise around it is turned down
+TEST_F(DeNoiserProcessorTest, ToneAboveNoiseIsKept) {
+    juce::AudioBuffer<float> buffer(1, samplesPerBlock);
+    juce::Random random(1234);
+    const float noiseAmplitude = juce::Decibels::decibelsToGain(-50.0f);
+    const float toneAmplitude = juce::Decibels::decibelsToGain(-12.0f);
+
+    processor->prepare(sampleRate);
+
+    //Learn plain white noise
+    processor->setLearning(true);
+    for(int b = 0; b < blocksForMS(500.0f); b++){
+        for(int i = 0; i < samplesPerBlock; i++){
+            buffer.getWritePointer(0)[i] = noiseAmplitude * (random.nextFloat() * 2.0f - 1.0f);
+        }
+        processor->process(buffer);
+    }
+    processor->setLearning(false);
+    processor->setReduction(0.5f);
+
+    //Noise on its own should be pulled way down
+    float noiseRms = 0.0f;
+    for(int b = 0; b < blocksForMS(500.0f); b++){
+        for(int i = 0; i < samplesPerBlock; i++){
+            buffer.getWritePointer(0)[i] = noiseAmplitude * (random.nextFloat() * 2.0f - 1.0f);
+        }
+        processor->process(buffer);
+        noiseRms = buffer.getRMSLevel(0, 0, samplesPerBlock);
+    }
+    ASSERT_LT(juce::Decibels::gainToDecibels(noiseRms), -70.0f);
+
+    //The tone with the same noise under it should keep its level
+    for(int b = 0; b < blocksForMS(500.0f); b++){
+        auto sineData = makeSineFrame(1000.0f, samplesPerBlock);
+        for(int i = 0; i < samplesPerBlock; i++){
+            buffer.getWritePointer(0)[i] = toneAmplitude * sineData[i] + noiseAmplitude * (random.nextFloat() * 2.0f - 1.0f);
+        }
+        processor->process(buffer);
+    }
+    ASSERT_NEAR(juce::Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, samplesPerBlock) * std::sqrt(2.0f)), -12.0f, 1.0f);
+}
+
+//Each channel should come out as its own signal. A tone only on the left should stay on the left, with silence on the right
+TEST_F(DeNoiserProcessorTest, StereoChannelsStaySeparate) {
+    juce::AudioBuffer<float> buffer(2, samplesPerBlock);
+    const float toneAmplitude = juce::Decibels::decibelsToGain(-12.0f);
+
+    processor->prepare(sampleRate, 2);
+    processor->setLearning(false);
+    processor->setReduction(0.5f);
+
+    for(int b = 0; b < blocksForMS(500.0f); b++){
+        auto sineData = makeSineFrame(1000.0f, samplesPerBlock);
+        for(int i = 0; i < samplesPerBlock; i++){
+            buffer.setSample(0, i, toneAmplitude * sineData[i]);
+            buffer.setSample(1, i, 0.0f);
+        }
+        processor->process(buffer);
+    }
+    ASSERT_NEAR(juce::Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, samplesPerBlock) * std::sqrt(2.0f)), -12.0f, 1.0f);
+    ASSERT_LT(buffer.getMagnitude(1, 0, samplesPerBlock), 1.0e-6f);
+}
+
+//With adaptive on, the profile should follow the noise floor when it gets louder after learning
+TEST_F(DeNoiserProcessorTest, AdaptiveFollowsRisingNoiseFloor) {
+    juce::AudioBuffer<float> buffer(1, samplesPerBlock);
+    juce::Random random(99);
+
+    auto runNoise = [&](float amplitudeDb, float durationMs){
+        const float amplitude = juce::Decibels::decibelsToGain(amplitudeDb);
+        float rms = 0.0f;
+        for(int b = 0; b < blocksForMS(durationMs); b++){
+            for(int i = 0; i < samplesPerBlock; i++){
+                buffer.getWritePointer(0)[i] = amplitude * (random.nextFloat() * 2.0f - 1.0f);
+            }
+            processor->process(buffer);
+            rms = buffer.getRMSLevel(0, 0, samplesPerBlock);
+        }
+        return juce::Decibels::gainToDecibels(rms);
+    };
+
+    processor->prepare(sampleRate);
+    processor->setReduction(0.5f);
+
+    //Learn a quiet floor
+    processor->setLearning(true);
+    runNoise(-50.0f, 500.0f);
+    processor->setLearning(false);
+
+    //Without tracking, noise 20 dB louder than the learned profile mostly gets through
+    ASSERT_GT(runNoise(-30.0f, 2000.0f), -45.0f);
+
+    //With tracking, the profile catches up and the louder noise is pulled down as well
+    processor->setAdaptive(true);
+    ASSERT_LT(runNoise(-30.0f, 6000.0f), -50.0f);
+}
+
+//Adaptive mode should find the noise without ever learning, and leave a tone on top of it alone
+TEST_F(DeNoiserProcessorTest, AdaptiveWorksWithoutLearning) {
+    juce::AudioBuffer<float> buffer(1, samplesPerBlock);
+    juce::Random random(7);
+    const float noiseAmplitude = juce::Decibels::decibelsToGain(-50.0f);
+    const float toneAmplitude = juce::Decibels::decibelsToGain(-12.0f);
+
+    processor->prepare(sampleRate);
+    processor->setAdaptive(true);
+    processor->setReduction(0.5f);
+
+    //Noise on its own
+    float noiseRms = 0.0f;
+    for(int b = 0; b < blocksForMS(3000.0f); b++){
+        for(int i = 0; i < samplesPerBlock; i++){
+            buffer.getWritePointer(0)[i] = noiseAmplitude * (random.nextFloat() * 2.0f - 1.0f);
+        }
+        processor->process(buffer);
+        noiseRms = buffer.getRMSLevel(0, 0, samplesPerBlock);
+    }
+    ASSERT_LT(juce::Decibels::gainToDecibels(noiseRms), -65.0f);
+
+    //Tone bursts over the noise, about the length of syllables, should keep their level
+    //(a tone held for several seconds would slowly be treated as part of the noise floor, which is the point of tracking)
+    const int burstBlocks = blocksForMS(250.0f);
+    for(int b = 0; b < burstBlocks * 7; b++){
+        const bool toneOn = (b / burstBlocks) % 2 == 0;
+        auto sineData = makeSineFrame(1000.0f, samplesPerBlock);
+        for(int i = 0; i < samplesPerBlock; i++){
+            const float tone = toneOn ? toneAmplitude * sineData[i] : 0.0f;
+            buffer.getWritePointer(0)[i] = tone + noiseAmplitude * (random.nextFloat() * 2.0f - 1.0f);
+        }
+        processor->process(buffer);
+    }
+    ASSERT_NEAR(juce::Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, samplesPerBlock) * std::sqrt(2.0f)), -12.0f, 1.0f);
+}
+
+//Each mode should delay the audio by exactly the latency it reports, and the reported latency should match the mode's FFT size
+TEST_F(DeNoiserProcessorTest, ModesReportTheirLatency) {
+    const std::array<int, DeNoiserProcessor::numModes> expectedSizes { 512, 2048, 4096 };
+
+    for(int m = 0; m < DeNoiserProcessor::numModes; m++){
+        processor->prepare(sampleRate, 1);
+        processor->setFFTMode((DeNoiserProcessor::FFTMode)m);
+        processor->setReduction(0.0f);
+        ASSERT_EQ(processor->getLatencySamples(), expectedSizes[(size_t)m]);
+
+        //Send a click through and find where it comes out
+        juce::AudioBuffer<float> buffer(1, samplesPerBlock);
+        int peakPosition = -1;
+        float peak = 0.0f;
+        for(int b = 0; b < 16; b++){
+            buffer.clear();
+            if(b == 1){
+                buffer.setSample(0, 100, 1.0f);
+            }
+            processor->process(buffer);
+            for(int i = 0; i < samplesPerBlock; i++){
+                if(std::abs(buffer.getSample(0, i)) > peak){
+                    peak = std::abs(buffer.getSample(0, i));
+                    peakPosition = b * samplesPerBlock + i;
+                }
+            }
+        }
+        ASSERT_EQ(peakPosition - (samplesPerBlock + 100), processor->getLatencySamples());
+    }
+}
+
+//A learned profile should still work after switching to a different FFT size
+TEST_F(DeNoiserProcessorTest, LearnedProfileSurvivesModeChange) {
+    juce::AudioBuffer<float> buffer(1, samplesPerBlock);
+    juce::Random random(42);
+    const float noiseAmplitude = juce::Decibels::decibelsToGain(-50.0f);
+
+    auto runNoise = [&](float durationMs){
+        float rms = 0.0f;
+        for(int b = 0; b < blocksForMS(durationMs); b++){
+            for(int i = 0; i < samplesPerBlock; i++){
+                buffer.getWritePointer(0)[i] = noiseAmplitude * (random.nextFloat() * 2.0f - 1.0f);
+            }
+            processor->process(buffer);
+            rms = buffer.getRMSLevel(0, 0, samplesPerBlock);
+        }
+        return juce::Decibels::gainToDecibels(rms);
+    };
+
+    processor->prepare(sampleRate);
+    processor->setReduction(0.5f);
+    processor->setLearning(true);
+    runNoise(500.0f);
+    processor->setLearning(false);
+
+    for(auto mode : { DeNoiserProcessor::FFTMode::lowLatency, DeNoiserProcessor::FFTMode::highResolution, DeNoiserProcessor::FFTMode::balanced }){
+        processor->setFFTMode(mode);
+        ASSERT_LT(runNoise(1000.0f), -70.0f);
+    }
+}
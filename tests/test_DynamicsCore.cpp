@@ -0,0 +1,104 @@
+//Austin
+
+#include <gtest/gtest.h>
+#include <JuceHeader.h>
+#include "Pitchblade/effects/DynamicsCore.h"
+
+using namespace DynamicsCore;
+
+//The fast dB conversions should stay within a tiny error of the JUCE versions across the whole range we use
+TEST(DynamicsCoreTest, FastDecibelConversionsAreAccurate) {
+    for(float db = -99.0f; db <= 24.0f; db += 0.25f){
+        float gain = juce::Decibels::decibelsToGain(db);
+
+        ASSERT_NEAR(fastGainToDecibels(gain), db, 0.001f);
+        ASSERT_NEAR(fastDecibelsToGain(db) / gain, 1.0f, 0.0001f);
+    }
+
+    //Unity gain should stay exactly unity so signals below the threshold aren't touched
+    ASSERT_FLOAT_EQ(fastDecibelsToGain(0.0f), 1.0f);
+}
+
+//Silence should hit the floor value just like juce::Decibels::gainToDecibels
+TEST(DynamicsCoreTest, FastGainToDecibelsFloor) {
+    ASSERT_FLOAT_EQ(fastGainToDecibels(0.0f), -100.0f);
+    ASSERT_FLOAT_EQ(fastGainToDecibels(0.000001f), -100.0f);
+}
+
+//The soft knee should match the hard knee outside of the knee and ease in within it
+TEST(DynamicsCoreTest, SoftKneeEasesIntoCompression) {
+    HardKnee hard;
+    SoftKnee soft;
+    soft.widthDb = 6.0f;
+
+    ASSERT_FLOAT_EQ(soft.overshoot(-10.0f), hard.overshoot(-10.0f));
+    ASSERT_FLOAT_EQ(soft.overshoot(10.0f), hard.overshoot(10.0f));
+
+    //At the threshold itself the soft knee is already compressing a little
+    ASSERT_GT(soft.overshoot(0.0f), 0.0f);
+    ASSERT_LT(soft.overshoot(0.0f), soft.overshoot(3.0f));
+}
+
+//The RMS detector should settle at the RMS of a constant signal, and the kernel should compress based on it
+TEST(DynamicsCoreTest, RmsKernelCompressesConstantSignal) {
+    DynamicsKernel<RmsDetector, CompressorComputer<HardKnee>> kernel;
+    kernel.detector.setWindow(10.0f, 44100.0);
+    kernel.computer.thresholdDB = -20.0f;
+    kernel.computer.ratio = 4.0f;
+    kernel.computer.ballistics.attackCoeff = std::exp(-1.0f / (0.001f * 10.0f * 44100.0f));
+    kernel.computer.ballistics.releaseCoeff = kernel.computer.ballistics.attackCoeff;
+
+    juce::AudioBuffer<float> buffer(2, 512);
+    for(int i = 0; i < 200; i++){
+        for(int channel = 0; channel < buffer.getNumChannels(); ++channel){
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(channel), juce::Decibels::decibelsToGain(-12.0f), buffer.getNumSamples());
+        }
+        kernel.process(buffer);
+    }
+
+    //8 dB over the threshold at 4:1 should come out 2 dB over
+    ASSERT_NEAR(buffer.getSample(0, 511), juce::Decibels::decibelsToGain(-18.0f), 0.002f);
+    ASSERT_FLOAT_EQ(buffer.getSample(0, 511), buffer.getSample(1, 511));
+}
+
+//The sliding window max should match a brute force search over the same window
+TEST(DynamicsCoreTest, SlidingWindowMaxMatchesBruteForce) {
+    const int windowSize = 37;
+    SlidingWindowMax windowMax;
+    windowMax.prepare(windowSize);
+    windowMax.setWindowSize(windowSize);
+
+    juce::Random random(1234);
+    std::vector<float> input(2000);
+    for(auto& sample : input){
+        sample = random.nextFloat();
+    }
+
+    for(int i = 0; i < (int)input.size(); i++){
+        float expected = 0.0f;
+        for(int j = std::max(0, i - windowSize + 1); j <= i; j++){
+            expected = std::max(expected, input[j]);
+        }
+        ASSERT_FLOAT_EQ(windowMax.process(input[i]), expected);
+    }
+}
+
+//The delay line should push the audio back by exactly the requested number of samples, even across blocks
+TEST(DynamicsCoreTest, LookaheadDelayShiftsAudio) {
+    LookaheadDelay delay;
+    delay.prepare(100, 1);
+    delay.setDelay(10);
+
+    std::vector<float> block(64);
+    for(int n = 0; n < 4; n++){
+        for(int i = 0; i < 64; i++){
+            block[i] = (float)(n * 64 + i);
+        }
+        float* channels[] = { block.data() };
+        delay.process(channels, 1, 64);
+
+        for(int i = 0; i < 64; i++){
+            ASSERT_FLOAT_EQ(block[i], std::max(0.0f, (float)(n * 64 + i - 10)));
+        }
+    }
+}
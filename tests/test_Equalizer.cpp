@@ -2,7 +2,11 @@
 #include <gtest/gtest.h>
 #include <JuceHeader.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <complex>
+#include <thread>
+#include <vector>
 
 #include "Pitchblade/effects/Equalizer.h"
 
@@ -274,4 +278,167 @@ TEST_F(EqualizerTest, TC_75_ExtraChannelsAreCleared)
         EXPECT_FLOAT_EQ(buffer.getSample(2, sample), 0.0f);
         EXPECT_FLOAT_EQ(buffer.getSample(3, sample), 0.0f);
     }
-}
\ No newline at end of file
+}
+
+// The allocation free designs should hit the requested gain where each shape is defined
+TEST_F(EqualizerTest, BiquadDesignHitsRequestedGain)
+{
+    auto magnitudeAt = [this] (const BiquadCoefficients& c, double frequency)
+    {
+        const std::complex<double> z = std::polar(1.0, -2.0 * juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto num = (double)c.b0 + (double)c.b1 * z + (double)c.b2 * z * z;
+        const auto den = 1.0 + (double)c.a1 * z + (double)c.a2 * z * z;
+        return (float)std::abs(num / den);
+    };
+
+    const float gain = juce::Decibels::decibelsToGain(9.0f);
+    EXPECT_NEAR(magnitudeAt(BiquadCoefficients::peak(sampleRate, 1000.0f, 1.0f, gain), 1000.0), gain, 1e-3f);
+    EXPECT_NEAR(magnitudeAt(BiquadCoefficients::lowShelf(sampleRate, 200.0f, 1.0f, gain), 0.0), gain, 1e-3f);
+    EXPECT_NEAR(magnitudeAt(BiquadCoefficients::highShelf(sampleRate, 4000.0f, 1.0f, gain), sampleRate * 0.5), gain, 1e-3f);
+    EXPECT_NEAR(magnitudeAt(BiquadCoefficients::peak(sampleRate, 1000.0f, 1.0f, gain), 50.0), 1.0f, 0.05f);
+}
+
+// The drawing shortcut has to agree with the filters, down at the bottom of the range too
+TEST_F(EqualizerTest, MagnitudeCurveMatchesDirectEvaluation)
+{
+    const std::vector<BiquadCoefficients> filters {
+        BiquadCoefficients::lowShelf(sampleRate, 40.0f, 1.0f, juce::Decibels::decibelsToGain(12.0f)),
+        BiquadCoefficients::peak(sampleRate, 1000.0f, 1.0f, juce::Decibels::decibelsToGain(-9.0f)),
+        BiquadCoefficients::highShelf(sampleRate, 8000.0f, 1.0f, juce::Decibels::decibelsToGain(6.0f)),
+        BiquadCoefficients::highPass(sampleRate, 30.0f, 0.707f),
+        BiquadCoefficients::notch(sampleRate, 3000.0f, 4.0f)
+    };
+    const std::vector<double> frequencies { 20.0, 35.0, 60.0, 200.0, 999.0, 2900.0, 7000.0, 15000.0, 20000.0 };
+
+    for (const auto& c : filters)
+    {
+        std::vector<float> phi, magnitudeSquared(frequencies.size(), 1.0f);
+        for (double f : frequencies)
+            phi.push_back((float)std::pow(std::sin(juce::MathConstants<double>::pi * f / sampleRate), 2.0));
+
+        c.multiplyMagnitudeSquared(phi.data(), magnitudeSquared.data(), (int)frequencies.size());
+
+        for (size_t i = 0; i < frequencies.size(); ++i)
+        {
+            const float expectedDb = juce::Decibels::gainToDecibels(c.magnitudeAt(frequencies[i], sampleRate), -60.0f);
+            const float curveDb = juce::Decibels::gainToDecibels(std::sqrt(magnitudeSquared[i]), -60.0f);
+            EXPECT_NEAR(curveDb, expectedDb, 0.05f);
+        }
+    }
+}
+
+// With the knobs still, the output shouldn't depend on how the host splits the audio into blocks
+TEST_F(EqualizerTest, StaticSettingsIgnoreBlockSize)
+{
+    Equalizer other;
+    for (auto* e : { &eq, &other })
+    {
+        e->setLowGainDb(4.0f);
+        e->setMidGainDb(-6.0f);
+        e->setHighGainDb(3.0f);
+        e->prepare(sampleRate, blockSize, numChannels);
+    }
+
+    auto input = makeSineBuffer(0.3f, 700.0);
+    juce::AudioBuffer<float> whole(input);
+    eq.processBlock(whole);
+
+    juce::AudioBuffer<float> first(numChannels, 100), second(numChannels, blockSize - 100);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        for (int i = 0; i < 100; ++i)
+            first.setSample(ch, i, input.getSample(ch, i));
+        for (int i = 100; i < blockSize; ++i)
+            second.setSample(ch, i - 100, input.getSample(ch, i));
+    }
+    other.processBlock(first);
+    other.processBlock(second);
+
+    for (int i = 0; i < blockSize; ++i)
+    {
+        const float split = i < 100 ? first.getSample(0, i) : second.getSample(0, i - 100);
+        ASSERT_NEAR(whole.getSample(0, i), split, 1e-6f);
+    }
+}
+
+// Linear phase should be a symmetric impulse response centred on the reported latency
+TEST_F(EqualizerTest, LinearPhaseIsSymmetricAroundLatency)
+{
+    eq.setLowGainDb(4.0f);
+    eq.setMidGainDb(9.0f);
+    eq.setHighGainDb(-6.0f);
+    eq.prepare(sampleRate, blockSize, numChannels);
+    eq.setLinearPhase(true);
+
+    const int latency = eq.getLatencySamples();
+    ASSERT_GT(latency, 0);
+
+    std::vector<float> response;
+    for (int b = 0; (int)response.size() < latency * 2 + blockSize; ++b)
+    {
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        buffer.clear();
+        if (b == 0)
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.setSample(ch, 0, 1.0f);
+        eq.processBlock(buffer);
+        for (int i = 0; i < blockSize; ++i)
+            response.push_back(buffer.getSample(0, i));
+    }
+
+    const auto peak = std::max_element(response.begin(), response.end(),
+                                       [](float a, float b) { return std::abs(a) < std::abs(b); });
+    EXPECT_EQ((int)(peak - response.begin()), latency);
+
+    for (int m = 1; m < latency / 2; ++m)
+        ASSERT_NEAR(response[(size_t)(latency - m)], response[(size_t)(latency + m)], 1.0e-5f);
+
+    eq.setLinearPhase(false);
+    EXPECT_EQ(eq.getLatencySamples(), 0);
+}
+
+// Same boost as the normal filters, and it follows the knobs once the background kernel is rebuilt
+TEST_F(EqualizerTest, LinearPhaseMatchesFiltersAndFollowsKnobs)
+{
+    // 937.5 Hz fits exactly 5 cycles in a block, so the block level doesn't depend on the delay
+    const double frequency = sampleRate / blockSize * 5.0;
+    auto levelAfter = [this, frequency](int blocks)
+    {
+        auto input = makeSineBuffer(0.25f, frequency);
+        float level = 0.0f;
+        for (int b = 0; b < blocks; ++b)
+        {
+            juce::AudioBuffer<float> temp(input);
+            eq.processBlock(temp);
+            level = rms(temp);
+        }
+        return juce::Decibels::gainToDecibels(level / rms(input));
+    };
+
+    eq.setMidFreq(1000.0f);
+    eq.setMidGainDb(-6.0f);
+    eq.prepare(sampleRate, blockSize, numChannels);
+    const float cutWithFilters = levelAfter(40);
+    eq.setMidGainDb(6.0f);
+    const float boostWithFilters = levelAfter(40);
+
+    // The kernel is rebuilt in the background, so give it a moment to arrive
+    auto settledLevel = [&levelAfter](float expected)
+    {
+        float level = 0.0f;
+        for (int attempt = 0; attempt < 100; ++attempt)
+        {
+            level = levelAfter(20);
+            if (std::abs(level - expected) < 0.1f)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return level;
+    };
+
+    eq.setLinearPhase(true);
+    EXPECT_NEAR(settledLevel(boostWithFilters), boostWithFilters, 0.1f);
+
+    eq.setMidGainDb(-6.0f);
+    EXPECT_NEAR(settledLevel(cutWithFilters), cutWithFilters, 0.1f);
+}
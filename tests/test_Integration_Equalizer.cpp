@@ -17,6 +17,14 @@ static std::shared_ptr<EffectNode> findNode(AudioPluginAudioProcessor& processor
     return {};
 }
 
+// Helper: the Equalizer node's own EQ
+static Equalizer& nodeEqualizer(AudioPluginAudioProcessor& processor)
+{
+    auto node = std::dynamic_pointer_cast<EqualizerNode>(findNode(processor, "Equalizer"));
+    EXPECT_TRUE(node != nullptr);
+    return node->getEqualizer();
+}
+
 //RMS helper for buffers.
 static float computeRms(const juce::AudioBuffer<float>& buffer)
 {
@@ -94,7 +102,7 @@ TEST_F(EqualizerIntegrationTest, TC_95_EqualizerMidBoostRaisesRms)
     insertEqualizerNode();
 
     // Configure EQ
-    auto& eq = processor.getEqualizer();
+    auto& eq = nodeEqualizer(processor);
     eq.setMidFreq(1000.0f);
     eq.setMidGainDb(6.0f);
     eq.setLowGainDb(0.0f);
@@ -132,13 +140,13 @@ TEST_F(EqualizerIntegrationTest, TC_96_EqualizerPanelLowBandUpdatesDsp)
     EqualizerPanel panel(processor, state, "Equalizer");
     panel.setSize(400, 200);
 
-    // Drive parameters via ValueTree; listener will push to DSP.
+    // Drive parameters via ValueTree; the node's listener will push to DSP.
     state.setProperty("LowFreq", 120.0f, nullptr);
     state.setProperty("LowGain", 6.0f, nullptr);
 
     // Read back DSP values.
-    const float fLow = processor.getEqualizer().getLowFreq();
-    const float gLow = processor.getEqualizer().getLowGainDb();
+    const float fLow = nodeEqualizer(processor).getLowFreq();
+    const float gLow = nodeEqualizer(processor).getLowGainDb();
 
     EXPECT_NEAR(fLow, 120.0f, 1.0f);
     EXPECT_NEAR(gLow, 6.0f, 0.25f);
@@ -147,8 +155,10 @@ TEST_F(EqualizerIntegrationTest, TC_96_EqualizerPanelLowBandUpdatesDsp)
 // ======= TC-97 =========
 TEST_F(EqualizerIntegrationTest, TC_97_VisualizerResponseReflectsEqSettings)
 {
+    insertEqualizerNode();
+
     // Configure EQ with a low boost, flat mid, high cut.
-    auto& eq = processor.getEqualizer();
+    auto& eq = nodeEqualizer(processor);
     eq.setLowFreq(100.0f);
     eq.setLowGainDb(6.0f);
     eq.setMidFreq(1000.0f);
@@ -156,7 +166,7 @@ TEST_F(EqualizerIntegrationTest, TC_97_VisualizerResponseReflectsEqSettings)
     eq.setHighFreq(8000.0f);
     eq.setHighGainDb(-6.0f);
 
-    EqualizerVisualizer viz(processor);
+    EqualizerVisualizer viz(processor, eq);
     viz.setSize(400, 200);
 
     // Force one update of the response curve.
@@ -194,7 +204,7 @@ TEST_F(EqualizerIntegrationTest, TC_97_VisualizerResponseReflectsEqSettings)
 TEST_F(EqualizerIntegrationTest, TC_98_UnityGainBehavesAsBypass)
 {
     insertEqualizerNode();
-    auto& eq = processor.getEqualizer();
+    auto& eq = nodeEqualizer(processor);
     eq.setLowGainDb(0.0f);
     eq.setMidGainDb(0.0f);
     eq.setHighGainDb(0.0f);
@@ -208,4 +218,88 @@ TEST_F(EqualizerIntegrationTest, TC_98_UnityGainBehavesAsBypass)
     const float inRms = computeRms(reference);
     const float outRms = computeRms(input);
     EXPECT_NEAR(outRms, inRms, inRms * 0.02f);
-}
\ No newline at end of file
+}
+
+// ======= TC-107 =========
+TEST_F(EqualizerIntegrationTest, TC_107_PresetCrossfadeHasNoJump)
+{
+    insertEqualizerNode();
+
+    // B is this chain left flat
+    juce::TemporaryFile presetTemp(".xml");
+    processor.savePresetToFile(presetTemp.getFile());
+
+    // A boosts the sine by 6 dB
+    auto& eq = nodeEqualizer(processor);
+    eq.setMidFreq(1000.0f);
+    eq.setMidGainDb(6.0f);
+
+    double phase = 0.0;
+    juce::MidiBuffer midi;
+    float last = 0.0f;
+    float maxJump = 0.0f;
+    auto run = [&](int blocks)
+    {
+        juce::AudioBuffer<float> in;
+        for (int b = 0; b < blocks; ++b)
+        {
+            in = makeSine(0.2f, 1000.0, phase);
+            auto out = in;
+            processor.processBlock(out, midi);
+            for (int i = 0; i < blockSize; ++i)
+            {
+                maxJump = std::max(maxJump, std::abs(out.getSample(0, i) - last));
+                last = out.getSample(0, i);
+            }
+            if (b == blocks - 1)
+                return std::make_pair(computeRms(in), computeRms(out));
+        }
+        return std::make_pair(0.0f, 0.0f);
+    };
+
+    const auto boosted = run(8);
+    ASSERT_GT(boosted.second, boosted.first * 1.5f);
+
+    // the old chain keeps its boost while it fades, so the output never steps
+    maxJump = 0.0f;
+    processor.loadPresetForTest(presetTemp.getFile());
+    const auto flat = run(8);
+
+    // a 0.4 peak sine at 1 kHz moves at most ~0.05 a sample at 48 kHz
+    EXPECT_LT(maxJump, 0.08f);
+    EXPECT_NEAR(flat.second, flat.first, flat.first * 0.05f);
+}
+
+// ======= TC-108 =========
+TEST_F(EqualizerIntegrationTest, TC_108_PresetAppliesWithoutEditor)
+{
+    insertEqualizerNode();
+
+    // save a preset with the mid band up, then flatten the chain again
+    auto node = findNode(processor, "Equalizer");
+    ASSERT_TRUE(node);
+    node->getMutableNodeState().setProperty("MidFreq", 1000.0f, nullptr);
+    node->getMutableNodeState().setProperty("MidGain", 6.0f, nullptr);
+    EXPECT_NEAR(nodeEqualizer(processor).getMidGainDb(), 6.0f, 0.01f);
+
+    juce::TemporaryFile presetTemp(".xml");
+    processor.savePresetToFile(presetTemp.getFile());
+    node->getMutableNodeState().setProperty("MidGain", 0.0f, nullptr);
+
+    // no panel is ever made, the new node's EQ is set from the preset alone
+    processor.loadPresetForTest(presetTemp.getFile());
+    auto& eq = nodeEqualizer(processor);
+    EXPECT_NEAR(eq.getMidFreq(), 1000.0f, 1.0f);
+    EXPECT_NEAR(eq.getMidGainDb(), 6.0f, 0.01f);
+
+    double phase = 0.0;
+    juce::MidiBuffer midi;
+    juce::AudioBuffer<float> in, out;
+    for (int i = 0; i < 8; ++i)
+    {
+        in = makeSine(0.2f, 1000.0, phase);
+        out = in;
+        processor.processBlock(out, midi);
+    }
+    EXPECT_GT(computeRms(out), computeRms(in) * 1.5f);
+}
@@ -61,3 +61,52 @@ TEST(VisualizerIntegrationTest, ClickingDaisyChainItemOpensCorrectTab) {
     }
 }
 
+
+// TC-99 Syncing the UI again keeps the visualizers and rows it already made
+TEST(VisualizerIntegrationTest, RebuildKeepsExistingComponents) {
+    AudioPluginAudioProcessor proc;
+    proc.prepareToPlay(44100.0, 512);
+
+    proc.loadDefaultPreset("default");
+    AudioPluginAudioProcessorEditor editor(proc);
+
+    auto& daisy = editor.getDaisyChain();
+    auto& tabs = editor.getVisualizer().getTabbedComponent();
+
+    editor.rebuildAndSyncUI();
+
+    std::vector<juce::Component*> visualizersBefore;
+    for (int i = 0; i < tabs.getNumTabs(); ++i)
+        visualizersBefore.push_back(tabs.getTabContentComponent(i));
+    std::vector<DaisyChainItem*> rowsBefore(daisy.items.begin(), daisy.items.end());
+
+    // nothing changed, so the same components should still be there in the same order
+    editor.rebuildAndSyncUI();
+
+    ASSERT_EQ(tabs.getNumTabs(), (int)visualizersBefore.size());
+    for (int i = 0; i < tabs.getNumTabs(); ++i)
+        EXPECT_EQ(tabs.getTabContentComponent(i), visualizersBefore[(size_t)i]);
+
+    ASSERT_EQ(daisy.items.size(), (int)rowsBefore.size());
+    for (int i = 0; i < daisy.items.size(); ++i)
+        EXPECT_EQ(daisy.items[i], rowsBefore[(size_t)i]);
+}
+
+// TC-100 Only the visualizer being shown is created
+TEST(VisualizerIntegrationTest, VisualizersAreCreatedWhenShown) {
+    AudioPluginAudioProcessor proc;
+    proc.prepareToPlay(44100.0, 512);
+
+    proc.loadDefaultPreset("default");
+    AudioPluginAudioProcessorEditor editor(proc);
+
+    auto& visualizer = editor.getVisualizer();
+    editor.rebuildAndSyncUI();
+    ASSERT_GT(visualizer.getNumTabs(), 1);
+
+    // the current tab is made, the rest wait until they're shown
+    EXPECT_EQ(visualizer.getNumCreatedVisualizers(), 1);
+
+    visualizer.showVisualizer(1);
+    EXPECT_EQ(visualizer.getNumCreatedVisualizers(), 2);
+}
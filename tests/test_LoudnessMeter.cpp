@@ -0,0 +1,106 @@
+//Austin
+
+#include <gtest/gtest.h>
+#include <JuceHeader.h>
+#include <cmath>
+#include "Pitchblade/effects/LoudnessMeter.h"
+
+//Feeds a stereo sine through the meter in host sized blocks. Phase carries on between calls
+static void feedSine(LoudnessMeter& meter, double sampleRate, double frequency, float amplitudeDb, double seconds, double& phase){
+    const float amplitude = juce::Decibels::decibelsToGain(amplitudeDb, -200.0f);
+    const double step = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const int blockSize = 512;
+    juce::AudioBuffer<float> buffer(2, blockSize);
+
+    int remaining = (int)(seconds * sampleRate);
+    while(remaining > 0){
+        const int count = juce::jmin(blockSize, remaining);
+        buffer.setSize(2, count, false, false, true);
+        for(int i = 0; i < count; i++){
+            const float sample = amplitude * (float)std::sin(phase);
+            buffer.setSample(0, i, sample);
+            buffer.setSample(1, i, sample);
+            phase += step;
+        }
+        meter.process(buffer);
+        remaining -= count;
+    }
+}
+
+//At 48 kHz the filters should come out as the table in BS.1770
+TEST(LoudnessMeterTest, KWeightingMatchesStandardAt48k) {
+    const auto shelf = LoudnessMeter::kWeightingShelf(48000.0);
+    EXPECT_NEAR(shelf.b0, 1.53512485958697f, 1e-5f);
+    EXPECT_NEAR(shelf.b1, -2.69169618940638f, 1e-5f);
+    EXPECT_NEAR(shelf.b2, 1.19839281085285f, 1e-5f);
+    EXPECT_NEAR(shelf.a1, -1.69065929318241f, 1e-5f);
+    EXPECT_NEAR(shelf.a2, 0.73248077421585f, 1e-5f);
+
+    const auto highPass = LoudnessMeter::kWeightingHighPass(48000.0);
+    EXPECT_NEAR(highPass.a1, -1.99004745483398f, 1e-5f);
+    EXPECT_NEAR(highPass.a2, 0.99007225036621f, 1e-5f);
+}
+
+//A 1 kHz sine at -23 dBFS in both channels is -23 LUFS (the first EBU Tech 3341 test)
+TEST(LoudnessMeterTest, StereoSineReadsItsLevel) {
+    for(double sampleRate : {44100.0, 48000.0, 96000.0}){
+        LoudnessMeter meter;
+        meter.prepare(sampleRate);
+        double phase = 0.0;
+        feedSine(meter, sampleRate, 1000.0, -23.0f, 4.0, phase);
+
+        EXPECT_NEAR(meter.getMomentaryLufs(), -23.0f, 0.1f);
+        EXPECT_NEAR(meter.getShortTermLufs(), -23.0f, 0.1f);
+        EXPECT_NEAR(meter.getIntegratedLufs(), -23.0f, 0.1f);
+    }
+}
+
+//Quiet passages under the relative gate and silence under the absolute gate shouldn't drag integrated loudness down
+TEST(LoudnessMeterTest, IntegratedLoudnessIsGated) {
+    LoudnessMeter meter;
+    meter.prepare(48000.0);
+    double phase = 0.0;
+
+    feedSine(meter, 48000.0, 1000.0, -36.0f, 10.0, phase);
+    feedSine(meter, 48000.0, 1000.0, -23.0f, 60.0, phase);
+    feedSine(meter, 48000.0, 1000.0, -36.0f, 10.0, phase);
+    feedSine(meter, 48000.0, 1000.0, -200.0f, 10.0, phase);
+
+    //Without the relative gate this would be about a dB quieter
+    EXPECT_NEAR(meter.getIntegratedLufs(), -23.0f, 0.1f);
+    //Short-term has only seen silence for the last 3 s
+    EXPECT_EQ(meter.getShortTermLufs(), LoudnessMeter::SILENCE_LUFS);
+}
+
+//A sine at a quarter of the sample rate, 45 degrees off, never has a sample on its peak. The samples sit 3 dB low
+TEST(LoudnessMeterTest, TruePeakFindsPeaksBetweenSamples) {
+    LoudnessMeter meter;
+    meter.prepare(48000.0);
+    double phase = juce::MathConstants<double>::pi * 0.25;
+    feedSine(meter, 48000.0, 12000.0, 0.0f, 1.0, phase);
+
+    EXPECT_NEAR(meter.getTruePeakDb(), 0.0f, 0.3f);
+
+    //And a low frequency sine shouldn't read over its real peak
+    LoudnessMeter lowMeter;
+    lowMeter.prepare(48000.0);
+    phase = 0.0;
+    feedSine(lowMeter, 48000.0, 997.0, -6.0f, 1.0, phase);
+    EXPECT_NEAR(lowMeter.getTruePeakDb(), -6.0f, 0.1f);
+}
+
+//A reset from another thread should take effect on the next block and clear everything, true peak included
+TEST(LoudnessMeterTest, ResetClearsReadings) {
+    LoudnessMeter meter;
+    meter.prepare(48000.0);
+    double phase = 0.0;
+    feedSine(meter, 48000.0, 1000.0, -10.0f, 2.0, phase);
+    ASSERT_GT(meter.getIntegratedLufs(), -11.0f);
+
+    meter.requestReset();
+    feedSine(meter, 48000.0, 1000.0, -200.0f, 0.05, phase);
+
+    EXPECT_EQ(meter.getIntegratedLufs(), LoudnessMeter::SILENCE_LUFS);
+    EXPECT_EQ(meter.getMomentaryLufs(), LoudnessMeter::SILENCE_LUFS);
+    EXPECT_EQ(meter.getTruePeakDb(), LoudnessMeter::SILENCE_LUFS);
+}
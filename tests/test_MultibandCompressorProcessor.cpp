@@ -0,0 +1,72 @@
+//Austin
+
+#include <gtest/gtest.h>
+#include <JuceHeader.h>
+#include "Pitchblade/effects/MultibandCompressorProcessor.h"
+
+class MultibandCompressorProcessorTest : public ::testing::Test {
+protected:
+    std::unique_ptr<MultibandCompressorProcessor> processor;
+
+    void SetUp() override {
+        processor = std::make_unique<MultibandCompressorProcessor>();
+        processor->prepare(44100);
+    }
+
+    //Helper to run a sine through the processor and return the peak of the last block
+    float runSine(float frequency, float amplitude, int numBlocks){
+        juce::AudioBuffer<float> buffer(2, 512);
+        double phase = 0.0;
+        const double increment = juce::MathConstants<double>::twoPi * frequency / 44100.0;
+        float peak = 0.0f;
+
+        for(int block = 0; block < numBlocks; block++){
+            for(int i = 0; i < buffer.getNumSamples(); i++){
+                const float sample = amplitude * (float)std::sin(phase);
+                phase += increment;
+                buffer.setSample(0, i, sample);
+                buffer.setSample(1, i, sample);
+            }
+            processor->process(buffer);
+            peak = buffer.getMagnitude(0, 0, buffer.getNumSamples());
+        }
+        return peak;
+    }
+};
+
+//With no compression the bands should add back up to the input, no matter how many bands there are
+TEST_F(MultibandCompressorProcessorTest, BandsSumToFlatResponse) {
+    for(int b = 0; b < MultibandCompressorProcessor::maxBands; b++){
+        processor->setRatio(b, 1.0f);
+    }
+
+    for(int bands = 2; bands <= MultibandCompressorProcessor::maxBands; bands++){
+        processor->setNumBands(bands);
+        for(float frequency : {60.0f, 200.0f, 1000.0f, 3000.0f, 5000.0f, 12000.0f}){
+            processor->prepare(44100);
+            const float peak = runSine(frequency, 0.5f, 20);
+            ASSERT_NEAR(juce::Decibels::gainToDecibels(peak), juce::Decibels::gainToDecibels(0.5f), 0.1f);
+        }
+    }
+}
+
+//Only the band the signal is in should be turned down
+TEST_F(MultibandCompressorProcessorTest, CompressesOnlyTheBandWithSignal) {
+    processor->setNumBands(3);
+    processor->setCrossover(0, 200.0f);
+    processor->setCrossover(1, 2000.0f);
+    processor->setThreshold(0, -30.0f);
+    processor->setRatio(0, 10.0f);
+    processor->setThreshold(2, -30.0f);
+    processor->setRatio(2, 10.0f);
+
+    //Low band is over its threshold, so it gets compressed
+    const float lowPeak = runSine(60.0f, 0.5f, 40);
+    ASSERT_LT(juce::Decibels::gainToDecibels(lowPeak), -20.0f);
+    ASSERT_LT(processor->bandGainReductionDb[0].load(), -10.0f);
+
+    //The middle band is left at its 0 dB threshold, so a mid tone passes through untouched
+    processor->prepare(44100);
+    const float midPeak = runSine(700.0f, 0.5f, 40);
+    ASSERT_NEAR(juce::Decibels::gainToDecibels(midPeak), juce::Decibels::gainToDecibels(0.5f), 0.5f);
+}
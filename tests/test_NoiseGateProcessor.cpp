@@ -96,4 +96,28 @@ TEST_F(NoiseGateProcessorTest, ReleaseTime){
     simulateConstantSignal(buffer, 59.0f, juce::Decibels::decibelsToGain(-40.0f));
 
     ASSERT_NEAR(buffer.getSample(0, 100),0.0,0.0001f);
-}
\ No newline at end of file
+}
+
+//With lookahead, the gate should already be open when the delayed onset comes out
+TEST_F(NoiseGateProcessorTest, LookaheadOpensBeforeOnset){
+
+    juce::AudioBuffer<float> buffer(1, 512);
+
+    processor->prepare(44100);
+
+    processor->setThreshold(-30.0f);
+    processor->setAttack(1.0f);
+    processor->setRelease(50.0f);
+    processor->setLookahead(5.0f);
+
+    const int latency = processor->getLatencySamples();
+    ASSERT_EQ(latency, (int)std::round(0.005 * 44100));
+
+    simulateConstantSignal(buffer, 100.0f, 0.0f);
+
+    juce::FloatVectorOperations::fill(buffer.getWritePointer(0), juce::Decibels::decibelsToGain(-12.0f), buffer.getNumSamples());
+    processor->process(buffer);
+
+    //The first sample of the onset comes out after the delay, and should not be cut
+    ASSERT_NEAR(buffer.getSample(0, latency), juce::Decibels::decibelsToGain(-12.0f), 0.001f);
+}
@@ -0,0 +1,189 @@
+//huda
+#include <gtest/gtest.h>
+#include <JuceHeader.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Pitchblade/effects/ParametricEq.h"
+
+class ParametricEqTest : public ::testing::Test {
+protected:
+    ParametricEq eq;
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    int numChannels = 2;
+
+    // A typical corrective vocal EQ
+    void setUpVocalCurve()
+    {
+        using T = ParametricEq::BandType;
+        const T types[] = { T::lowCut, T::bell, T::bell, T::notch, T::bell, T::bell, T::highShelf, T::highCut };
+        const float freqs[] = { 90.0f, 250.0f, 400.0f, 1200.0f, 3000.0f, 5500.0f, 9000.0f, 16000.0f };
+        const float gains[] = { 0.0f, -3.0f, -2.0f, 0.0f, 2.5f, -4.0f, 3.0f, 0.0f };
+        const float qs[] = { 0.707f, 1.2f, 2.0f, 8.0f, 1.0f, 4.0f, 0.707f, 0.707f };
+
+        eq.setNumBands(8);
+        for (int b = 0; b < 8; ++b)
+        {
+            eq.setBandType(b, types[b]);
+            eq.setBandFrequency(b, freqs[b]);
+            eq.setBandGainDb(b, gains[b]);
+            eq.setBandQ(b, qs[b]);
+        }
+    }
+
+    juce::AudioBuffer<float> makeNoise(int numSamples, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+        juce::AudioBuffer<float> buffer(numChannels, numSamples);
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(ch, i, dist(rng));
+        return buffer;
+    }
+
+    // Runs a buffer through the EQ in blocks of the given sizes, cycling through them
+    void processInBlocks(juce::AudioBuffer<float>& buffer, const std::vector<int>& sizes)
+    {
+        int pos = 0;
+        for (size_t k = 0; pos < buffer.getNumSamples(); ++k)
+        {
+            const int len = std::min(sizes[k % sizes.size()], buffer.getNumSamples() - pos);
+            juce::AudioBuffer<float> block(numChannels, len);
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < len; ++i)
+                    block.setSample(ch, i, buffer.getSample(ch, pos + i));
+
+            eq.processBlock(block);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < len; ++i)
+                    buffer.setSample(ch, pos + i, block.getSample(ch, i));
+            pos += len;
+        }
+    }
+};
+
+// The staggered SIMD lanes have to give the same answer as running the bands one after another,
+// including for blocks shorter than the pipeline
+TEST_F(ParametricEqTest, MatchesPlainCascade)
+{
+    setUpVocalCurve();
+    eq.prepare(sampleRate, blockSize, numChannels);
+
+    auto input = makeNoise(4096, 1);
+    juce::AudioBuffer<float> output(input);
+    processInBlocks(output, { 1, 2, 3, 5, 64, 511, 7, 256 });
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        std::vector<BiquadState> cascade(8);
+        for (int i = 0; i < input.getNumSamples(); ++i)
+        {
+            float x = input.getSample(ch, i);
+            for (int b = 0; b < 8; ++b)
+            {
+                const auto c = ParametricEq::designBand(sampleRate, eq.getBandType(b), eq.getBandFrequency(b),
+                                                        eq.getBandGainDb(b), eq.getBandQ(b));
+                x = cascade[(size_t)b].process(x, c);
+            }
+            ASSERT_NEAR(output.getSample(ch, i), x, 1.0e-4f);
+        }
+    }
+}
+
+// With every band flat the audio should come through untouched
+TEST_F(ParametricEqTest, FlatBandsPassAudioUnchanged)
+{
+    eq.setNumBands(16);
+    eq.prepare(sampleRate, blockSize, numChannels);
+
+    auto input = makeNoise(blockSize, 2);
+    juce::AudioBuffer<float> output(input);
+    eq.processBlock(output);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            ASSERT_EQ(output.getSample(ch, i), input.getSample(ch, i));
+}
+
+// Bands past the band count, or switched off, should have no effect
+TEST_F(ParametricEqTest, UnusedBandsAreIgnored)
+{
+    eq.setNumBands(4);
+    eq.setBandGainDb(6, 12.0f);
+    eq.setBandGainDb(1, -12.0f);
+    eq.setBandEnabled(1, false);
+    eq.prepare(sampleRate, blockSize, numChannels);
+
+    auto input = makeNoise(blockSize, 3);
+    juce::AudioBuffer<float> output(input);
+    eq.processBlock(output);
+
+    for (int i = 0; i < blockSize; ++i)
+        ASSERT_EQ(output.getSample(0, i), input.getSample(0, i));
+}
+
+// Sweeping every knob and type while audio plays should stay stable and end up on the new curve
+TEST_F(ParametricEqTest, ChangesWhilePlayingStayStable)
+{
+    eq.prepare(sampleRate, blockSize, numChannels);
+
+    auto input = makeNoise(48000, 4);
+    int pos = 0;
+    for (int block = 0; pos < input.getNumSamples(); ++block)
+    {
+        for (int b = 0; b < 8; ++b)
+        {
+            eq.setBandType(b, (ParametricEq::BandType)((block + b) % ParametricEq::numBandTypes));
+            eq.setBandFrequency(b, 40.0f * std::pow(2.0f, (float)((block * 3 + b) % 9)));
+            eq.setBandGainDb(b, (float)((block + b) % 7) * 4.0f - 12.0f);
+            eq.setBandQ(b, 0.3f + (float)((block + 2 * b) % 5));
+        }
+
+        const int len = std::min(blockSize, input.getNumSamples() - pos);
+        juce::AudioBuffer<float> chunk(numChannels, len);
+        for (int i = 0; i < len; ++i)
+            for (int ch = 0; ch < numChannels; ++ch)
+                chunk.setSample(ch, i, input.getSample(ch, pos + i));
+        eq.processBlock(chunk);
+
+        for (int i = 0; i < len; ++i)
+            ASSERT_TRUE(std::isfinite(chunk.getSample(0, i)) && std::abs(chunk.getSample(0, i)) < 100.0f);
+        pos += len;
+    }
+
+    // move to one 1 kHz bell at +6 dB with the rest flat, and a 1 kHz sine should settle 6 dB up
+    for (int b = 0; b < 8; ++b)
+    {
+        eq.setBandType(b, ParametricEq::BandType::bell);
+        eq.setBandGainDb(b, 0.0f);
+    }
+    eq.setBandFrequency(2, 1000.0f);
+    eq.setBandGainDb(2, 6.0f);
+    eq.setBandQ(2, 1.0f);
+
+    const int settleSamples = (int)sampleRate;
+    const int measureSamples = 4800;
+    double inSum = 0.0, outSum = 0.0;
+    for (pos = 0; pos < settleSamples; pos += blockSize)
+    {
+        juce::AudioBuffer<float> chunk(numChannels, blockSize);
+        for (int i = 0; i < blockSize; ++i)
+            for (int ch = 0; ch < numChannels; ++ch)
+                chunk.setSample(ch, i, 0.25f * (float)std::sin(2.0 * juce::MathConstants<double>::pi * 1000.0 * (pos + i) / sampleRate));
+        juce::AudioBuffer<float> dry(chunk);
+        eq.processBlock(chunk);
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            if (pos + i < settleSamples - measureSamples) continue;
+            inSum += dry.getSample(0, i) * dry.getSample(0, i);
+            outSum += chunk.getSample(0, i) * chunk.getSample(0, i);
+        }
+    }
+    const double gainDb = 10.0 * std::log10(outSum / inSum);
+    EXPECT_NEAR(gainDb, 6.0, 0.25);
+}
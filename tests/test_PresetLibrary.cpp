@@ -0,0 +1,102 @@
+//reyna
+
+#include <gtest/gtest.h>
+#include <JuceHeader.h>
+
+#include "Pitchblade/PresetLibrary.h"
+
+// writes a small preset with the given node tags
+static void writePreset(const juce::File& file, const juce::StringArray& nodeTypes, const juce::String& tags = {}) {
+    juce::XmlElement root("PitchbladePreset");
+    root.setAttribute("version", 1.0);
+    if (tags.isNotEmpty())
+        root.setAttribute("tags", tags);
+
+    auto* nodes = root.createNewChildElement("EffectNodes");
+    for (auto& t : nodeTypes)
+        nodes->createNewChildElement(t)->setAttribute("name", t);
+
+    file.getParentDirectory().createDirectory();
+    root.writeTo(file);
+}
+
+// TC-103 Preset library indexes a folder and searches by name, tag and effect
+TEST(PresetLibraryTest, IndexesAndSearchesPresets) {
+    juce::TemporaryFile folderTemp;
+    auto folder = folderTemp.getFile();
+    folder.createDirectory();
+    auto index = folder.getSiblingFile(folder.getFileName() + "_index.bin");
+
+    writePreset(folder.getChildFile("Warm Vocal.xml"), { "GainNode", "CompressorNode" }, "warm, lead");
+    writePreset(folder.getChildFile("Podcast/Clean Voice.xml"), { "NoiseGateNode", "DeNoiserNode" });
+    folder.getChildFile("notes.xml").replaceWithText("<NotAPreset/>");
+
+    {
+        PresetLibrary library(folder, index);
+        ASSERT_TRUE(library.waitForScan(5000));
+
+        EXPECT_EQ(library.getNumPresets(), 2);
+        EXPECT_EQ(library.search("").size(), 2u);
+
+        // name, preset tag and folder tag
+        ASSERT_EQ(library.search("warm").size(), 1u);
+        EXPECT_EQ(library.search("warm")[0].name, "Warm Vocal");
+        EXPECT_EQ(library.search("lead vocal").size(), 1u);
+        EXPECT_EQ(library.search("podcast").size(), 1u);
+
+        // effect filter
+        auto gated = library.search("", "NoiseGateNode");
+        ASSERT_EQ(gated.size(), 1u);
+        EXPECT_EQ(gated[0].name, "Clean Voice");
+        EXPECT_TRUE(library.getAllNodeTypes().contains("DeNoiserNode"));
+        EXPECT_EQ(gated[0].hash.length(), 16);
+    }
+
+    // notes.xml is remembered as not a preset, so nothing is opened again and the index isn't rewritten
+    const auto indexWritten = index.getLastModificationTime();
+    {
+        PresetLibrary library(folder, index);
+        ASSERT_TRUE(library.waitForScan(5000));
+        EXPECT_EQ(library.getNumParsedLastScan(), 0);
+        EXPECT_EQ(library.getNumPresets(), 2);
+        EXPECT_EQ(library.search("notes").size(), 0u);
+    }
+    EXPECT_EQ(index.getLastModificationTime(), indexWritten);
+
+    index.deleteFile();
+    folder.deleteRecursively();
+}
+
+// TC-104 A new library reads the index and only opens presets that changed
+TEST(PresetLibraryTest, StartupOnlyReadsTheIndex) {
+    juce::TemporaryFile folderTemp;
+    auto folder = folderTemp.getFile();
+    folder.createDirectory();
+    auto index = folder.getSiblingFile(folder.getFileName() + "_index.bin");
+
+    for (int i = 0; i < 20; ++i)
+        writePreset(folder.getChildFile("Preset " + juce::String(i) + ".xml"), { "GainNode" });
+
+    {
+        PresetLibrary first(folder, index);
+        ASSERT_TRUE(first.waitForScan(5000));
+        EXPECT_EQ(first.getNumParsedLastScan(), 20);
+    }
+    ASSERT_TRUE(index.existsAsFile());
+
+    // one preset added, the other 20 come from the index
+    writePreset(folder.getChildFile("Preset new.xml"), { "PitchNode" });
+    {
+        PresetLibrary second(folder, index);
+        // searchable before the scan, straight from the index
+        EXPECT_GE(second.getNumPresets(), 20);
+
+        ASSERT_TRUE(second.waitForScan(5000));
+        EXPECT_EQ(second.getNumParsedLastScan(), 1);
+        EXPECT_EQ(second.getNumPresets(), 21);
+        EXPECT_EQ(second.search("", "PitchNode").size(), 1u);
+    }
+
+    index.deleteFile();
+    folder.deleteRecursively();
+}
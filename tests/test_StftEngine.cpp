@@ -0,0 +1,92 @@
+//Austin
+
+#include <gtest/gtest.h>
+#include <JuceHeader.h>
+#include <cmath>
+#include "Pitchblade/effects/StftEngine.h"
+
+class StftEngineTest : public ::testing::Test {
+protected:
+    StftEngine engine;
+    const double sampleRate = 48000.0;
+    const int blockSize = 480;
+
+    //Runs a sine through the engine with the given callback, and returns the largest difference from the input delayed by the latency
+    template<typename FrameCallback>
+    float runAndCompare(int numBlocks, FrameCallback&& onFrame){
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        std::vector<float> input;
+        std::vector<float> output;
+
+        for(int b = 0; b < numBlocks; b++){
+            for(int i = 0; i < blockSize; i++){
+                const float sample = 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * 440.0 * (double)input.size() / sampleRate);
+                input.push_back(sample);
+                buffer.setSample(0, i, sample);
+                buffer.setSample(1, i, -sample);
+            }
+            engine.process(buffer, onFrame);
+            for(int i = 0; i < blockSize; i++){
+                output.push_back(buffer.getSample(0, i));
+                //The second channel should be processed on its own
+                if(std::abs(buffer.getSample(1, i) + buffer.getSample(0, i)) > 1.0e-5f){
+                    return 1.0f;
+                }
+            }
+        }
+
+        //Skip the first frame while the overlap fills up
+        const int latency = engine.getLatencySamples();
+        float worst = 0.0f;
+        for(size_t i = (size_t)(latency * 2); i < output.size(); i++){
+            worst = std::max(worst, std::abs(output[i] - input[i - (size_t)latency]));
+        }
+        return worst;
+    }
+};
+
+//Passing the spectra straight through should give back the input exactly, one frame later, for every supported hop
+TEST_F(StftEngineTest, UnchangedSpectraReconstructInput) {
+    for(int hopDivisor : { 4, 8, 16 }){
+        engine.prepare(10, (1 << 10) / hopDivisor, 2);
+        ASSERT_EQ(engine.getLatencySamples(), 1024);
+
+        const float error = runAndCompare(40, [](std::complex<float>* const*, int){});
+        ASSERT_LT(error, 1.0e-4f);
+    }
+}
+
+//The callback should see one frame per hop, and its changes should end up in the output
+TEST_F(StftEngineTest, CallbackRunsOncePerHopAndChangesOutput) {
+    engine.prepare(9, 128, 2);
+
+    int frames = 0;
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    for(int b = 0; b < 20; b++){
+        for(int ch = 0; ch < 2; ch++){
+            for(int i = 0; i < blockSize; i++){
+                buffer.setSample(ch, i, 0.25f);
+            }
+        }
+        engine.process(buffer, [&](std::complex<float>* const* spectra, int numChannels){
+            frames++;
+            //Halve every bin
+            for(int ch = 0; ch < numChannels; ch++){
+                for(int i = 0; i < engine.getNumBins(); i++){
+                    spectra[ch][i] *= 0.5f;
+                }
+            }
+        });
+    }
+    ASSERT_EQ(frames, 20 * blockSize / 128);
+    ASSERT_NEAR(buffer.getSample(0, blockSize - 1), 0.125f, 1.0e-4f);
+}
+
+//Engines with the same FFT size should share one window table
+TEST_F(StftEngineTest, PlansAreShared) {
+    StftEngine other;
+    engine.prepare(11, 512, 1);
+    other.prepare(11, 256, 2);
+    ASSERT_TRUE(&engine.getPlan() == &other.getPlan());
+    ASSERT_TRUE(StftPlan::get(11).get() == &engine.getPlan());
+}
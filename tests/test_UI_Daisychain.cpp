@@ -619,3 +619,157 @@ TEST(DaisyChainTest, StateLoadReconstructsExactDaisyChainLayout) {
     EXPECT_EQ(orderBeforeSave, orderAfterLoad);
 }
 
+
+// TC-101 Long chains only put the rows in view into the list
+TEST(DaisyChainTest, LongChainOnlyAddsRowsInView) {
+    AudioPluginAudioProcessor proc;
+    proc.prepareToPlay(44100.0, 512);
+
+    auto& nodes = proc.getEffectNodes();
+    ASSERT_FALSE(nodes.empty());
+
+    // template sized chain of copies
+    while (nodes.size() < 40) {
+        auto copy = nodes[0]->clone();
+        copy->effectName = nodes[0]->effectName + " " + juce::String((int)nodes.size());
+        nodes.push_back(copy);
+    }
+
+    DaisyChain dc(proc, nodes);
+    dc.setSize(250, 400);
+    dc.resetRowsToNodes();
+    dc.rebuild();
+
+    // every row still has its item
+    ASSERT_EQ(dc.items.size(), (int)nodes.size());
+
+    int inList = 0;
+    for (auto* item : dc.items)
+        if (item->getParentComponent() != nullptr)
+            ++inList;
+
+    // a 400px sidebar fits a handful of 56px rows, not all 40
+    EXPECT_GT(inList, 0);
+    EXPECT_LT(inList, 15);
+
+    // the first row is in view and laid out
+    EXPECT_NE(dc.items[0]->getParentComponent(), nullptr);
+    EXPECT_GT(dc.items[0]->getHeight(), 0);
+}
+
+// TC-102 Session state rebuilds the chain, uuids and bypass included, at the first prepare
+TEST(DaisyChainTest, SessionStateRestoresWholeChain) {
+    AudioPluginAudioProcessor proc1;
+    proc1.prepareToPlay(44100.0, 512);
+
+    auto& nodes1 = proc1.getEffectNodes();
+    ASSERT_GE(nodes1.size(), 2u);
+
+    // reverse the rows and bypass one node
+    std::vector<AudioPluginAudioProcessor::Row> rows;
+    for (auto it = nodes1.rbegin(); it != nodes1.rend(); ++it)
+        rows.push_back({ (*it)->effectName, {} });
+    proc1.requestLayout(rows);
+    nodes1.back()->bypassed = true;
+
+    std::vector<juce::String> namesBefore, uuidsBefore;
+    for (auto& r : rows) {
+        namesBefore.push_back(r.left);
+        for (auto& n : nodes1)
+            if (n->effectName == r.left) uuidsBefore.push_back(n->getUuid());
+    }
+
+    juce::MemoryBlock state;
+    proc1.getStateInformation(state);
+    ASSERT_GT(state.getSize(), 4u);
+    EXPECT_EQ(juce::String((const char*)state.getData(), 4), "PBSS");
+
+    // restored before prepare like a host does, nothing is built until the rate is known
+    AudioPluginAudioProcessor proc2;
+    proc2.setStateInformation(state.getData(), (int)state.getSize());
+    EXPECT_TRUE(proc2.getEffectNodes().empty());
+
+    proc2.prepareToPlay(44100.0, 512);
+    auto& nodes2 = proc2.getEffectNodes();
+    ASSERT_EQ(nodes2.size(), namesBefore.size());
+
+    for (size_t i = 0; i < nodes2.size(); ++i) {
+        EXPECT_EQ(nodes2[i]->effectName, namesBefore[i]);
+        EXPECT_EQ(nodes2[i]->getUuid(), uuidsBefore[i]);
+    }
+    EXPECT_TRUE(nodes2.front()->bypassed);
+
+    // a second prepare at the same rate keeps the same nodes
+    auto* first = nodes2.front().get();
+    proc2.prepareToPlay(44100.0, 512);
+    EXPECT_EQ(proc2.getEffectNodes().front().get(), first);
+}
+
+// TC-105 A/B morph blends params when B has the same nodes as A
+TEST(DaisyChainTest, MorphBlendsMatchingChains) {
+    AudioPluginAudioProcessor proc;
+    proc.prepareToPlay(44100.0, 512);
+
+    auto& nodes = proc.getEffectNodes();
+    ASSERT_FALSE(nodes.empty());
+    auto gain = nodes.front();
+
+    // B is the chain at 0 dB, then A is turned up
+    gain->getMutableNodeState().setProperty("Gain", 0.0f, nullptr);
+    proc.captureMorphTarget();
+    ASSERT_TRUE(proc.hasMorphTarget());
+    EXPECT_TRUE(proc.isMorphBlending());
+
+    gain->getMutableNodeState().setProperty("Gain", 12.0f, nullptr);
+    proc.updateMorph();     // sitting at A keeps the new value as A's
+
+    auto* morph = proc.apvts.getParameter("GLOBAL_MORPH");
+    ASSERT_NE(morph, nullptr);
+    morph->setValueNotifyingHost(0.5f);
+    proc.updateMorph();
+    EXPECT_NEAR((double)gain->getNodeState().getProperty("Gain"), 6.0, 0.01);
+
+    morph->setValueNotifyingHost(0.0f);
+    proc.updateMorph();
+    EXPECT_NEAR((double)gain->getNodeState().getProperty("Gain"), 12.0, 0.01);
+
+    proc.clearMorphTarget();
+    EXPECT_FALSE(proc.hasMorphTarget());
+}
+
+// TC-106 A/B morph crossfades chains that don't match, and B sleeps at A
+TEST(DaisyChainTest, MorphCrossfadesDifferentChains) {
+    AudioPluginAudioProcessor proc;
+    proc.prepareToPlay(44100.0, 512);
+
+    // B is the default chain turned down, A is empty so it passes the input straight through
+    auto& nodes = proc.getEffectNodes();
+    ASSERT_FALSE(nodes.empty());
+    nodes.front()->getMutableNodeState().setProperty("Gain", -24.0f, nullptr);
+    proc.captureMorphTarget();
+    proc.clearAllNodes();
+    proc.updateMorph();
+    EXPECT_FALSE(proc.isMorphBlending());
+
+    juce::AudioBuffer<float> buffer(2, 512);
+    juce::MidiBuffer midi;
+    auto fill = [&buffer]() {
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < 512; ++i)
+                buffer.setSample(ch, i, 0.5f * std::sin(0.05f * (float)i));
+    };
+
+    // at A, B is asleep and the input comes out untouched
+    fill();
+    const float inputRms = buffer.getRMSLevel(0, 0, 512);
+    proc.processBlock(buffer, midi);
+    EXPECT_NEAR(buffer.getRMSLevel(0, 0, 512), inputRms, 1.0e-6f);
+
+    // all the way to B, once the 20 ms ramp is done only B is heard
+    proc.apvts.getParameter("GLOBAL_MORPH")->setValueNotifyingHost(1.0f);
+    for (int b = 0; b < 40; ++b) {
+        fill();
+        proc.processBlock(buffer, midi);
+    }
+    EXPECT_LT(buffer.getRMSLevel(0, 0, 512), inputRms * 0.5f);
+}